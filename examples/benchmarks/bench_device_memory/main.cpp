@@ -0,0 +1,213 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_cuda.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#define BENCH_NAME "bench_device_memory"
+#define ALLOC_NAME "default_allocator"
+
+#define MIN_BYTES   (1 << 6)
+#define MAX_BYTES   (1 << 22)
+/* each size is repeated until at least this many bytes have moved */
+#define BENCH_BYTES (1 << 23)
+#define MIN_REPS    3
+
+/* allocator workload */
+#define ALLOCATIONS      2048
+#define CHURN_LIVE       256
+#define CHURN_OPS        8192
+#define MAX_ALLOC_BYTES  (1 << 16)
+
+/*!
+ * Measures hb_mc_device_pod_memcpy_to_device/to_host and DMA bandwidth
+ * as the transfer size grows, and the throughput of
+ * hb_mc_device_pod_malloc/free.
+ * This benchmark uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+ */
+
+static int reps_for(size_t bytes)
+{
+        return std::max<int>(MIN_REPS, BENCH_BYTES / bytes);
+}
+
+static bench_fields bandwidth_fields(size_t bytes, int reps, double ns)
+{
+        return {{"ns_per_call", ns / reps}, {"mb_per_s", 1e3 * bytes * reps / ns}};
+}
+
+static int bench_memcpy(hb_mc_device_t *device, bench_report *report, hb_mc_eva_t eva,
+                        std::vector<uint8_t> &out, std::vector<uint8_t> &in, size_t bytes)
+{
+        hb_mc_pod_id_t pod = device->default_pod_id;
+        int reps = reps_for(bytes);
+
+        double t0 = bench_now_ns();
+        for (int r = 0; r < reps; r++)
+                BSG_CUDA_CALL(hb_mc_device_pod_memcpy_to_device(device, pod, eva, out.data(), bytes));
+        double t1 = bench_now_ns();
+        report->add("memcpy_to_device", {{"bytes", static_cast<double>(bytes)}, {"reps", static_cast<double>(reps)}},
+                    bandwidth_fields(bytes, reps, t1 - t0));
+
+        t0 = bench_now_ns();
+        for (int r = 0; r < reps; r++)
+                BSG_CUDA_CALL(hb_mc_device_pod_memcpy_to_host(device, pod, in.data(), eva, bytes));
+        t1 = bench_now_ns();
+        report->add("memcpy_to_host", {{"bytes", static_cast<double>(bytes)}, {"reps", static_cast<double>(reps)}},
+                    bandwidth_fields(bytes, reps, t1 - t0));
+
+        if (!std::equal(out.begin(), out.begin() + bytes, in.begin())) {
+                bsg_pr_err("%s: memcpy of %zu bytes does not match\n", BENCH_NAME, bytes);
+                return HB_MC_FAIL;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int bench_dma(hb_mc_device_t *device, bench_report *report, hb_mc_eva_t eva,
+                     std::vector<uint8_t> &out, std::vector<uint8_t> &in, size_t bytes)
+{
+        hb_mc_pod_id_t pod = device->default_pod_id;
+        int reps = reps_for(bytes);
+        hb_mc_dma_htod_t htod = {.d_addr = eva, .h_addr = out.data(), .size = bytes};
+        hb_mc_dma_dtoh_t dtoh = {.d_addr = eva, .h_addr = in.data(), .size = bytes};
+
+        double t0 = bench_now_ns();
+        for (int r = 0; r < reps; r++)
+                BSG_CUDA_CALL(hb_mc_device_pod_dma_to_device(device, pod, &htod, 1));
+        double t1 = bench_now_ns();
+        report->add("dma_to_device", {{"bytes", static_cast<double>(bytes)}, {"reps", static_cast<double>(reps)}},
+                    bandwidth_fields(bytes, reps, t1 - t0));
+
+        t0 = bench_now_ns();
+        for (int r = 0; r < reps; r++)
+                BSG_CUDA_CALL(hb_mc_device_pod_dma_to_host(device, pod, &dtoh, 1));
+        t1 = bench_now_ns();
+        report->add("dma_to_host", {{"bytes", static_cast<double>(bytes)}, {"reps", static_cast<double>(reps)}},
+                    bandwidth_fields(bytes, reps, t1 - t0));
+
+        if (!std::equal(out.begin(), out.begin() + bytes, in.begin())) {
+                bsg_pr_err("%s: DMA of %zu bytes does not match\n", BENCH_NAME, bytes);
+                return HB_MC_FAIL;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static uint32_t random_alloc_size(void)
+{
+        return 1 + rand() % MAX_ALLOC_BYTES;
+}
+
+static int bench_malloc_free(hb_mc_device_t *device, bench_report *report)
+{
+        hb_mc_pod_id_t pod = device->default_pod_id;
+        std::vector<hb_mc_eva_t> live(ALLOCATIONS);
+
+        /* allocate everything, then free in a random order */
+        double t0 = bench_now_ns();
+        for (auto &eva : live)
+                BSG_CUDA_CALL(hb_mc_device_pod_malloc(device, pod, random_alloc_size(), &eva));
+        double t1 = bench_now_ns();
+
+        for (size_t i = live.size() - 1; i > 0; i--)
+                std::swap(live[i], live[rand() % (i + 1)]);
+        double t2 = bench_now_ns();
+        for (auto eva : live)
+                BSG_CUDA_CALL(hb_mc_device_pod_free(device, pod, eva));
+        double t3 = bench_now_ns();
+
+        report->add("malloc", {{"allocations", ALLOCATIONS}, {"max_bytes", MAX_ALLOC_BYTES}},
+                    {{"ns_per_op", (t1 - t0) / ALLOCATIONS}, {"ops_per_s", 1e9 * ALLOCATIONS / (t1 - t0)}});
+        report->add("free", {{"allocations", ALLOCATIONS}, {"max_bytes", MAX_ALLOC_BYTES}},
+                    {{"ns_per_op", (t3 - t2) / ALLOCATIONS}, {"ops_per_s", 1e9 * ALLOCATIONS / (t3 - t2)}});
+
+        /* steady state: free a random allocation and replace it */
+        live.resize(CHURN_LIVE);
+        for (auto &eva : live)
+                BSG_CUDA_CALL(hb_mc_device_pod_malloc(device, pod, random_alloc_size(), &eva));
+
+        t0 = bench_now_ns();
+        for (int i = 0; i < CHURN_OPS; i++) {
+                hb_mc_eva_t &eva = live[rand() % live.size()];
+                BSG_CUDA_CALL(hb_mc_device_pod_free(device, pod, eva));
+                BSG_CUDA_CALL(hb_mc_device_pod_malloc(device, pod, random_alloc_size(), &eva));
+        }
+        t1 = bench_now_ns();
+
+        for (auto eva : live)
+                BSG_CUDA_CALL(hb_mc_device_pod_free(device, pod, eva));
+
+        report->add("malloc_free_churn", {{"live", CHURN_LIVE}, {"ops", 2 * CHURN_OPS},
+                                          {"max_bytes", MAX_ALLOC_BYTES}},
+                    {{"ns_per_op", (t1 - t0) / (2 * CHURN_OPS)},
+                     {"ops_per_s", 1e9 * 2 * CHURN_OPS / (t1 - t0)}});
+        return HB_MC_SUCCESS;
+}
+
+int bench_device_memory(int argc, char **argv)
+{
+        struct arguments_path args = {NULL, NULL};
+        argp_parse(&argp_path, argc, argv, 0, 0, &args);
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, BENCH_NAME, 0));
+        BSG_CUDA_CALL(hb_mc_device_program_init(&device, args.path, ALLOC_NAME, 0));
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(device.mc);
+
+        std::vector<uint8_t> out(MAX_BYTES), in(MAX_BYTES);
+        for (auto &b : out)
+                b = static_cast<uint8_t>(rand());
+
+        hb_mc_eva_t eva;
+        BSG_CUDA_CALL(hb_mc_device_malloc(&device, MAX_BYTES, &eva));
+
+        for (size_t bytes = MIN_BYTES; bytes <= MAX_BYTES; bytes *= 4)
+                BSG_CUDA_CALL(bench_memcpy(&device, &report, eva, out, in, bytes));
+
+        if (hb_mc_manycore_supports_dma_write(device.mc) && hb_mc_manycore_supports_dma_read(device.mc)) {
+                for (size_t bytes = MIN_BYTES; bytes <= MAX_BYTES; bytes *= 4)
+                        BSG_CUDA_CALL(bench_dma(&device, &report, eva, out, in, bytes));
+        } else {
+                bsg_pr_test_info("%s: DMA is not supported on this platform\n", BENCH_NAME);
+        }
+
+        BSG_CUDA_CALL(hb_mc_device_free(&device, eva));
+        BSG_CUDA_CALL(bench_malloc_free(&device, &report));
+
+        BSG_CUDA_CALL(report.write());
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_device_memory);
@@ -0,0 +1,153 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_config_pod.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#define BENCH_NAME "bench_dram_interleave"
+
+/* transfers start at one stripe and grow to many stripes per cache */
+#define MAX_BYTES   (1 << 20)
+/* each size is repeated until at least this many bytes have moved */
+#define BENCH_BYTES (1 << 22)
+#define MIN_REPS    3
+
+/*!
+ * Measures the bandwidth of hb_mc_manycore_eva_write() and
+ * hb_mc_manycore_eva_read() to the DRAM of a pod as the transfer grows,
+ * with packets sent in linear order (one stripe, and so one cache, at a
+ * time) and in interleaved order (round-robin across the caches).
+ */
+
+static const struct {
+        const char *name;
+        hb_mc_manycore_bulk_order_t order;
+} orders[] = {
+        {"linear",      HB_MC_MANYCORE_BULK_ORDER_LINEAR},
+        {"interleaved", HB_MC_MANYCORE_BULK_ORDER_INTERLEAVED},
+};
+
+static int bench_size(hb_mc_manycore_t *mc, bench_report *report,
+                      const hb_mc_coordinate_t *origin, hb_mc_eva_t base, size_t caches,
+                      std::vector<uint32_t> &out, std::vector<uint32_t> &in, size_t bytes)
+{
+        int reps = std::max<int>(MIN_REPS, BENCH_BYTES / bytes);
+        bench_fields params = {{"bytes", static_cast<double>(bytes)},
+                               {"caches", static_cast<double>(caches)},
+                               {"reps", static_cast<double>(reps)}};
+
+        for (const auto &o : orders) {
+                hb_mc_manycore_set_bulk_order(mc, o.order);
+                std::fill(in.begin(), in.end(), 0);
+
+                uint64_t c0 = bench_cycle(mc);
+                double t0 = bench_now_ns();
+                for (int r = 0; r < reps; r++)
+                        BSG_MANYCORE_CALL(mc, hb_mc_manycore_eva_write(mc, &default_map, origin, &base,
+                                                                       out.data(), bytes));
+                double t1 = bench_now_ns();
+                uint64_t c1 = bench_cycle(mc);
+
+                report->add((std::string("eva_write_") + o.name).c_str(), params,
+                            {{"ns_per_call", (t1 - t0) / reps},
+                             {"mb_per_s", 1e3 * bytes * reps / (t1 - t0)},
+                             {"cycles_per_call", static_cast<double>(c1 - c0) / reps}});
+
+                c0 = bench_cycle(mc);
+                t0 = bench_now_ns();
+                for (int r = 0; r < reps; r++)
+                        BSG_MANYCORE_CALL(mc, hb_mc_manycore_eva_read(mc, &default_map, origin, &base,
+                                                                      in.data(), bytes));
+                t1 = bench_now_ns();
+                c1 = bench_cycle(mc);
+
+                report->add((std::string("eva_read_") + o.name).c_str(), params,
+                            {{"ns_per_call", (t1 - t0) / reps},
+                             {"mb_per_s", 1e3 * bytes * reps / (t1 - t0)},
+                             {"cycles_per_call", static_cast<double>(c1 - c0) / reps}});
+
+                if (!std::equal(out.begin(), out.begin() + bytes / sizeof(uint32_t), in.begin())) {
+                        bsg_pr_err("%s: %s read back of %zu bytes does not match\n",
+                                   BENCH_NAME, o.name, bytes);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int bench_dram_interleave(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, BENCH_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to initialize manycore: %s\n",
+                           BENCH_NAME, hb_mc_strerror(err));
+                return err;
+        }
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(mc);
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pod = hb_mc_coordinate(0, 0);
+        hb_mc_coordinate_t origin = hb_mc_config_pod_vcore_origin(cfg, pod);
+        size_t stripe = hb_mc_config_get_vcache_stripe_size(cfg);
+
+        // the DRAM EVA that names the start of the first bank of the pod
+        size_t caches = 0;
+        hb_mc_coordinate_t dram;
+        hb_mc_config_pod_foreach_dram(dram, pod, cfg) {
+                caches++;
+        }
+        hb_mc_npa_t first = hb_mc_epa_to_npa(hb_mc_config_pod_dram(cfg, pod, 0), 0);
+        hb_mc_eva_t base;
+        size_t sz;
+        BSG_MANYCORE_CALL(mc, hb_mc_npa_to_eva(mc, &default_map, &origin, &first, &base, &sz));
+
+        std::vector<uint32_t> out(MAX_BYTES / sizeof(uint32_t)), in(out.size());
+        for (auto &w : out)
+                w = static_cast<uint32_t>(rand());
+
+        for (size_t bytes = stripe; bytes <= MAX_BYTES; bytes *= 4)
+                BSG_MANYCORE_CALL(mc, bench_size(mc, &report, &origin, base, caches, out, in, bytes));
+
+        BSG_MANYCORE_CALL(mc, report.write());
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_dram_interleave);
@@ -0,0 +1,171 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_config_pod.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <vector>
+
+#define BENCH_NAME "bench_eva_translate"
+
+#define SAMPLES 8
+/* translations timed per sample */
+#define TRANSLATIONS (1 << 18)
+
+/* group EVA layout of the default map */
+#define GROUP_BIT      (1 << 29)
+#define GROUP_X_OFFSET 18
+#define GROUP_Y_OFFSET 24
+
+/*!
+ * Measures the host time of one default map EVA to NPA translation for
+ * DRAM, group, global, and tile-local EVAs, and of one DRAM NPA to EVA
+ * translation. Every memcpy stripe and every loader segment pays one
+ * of these.
+ */
+
+typedef struct {
+        const char *measurement;
+        std::vector<hb_mc_eva_t> evas;
+} eva_region_t;
+
+static int bench_eva_to_npa(hb_mc_manycore_t *mc, bench_report *report,
+                            const hb_mc_coordinate_t *src, const eva_region_t *region)
+{
+        std::vector<double> ns;
+        size_t n = region->evas.size();
+        for (int s = 0; s < SAMPLES; s++) {
+                double t0 = bench_now_ns();
+                for (size_t i = 0; i < TRANSLATIONS; i++) {
+                        hb_mc_npa_t npa;
+                        size_t sz;
+                        int err = hb_mc_eva_to_npa(mc, &default_map, src, &region->evas[i % n], &npa, &sz);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+                }
+                ns.push_back((bench_now_ns() - t0) / TRANSLATIONS);
+        }
+
+        report->add(region->measurement,
+                    {{"evas", static_cast<double>(n)}, {"translations", TRANSLATIONS}, {"samples", SAMPLES}},
+                    bench_summary_fields("ns", bench_summarize(ns)));
+        return HB_MC_SUCCESS;
+}
+
+static int bench_npa_to_eva(hb_mc_manycore_t *mc, bench_report *report,
+                            const hb_mc_coordinate_t *tgt, const std::vector<hb_mc_npa_t> &npas)
+{
+        std::vector<double> ns;
+        size_t n = npas.size();
+        for (int s = 0; s < SAMPLES; s++) {
+                double t0 = bench_now_ns();
+                for (size_t i = 0; i < TRANSLATIONS; i++) {
+                        hb_mc_eva_t eva;
+                        size_t sz;
+                        int err = hb_mc_npa_to_eva(mc, &default_map, tgt, &npas[i % n], &eva, &sz);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+                }
+                ns.push_back((bench_now_ns() - t0) / TRANSLATIONS);
+        }
+
+        report->add("npa_to_eva_dram",
+                    {{"npas", static_cast<double>(n)}, {"translations", TRANSLATIONS}, {"samples", SAMPLES}},
+                    bench_summary_fields("ns", bench_summarize(ns)));
+        return HB_MC_SUCCESS;
+}
+
+int bench_eva_translate(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, BENCH_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to initialize manycore: %s\n",
+                           BENCH_NAME, hb_mc_strerror(err));
+                return err;
+        }
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(mc);
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pod = hb_mc_coordinate(0, 0);
+        hb_mc_coordinate_t origin = hb_mc_config_pod_vcore_origin(cfg, pod);
+        size_t dmem_words = hb_mc_config_get_dmem_size(cfg) / sizeof(uint32_t);
+        size_t stripe = hb_mc_config_get_vcache_stripe_size(cfg);
+
+        // DRAM: a few words of every stripe in every bank of the pod,
+        // named by the NPAs they translate back from
+        std::vector<hb_mc_npa_t> npas;
+        hb_mc_coordinate_t dram;
+        hb_mc_config_pod_foreach_dram(dram, pod, cfg) {
+                for (size_t epa = 0; epa < 64 * stripe; epa += stripe + sizeof(uint32_t))
+                        npas.push_back(hb_mc_epa_to_npa(dram, epa));
+        }
+
+        eva_region_t dram_evas = {"eva_to_npa_dram"}, group = {"eva_to_npa_group"},
+                global = {"eva_to_npa_global"}, local = {"eva_to_npa_local"};
+        for (const hb_mc_npa_t &npa : npas) {
+                hb_mc_eva_t eva;
+                size_t sz;
+                BSG_MANYCORE_CALL(mc, hb_mc_npa_to_eva(mc, &default_map, &origin, &npa, &eva, &sz));
+                dram_evas.evas.push_back(eva);
+        }
+
+        // group, global, and local: a word of data memory in each tile
+        hb_mc_coordinate_t tile;
+        size_t i = 0;
+        hb_mc_config_pod_foreach_vcore(tile, pod, cfg) {
+                hb_mc_epa_t epa = HB_MC_TILE_EPA_DMEM_BASE + (i++ * 17 % dmem_words) * sizeof(uint32_t);
+                hb_mc_npa_t npa = hb_mc_epa_to_npa(tile, epa);
+                hb_mc_eva_t eva;
+                size_t sz;
+                BSG_MANYCORE_CALL(mc, hb_mc_npa_to_eva(mc, &default_map, &origin, &npa, &eva, &sz));
+                global.evas.push_back(eva);
+                group.evas.push_back(GROUP_BIT
+                                     | ((tile.x - origin.x) << GROUP_X_OFFSET)
+                                     | ((tile.y - origin.y) << GROUP_Y_OFFSET)
+                                     | (HB_MC_TILE_EVA_DMEM_BASE + epa - HB_MC_TILE_EPA_DMEM_BASE));
+                local.evas.push_back(HB_MC_TILE_EVA_DMEM_BASE + epa - HB_MC_TILE_EPA_DMEM_BASE);
+        }
+
+        for (const eva_region_t *region : {&dram_evas, &group, &global, &local})
+                BSG_MANYCORE_CALL(mc, bench_eva_to_npa(mc, &report, &origin, region));
+        BSG_MANYCORE_CALL(mc, bench_npa_to_eva(mc, &report, &origin, npas));
+
+        BSG_MANYCORE_CALL(mc, report.write());
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_eva_translate);
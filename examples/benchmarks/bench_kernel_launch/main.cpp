@@ -0,0 +1,101 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_cuda.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <vector>
+
+#define BENCH_NAME "bench_kernel_launch"
+#define ALLOC_NAME "default_allocator"
+
+#define SAMPLES 16
+
+/*!
+ * Measures the latency from enqueuing a kernel to every one of its tile
+ * groups having finished, for a single tile group and for grids of them.
+ * This benchmark uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+ */
+
+static int bench_launch(hb_mc_device_t *device, bench_report *report,
+                        hb_mc_dimension_t grid_dim, hb_mc_dimension_t tg_dim)
+{
+        std::vector<double> ns, cycles;
+        uint32_t cuda_argv[1] = {0};
+
+        for (int i = 0; i < SAMPLES; i++) {
+                uint64_t c0 = bench_cycle(device->mc);
+                double t0 = bench_now_ns();
+                BSG_CUDA_CALL(hb_mc_kernel_enqueue(device, grid_dim, tg_dim, "kernel_empty", 0, cuda_argv));
+                BSG_CUDA_CALL(hb_mc_device_tile_groups_execute(device));
+                double t1 = bench_now_ns();
+                uint64_t c1 = bench_cycle(device->mc);
+                ns.push_back(t1 - t0);
+                cycles.push_back(static_cast<double>(c1 - c0));
+        }
+
+        double groups = grid_dim.x * grid_dim.y;
+        bench_summary s = bench_summarize(ns);
+        bench_fields metrics = bench_summary_fields("ns", s);
+        bench_fields c = bench_summary_fields("cycles", bench_summarize(cycles));
+        metrics.insert(metrics.end(), c.begin(), c.end());
+        metrics.push_back({"ns_per_tile_group_median", s.median / groups});
+
+        report->add("launch_to_finish",
+                    {{"grid_x", static_cast<double>(grid_dim.x)}, {"grid_y", static_cast<double>(grid_dim.y)},
+                     {"tg_x", static_cast<double>(tg_dim.x)}, {"tg_y", static_cast<double>(tg_dim.y)},
+                     {"samples", SAMPLES}},
+                    metrics);
+        return HB_MC_SUCCESS;
+}
+
+int bench_kernel_launch(int argc, char **argv)
+{
+        struct arguments_path args = {NULL, NULL};
+        argp_parse(&argp_path, argc, argv, 0, 0, &args);
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, BENCH_NAME, 0));
+        BSG_CUDA_CALL(hb_mc_device_program_init(&device, args.path, ALLOC_NAME, 0));
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(device.mc);
+
+        hb_mc_dimension_t tg_dim = {.x = 1, .y = 1};
+        for (uint32_t n : {1, 4, 16, 64}) {
+                hb_mc_dimension_t grid_dim = {.x = n, .y = 1};
+                BSG_CUDA_CALL(bench_launch(&device, &report, grid_dim, tg_dim));
+        }
+
+        BSG_CUDA_CALL(report.write());
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_kernel_launch);
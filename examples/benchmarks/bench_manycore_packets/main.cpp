@@ -0,0 +1,168 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_config_pod.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <vector>
+
+#define BENCH_NAME "bench_manycore_packets"
+
+#define TX_PACKETS      4096
+#define LATENCY_SAMPLES 256
+#define FENCE_SAMPLES   64
+
+/*!
+ * Measures the host's request packet transmit rate, the round-trip
+ * latency of a remote load, and the latency of a host request fence.
+ */
+
+/* packet transmit rate, one packet per call and batched */
+static int bench_tx_rate(hb_mc_manycore_t *mc, bench_report *report, const hb_mc_npa_t *base)
+{
+        std::vector<uint32_t> words(TX_PACKETS);
+        for (size_t i = 0; i < words.size(); i++)
+                words[i] = static_cast<uint32_t>(i);
+
+        uint64_t c0 = bench_cycle(mc);
+        double t0 = bench_now_ns();
+        for (int i = 0; i < TX_PACKETS; i++) {
+                hb_mc_npa_t npa = *base;
+                hb_mc_npa_set_epa(&npa, hb_mc_npa_get_epa(base) + i * sizeof(uint32_t));
+                BSG_MANYCORE_CALL(mc, hb_mc_manycore_write32(mc, &npa, words[i]));
+        }
+        double t1 = bench_now_ns();
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_host_request_fence(mc, -1));
+        double t2 = bench_now_ns();
+        uint64_t c2 = bench_cycle(mc);
+
+        report->add("packet_tx", {{"packets", TX_PACKETS}, {"batched", 0}},
+                    {{"tx_ns", t1 - t0},
+                     {"total_ns", t2 - t0},
+                     {"packets_per_s", 1e9 * TX_PACKETS / (t1 - t0)},
+                     {"cycles", static_cast<double>(c2 - c0)}});
+
+        c0 = bench_cycle(mc);
+        t0 = bench_now_ns();
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_write_mem_nofence(mc, base, words.data(),
+                                                               words.size() * sizeof(uint32_t)));
+        t1 = bench_now_ns();
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_host_request_fence(mc, -1));
+        t2 = bench_now_ns();
+        c2 = bench_cycle(mc);
+
+        report->add("packet_tx", {{"packets", TX_PACKETS}, {"batched", 1}},
+                    {{"tx_ns", t1 - t0},
+                     {"total_ns", t2 - t0},
+                     {"packets_per_s", 1e9 * TX_PACKETS / (t1 - t0)},
+                     {"cycles", static_cast<double>(c2 - c0)}});
+
+        return HB_MC_SUCCESS;
+}
+
+/* remote load round trip to #npa */
+static int bench_load_latency(hb_mc_manycore_t *mc, bench_report *report,
+                              const char *target, const hb_mc_npa_t *npa)
+{
+        std::vector<double> ns, cycles;
+        for (int i = 0; i < LATENCY_SAMPLES; i++) {
+                uint32_t v;
+                uint64_t c0 = bench_cycle(mc);
+                double t0 = bench_now_ns();
+                BSG_MANYCORE_CALL(mc, hb_mc_manycore_read32(mc, npa, &v));
+                double t1 = bench_now_ns();
+                uint64_t c1 = bench_cycle(mc);
+                ns.push_back(t1 - t0);
+                cycles.push_back(static_cast<double>(c1 - c0));
+        }
+
+        bench_fields metrics = bench_summary_fields("ns", bench_summarize(ns));
+        bench_fields c = bench_summary_fields("cycles", bench_summarize(cycles));
+        metrics.insert(metrics.end(), c.begin(), c.end());
+        report->add(target, {{"samples", LATENCY_SAMPLES}}, metrics);
+        return HB_MC_SUCCESS;
+}
+
+/* fence latency with #outstanding writes in flight */
+static int bench_fence_latency(hb_mc_manycore_t *mc, bench_report *report,
+                               const hb_mc_npa_t *base, int outstanding)
+{
+        std::vector<uint32_t> words(outstanding, 0);
+        std::vector<double> ns;
+        for (int i = 0; i < FENCE_SAMPLES; i++) {
+                if (outstanding > 0)
+                        BSG_MANYCORE_CALL(mc, hb_mc_manycore_write_mem_nofence(mc, base, words.data(),
+                                                                               words.size() * sizeof(uint32_t)));
+                double t0 = bench_now_ns();
+                BSG_MANYCORE_CALL(mc, hb_mc_manycore_host_request_fence(mc, -1));
+                double t1 = bench_now_ns();
+                ns.push_back(t1 - t0);
+        }
+
+        report->add("fence_latency", {{"outstanding_writes", static_cast<double>(outstanding)},
+                                      {"samples", FENCE_SAMPLES}},
+                    bench_summary_fields("ns", bench_summarize(ns)));
+        return HB_MC_SUCCESS;
+}
+
+int bench_manycore_packets(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, BENCH_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to initialize manycore: %s\n",
+                           BENCH_NAME, hb_mc_strerror(err));
+                return err;
+        }
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(mc);
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pod = {.x = 0, .y = 0};
+        hb_mc_coordinate_t origin = hb_mc_config_get_origin_vcore(cfg);
+        hb_mc_npa_t dram = hb_mc_npa_from_x_y(hb_mc_config_get_vcore_base_x(cfg),
+                                              hb_mc_config_pod_dram_y(cfg, pod, 0), 0);
+        hb_mc_npa_t dmem = hb_mc_npa(origin, HB_MC_TILE_EPA_DMEM_BASE);
+
+        BSG_MANYCORE_CALL(mc, bench_tx_rate(mc, &report, &dram));
+        BSG_MANYCORE_CALL(mc, bench_load_latency(mc, &report, "load_latency_dmem", &dmem));
+        BSG_MANYCORE_CALL(mc, bench_load_latency(mc, &report, "load_latency_dram", &dram));
+        for (int outstanding : {0, 1, 16, 256})
+                BSG_MANYCORE_CALL(mc, bench_fence_latency(mc, &report, &dram, outstanding));
+
+        BSG_MANYCORE_CALL(mc, report.write());
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_manycore_packets);
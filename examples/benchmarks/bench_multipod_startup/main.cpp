@@ -0,0 +1,102 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore.h>
+#include <bsg_manycore_cuda.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <vector>
+
+#define BENCH_NAME "bench_multipod_startup"
+
+#define SAMPLES 8
+
+/*!
+ * Measures the time to load a program onto every pod of the machine,
+ * first one pod after another from the calling thread, then with a
+ * host thread per pod (hb_mc_device_enable_pod_threads()).
+ * This benchmark uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+ */
+
+static int pod_program_init(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        const char *path = (const char*)arg;
+        return hb_mc_device_pod_program_init(device, pod, path);
+}
+
+static int pod_program_finish(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        return hb_mc_device_pod_program_finish(device, pod);
+}
+
+static int bench_startup(hb_mc_device_t *device, const char *path, bench_report &report, int threads)
+{
+        // parse the binary once, so that every sample measures loading it
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_program_init, (void*)path));
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_program_finish, NULL));
+
+        std::vector<double> ns;
+        for (int i = 0; i < SAMPLES; i++) {
+                double t0 = bench_now_ns();
+                BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_program_init, (void*)path));
+                double t1 = bench_now_ns();
+                ns.push_back(t1 - t0);
+
+                BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_program_finish, NULL));
+        }
+
+        report.add("program_init_all_pods",
+                   {{"pods", static_cast<double>(device->num_pods)},
+                    {"pod_threads", static_cast<double>(threads)},
+                    {"samples", SAMPLES}},
+                   bench_summary_fields("ns", bench_summarize(ns)));
+
+        return HB_MC_SUCCESS;
+}
+
+int bench_multipod_startup(int argc, char **argv)
+{
+        struct arguments_path args = {NULL, NULL};
+        argp_parse(&argp_path, argc, argv, 0, 0, &args);
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, BENCH_NAME, 0));
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(device.mc);
+
+        BSG_CUDA_CALL(bench_startup(&device, args.path, report, 0));
+
+        BSG_CUDA_CALL(hb_mc_device_enable_pod_threads(&device));
+        BSG_CUDA_CALL(bench_startup(&device, args.path, report, 1));
+
+        BSG_CUDA_CALL(report.write());
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_multipod_startup);
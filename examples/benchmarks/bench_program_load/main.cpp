@@ -0,0 +1,100 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore.h>
+#include <bsg_manycore_cuda.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <vector>
+
+#define BENCH_NAME "bench_program_load"
+#define ALLOC_NAME "default_allocator"
+
+#define SAMPLES 8
+
+/*!
+ * Measures the time to load a program onto every tile of a pod, with
+ * the request packets and fences each load costs. The first load also
+ * reads and parses the binary; reloads reuse the parsed program.
+ * This benchmark uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+ */
+
+int bench_program_load(int argc, char **argv)
+{
+        struct arguments_path args = {NULL, NULL};
+        argp_parse(&argp_path, argc, argv, 0, 0, &args);
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, BENCH_NAME, 0));
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(device.mc);
+
+        std::vector<double> ns, cycles;
+        double first_ns = 0;
+        uint64_t packets = 0, fences = 0;
+        for (int i = 0; i <= SAMPLES; i++) {
+                uint64_t p0 = device.mc->request_packets_tx;
+                uint64_t f0 = device.mc->host_request_fences;
+                uint64_t c0 = bench_cycle(device.mc);
+                double t0 = bench_now_ns();
+                BSG_CUDA_CALL(hb_mc_device_program_init(&device, args.path, ALLOC_NAME, 0));
+                double t1 = bench_now_ns();
+                uint64_t c1 = bench_cycle(device.mc);
+                packets = device.mc->request_packets_tx - p0;
+                fences = device.mc->host_request_fences - f0;
+                if (i == 0) {
+                        first_ns = t1 - t0;
+                } else {
+                        ns.push_back(t1 - t0);
+                        cycles.push_back(static_cast<double>(c1 - c0));
+                }
+
+                BSG_CUDA_CALL(hb_mc_device_program_finish(&device));
+        }
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(device.mc);
+        hb_mc_dimension_t dim = hb_mc_config_get_dimension_vcore(cfg);
+
+        bench_fields metrics = bench_summary_fields("ns", bench_summarize(ns));
+        bench_fields c = bench_summary_fields("cycles", bench_summarize(cycles));
+        metrics.insert(metrics.end(), c.begin(), c.end());
+        metrics.push_back({"request_packets", static_cast<double>(packets)});
+        metrics.push_back({"fences", static_cast<double>(fences)});
+        metrics.push_back({"first_ns", first_ns});
+
+        report.add("program_init",
+                   {{"tiles_x", static_cast<double>(dim.x)}, {"tiles_y", static_cast<double>(dim.y)},
+                    {"samples", SAMPLES}},
+                   metrics);
+
+        BSG_CUDA_CALL(report.write());
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_program_load);
@@ -0,0 +1,118 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_config_pod.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <vector>
+
+#define BENCH_NAME "bench_read_latency"
+
+#define SAMPLES 256
+
+/*!
+ * Measures the latency of small and medium reads from DRAM: through
+ * hb_mc_manycore_read_mem() to one bank, and through
+ * hb_mc_manycore_eva_read() as a symbol readback would.
+ */
+
+static const size_t sizes[] = {4, 64, 4096};
+
+static int bench_read_mem(hb_mc_manycore_t *mc, bench_report *report,
+                          const hb_mc_npa_t *npa, std::vector<uint32_t> &in, size_t bytes)
+{
+        std::vector<double> ns;
+        for (int s = 0; s < SAMPLES; s++) {
+                double t0 = bench_now_ns();
+                BSG_MANYCORE_CALL(mc, hb_mc_manycore_read_mem(mc, npa, in.data(), bytes));
+                double t1 = bench_now_ns();
+                ns.push_back(t1 - t0);
+        }
+
+        report->add("read_mem", {{"bytes", static_cast<double>(bytes)}, {"samples", SAMPLES}},
+                    bench_summary_fields("ns", bench_summarize(ns)));
+        return HB_MC_SUCCESS;
+}
+
+static int bench_eva_read(hb_mc_manycore_t *mc, bench_report *report,
+                          const hb_mc_coordinate_t *origin, hb_mc_eva_t eva,
+                          std::vector<uint32_t> &in, size_t bytes)
+{
+        std::vector<double> ns;
+        for (int s = 0; s < SAMPLES; s++) {
+                double t0 = bench_now_ns();
+                BSG_MANYCORE_CALL(mc, hb_mc_manycore_eva_read(mc, &default_map, origin, &eva,
+                                                              in.data(), bytes));
+                double t1 = bench_now_ns();
+                ns.push_back(t1 - t0);
+        }
+
+        report->add("eva_read", {{"bytes", static_cast<double>(bytes)}, {"samples", SAMPLES}},
+                    bench_summary_fields("ns", bench_summarize(ns)));
+        return HB_MC_SUCCESS;
+}
+
+int bench_read_latency(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, BENCH_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to initialize manycore: %s\n",
+                           BENCH_NAME, hb_mc_strerror(err));
+                return err;
+        }
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(mc);
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pod = hb_mc_coordinate(0, 0);
+        hb_mc_coordinate_t origin = hb_mc_config_pod_vcore_origin(cfg, pod);
+
+        // the start of the first bank of the pod, and the DRAM EVA that names it
+        hb_mc_npa_t base = hb_mc_epa_to_npa(hb_mc_config_pod_dram(cfg, pod, 0), 0);
+        hb_mc_eva_t eva;
+        size_t sz;
+        BSG_MANYCORE_CALL(mc, hb_mc_npa_to_eva(mc, &default_map, &origin, &base, &eva, &sz));
+
+        std::vector<uint32_t> in(sizes[2] / sizeof(uint32_t));
+        for (size_t bytes : sizes) {
+                BSG_MANYCORE_CALL(mc, bench_read_mem(mc, &report, &base, in, bytes));
+                BSG_MANYCORE_CALL(mc, bench_eva_read(mc, &report, &origin, eva, in, bytes));
+        }
+
+        BSG_MANYCORE_CALL(mc, report.write());
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_read_latency);
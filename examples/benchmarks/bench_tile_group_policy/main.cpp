@@ -0,0 +1,128 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_cuda.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_bench.hpp>
+#include <vector>
+
+#define BENCH_NAME "bench_tile_group_policy"
+
+#define SAMPLES 8
+
+/*!
+ * Runs one sequence of kernels with mixed tile group shapes under each
+ * tile group order and placement, and reports how busy the pod's tiles
+ * were: the utilization fraction and the idle tile-nanoseconds while any
+ * tile group was running.
+ * This benchmark uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+ */
+
+static int run_sequence(hb_mc_device_t *device, hb_mc_pod_id_t pod_id)
+{
+        hb_mc_dimension_t mesh = device->pods[pod_id].mesh->dim;
+        hb_mc_dimension_t half = {.x = (mesh.x + 1) / 2, .y = (mesh.y + 1) / 2};
+        uint32_t cuda_argv[1] = {0};
+
+        // shapes that leave holes a first-fit FIFO schedule cannot fill
+        struct { hb_mc_dimension_t grid, tg; } kernels[] = {
+                { {.x = 4, .y = 1}, {.x = half.x, .y = 1} },
+                { {.x = 2, .y = 2}, half },
+                { {.x = 16, .y = 1}, {.x = 1, .y = 1} },
+                { {.x = 2, .y = 1}, {.x = mesh.x, .y = half.y} },
+                { {.x = 8, .y = 1}, {.x = 1, .y = mesh.y} },
+        };
+        for (auto &k : kernels)
+                BSG_CUDA_CALL(hb_mc_device_pod_kernel_enqueue(device, pod_id, k.grid, k.tg,
+                                                              "kernel_empty", 0, cuda_argv));
+        return hb_mc_device_pod_kernels_execute(device, pod_id);
+}
+
+static int bench_policy(hb_mc_device_t *device, bench_report *report, hb_mc_pod_id_t pod_id,
+                        hb_mc_tile_group_order_t order, hb_mc_tile_group_placement_t placement)
+{
+        std::vector<double> ns, fraction, idle;
+
+        BSG_CUDA_CALL(hb_mc_device_set_tile_group_policy(device, order, placement));
+        for (int i = 0; i < SAMPLES; i++) {
+                BSG_CUDA_CALL(hb_mc_device_pod_reset_utilization(device, pod_id));
+                double t0 = bench_now_ns();
+                BSG_CUDA_CALL(run_sequence(device, pod_id));
+                double t1 = bench_now_ns();
+
+                hb_mc_pod_utilization_t u;
+                BSG_CUDA_CALL(hb_mc_device_pod_get_utilization(device, pod_id, &u));
+                ns.push_back(t1 - t0);
+                fraction.push_back(hb_mc_pod_utilization_fraction(&u));
+                idle.push_back(static_cast<double>(u.active_ns) * u.tiles - static_cast<double>(u.busy_tile_ns));
+        }
+
+        bench_fields metrics = bench_summary_fields("ns", bench_summarize(ns));
+        bench_fields f = bench_summary_fields("utilization", bench_summarize(fraction));
+        bench_fields i = bench_summary_fields("idle_tile_ns", bench_summarize(idle));
+        metrics.insert(metrics.end(), f.begin(), f.end());
+        metrics.insert(metrics.end(), i.begin(), i.end());
+
+        report->add("kernel_sequence",
+                    {{"order", static_cast<double>(order)}, {"placement", static_cast<double>(placement)},
+                     {"samples", SAMPLES}},
+                    metrics);
+        return HB_MC_SUCCESS;
+}
+
+int bench_tile_group_policy(int argc, char **argv)
+{
+        struct arguments_path args = {NULL, NULL};
+        argp_parse(&argp_path, argc, argv, 0, 0, &args);
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, BENCH_NAME, 0));
+
+        hb_mc_pod_id_t pod_id = device.default_pod_id;
+        BSG_CUDA_CALL(hb_mc_device_pod_program_init(&device, pod_id, args.path));
+
+        bench_report report(BENCH_NAME);
+        report.set_machine(device.mc);
+
+        for (hb_mc_tile_group_order_t order : {HB_MC_TILE_GROUP_ORDER_BACKFILL,
+                                               HB_MC_TILE_GROUP_ORDER_FIFO,
+                                               HB_MC_TILE_GROUP_ORDER_LARGEST_FIRST}) {
+                for (hb_mc_tile_group_placement_t placement : {HB_MC_TILE_GROUP_PLACEMENT_FIRST_FIT,
+                                                               HB_MC_TILE_GROUP_PLACEMENT_BEST_FIT}) {
+                        BSG_CUDA_CALL(bench_policy(&device, &report, pod_id, order, placement));
+                }
+        }
+
+        BSG_CUDA_CALL(report.write());
+        BSG_CUDA_CALL(hb_mc_device_pod_program_finish(&device, pod_id));
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(BENCH_NAME, bench_tile_group_policy);
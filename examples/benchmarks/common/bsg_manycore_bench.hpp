@@ -0,0 +1,214 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BSG_MANYCORE_BENCH_HPP
+#define BSG_MANYCORE_BENCH_HPP
+
+/*
+ * Helpers shared by the host runtime benchmarks: wall-clock timing,
+ * sample summaries, and a report that is written out as JSON so that
+ * runs on different machines and runtime versions can be compared.
+ *
+ * Every benchmark writes one JSON object to bench.json in its working
+ * directory:
+ *
+ * {
+ *   "benchmark": "<name>",
+ *   "machine": { <configuration of the manycore under test> },
+ *   "results": [
+ *     { "measurement": "<name>", "params": { ... }, "metrics": { ... } },
+ *     ...
+ *   ]
+ * }
+ */
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_errno.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define BENCH_JSON_PATH "bench.json"
+
+/* monotonic wall-clock time in nanoseconds */
+static inline double bench_now_ns(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* manycore cycle counter, or 0 if the platform does not have one */
+static inline uint64_t bench_cycle(hb_mc_manycore_t *mc)
+{
+        uint64_t cycle = 0;
+        if (hb_mc_manycore_get_cycle(mc, &cycle) != HB_MC_SUCCESS)
+                return 0;
+        return cycle;
+}
+
+typedef std::vector<std::pair<std::string, double>> bench_fields;
+
+/* summary statistics of a set of latency samples */
+typedef struct bench_summary {
+        double min;
+        double median;
+        double mean;
+        double p99;
+        double max;
+} bench_summary;
+
+static inline bench_summary bench_summarize(std::vector<double> samples)
+{
+        bench_summary s = {0, 0, 0, 0, 0};
+        if (samples.empty())
+                return s;
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double v : samples)
+                sum += v;
+
+        s.min    = samples.front();
+        s.median = samples[samples.size() / 2];
+        s.mean   = sum / samples.size();
+        s.p99    = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+        s.max    = samples.back();
+        return s;
+}
+
+/* metrics for a latency summary, with every name prefixed by #prefix */
+static inline bench_fields bench_summary_fields(const char *prefix, const bench_summary &s)
+{
+        std::string p(prefix);
+        return {
+                {p + "_min",    s.min},
+                {p + "_median", s.median},
+                {p + "_mean",   s.mean},
+                {p + "_p99",    s.p99},
+                {p + "_max",    s.max},
+        };
+}
+
+class bench_report {
+public:
+        bench_report(const char *benchmark) : benchmark(benchmark) {}
+
+        /* record the configuration of the machine being measured */
+        void set_machine(hb_mc_manycore_t *mc) {
+                const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+                hb_mc_dimension_t vcore = hb_mc_config_get_dimension_vcore(cfg);
+                machine = {
+                        {"vcore_dim_x",        static_cast<double>(vcore.x)},
+                        {"vcore_dim_y",        static_cast<double>(vcore.y)},
+                        {"pods_x",             static_cast<double>(cfg->pods.x)},
+                        {"pods_y",             static_cast<double>(cfg->pods.y)},
+                        {"dram_caches",        static_cast<double>(hb_mc_config_get_num_dram_coordinates(cfg))},
+                        {"vcache_ways",        static_cast<double>(hb_mc_config_get_vcache_ways(cfg))},
+                        {"vcache_sets",        static_cast<double>(hb_mc_config_get_vcache_sets(cfg))},
+                        {"vcache_block_bytes", static_cast<double>(hb_mc_config_get_vcache_block_size(cfg))},
+                        {"dram_enabled",       static_cast<double>(hb_mc_manycore_dram_is_enabled(mc))},
+                        {"has_cache",          static_cast<double>(hb_mc_manycore_has_cache(mc))},
+                };
+                githash = hb_mc_config_get_githash_manycore(cfg);
+        }
+
+        /* record one measurement, and print it for whoever is watching */
+        void add(const char *measurement, const bench_fields &params, const bench_fields &metrics) {
+                results.push_back({measurement, params, metrics});
+
+                std::string line = measurement;
+                for (auto &f : params)
+                        line += " " + f.first + "=" + number(f.second);
+                line += ":";
+                for (auto &f : metrics)
+                        line += " " + f.first + "=" + number(f.second);
+                bsg_pr_test_info("%s: %s\n", benchmark.c_str(), line.c_str());
+        }
+
+        /* write the report as JSON */
+        int write(const char *path = BENCH_JSON_PATH) const {
+                FILE *f = fopen(path, "w");
+                if (f == nullptr) {
+                        bsg_pr_err("%s: failed to open '%s'\n", benchmark.c_str(), path);
+                        return HB_MC_FAIL;
+                }
+
+                fprintf(f, "{\n  \"benchmark\": \"%s\",\n", benchmark.c_str());
+                fprintf(f, "  \"machine\": {\"githash_manycore\": \"%08" PRIx32 "\"", githash);
+                for (auto &m : machine)
+                        fprintf(f, ", \"%s\": %s", m.first.c_str(), number(m.second).c_str());
+                fprintf(f, "},\n  \"results\": [");
+                for (size_t i = 0; i < results.size(); i++) {
+                        const result &r = results[i];
+                        fprintf(f, "%s\n    {\"measurement\": \"%s\", \"params\": %s, \"metrics\": %s}",
+                                i ? "," : "", r.measurement.c_str(),
+                                object(r.params).c_str(), object(r.metrics).c_str());
+                }
+                fprintf(f, "\n  ]\n}\n");
+                fclose(f);
+                return HB_MC_SUCCESS;
+        }
+
+private:
+        struct result {
+                std::string measurement;
+                bench_fields params;
+                bench_fields metrics;
+        };
+
+        static std::string number(double v) {
+                char buf[64];
+                if (v == static_cast<double>(static_cast<int64_t>(v)))
+                        snprintf(buf, sizeof(buf), "%" PRId64, static_cast<int64_t>(v));
+                else
+                        snprintf(buf, sizeof(buf), "%.6g", v);
+                return buf;
+        }
+
+        static std::string object(const bench_fields &fields) {
+                std::string s = "{";
+                for (size_t i = 0; i < fields.size(); i++) {
+                        s += i ? ", \"" : "\"";
+                        s += fields[i].first + "\": " + number(fields[i].second);
+                }
+                return s + "}";
+        }
+
+        std::string benchmark;
+        bench_fields machine;
+        uint32_t githash = 0;
+        std::vector<result> results;
+};
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+/* launches made; enough to wrap the kernel argument arena several times */
+#define LAUNCHES 200
+
+/* more arguments than the kernel argument arena holds */
+#define ARGC_HUGE 5000
+
+/*!
+ * Launches the CUDA Empty Kernel with argument lists of varying length,
+ * so that argument slots are recycled and wrap around the end of the
+ * arena, and once with more arguments than the arena holds. After each
+ * launch the arguments in device memory are read back and checked.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static int launch_and_check(hb_mc_device_t *device, const uint32_t *cuda_argv, uint32_t argc)
+{
+        static uint32_t readback[ARGC_HUGE];
+        hb_mc_pod_id_t pod_id = device->default_pod_id;
+        hb_mc_pod_t *pod = &device->pods[pod_id];
+        hb_mc_dimension_t grid_dim = { .x = 2, .y = 2 };
+        hb_mc_dimension_t tg_dim = { .x = 2, .y = 1 };
+
+        BSG_CUDA_CALL(hb_mc_device_pod_kernel_enqueue(device, pod_id, grid_dim, tg_dim,
+                                                      "kernel_empty", argc, cuda_argv));
+        BSG_CUDA_CALL(hb_mc_device_pod_kernels_execute(device, pod_id));
+
+        if (argc == 0)
+                return HB_MC_SUCCESS;
+
+        // every tile group of the grid was handed the same arguments;
+        // the pod keeps its finished tile groups most recent first
+        hb_mc_tile_group_t *tg = pod->finished.head;
+        for (int n = 0; n < 4; n++, tg = tg->next) {
+                BSG_CUDA_CALL(hb_mc_device_pod_memcpy_to_host(device, pod_id, readback,
+                                                              tg->argv_eva,
+                                                              argc * sizeof(uint32_t)));
+                for (uint32_t i = 0; i < argc; i++) {
+                        if (readback[i] != cuda_argv[i]) {
+                                bsg_pr_err("argc %" PRIu32 ": argv[%" PRIu32 "] read 0x%08" PRIx32
+                                           ", expected 0x%08" PRIx32 "\n",
+                                           argc, i, readback[i], cuda_argv[i]);
+                                return HB_MC_FAIL;
+                        }
+                }
+        }
+        return HB_MC_SUCCESS;
+}
+
+int kernel_kernel_argv (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Empty Kernel with argument lists of varying length.\n\n");
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+        BSG_CUDA_CALL(hb_mc_device_program_init(&device, bin_path, "default_allocator", 0));
+
+        static uint32_t cuda_argv[ARGC_HUGE];
+        for (int launch = 0; launch < LAUNCHES; launch++) {
+                uint32_t n = (launch * 37) % 64;
+                for (uint32_t i = 0; i < n; i++)
+                        cuda_argv[i] = (launch << 16) | i;
+                BSG_CUDA_CALL(launch_and_check(&device, cuda_argv, n));
+        }
+        bsg_pr_test_info("%d launches checked\n", LAUNCHES);
+
+        for (uint32_t i = 0; i < ARGC_HUGE; i++)
+                cuda_argv[i] = ~i;
+        BSG_CUDA_CALL(launch_and_check(&device, cuda_argv, ARGC_HUGE));
+        bsg_pr_test_info("Launch with %d arguments checked\n", ARGC_HUGE);
+
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_kernel_argv", kernel_kernel_argv);
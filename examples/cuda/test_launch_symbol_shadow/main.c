@@ -0,0 +1,123 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+#define ALLOC_NAME "default_allocator"
+
+/* number of times each grid is launched */
+#define LAUNCHES 4
+
+/*!
+ * Launches the same grids of the CUDA Empty Kernel several times and counts
+ * the request packets each launch sends. The runtime only rewrites the
+ * runtime symbols that changed since a tile's last launch, so repeating a
+ * grid must cost fewer packets than launching it the first time, and a
+ * grid of a new shape must still run correctly.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static int launch(hb_mc_device_t *device, hb_mc_dimension_t grid_dim, hb_mc_dimension_t tg_dim,
+                  uint64_t *packets)
+{
+        int cuda_argv[1];
+        uint64_t before = device->mc->request_packets_tx;
+
+        BSG_CUDA_CALL(hb_mc_kernel_enqueue (device, grid_dim, tg_dim, "kernel_empty", 0, cuda_argv));
+        BSG_CUDA_CALL(hb_mc_device_tile_groups_execute(device));
+
+        *packets = device->mc->request_packets_tx - before;
+        return HB_MC_SUCCESS;
+}
+
+static int launch_repeatedly(hb_mc_device_t *device, hb_mc_dimension_t grid_dim, hb_mc_dimension_t tg_dim)
+{
+        uint64_t first, repeat;
+
+        BSG_CUDA_CALL(launch(device, grid_dim, tg_dim, &first));
+        for (int i = 1; i < LAUNCHES; i++) {
+                BSG_CUDA_CALL(launch(device, grid_dim, tg_dim, &repeat));
+                bsg_pr_test_info("%dx%d grid of %dx%d tile groups: launch %d sent %" PRIu64
+                                 " packets, first launch sent %" PRIu64 "\n",
+                                 grid_dim.x, grid_dim.y, tg_dim.x, tg_dim.y,
+                                 i, repeat, first);
+                if (repeat >= first) {
+                        bsg_pr_err("Repeated launch sent %" PRIu64 " packets, first launch sent %" PRIu64 "\n",
+                                   repeat, first);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int kernel_launch_symbol_shadow (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Empty Kernel repeatedly on grids of the same shape.\n\n");
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+
+        hb_mc_pod_id_t pod;
+        hb_mc_device_foreach_pod_id(&device, pod)
+        {
+                BSG_CUDA_CALL(hb_mc_device_set_default_pod(&device, pod));
+
+                /* loading a program again must forget what the tiles held */
+                for (int load = 0; load < 2; load++) {
+                        BSG_CUDA_CALL(hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0));
+
+                        hb_mc_dimension_t one = { .x = 1, .y = 1 };
+                        hb_mc_dimension_t grid_dim = { .x = 4, .y = 2 };
+                        hb_mc_dimension_t tg_dim = { .x = 2, .y = 2 };
+                        BSG_CUDA_CALL(launch_repeatedly(&device, one, one));
+                        BSG_CUDA_CALL(launch_repeatedly(&device, grid_dim, tg_dim));
+                        BSG_CUDA_CALL(launch_repeatedly(&device, grid_dim, one));
+
+                        BSG_CUDA_CALL(hb_mc_device_program_finish(&device));
+                }
+        }
+
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_launch_symbol_shadow", kernel_launch_symbol_shadow);
@@ -0,0 +1,121 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+/* words copied to and from each pod */
+#define WORDS 1024
+
+/* number of kernel rounds run on all pods at once */
+#define ROUNDS 4
+
+/*!
+ * Runs the CUDA Empty Kernel and copies data on every pod at once, with
+ * a host thread per pod. Each pod gets a different pattern, so reads that
+ * returned another pod's data, or another thread's responses, are caught.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static int pod_program_init(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        return hb_mc_device_pod_program_init(device, pod, (const char*)arg);
+}
+
+static int pod_program_finish(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        return hb_mc_device_pod_program_finish(device, pod);
+}
+
+static int pod_copy_round_trip(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        uint32_t src[WORDS], dst[WORDS];
+        hb_mc_eva_t eva;
+
+        for (int i = 0; i < WORDS; i++)
+                src[i] = (pod << 24) | i;
+
+        BSG_CUDA_CALL(hb_mc_device_pod_malloc(device, pod, sizeof(src), &eva));
+        BSG_CUDA_CALL(hb_mc_device_pod_memcpy_to_device(device, pod, eva, src, sizeof(src)));
+        BSG_CUDA_CALL(hb_mc_device_pod_memcpy_to_host(device, pod, dst, eva, sizeof(dst)));
+
+        for (int i = 0; i < WORDS; i++) {
+                if (dst[i] != src[i]) {
+                        bsg_pr_err("pod %d: word %d read 0x%08" PRIx32 ", expected 0x%08" PRIx32 "\n",
+                                   pod, i, dst[i], src[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        BSG_CUDA_CALL(hb_mc_device_pod_free(device, pod, eva));
+        return HB_MC_SUCCESS;
+}
+
+int kernel_pod_threads (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Empty Kernel on all pods with a host thread per pod.\n\n");
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+        BSG_CUDA_CALL(hb_mc_device_enable_pod_threads(&device));
+
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(&device, pod_program_init, bin_path));
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(&device, pod_copy_round_trip, NULL));
+
+        hb_mc_dimension_t grid_dim = { .x = 4, .y = 2 };
+        hb_mc_dimension_t tg_dim = { .x = 2, .y = 2 };
+        uint32_t cuda_argv[1];
+        for (int round = 0; round < ROUNDS; round++) {
+                hb_mc_pod_id_t pod;
+                hb_mc_device_foreach_pod_id(&device, pod)
+                {
+                        BSG_CUDA_CALL(hb_mc_device_pod_kernel_enqueue(&device, pod, grid_dim, tg_dim,
+                                                                      "kernel_empty", 0, cuda_argv));
+                }
+                BSG_CUDA_CALL(hb_mc_device_pods_kernels_execute(&device));
+                bsg_pr_test_info("Round %d finished on %d pods\n", round, device.num_pods);
+        }
+
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(&device, pod_program_finish, NULL));
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_pod_threads", kernel_pod_threads);
@@ -0,0 +1,124 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+#define ALLOC_NAME "default_allocator"
+
+/*!
+ * Loads the CUDA Empty Kernel onto every pod, reloads it, and loads it
+ * again from a buffer. A device parses a binary once: every pod and every
+ * reload must share one program image, and the kernel must still run.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static int run_empty(hb_mc_device_t *device)
+{
+        int cuda_argv[1];
+        hb_mc_dimension_t one = { .x = 1, .y = 1 };
+        hb_mc_dimension_t tg_dim = { .x = 2, .y = 2 };
+
+        BSG_CUDA_CALL(hb_mc_kernel_enqueue (device, one, tg_dim, "kernel_empty", 0, cuda_argv));
+        BSG_CUDA_CALL(hb_mc_device_tile_groups_execute(device));
+        return HB_MC_SUCCESS;
+}
+
+static int check_shared(hb_mc_device_t *device, hb_mc_loader_program_image_t *image, const char *how)
+{
+        hb_mc_pod_id_t pod;
+        hb_mc_device_foreach_pod_id(device, pod)
+        {
+                hb_mc_loader_program_image_t *pod_image = device->pods[pod].program->image;
+                if (pod_image != image) {
+                        bsg_pr_err("%s: pod %d has its own program image (%p, expected %p)\n",
+                                   how, pod, (void *) pod_image, (void *) image);
+                        return HB_MC_FAIL;
+                }
+        }
+        bsg_pr_test_info("%s: all %d pods share one program image\n", how, device->num_pods);
+        return HB_MC_SUCCESS;
+}
+
+static int finish_all(hb_mc_device_t *device)
+{
+        hb_mc_pod_id_t pod;
+        hb_mc_device_foreach_pod_id(device, pod)
+        {
+                BSG_CUDA_CALL(hb_mc_device_pod_program_finish(device, pod));
+        }
+        return HB_MC_SUCCESS;
+}
+
+int kernel_program_image_cache (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Loading the CUDA Empty Kernel onto every pod more than once.\n\n");
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+
+        /* load onto every pod from the file */
+        BSG_CUDA_CALL(hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0));
+        hb_mc_loader_program_image_t *image = device.pods[0].program->image;
+        BSG_CUDA_CALL(check_shared(&device, image, "first load"));
+        BSG_CUDA_CALL(run_empty(&device));
+        BSG_CUDA_CALL(finish_all(&device));
+
+        /* reload from the file */
+        BSG_CUDA_CALL(hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0));
+        BSG_CUDA_CALL(check_shared(&device, image, "reload"));
+        BSG_CUDA_CALL(run_empty(&device));
+        BSG_CUDA_CALL(finish_all(&device));
+
+        /* reload from a buffer with the same contents */
+        unsigned char *bin_data;
+        size_t bin_size;
+        BSG_CUDA_CALL(hb_mc_loader_read_program_file(bin_path, &bin_data, &bin_size));
+        BSG_CUDA_CALL(hb_mc_device_program_init_binary(&device, bin_path, bin_data, bin_size, ALLOC_NAME, 0));
+        free(bin_data);
+        BSG_CUDA_CALL(check_shared(&device, image, "buffer load"));
+        BSG_CUDA_CALL(run_empty(&device));
+
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_program_image_cache", kernel_program_image_cache);
@@ -0,0 +1,147 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+/* words copied by each batch */
+#define WORDS 8192
+
+/* batches each stream pipelines */
+#define BATCHES 3
+
+/*!
+ * Pipelines copies and kernels on two streams: each batch is copied to the
+ * device, runs the CUDA Empty Kernel, and is copied back, while the other
+ * stream's copies proceed. Also checks memset, and that a stream waiting
+ * on an event of another stream sees that stream's writes.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static int check_words(const char *what, const uint32_t *got, const uint32_t *expect, int n)
+{
+        for (int i = 0; i < n; i++) {
+                if (got[i] != expect[i]) {
+                        bsg_pr_err("%s: word %d read 0x%08" PRIx32 ", expected 0x%08" PRIx32 "\n",
+                                   what, i, got[i], expect[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+        return HB_MC_SUCCESS;
+}
+
+int kernel_stream (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Empty Kernel on two streams.\n\n");
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+        BSG_CUDA_CALL(hb_mc_device_program_init(&device, bin_path, "default_allocator", 0));
+
+        static uint32_t src[2][BATCHES][WORDS], dst[2][BATCHES][WORDS];
+        hb_mc_eva_t eva[2][BATCHES];
+        hb_mc_stream_t streams[2];
+
+        hb_mc_dimension_t grid_dim = { .x = 4, .y = 2 };
+        hb_mc_dimension_t tg_dim = { .x = 2, .y = 2 };
+        uint32_t cuda_argv[1];
+
+        for (int s = 0; s < 2; s++) {
+                BSG_CUDA_CALL(hb_mc_stream_init(&device, device.default_pod_id, &streams[s]));
+                for (int b = 0; b < BATCHES; b++) {
+                        for (int i = 0; i < WORDS; i++)
+                                src[s][b][i] = (s << 28) | (b << 20) | i;
+                        BSG_CUDA_CALL(hb_mc_device_malloc(&device, sizeof(src[s][b]), &eva[s][b]));
+                }
+        }
+
+        for (int b = 0; b < BATCHES; b++) {
+                for (int s = 0; s < 2; s++) {
+                        BSG_CUDA_CALL(hb_mc_stream_memcpy_to_device_async(&streams[s], eva[s][b],
+                                                                          src[s][b], sizeof(src[s][b])));
+                        BSG_CUDA_CALL(hb_mc_stream_kernel_launch_async(&streams[s], grid_dim, tg_dim,
+                                                                       "kernel_empty", 0, cuda_argv));
+                        BSG_CUDA_CALL(hb_mc_stream_memcpy_to_host_async(&streams[s], dst[s][b],
+                                                                        eva[s][b], sizeof(dst[s][b])));
+                }
+        }
+
+        for (int s = 0; s < 2; s++) {
+                BSG_CUDA_CALL(hb_mc_stream_synchronize(&streams[s]));
+                for (int b = 0; b < BATCHES; b++)
+                        BSG_CUDA_CALL(check_words("pipeline", dst[s][b], src[s][b], WORDS));
+        }
+        bsg_pr_test_info("Pipelined %d batches on 2 streams\n", BATCHES);
+
+        // stream 1 reads what stream 0 sets, once stream 0's event is reached
+        hb_mc_event_t set;
+        BSG_CUDA_CALL(hb_mc_stream_memset_async(&streams[0], eva[0][0], 0xA5, sizeof(src[0][0])));
+        BSG_CUDA_CALL(hb_mc_event_record(&set, &streams[0]));
+        BSG_CUDA_CALL(hb_mc_stream_wait_event(&streams[1], &set));
+        BSG_CUDA_CALL(hb_mc_stream_memcpy_to_host_async(&streams[1], dst[1][0], eva[0][0], sizeof(dst[1][0])));
+
+        hb_mc_event_t read;
+        BSG_CUDA_CALL(hb_mc_event_record(&read, &streams[1]));
+        BSG_CUDA_CALL(hb_mc_event_synchronize(&read));
+        if (hb_mc_event_query(&set) != HB_MC_SUCCESS) {
+                bsg_pr_err("event waited on was not reached\n");
+                return HB_MC_FAIL;
+        }
+
+        for (int i = 0; i < WORDS; i++)
+                src[1][0][i] = 0xA5A5A5A5;
+        BSG_CUDA_CALL(check_words("memset", dst[1][0], src[1][0], WORDS));
+        bsg_pr_test_info("Stream waited on an event of another stream\n");
+
+        // arguments without an argument list are refused when enqueued
+        if (hb_mc_stream_kernel_launch_async(&streams[0], grid_dim, tg_dim,
+                                             "kernel_empty", 1, NULL) != HB_MC_INVALID) {
+                bsg_pr_err("kernel launch with a null argument list was enqueued\n");
+                return HB_MC_FAIL;
+        }
+
+        for (int s = 0; s < 2; s++)
+                BSG_CUDA_CALL(hb_mc_stream_finish(&streams[s]));
+
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_stream", kernel_stream);
@@ -0,0 +1,134 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+/*!
+ * Runs the CUDA Empty Kernel on grids of mixed tile group shapes under
+ * every tile group order and placement, and checks that every tile group
+ * finishes and is counted in the pod's utilization.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static const char *order_names[] = { "backfill", "fifo", "largest-first" };
+static const char *placement_names[] = { "first-fit", "best-fit" };
+
+static int run_mixed_shapes(hb_mc_device_t *device, hb_mc_pod_id_t pod_id,
+                            hb_mc_tile_group_order_t order,
+                            hb_mc_tile_group_placement_t placement)
+{
+        hb_mc_pod_t *pod = &device->pods[pod_id];
+        hb_mc_dimension_t mesh = pod->mesh->dim;
+        uint32_t cuda_argv[1];
+
+        BSG_CUDA_CALL(hb_mc_device_set_tile_group_policy(device, order, placement));
+        BSG_CUDA_CALL(hb_mc_device_pod_reset_utilization(device, pod_id));
+
+        // a full-width row, small squares, and single tiles
+        struct { hb_mc_dimension_t grid, tg; } kernels[] = {
+                { { .x = 2, .y = 1 }, { .x = mesh.x, .y = 1 } },
+                { { .x = 4, .y = 2 }, { .x = mesh.x > 1 ? 2 : 1, .y = mesh.y > 1 ? 2 : 1 } },
+                { { .x = 8, .y = 2 }, { .x = 1, .y = 1 } },
+                { { .x = 1, .y = 1 }, { .x = mesh.x, .y = mesh.y } },
+        };
+        uint64_t tile_groups = 0;
+        for (size_t k = 0; k < sizeof(kernels)/sizeof(kernels[0]); k++) {
+                BSG_CUDA_CALL(hb_mc_device_pod_kernel_enqueue(device, pod_id, kernels[k].grid, kernels[k].tg,
+                                                              "kernel_empty", 0, cuda_argv));
+                tile_groups += kernels[k].grid.x * kernels[k].grid.y;
+        }
+        BSG_CUDA_CALL(hb_mc_device_pod_kernels_execute(device, pod_id));
+
+        hb_mc_pod_utilization_t u;
+        BSG_CUDA_CALL(hb_mc_device_pod_get_utilization(device, pod_id, &u));
+        double fraction = hb_mc_pod_utilization_fraction(&u);
+        bsg_pr_test_info("%-13s %-9s: %" PRIu64 " tile groups, utilization %.3f\n",
+                         order_names[order], placement_names[placement], u.tile_groups, fraction);
+
+        if (u.tile_groups != tile_groups) {
+                bsg_pr_err("%" PRIu64 " tile groups finished, expected %" PRIu64 "\n",
+                           u.tile_groups, tile_groups);
+                return HB_MC_FAIL;
+        }
+
+        if (u.tiles != mesh.x * mesh.y || fraction < 0.0 || fraction > 1.0) {
+                bsg_pr_err("utilization of %" PRIu32 " tiles is %f\n", u.tiles, fraction);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int kernel_tile_group_policy (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Empty Kernel under each tile group policy.\n\n");
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+
+        hb_mc_pod_id_t pod_id = device.default_pod_id;
+        BSG_CUDA_CALL(hb_mc_device_pod_program_init(&device, pod_id, bin_path));
+
+        hb_mc_tile_group_order_t orders[] = {
+                HB_MC_TILE_GROUP_ORDER_BACKFILL,
+                HB_MC_TILE_GROUP_ORDER_FIFO,
+                HB_MC_TILE_GROUP_ORDER_LARGEST_FIRST,
+        };
+        hb_mc_tile_group_placement_t placements[] = {
+                HB_MC_TILE_GROUP_PLACEMENT_FIRST_FIT,
+                HB_MC_TILE_GROUP_PLACEMENT_BEST_FIT,
+        };
+        for (int o = 0; o < 3; o++)
+                for (int p = 0; p < 2; p++)
+                        BSG_CUDA_CALL(run_mixed_shapes(&device, pod_id, orders[o], placements[p]));
+
+        if (hb_mc_device_set_tile_group_policy(&device, (hb_mc_tile_group_order_t)3,
+                                               HB_MC_TILE_GROUP_PLACEMENT_FIRST_FIT) != HB_MC_INVALID) {
+                bsg_pr_err("invalid tile group order accepted\n");
+                return HB_MC_FAIL;
+        }
+
+        BSG_CUDA_CALL(hb_mc_device_pod_program_finish(&device, pod_id));
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_tile_group_policy", kernel_tile_group_policy);
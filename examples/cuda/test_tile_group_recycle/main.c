@@ -0,0 +1,103 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+/* kernels launched */
+#define ROUNDS 1000
+
+/* kernels enqueued before each execute */
+#define KERNELS_PER_ROUND 2
+
+/*!
+ * Runs the CUDA Empty Kernel many times and checks that the pod keeps
+ * no more tile group descriptors than were ever outstanding at once, so
+ * that memory use stays flat however many kernels are launched.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+int kernel_tile_group_recycle (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Empty Kernel %d times.\n\n", ROUNDS * KERNELS_PER_ROUND);
+
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+
+        hb_mc_pod_id_t pod_id = device.default_pod_id;
+        hb_mc_pod_t *pod = &device.pods[pod_id];
+        BSG_CUDA_CALL(hb_mc_device_pod_program_init(&device, pod_id, bin_path));
+
+        hb_mc_dimension_t grid_dim = { .x = 4, .y = 2 };
+        hb_mc_dimension_t tg_dim = { .x = 2, .y = 2 };
+        uint32_t outstanding = KERNELS_PER_ROUND * grid_dim.x * grid_dim.y;
+        uint32_t cuda_argv[1];
+
+        for (int round = 0; round < ROUNDS; round++) {
+                for (int k = 0; k < KERNELS_PER_ROUND; k++)
+                        BSG_CUDA_CALL(hb_mc_device_pod_kernel_enqueue(&device, pod_id, grid_dim, tg_dim,
+                                                                      "kernel_empty", 0, cuda_argv));
+
+                if (pod->ready.length != outstanding) {
+                        bsg_pr_err("round %d: %" PRIu32 " tile groups ready, expected %" PRIu32 "\n",
+                                   round, pod->ready.length, outstanding);
+                        return HB_MC_FAIL;
+                }
+
+                BSG_CUDA_CALL(hb_mc_device_pod_kernels_execute(&device, pod_id));
+
+                if (pod->ready.length != 0 || pod->launched.length != 0 ||
+                    pod->finished.length != outstanding) {
+                        bsg_pr_err("round %d: %" PRIu32 " ready, %" PRIu32 " launched, %" PRIu32
+                                   " finished tile groups, expected 0, 0, %" PRIu32 "\n",
+                                   round, pod->ready.length, pod->launched.length,
+                                   pod->finished.length, outstanding);
+                        return HB_MC_FAIL;
+                }
+        }
+        bsg_pr_test_info("%d kernels ran with %" PRIu32 " tile group descriptors\n",
+                         ROUNDS * KERNELS_PER_ROUND, pod->finished.length);
+
+        BSG_CUDA_CALL(hb_mc_device_pod_program_finish(&device, pod_id));
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_tile_group_recycle", kernel_tile_group_recycle);
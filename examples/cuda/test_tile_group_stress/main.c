@@ -0,0 +1,124 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_cuda.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <stdio.h>
+#include <bsg_manycore_regression.h>
+
+#define ALLOC_NAME "default_allocator"
+
+/* a very large grid of the smallest possible tile groups */
+#define GRID_DIM_X 128
+#define GRID_DIM_Y 64
+
+/* a second grid launched alongside the first whose tile groups reuse the
+ * same finish signal addresses as the first grid's */
+#define SMALL_GRID_DIM_X 4
+#define SMALL_GRID_DIM_Y 4
+
+/*!
+ * Runs an empty kernel on a 128x64 grid of 1x1 tile groups together with a
+ * 4x4 grid of 1x1 tile groups, and reports the host-side cost per tile group.
+ * This stresses the runtime's tile group bookkeeping: every completion must be
+ * matched to its tile group in constant time regardless of the grid size.
+ * This tests uses the software/spmd/bsg_cuda_lite_runtime/empty_parallel/ Manycore binary in the BSG Manycore github repository.
+*/
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *end)
+{
+        return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int kernel_tile_group_stress (int argc, char **argv) {
+        char *bin_path, *test_name;
+        struct arguments_path args = {NULL, NULL};
+
+        argp_parse (&argp_path, argc, argv, 0, 0, &args);
+        bin_path = args.path;
+        test_name = args.name;
+
+        bsg_pr_test_info("Running the CUDA Empty Kernel on a %dx%d grid and a %dx%d grid of 1x1 tile groups.\n\n",
+                         GRID_DIM_X, GRID_DIM_Y, SMALL_GRID_DIM_X, SMALL_GRID_DIM_Y);
+
+        /*****************************************************************************************************************
+        * Define path to binary.
+        * Initialize device, load binary and unfreeze tiles.
+        ******************************************************************************************************************/
+        hb_mc_device_t device;
+        BSG_CUDA_CALL(hb_mc_device_init(&device, test_name, 0));
+
+        hb_mc_pod_id_t pod;
+        hb_mc_device_foreach_pod_id(&device, pod)
+        {
+                BSG_CUDA_CALL(hb_mc_device_set_default_pod(&device, pod));
+                BSG_CUDA_CALL(hb_mc_device_program_init(&device, bin_path, ALLOC_NAME, 0));
+
+                hb_mc_dimension_t grid_dim = { .x = GRID_DIM_X, .y = GRID_DIM_Y};
+                hb_mc_dimension_t small_grid_dim = { .x = SMALL_GRID_DIM_X, .y = SMALL_GRID_DIM_Y};
+                hb_mc_dimension_t tg_dim = { .x = 1, .y = 1};
+                int cuda_argv[1];
+
+                /*****************************************************************************************************************
+                 * Enquque both grids so that their tile groups are in flight at the same time.
+                 ******************************************************************************************************************/
+                BSG_CUDA_CALL(hb_mc_kernel_enqueue (&device, grid_dim, tg_dim, "kernel_empty", 0, cuda_argv));
+                BSG_CUDA_CALL(hb_mc_kernel_enqueue (&device, small_grid_dim, tg_dim, "kernel_empty", 0, cuda_argv));
+
+                /*****************************************************************************************************************
+                 * Launch and execute all tile groups on device and wait for all to finish.
+                 ******************************************************************************************************************/
+                struct timespec start, end;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                BSG_CUDA_CALL(hb_mc_device_tile_groups_execute(&device));
+                clock_gettime(CLOCK_MONOTONIC, &end);
+
+                int num_tile_groups = GRID_DIM_X * GRID_DIM_Y + SMALL_GRID_DIM_X * SMALL_GRID_DIM_Y;
+                double seconds = elapsed_seconds(&start, &end);
+                bsg_pr_test_info("Pod %d: %d tile groups in %.3f s (%.1f us/tile group)\n",
+                                 pod, num_tile_groups, seconds, 1e6 * seconds / num_tile_groups);
+
+                /******************************************/
+                /* Cleanup the program on the current pod */
+                /******************************************/
+                BSG_CUDA_CALL(hb_mc_device_program_finish(&device));
+        }
+
+        /*****************************************************************************************************************
+        * Freeze the tiles and memory manager cleanup.
+        ******************************************************************************************************************/
+        BSG_CUDA_CALL(hb_mc_device_finish(&device));
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main("test_tile_group_stress", kernel_tile_group_stress);
@@ -0,0 +1,228 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore.h>
+#include <bsg_manycore_api_trace.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <inttypes.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TEST_NAME "test_api_trace"
+#define TRACE_FILE TEST_NAME ".json"
+
+#define WORKER_THREADS 3
+#define WORKER_EVENTS  5
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* calls that test_api_trace() makes once each, moving the same number of bytes */
+static const char *sized_events[] = {
+        "hb_mc_manycore_write_mem",
+        "hb_mc_manycore_read_mem",
+        "hb_mc_manycore_read_mem_extents",
+        "hb_mc_manycore_write_mem_extents_nofence",
+        "hb_mc_manycore_memset_extents_nofence",
+        "hb_mc_manycore_writev",
+        "hb_mc_manycore_readv",
+};
+
+#define SIZED_EVENTS (sizeof(sized_events) / sizeof(sized_events[0]))
+
+static void test_api_trace_worker()
+{
+        for (int i = 0; i < WORKER_EVENTS; i++) {
+                HB_MC_API_TRACE_SCOPE("test", nullptr, i);
+        }
+}
+
+static int count_occurrences(const std::string &s, const std::string &what)
+{
+        int n = 0;
+        for (size_t pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1))
+                n++;
+        return n;
+}
+
+static int read_trace(std::string &trace)
+{
+        std::ifstream f(TRACE_FILE);
+        if (!f) {
+                test_pr_err("could not open %s\n", TRACE_FILE);
+                return HB_MC_FAIL;
+        }
+
+        std::stringstream ss;
+        ss << f.rdbuf();
+        trace = ss.str();
+        return HB_MC_SUCCESS;
+}
+
+static int check_event_count(const std::string &trace, const char *name, int expect)
+{
+        int n = count_occurrences(trace, std::string("\"name\":\"") + name + "\"");
+        if (n != expect) {
+                test_pr_err("found %d '%s' events, expected %d\n", n, name, expect);
+                return HB_MC_FAIL;
+        }
+        return HB_MC_SUCCESS;
+}
+
+#define CHECK(stmt)                                                     \
+        {                                                               \
+                int __r = stmt;                                         \
+                if (__r != HB_MC_SUCCESS)                               \
+                        return __r;                                     \
+        }
+
+/*
+ * Check the dumped trace for the calls made by test_api_trace(), which
+ * has already exited the manycore.
+ */
+static int check_trace(bool has_cycle, size_t mem_bytes)
+{
+        std::string trace;
+        CHECK(read_trace(trace));
+        if (trace.compare(0, 16, "{\"traceEvents\":[") != 0
+            || trace.find("],\"displayTimeUnit\":\"ns\"}") == std::string::npos) {
+                test_pr_err("%s is not a trace-event file\n", TRACE_FILE);
+                return HB_MC_FAIL;
+        }
+
+        CHECK(check_event_count(trace, "hb_mc_manycore_init", 1));
+        CHECK(check_event_count(trace, "hb_mc_manycore_exit", 1));
+        for (size_t i = 0; i < SIZED_EVENTS; i++)
+                CHECK(check_event_count(trace, sized_events[i], 1));
+        CHECK(check_event_count(trace, "test_api_trace_worker",
+                                WORKER_THREADS * WORKER_EVENTS));
+
+        std::string bytes = "\"bytes\":" + std::to_string(mem_bytes);
+        if (count_occurrences(trace, bytes) < (int)SIZED_EVENTS) {
+                test_pr_err("memory events do not record their size\n");
+                return HB_MC_FAIL;
+        }
+
+        /* the workers each record on their own thread */
+        for (int tid = 1; tid <= WORKER_THREADS; tid++) {
+                std::string tid_field = "\"tid\":" + std::to_string(tid) + ",";
+                if (count_occurrences(trace, tid_field) != WORKER_EVENTS) {
+                        test_pr_err("expected %d events on thread %d\n", WORKER_EVENTS, tid);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        if (has_cycle && trace.find("\"cycles\":") == std::string::npos) {
+                test_pr_err("events do not carry device cycles\n");
+                return HB_MC_FAIL;
+        }
+
+        /* dumping discards what was written */
+        CHECK(hb_mc_api_trace_dump());
+        CHECK(read_trace(trace));
+        CHECK(check_event_count(trace, "hb_mc_manycore_init", 0));
+
+        return HB_MC_SUCCESS;
+}
+
+int test_api_trace(int argc, char **argv)
+{
+        int err = hb_mc_api_trace_enable(TRACE_FILE);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to enable tracing: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_npa_t npa = hb_mc_npa(hb_mc_config_get_origin_vcore(cfg), HB_MC_TILE_EPA_DMEM_BASE);
+        std::vector<uint32_t> wr(64), rd(64);
+        for (size_t i = 0; i < wr.size(); i++)
+                wr[i] = i * 0x01010101;
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_write_mem(mc, &npa, wr.data(), wr.size() * sizeof(uint32_t)));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_read_mem(mc, &npa, rd.data(), rd.size() * sizeof(uint32_t)));
+
+        /* a transfer split over extents records the bytes of all of them */
+        size_t half = wr.size() * sizeof(uint32_t) / 2;
+        hb_mc_npa_extent_t extents[2] = {
+                { npa, half },
+                { hb_mc_npa(hb_mc_config_get_origin_vcore(cfg), HB_MC_TILE_EPA_DMEM_BASE + half), half },
+        };
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_read_mem_extents(mc, extents, 2, rd.data()));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_write_mem_extents_nofence(mc, extents, 2, wr.data()));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_memset_extents_nofence(mc, extents, 2, 0));
+
+        hb_mc_manycore_iovec_t wr_iov[2] = {
+                { extents[0].npa, &wr[0], half },
+                { extents[1].npa, &wr[wr.size() / 2], half },
+        };
+        hb_mc_manycore_iovec_t rd_iov[2] = {
+                { extents[0].npa, &rd[0], half },
+                { extents[1].npa, &rd[rd.size() / 2], half },
+        };
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_writev(mc, wr_iov, 2));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_readv(mc, rd_iov, 2));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_host_request_fence(mc, -1));
+
+        /* calls made while tracing is disabled are not recorded */
+        hb_mc_api_trace_disable();
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_write_mem(mc, &npa, wr.data(), sizeof(uint32_t)));
+        BSG_MANYCORE_CALL(mc, hb_mc_api_trace_enable(TRACE_FILE));
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < WORKER_THREADS; i++)
+                workers.emplace_back(test_api_trace_worker);
+        for (std::thread &t : workers)
+                t.join();
+
+        uint64_t cycle;
+        bool has_cycle = hb_mc_manycore_get_cycle(mc, &cycle) == HB_MC_SUCCESS;
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+
+        err = hb_mc_api_trace_dump();
+        if (err == HB_MC_SUCCESS)
+                err = check_trace(has_cycle, wr.size() * sizeof(uint32_t));
+
+        hb_mc_api_trace_disable();
+        return err;
+}
+
+declare_program_main(TEST_NAME, test_api_trace);
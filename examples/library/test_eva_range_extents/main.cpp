@@ -0,0 +1,193 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <inttypes.h>
+#include <vector>
+
+#define TEST_NAME "test_eva_range_extents"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* DRAM EVA under test - clear of address zero */
+#define DRAM_EVA_BASE 0x80010000
+
+/*
+ * A map that translates exactly like the default map, but that is not
+ * recognized as it, so ranges go through the generic translation loop.
+ */
+static int wrapped_eva_to_npa(hb_mc_manycore_t *mc, const void *priv,
+                              const hb_mc_coordinate_t *src, const hb_mc_eva_t *eva,
+                              hb_mc_npa_t *npa, size_t *sz)
+{
+        return default_eva_to_npa(mc, priv, src, eva, npa, sz);
+}
+
+static hb_mc_eva_map_t wrapped_map = {
+        .eva_map_name = "Wrapped default EVA space",
+        .priv = (const void *)(&default_origin),
+        .eva_to_npa = wrapped_eva_to_npa,
+        .eva_size = default_eva_size,
+        .npa_to_eva = default_npa_to_eva,
+};
+
+/*
+ * Check that the extents of [eva, eva + sz) cover every byte of the range
+ * with the NPA that hb_mc_eva_to_npa() gives for it, when the extents are
+ * fetched #max_extents at a time.
+ */
+static int check_range(hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                       const hb_mc_coordinate_t *tgt,
+                       hb_mc_eva_t eva, size_t sz, size_t max_extents)
+{
+        std::vector<hb_mc_npa_extent_t> extents(max_extents);
+        size_t off = 0;
+
+        while (off < sz) {
+                size_t n, translated;
+                hb_mc_eva_t curr = eva + off;
+                BSG_MANYCORE_CALL(mc, hb_mc_eva_range_to_npa_extents(mc, map, tgt, &curr, sz - off,
+                                                                     extents.data(), max_extents,
+                                                                     &n, &translated));
+                if (n == 0 || n > max_extents || translated == 0) {
+                        test_pr_err("%s: range at 0x%08" PRIx32 " returned %zu extents for %zu bytes\n",
+                                    map->eva_map_name, curr, n, translated);
+                        return HB_MC_FAIL;
+                }
+
+                size_t covered = 0;
+                for (size_t i = 0; i < n; i++) {
+                        // walk the extent a stripe at a time
+                        size_t xoff = 0;
+                        while (xoff < extents[i].sz) {
+                                hb_mc_eva_t e = eva + off + xoff;
+                                hb_mc_npa_t npa;
+                                size_t npa_sz;
+                                BSG_MANYCORE_CALL(mc, hb_mc_eva_to_npa(mc, &default_map, tgt, &e, &npa, &npa_sz));
+                                if (npa.x != extents[i].npa.x || npa.y != extents[i].npa.y ||
+                                    npa.epa != extents[i].npa.epa + xoff) {
+                                        test_pr_err("%s: EVA 0x%08" PRIx32 " is in extent %zu, which does "
+                                                    "not cover its NPA\n", map->eva_map_name, e, i);
+                                        return HB_MC_FAIL;
+                                }
+                                xoff += npa_sz;
+                        }
+
+                        // adjacent extents are never contiguous in the same endpoint
+                        if (i != 0 &&
+                            extents[i].npa.x == extents[i-1].npa.x &&
+                            extents[i].npa.y == extents[i-1].npa.y &&
+                            extents[i].npa.epa == extents[i-1].npa.epa + extents[i-1].sz) {
+                                test_pr_err("%s: extents %zu and %zu were not merged\n",
+                                            map->eva_map_name, i - 1, i);
+                                return HB_MC_FAIL;
+                        }
+
+                        covered += extents[i].sz;
+                        off += extents[i].sz;
+                }
+
+                if (covered != translated) {
+                        test_pr_err("%s: extents cover %zu bytes, but %zu were reported\n",
+                                    map->eva_map_name, covered, translated);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int test_eva_range_extents(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t tgt = hb_mc_config_get_origin_vcore(cfg);
+        size_t stripe = hb_mc_config_get_vcache_stripe_size(cfg);
+        size_t dmem = hb_mc_config_get_dmem_size(cfg);
+
+        /* (eva, size) pairs: DRAM words, stripe crossings, and whole data memories */
+        std::vector<std::pair<hb_mc_eva_t, size_t>> ranges = {
+                {DRAM_EVA_BASE, 4},
+                {DRAM_EVA_BASE + 3, 2},
+                {DRAM_EVA_BASE + stripe - 4, 8},
+                {DRAM_EVA_BASE + stripe / 2, 37 * stripe + 12},
+                {DRAM_EVA_BASE + 1, 300 * stripe},
+                {HB_MC_TILE_EVA_DMEM_BASE, dmem},
+                {HB_MC_TILE_EVA_DMEM_BASE + 8, 64},
+        };
+
+        for (const hb_mc_eva_map_t *map : {&default_map, &wrapped_map}) {
+                for (auto &r : ranges) {
+                        for (size_t max_extents : {1, 3, 64, 1024})
+                                BSG_MANYCORE_CALL(mc, check_range(mc, map, &tgt, r.first, r.second,
+                                                                  max_extents));
+                }
+        }
+
+        /* a whole data memory is one extent */
+        hb_mc_npa_extent_t extent;
+        size_t n, translated;
+        hb_mc_eva_t eva = HB_MC_TILE_EVA_DMEM_BASE;
+        BSG_MANYCORE_CALL(mc, hb_mc_eva_range_to_npa_extents(mc, &default_map, &tgt, &eva, dmem,
+                                                             &extent, 1, &n, &translated));
+        if (n != 1 || translated != dmem) {
+                test_pr_err("data memory translated to %zu extents covering %zu bytes\n", n, translated);
+                return HB_MC_FAIL;
+        }
+
+        /* an empty range needs no extents; a range with nowhere to put them is invalid */
+        BSG_MANYCORE_CALL(mc, hb_mc_eva_range_to_npa_extents(mc, &default_map, &tgt, &eva, 0,
+                                                             nullptr, 0, &n, &translated));
+        if (n != 0 || translated != 0) {
+                test_pr_err("empty range translated to %zu extents\n", n);
+                return HB_MC_FAIL;
+        }
+
+        err = hb_mc_eva_range_to_npa_extents(mc, &default_map, &tgt, &eva, 4, &extent, 0, &n, &translated);
+        if (err != HB_MC_INVALID) {
+                test_pr_err("range with no room for extents returned %s\n", hb_mc_strerror(err));
+                return HB_MC_FAIL;
+        }
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(TEST_NAME, test_eva_range_extents);
@@ -0,0 +1,165 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_printing.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_NAME "test_eva_read_bandwidth"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* spans many DRAM stripes */
+#define WORDS 4096
+
+#define DRAM_INDICATOR (1u << 31)
+
+hb_mc_manycore_t manycore, *mc = &manycore;
+
+uint32_t out [WORDS];
+uint32_t in  [WORDS];
+
+/*
+ * Read the buffer one stripe at a time.
+ * This is how EVA reads were performed before they were pipelined
+ * across stripes: the load pipeline drains at every stripe boundary.
+ */
+static int read_per_stripe(const hb_mc_coordinate_t *tgt, hb_mc_eva_t eva)
+{
+        size_t off = 0, sz = sizeof(in);
+        while (off < sz) {
+                hb_mc_eva_t curr = eva + off;
+                hb_mc_npa_t npa;
+                size_t npa_sz;
+                int err = hb_mc_eva_to_npa(mc, &default_map, tgt, &curr, &npa, &npa_sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                npa_sz = npa_sz < sz - off ? npa_sz : sz - off;
+                err = hb_mc_manycore_read_mem(mc, &npa, (char*)in + off, npa_sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                off += npa_sz;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int read_pipelined(const hb_mc_coordinate_t *tgt, hb_mc_eva_t eva)
+{
+        return hb_mc_manycore_eva_read(mc, &default_map, tgt, &eva, in, sizeof(in));
+}
+
+/*
+ * Time one read of the whole buffer and check the data.
+ */
+static int measure(const char *label,
+                   int (*read_fn)(const hb_mc_coordinate_t *, hb_mc_eva_t),
+                   const hb_mc_coordinate_t *tgt, hb_mc_eva_t eva,
+                   uint64_t *cycles)
+{
+        uint64_t start, end;
+        int err;
+
+        memset(in, 0, sizeof(in));
+
+        err = hb_mc_manycore_get_cycle(mc, &start);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = read_fn(tgt, eva);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("%s: read failed: %s\n", label, hb_mc_strerror(err));
+                return err;
+        }
+
+        err = hb_mc_manycore_get_cycle(mc, &end);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        *cycles = end - start;
+        bsg_pr_test_info("%-20s: %zu bytes in %10" PRIu64 " cycles (%.3f bytes/cycle)\n",
+                         label, sizeof(in), *cycles,
+                         *cycles ? (double)sizeof(in) / *cycles : 0.0);
+
+        for (int i = 0; i < WORDS; i++) {
+                if (in[i] != out[i]) {
+                        test_pr_err("%s: mismatch at word %d: read 0x%08" PRIx32 ", wrote 0x%08" PRIx32 "\n",
+                                    label, i, in[i], out[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int run_tests(int argc, char *argv[])
+{
+        int err, rc = HB_MC_FAIL;
+        uint64_t per_stripe, pipelined;
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n",
+                            hb_mc_strerror(err));
+                goto done;
+        }
+
+        hb_mc_coordinate_t tgt = hb_mc_config_get_origin_vcore(hb_mc_manycore_get_config(mc));
+        hb_mc_eva_t eva = DRAM_INDICATOR;
+
+        for (int i = 0; i < WORDS; i++)
+                out[i] = (uint32_t)rand();
+
+        err = hb_mc_manycore_eva_write(mc, &default_map, &tgt, &eva, out, sizeof(out));
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to write test data: %s\n", hb_mc_strerror(err));
+                goto cleanup;
+        }
+
+        if (measure("read per stripe", read_per_stripe, &tgt, eva, &per_stripe) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (measure("pipelined read", read_pipelined, &tgt, eva, &pipelined) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (pipelined)
+                bsg_pr_test_info("Speedup: %.2fx\n", (double)per_stripe / pipelined);
+
+        rc = HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_manycore_exit(mc);
+done:
+        return rc;
+}
+
+declare_program_main(TEST_NAME, run_tests);
@@ -0,0 +1,184 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_printing.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_NAME "test_eva_write_fence"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* spans many DRAM stripes */
+#define WORDS 2048
+#define WINDOW_BYTES 1024
+
+#define DRAM_INDICATOR (1u << 31)
+
+hb_mc_manycore_t manycore, *mc = &manycore;
+
+uint32_t out [WORDS];
+uint32_t in  [WORDS];
+
+typedef struct {
+        uint64_t packets;
+        uint64_t fences;
+} write_stats_t;
+
+static void stats_begin(write_stats_t *stats)
+{
+        stats->packets = mc->request_packets_tx;
+        stats->fences = mc->host_request_fences;
+}
+
+static void stats_end(write_stats_t *stats, const char *label)
+{
+        stats->packets = mc->request_packets_tx - stats->packets;
+        stats->fences = mc->host_request_fences - stats->fences;
+        bsg_pr_test_info("%-24s: %8" PRIu64 " packets, %6" PRIu64 " fences, %8.1f packets/fence\n",
+                         label, stats->packets, stats->fences,
+                         stats->fences ? (double)stats->packets / stats->fences : 0.0);
+}
+
+/*
+ * Write the buffer one stripe at a time with a fenced write per stripe.
+ * This is how EVA writes were performed before they were pipelined.
+ */
+static int write_per_stripe(const hb_mc_coordinate_t *tgt, hb_mc_eva_t eva)
+{
+        size_t off = 0, sz = sizeof(out);
+        while (off < sz) {
+                hb_mc_eva_t curr = eva + off;
+                hb_mc_npa_t npa;
+                size_t npa_sz;
+                int err = hb_mc_eva_to_npa(mc, &default_map, tgt, &curr, &npa, &npa_sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                npa_sz = npa_sz < sz - off ? npa_sz : sz - off;
+                err = hb_mc_manycore_write_mem(mc, &npa, (const char*)out + off, npa_sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                off += npa_sz;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int check(const hb_mc_coordinate_t *tgt, hb_mc_eva_t eva)
+{
+        int err;
+
+        memset(in, 0, sizeof(in));
+        err = hb_mc_manycore_eva_read(mc, &default_map, tgt, &eva, in, sizeof(in));
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to read back: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        for (int i = 0; i < WORDS; i++) {
+                if (in[i] != out[i]) {
+                        test_pr_err("mismatch at word %d: read 0x%08" PRIx32 ", wrote 0x%08" PRIx32 "\n",
+                                    i, in[i], out[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+        return HB_MC_SUCCESS;
+}
+
+static void refresh_out_data(void)
+{
+        for (int i = 0; i < WORDS; i++)
+                out[i] = (uint32_t)rand();
+}
+
+static int run_tests(int argc, char *argv[])
+{
+        int err, rc = HB_MC_FAIL;
+        write_stats_t per_stripe, pipelined, windowed;
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n",
+                            hb_mc_strerror(err));
+                goto done;
+        }
+
+        hb_mc_coordinate_t tgt = hb_mc_config_get_origin_vcore(hb_mc_manycore_get_config(mc));
+        hb_mc_eva_t eva = DRAM_INDICATOR;
+
+        /* before: one fence per stripe */
+        refresh_out_data();
+        stats_begin(&per_stripe);
+        err = write_per_stripe(&tgt, eva);
+        stats_end(&per_stripe, "fence per stripe");
+        if (err != HB_MC_SUCCESS || check(&tgt, eva) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        /* after: a single trailing fence */
+        refresh_out_data();
+        hb_mc_manycore_set_write_fence_window(mc, 0);
+        stats_begin(&pipelined);
+        err = hb_mc_manycore_eva_write(mc, &default_map, &tgt, &eva, out, sizeof(out));
+        stats_end(&pipelined, "single trailing fence");
+        if (err != HB_MC_SUCCESS || check(&tgt, eva) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (pipelined.fences != 1) {
+                test_pr_err("expected 1 fence, saw %" PRIu64 "\n", pipelined.fences);
+                goto cleanup;
+        }
+
+        /* after: a fence per window */
+        refresh_out_data();
+        hb_mc_manycore_set_write_fence_window(mc, WINDOW_BYTES);
+        stats_begin(&windowed);
+        err = hb_mc_manycore_eva_write(mc, &default_map, &tgt, &eva, out, sizeof(out));
+        stats_end(&windowed, "fence per window");
+        if (err != HB_MC_SUCCESS || check(&tgt, eva) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (windowed.fences > sizeof(out) / WINDOW_BYTES + 1) {
+                test_pr_err("expected at most %zu fences, saw %" PRIu64 "\n",
+                            sizeof(out) / WINDOW_BYTES + 1, windowed.fences);
+                goto cleanup;
+        }
+
+        rc = HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_manycore_exit(mc);
+done:
+        return rc;
+}
+
+declare_program_main(TEST_NAME, run_tests);
@@ -0,0 +1,237 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_memory_allocator.h>
+#include <bsg_manycore_printing.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <map>
+#include <vector>
+
+#define TEST_NAME "test_memory_allocator"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+#define STEPS 20000
+
+/*
+ * A reference model of the allocator: the set of live allocations,
+ * from which the free gaps are recomputed after every operation.
+ */
+struct reference {
+        uint64_t start, size, alignment;
+        std::map<uint64_t, uint64_t> live; // address -> aligned size
+
+        uint64_t align(uint64_t bytes) const {
+                if (bytes == 0)
+                        bytes = alignment;
+                return (bytes + alignment - 1) / alignment * alignment;
+        }
+
+        uint64_t live_bytes() const {
+                uint64_t sum = 0;
+                for (auto &a : live)
+                        sum += a.second;
+                return sum;
+        }
+
+        /* largest gap between live allocations and the number of gaps */
+        uint64_t largest_gap(uint64_t *gaps) const {
+                uint64_t largest = 0, at = start;
+                *gaps = 0;
+                for (auto &a : live) {
+                        if (a.first > at) {
+                                largest = std::max(largest, a.first - at);
+                                (*gaps)++;
+                        }
+                        at = a.first + a.second;
+                }
+                if (start + size > at) {
+                        largest = std::max(largest, start + size - at);
+                        (*gaps)++;
+                }
+                return largest;
+        }
+
+        bool overlaps(uint64_t addr, uint64_t bytes) const {
+                auto next = live.lower_bound(addr);
+                if (next != live.end() && next->first < addr + bytes)
+                        return true;
+                if (next != live.begin()) {
+                        auto prev = std::prev(next);
+                        if (prev->first + prev->second > addr)
+                                return true;
+                }
+                return false;
+        }
+};
+
+static int check_stats(hb_mc_memory_allocator_t *alloc, const reference &ref, int step)
+{
+        hb_mc_memory_allocator_stats_t stats;
+        uint64_t gaps;
+        uint64_t largest = ref.largest_gap(&gaps);
+
+        hb_mc_memory_allocator_get_stats(alloc, &stats);
+
+        if (stats.live_bytes != ref.live_bytes()
+            || stats.free_bytes != ref.size - ref.live_bytes()
+            || stats.live_allocations != ref.live.size()
+            || stats.largest_free_block != largest
+            || stats.free_blocks != gaps
+            || stats.peak_bytes < stats.live_bytes) {
+                test_pr_err("step %d: stats mismatch: "
+                            "live %" PRIu64 "/%" PRIu64 " "
+                            "largest free %" PRIu64 "/%" PRIu64 " "
+                            "free blocks %" PRIu64 "/%" PRIu64 "\n",
+                            step,
+                            stats.live_bytes, ref.live_bytes(),
+                            stats.largest_free_block, largest,
+                            stats.free_blocks, gaps);
+                return HB_MC_FAIL;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int test_allocator(uint64_t start, uint64_t size, uint32_t alignment, uint64_t max_request)
+{
+        hb_mc_memory_allocator_t *alloc;
+        reference ref = {start, size - size % alignment, alignment, {}};
+        std::vector<uint64_t> addrs;
+        int rc = HB_MC_FAIL, failed = 0;
+
+        if (hb_mc_memory_allocator_init(&alloc, start, size, alignment) != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize allocator\n");
+                return HB_MC_FAIL;
+        }
+
+        for (int step = 0; step < STEPS; step++) {
+                /* free slightly less often than allocating, so memory fills up */
+                if (!addrs.empty() && rand() % 5 < 2) {
+                        size_t i = rand() % addrs.size();
+                        uint64_t addr = addrs[i];
+                        addrs[i] = addrs.back();
+                        addrs.pop_back();
+
+                        if (hb_mc_memory_allocator_free(alloc, addr) != HB_MC_SUCCESS) {
+                                test_pr_err("step %d: failed to free 0x%" PRIx64 "\n", step, addr);
+                                goto cleanup;
+                        }
+                        ref.live.erase(addr);
+
+                        /* a second free of the same address is rejected */
+                        if (hb_mc_memory_allocator_free(alloc, addr) != HB_MC_INVALID) {
+                                test_pr_err("step %d: freed 0x%" PRIx64 " twice\n", step, addr);
+                                goto cleanup;
+                        }
+                } else {
+                        uint64_t bytes = rand() % (max_request + 1);
+                        uint64_t aligned = ref.align(bytes);
+                        uint64_t gaps, addr;
+                        bool fits = ref.largest_gap(&gaps) >= aligned;
+
+                        int err = hb_mc_memory_allocator_alloc(alloc, bytes, &addr);
+                        if (!fits) {
+                                if (err != HB_MC_NOMEM) {
+                                        test_pr_err("step %d: allocated %" PRIu64 " bytes with no gap large enough\n",
+                                                    step, bytes);
+                                        goto cleanup;
+                                }
+                                failed++;
+                                continue;
+                        }
+
+                        if (err != HB_MC_SUCCESS) {
+                                test_pr_err("step %d: failed to allocate %" PRIu64 " bytes: %s\n",
+                                            step, bytes, hb_mc_strerror(err));
+                                goto cleanup;
+                        }
+
+                        if (addr % alignment != 0 || addr < start || addr + aligned > start + ref.size
+                            || ref.overlaps(addr, aligned)) {
+                                test_pr_err("step %d: bad allocation of %" PRIu64 " bytes at 0x%" PRIx64 "\n",
+                                            step, bytes, addr);
+                                goto cleanup;
+                        }
+
+                        ref.live[addr] = aligned;
+                        addrs.push_back(addr);
+                }
+
+                if (check_stats(alloc, ref, step) != HB_MC_SUCCESS)
+                        goto cleanup;
+        }
+
+        /* free everything: the range must coalesce back into one block */
+        for (uint64_t addr : addrs) {
+                if (hb_mc_memory_allocator_free(alloc, addr) != HB_MC_SUCCESS) {
+                        test_pr_err("failed to free 0x%" PRIx64 "\n", addr);
+                        goto cleanup;
+                }
+                ref.live.erase(addr);
+        }
+
+        if (check_stats(alloc, ref, STEPS) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        {
+                hb_mc_memory_allocator_stats_t stats;
+                hb_mc_memory_allocator_get_stats(alloc, &stats);
+                bsg_pr_test_info("%" PRIu64 " bytes, %" PRIu32 "-byte alignment: "
+                                 "peak %" PRIu64 " bytes, %d allocations did not fit\n",
+                                 size, alignment, stats.peak_bytes, failed);
+        }
+
+        rc = HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_memory_allocator_exit(alloc);
+        return rc;
+}
+
+int test_memory_allocator (int argc, char **argv) {
+        srand(0xa110c);
+
+        /* a program's DRAM heap: vcache-block aligned */
+        if (test_allocator(0x80004000, 1 << 20, 32, 16 << 10) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        /* a size that is not a multiple of the alignment */
+        if (test_allocator(0x1000, 100003, 64, 4096) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        /* many small allocations */
+        if (test_allocator(0, 64 << 10, 4, 64) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(TEST_NAME, test_memory_allocator);
@@ -0,0 +1,165 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_memory_allocator.h>
+#include <bsg_manycore_memory_manager.h>
+#include <bsg_manycore_printing.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define TEST_NAME "test_memory_allocator_throughput"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* a program's DRAM heap */
+#define HEAP_START 0x80004000
+#define HEAP_SIZE  (512ull << 20)
+#define ALIGNMENT  32
+
+/* allocate/free pairs performed at each level of live allocations */
+#define OPERATIONS 20000
+
+/*
+ * Both allocators are driven by the same sequence: fill the heap with
+ * #live allocations, then free a random one and allocate a new one
+ * #OPERATIONS times.
+ */
+struct workload {
+        std::vector<uint32_t> sizes;
+        std::vector<uint32_t> victims;
+
+        workload(int live) {
+                for (int i = 0; i < live + OPERATIONS; i++)
+                        sizes.push_back(4 + rand() % 8192);
+                for (int i = 0; i < OPERATIONS; i++)
+                        victims.push_back(rand() % live);
+        }
+};
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *end)
+{
+        return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static int run_allocator(const workload &w, int live, double *seconds)
+{
+        hb_mc_memory_allocator_t *alloc;
+        std::vector<uint64_t> addrs(live);
+        struct timespec start, end;
+        int rc = HB_MC_FAIL;
+
+        if (hb_mc_memory_allocator_init(&alloc, HEAP_START, HEAP_SIZE, ALIGNMENT) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < live; i++) {
+                if (hb_mc_memory_allocator_alloc(alloc, w.sizes[i], &addrs[i]) != HB_MC_SUCCESS)
+                        goto cleanup;
+        }
+        for (int i = 0; i < OPERATIONS; i++) {
+                uint32_t v = w.victims[i];
+                if (hb_mc_memory_allocator_free(alloc, addrs[v]) != HB_MC_SUCCESS
+                    || hb_mc_memory_allocator_alloc(alloc, w.sizes[live + i], &addrs[v]) != HB_MC_SUCCESS)
+                        goto cleanup;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        *seconds = elapsed_seconds(&start, &end);
+        rc = HB_MC_SUCCESS;
+
+        {
+                hb_mc_memory_allocator_stats_t stats;
+                hb_mc_memory_allocator_get_stats(alloc, &stats);
+                bsg_pr_test_info("%6d live: %" PRIu64 " free blocks, largest %" PRIu64 " bytes, peak %" PRIu64 " bytes\n",
+                                 live, stats.free_blocks, stats.largest_free_block, stats.peak_bytes);
+        }
+
+cleanup:
+        hb_mc_memory_allocator_exit(alloc);
+        return rc;
+}
+
+static int run_legacy(const workload &w, int live, double *seconds)
+{
+        awsbwhal::MemoryManager mm(HEAP_SIZE, HEAP_START, ALIGNMENT);
+        std::vector<uint64_t> addrs(live);
+        struct timespec start, end;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < live; i++) {
+                addrs[i] = mm.alloc(w.sizes[i]);
+                if (addrs[i] == awsbwhal::MemoryManager::mNull)
+                        return HB_MC_FAIL;
+        }
+        for (int i = 0; i < OPERATIONS; i++) {
+                uint32_t v = w.victims[i];
+                mm.free(addrs[v]);
+                addrs[v] = mm.alloc(w.sizes[live + i]);
+                if (addrs[v] == awsbwhal::MemoryManager::mNull)
+                        return HB_MC_FAIL;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        *seconds = elapsed_seconds(&start, &end);
+        return HB_MC_SUCCESS;
+}
+
+int test_memory_allocator_throughput (int argc, char **argv) {
+        static const int lives[] = {16, 256, 4096};
+
+        srand(0xa110c);
+
+        for (int live : lives) {
+                workload w(live);
+                double fast, legacy;
+                int ops = live + 2 * OPERATIONS;
+
+                if (run_allocator(w, live, &fast) != HB_MC_SUCCESS) {
+                        test_pr_err("%d live: allocator ran out of memory\n", live);
+                        return HB_MC_FAIL;
+                }
+
+                if (run_legacy(w, live, &legacy) != HB_MC_SUCCESS) {
+                        test_pr_err("%d live: legacy memory manager ran out of memory\n", live);
+                        return HB_MC_FAIL;
+                }
+
+                bsg_pr_test_info("%6d live: allocator %8.2f Mops/s, legacy %8.2f Mops/s (%.1fx)\n",
+                                 live,
+                                 ops / fast / 1e6, ops / legacy / 1e6,
+                                 fast > 0 ? legacy / fast : 0.0);
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(TEST_NAME, test_memory_allocator_throughput);
@@ -0,0 +1,248 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore_mesh_occupancy.h>
+#include <bsg_manycore_printing.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <vector>
+
+#define TEST_NAME "test_mesh_occupancy"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* operations per mesh shape */
+#define STEPS 4000
+
+struct rect {
+        hb_mc_coordinate_t origin;
+        hb_mc_dimension_t  dim;
+};
+
+/*
+ * A tile-by-tile model of the mesh, searched in foreach_coordinate() order
+ * the way the CUDA runtime used to.
+ */
+struct reference {
+        hb_mc_dimension_t dim;
+        std::vector<bool> busy;
+
+        reference(hb_mc_dimension_t dim) : dim(dim), busy(dim.x * dim.y, false) {}
+
+        bool is_free(hb_mc_coordinate_t origin, hb_mc_dimension_t rdim) const {
+                hb_mc_coordinate_t xy;
+                foreach_coordinate(xy, origin, rdim) {
+                        if (busy[xy.y * dim.x + xy.x])
+                                return false;
+                }
+                return true;
+        }
+
+        bool find(hb_mc_dimension_t rdim, hb_mc_coordinate_t *origin) const {
+                hb_mc_dimension_t boundary = HB_MC_DIMENSION(dim.x - rdim.x + 1, dim.y - rdim.y + 1);
+                hb_mc_coordinate_t o;
+                foreach_coordinate(o, HB_MC_COORDINATE(0, 0), boundary) {
+                        if (is_free(o, rdim)) {
+                                *origin = o;
+                                return true;
+                        }
+                }
+                return false;
+        }
+
+        bool busy_or_edge(int64_t x, int64_t y) const {
+                return x < 0 || y < 0 || x >= dim.x || y >= dim.y || busy[y * dim.x + x];
+        }
+
+        /* busy tiles and mesh edges bordering a rectangle */
+        unsigned contact(hb_mc_coordinate_t o, hb_mc_dimension_t rdim) const {
+                unsigned c = 0;
+                for (int64_t y = o.y; y < o.y + rdim.y; y++)
+                        c += busy_or_edge((int64_t)o.x - 1, y) + busy_or_edge(o.x + rdim.x, y);
+                for (int64_t x = o.x; x < o.x + rdim.x; x++)
+                        c += busy_or_edge(x, (int64_t)o.y - 1) + busy_or_edge(x, o.y + rdim.y);
+                return c;
+        }
+
+        bool find_best_fit(hb_mc_dimension_t rdim, hb_mc_coordinate_t *origin) const {
+                hb_mc_dimension_t boundary = HB_MC_DIMENSION(dim.x - rdim.x + 1, dim.y - rdim.y + 1);
+                hb_mc_coordinate_t o;
+                bool found = false;
+                unsigned best = 0;
+                foreach_coordinate(o, HB_MC_COORDINATE(0, 0), boundary) {
+                        if (is_free(o, rdim) && (!found || contact(o, rdim) > best)) {
+                                *origin = o;
+                                best = contact(o, rdim);
+                                found = true;
+                        }
+                }
+                return found;
+        }
+
+        void set(const rect &r, bool b) {
+                hb_mc_coordinate_t xy;
+                foreach_coordinate(xy, r.origin, r.dim)
+                        busy[xy.y * dim.x + xy.x] = b;
+        }
+};
+
+static int test_mesh(hb_mc_dimension_t dim, hb_mc_dimension_t max_rect)
+{
+        hb_mc_mesh_occupancy_t occ;
+        reference ref(dim);
+        std::vector<rect> allocated;
+        int found = 0, missed = 0, rc = HB_MC_FAIL;
+
+        if (hb_mc_mesh_occupancy_init(&occ, dim) != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize %ux%u occupancy\n", dim.x, dim.y);
+                return HB_MC_FAIL;
+        }
+
+        for (int step = 0; step < STEPS; step++) {
+                /* free a random rectangle about a third of the time */
+                if (!allocated.empty() && rand() % 3 == 0) {
+                        size_t i = rand() % allocated.size();
+                        rect r = allocated[i];
+                        allocated[i] = allocated.back();
+                        allocated.pop_back();
+
+                        if (hb_mc_mesh_occupancy_release(&occ, r.origin, r.dim) != HB_MC_SUCCESS) {
+                                test_pr_err("step %d: failed to release %ux%u @ (%u,%u)\n",
+                                            step, r.dim.x, r.dim.y, r.origin.x, r.origin.y);
+                                goto cleanup;
+                        }
+                        ref.set(r, false);
+                        continue;
+                }
+
+                rect r;
+                r.dim = HB_MC_DIMENSION(1 + rand() % max_rect.x, 1 + rand() % max_rect.y);
+
+                /* alternate first fit and best fit placement */
+                bool best_fit = step & 1;
+                hb_mc_coordinate_t expect;
+                bool expect_found = best_fit ? ref.find_best_fit(r.dim, &expect) : ref.find(r.dim, &expect);
+                int err = best_fit
+                        ? hb_mc_mesh_occupancy_find_best_fit(&occ, r.dim, &r.origin)
+                        : hb_mc_mesh_occupancy_find(&occ, r.dim, &r.origin);
+
+                if (!expect_found) {
+                        if (err != HB_MC_NOTFOUND) {
+                                test_pr_err("step %d: found %ux%u @ (%u,%u) but none is free\n",
+                                            step, r.dim.x, r.dim.y, r.origin.x, r.origin.y);
+                                goto cleanup;
+                        }
+                        missed++;
+                        continue;
+                }
+
+                if (err != HB_MC_SUCCESS || !hb_mc_coordinate_eq(r.origin, expect)) {
+                        test_pr_err("step %d: %ux%u %s: expected (%u,%u), got %s (%u,%u)\n",
+                                    step, r.dim.x, r.dim.y, best_fit ? "best fit" : "first fit",
+                                    expect.x, expect.y,
+                                    hb_mc_strerror(err), r.origin.x, r.origin.y);
+                        goto cleanup;
+                }
+
+                if (hb_mc_mesh_occupancy_allocate(&occ, r.origin, r.dim) != HB_MC_SUCCESS) {
+                        test_pr_err("step %d: failed to allocate %ux%u @ (%u,%u)\n",
+                                    step, r.dim.x, r.dim.y, r.origin.x, r.origin.y);
+                        goto cleanup;
+                }
+
+                /* the same tiles cannot be allocated twice */
+                if (hb_mc_mesh_occupancy_allocate(&occ, r.origin, r.dim) != HB_MC_INVALID) {
+                        test_pr_err("step %d: allocated %ux%u @ (%u,%u) twice\n",
+                                    step, r.dim.x, r.dim.y, r.origin.x, r.origin.y);
+                        goto cleanup;
+                }
+
+                ref.set(r, true);
+                allocated.push_back(r);
+                found++;
+        }
+
+        /* rectangles larger than the mesh are rejected */
+        {
+                hb_mc_coordinate_t origin;
+                if (hb_mc_mesh_occupancy_find(&occ, HB_MC_DIMENSION(dim.x + 1, 1), &origin) != HB_MC_INVALID
+                    || hb_mc_mesh_occupancy_find(&occ, HB_MC_DIMENSION(1, dim.y + 1), &origin) != HB_MC_INVALID) {
+                        test_pr_err("%ux%u: oversized rectangle not rejected\n", dim.x, dim.y);
+                        goto cleanup;
+                }
+        }
+
+        /* releasing everything leaves the whole mesh free */
+        for (const rect &r : allocated) {
+                if (hb_mc_mesh_occupancy_release(&occ, r.origin, r.dim) != HB_MC_SUCCESS) {
+                        test_pr_err("failed to release %ux%u @ (%u,%u)\n",
+                                    r.dim.x, r.dim.y, r.origin.x, r.origin.y);
+                        goto cleanup;
+                }
+        }
+
+        if (!hb_mc_mesh_occupancy_is_free(&occ, HB_MC_COORDINATE(0, 0), dim)
+            || occ.num_free != dim.x * dim.y) {
+                test_pr_err("%ux%u: mesh not free after releasing all tiles\n", dim.x, dim.y);
+                goto cleanup;
+        }
+
+        bsg_pr_test_info("%3ux%-3u mesh: %d allocations, %d searches found no space\n",
+                         dim.x, dim.y, found, missed);
+        rc = HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_mesh_occupancy_exit(&occ);
+        return rc;
+}
+
+int test_mesh_occupancy (int argc, char **argv) {
+        srand(0x5eed);
+
+        /* a pod */
+        if (test_mesh(HB_MC_DIMENSION(16, 8), HB_MC_DIMENSION(4, 4)) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        /* a single column */
+        if (test_mesh(HB_MC_DIMENSION(1, 8), HB_MC_DIMENSION(1, 3)) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        /* columns taller than a bitmap word */
+        if (test_mesh(HB_MC_DIMENSION(5, 150), HB_MC_DIMENSION(3, 70)) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        /* exactly one bitmap word per column */
+        if (test_mesh(HB_MC_DIMENSION(32, 64), HB_MC_DIMENSION(8, 64)) != HB_MC_SUCCESS)
+                return HB_MC_FAIL;
+
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(TEST_NAME, test_mesh_occupancy);
@@ -0,0 +1,188 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_regression.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_printing.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_NAME "test_packet_rate"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* one request packet per word */
+#define WORDS 1024
+
+hb_mc_manycore_t manycore, *mc = &manycore;
+
+uint32_t out [WORDS];
+uint32_t in  [WORDS];
+
+/*
+ * Send one packet per call through the single-packet interface.
+ */
+static int write_per_packet(const hb_mc_npa_t *base)
+{
+        for (int i = 0; i < WORDS; i++) {
+                hb_mc_npa_t npa = *base;
+                hb_mc_npa_set_epa(&npa, hb_mc_npa_get_epa(base) + i * sizeof(uint32_t));
+                int err = hb_mc_manycore_write32(mc, &npa, out[i]);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        return hb_mc_manycore_host_request_fence(mc, -1);
+}
+
+static int write_batched(const hb_mc_npa_t *base)
+{
+        return hb_mc_manycore_write_mem(mc, base, out, sizeof(out));
+}
+
+static int read_per_packet(const hb_mc_npa_t *base)
+{
+        for (int i = 0; i < WORDS; i++) {
+                hb_mc_npa_t npa = *base;
+                hb_mc_npa_set_epa(&npa, hb_mc_npa_get_epa(base) + i * sizeof(uint32_t));
+                int err = hb_mc_manycore_read32(mc, &npa, &in[i]);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int read_batched(const hb_mc_npa_t *base)
+{
+        return hb_mc_manycore_read_mem(mc, base, in, sizeof(in));
+}
+
+/*
+ * Time #fn over the buffer and report the request packet rate.
+ */
+static int measure(const char *label, int (*fn)(const hb_mc_npa_t *),
+                   const hb_mc_npa_t *base, uint64_t *cycles)
+{
+        uint64_t start, end;
+        int err;
+
+        err = hb_mc_manycore_get_cycle(mc, &start);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = fn(base);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("%s: failed: %s\n", label, hb_mc_strerror(err));
+                return err;
+        }
+
+        err = hb_mc_manycore_get_cycle(mc, &end);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        *cycles = end - start;
+        bsg_pr_test_info("%-20s: %d packets in %10" PRIu64 " cycles (%.3f packets/kcycle)\n",
+                         label, WORDS, *cycles,
+                         *cycles ? 1000.0 * WORDS / *cycles : 0.0);
+        return HB_MC_SUCCESS;
+}
+
+static int check(const char *label)
+{
+        for (int i = 0; i < WORDS; i++) {
+                if (in[i] != out[i]) {
+                        test_pr_err("%s: mismatch at word %d: read 0x%08" PRIx32 ", wrote 0x%08" PRIx32 "\n",
+                                    label, i, in[i], out[i]);
+                        return HB_MC_FAIL;
+                }
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int run_tests(int argc, char *argv[])
+{
+        int err, rc = HB_MC_FAIL;
+        uint64_t single, batched;
+
+        err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n",
+                            hb_mc_strerror(err));
+                goto done;
+        }
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pod = {.x=0, .y=0};
+        hb_mc_npa_t base = hb_mc_npa_from_x_y(hb_mc_config_get_vcore_base_x(cfg),
+                                              hb_mc_config_pod_dram_y(cfg, pod, 0), 0);
+
+        for (int i = 0; i < WORDS; i++)
+                out[i] = (uint32_t)rand();
+
+        /* writes */
+        if (measure("write per packet", write_per_packet, &base, &single) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        memset(in, 0, sizeof(in));
+        if (hb_mc_manycore_read_mem(mc, &base, in, sizeof(in)) != HB_MC_SUCCESS
+            || check("write per packet") != HB_MC_SUCCESS)
+                goto cleanup;
+
+        for (int i = 0; i < WORDS; i++)
+                out[i] = (uint32_t)rand();
+
+        if (measure("write batched", write_batched, &base, &batched) != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (batched)
+                bsg_pr_test_info("Write speedup: %.2fx\n", (double)single / batched);
+
+        /* reads */
+        memset(in, 0, sizeof(in));
+        if (measure("read per packet", read_per_packet, &base, &single) != HB_MC_SUCCESS
+            || check("read per packet") != HB_MC_SUCCESS)
+                goto cleanup;
+
+        memset(in, 0, sizeof(in));
+        if (measure("read batched", read_batched, &base, &batched) != HB_MC_SUCCESS
+            || check("read batched") != HB_MC_SUCCESS)
+                goto cleanup;
+
+        if (batched)
+                bsg_pr_test_info("Read speedup: %.2fx\n", (double)single / batched);
+
+        rc = HB_MC_SUCCESS;
+
+cleanup:
+        hb_mc_manycore_exit(mc);
+done:
+        return rc;
+}
+
+declare_program_main(TEST_NAME, run_tests);
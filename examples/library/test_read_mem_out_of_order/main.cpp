@@ -0,0 +1,216 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_config_pod.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define TEST_NAME "test_read_mem_out_of_order"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* each DRAM bank of pod 0 holds BANK_WORDS known words from BANK_EPA */
+#define BANK_EPA   0x4000
+#define BANK_WORDS 96
+
+/* readers running at once, and the reads each makes */
+#define THREADS 4
+#define REPS    8
+
+/* the word stored at an NPA, unique to it */
+static uint32_t expected(const hb_mc_npa_t *npa)
+{
+        return (hb_mc_npa_get_x(npa) << 24) ^ (hb_mc_npa_get_y(npa) << 16) ^
+                hb_mc_npa_get_epa(npa) ^ 0xA5000000;
+}
+
+static hb_mc_npa_t bank_word(const hb_mc_coordinate_t &bank, size_t word)
+{
+        return hb_mc_npa(bank, BANK_EPA + word * sizeof(uint32_t));
+}
+
+static int check_words(const char *label, const hb_mc_npa_t *npas,
+                       const uint32_t *words, size_t n)
+{
+        for (size_t i = 0; i < n; i++) {
+                if (words[i] != expected(&npas[i])) {
+                        char npa_str[256];
+                        hb_mc_npa_to_string(&npas[i], npa_str, sizeof(npa_str));
+                        test_pr_err("%s: word %zu from %s is 0x%08" PRIx32 ", expected 0x%08" PRIx32 "\n",
+                                    label, i, npa_str, words[i], expected(&npas[i]));
+                        return HB_MC_FAIL;
+                }
+        }
+        return HB_MC_SUCCESS;
+}
+
+/*
+ * Read the words of every bank, starting at bank #first, with each of the
+ * bulk read calls in the bulk order of #mc, and check that every word lands where it belongs. The
+ * loads go to many destinations with many loads in flight, so responses
+ * return in a different order than their loads were sent.
+ */
+static int read_banks(hb_mc_manycore_t *mc, const std::vector<hb_mc_coordinate_t> &banks,
+                      size_t first)
+{
+        size_t n_banks = banks.size();
+        size_t n_words = n_banks * BANK_WORDS;
+        std::vector<hb_mc_npa_t> npas(n_words);
+        std::vector<uint32_t> words(n_words);
+        int err;
+
+        /* word by word, striding across the banks */
+        for (size_t i = 0; i < n_words; i++)
+                npas[i] = bank_word(banks[(first + i) % n_banks], i / n_banks);
+
+        err = hb_mc_manycore_read_mem_scatter_gather(mc, npas.data(), words.data(), n_words);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("scatter-gather read failed: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+        err = check_words("scatter-gather", npas.data(), words.data(), n_words);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* three extents per bank, one of them empty, and the words they cover back to back */
+        std::vector<hb_mc_npa_extent_t> extents;
+        std::vector<hb_mc_npa_t> extent_npas;
+        for (size_t b = 0; b < n_banks; b++) {
+                const hb_mc_coordinate_t &bank = banks[(first + b) % n_banks];
+                size_t split = 1 + (first + b) % (BANK_WORDS - 1);
+                extents.push_back({bank_word(bank, 0), split * sizeof(uint32_t)});
+                extents.push_back({bank_word(bank, split), 0});
+                extents.push_back({bank_word(bank, split), (BANK_WORDS - split) * sizeof(uint32_t)});
+                for (size_t w = 0; w < BANK_WORDS; w++)
+                        extent_npas.push_back(bank_word(bank, w));
+        }
+
+        const char *label = hb_mc_manycore_get_bulk_order(mc) == HB_MC_MANYCORE_BULK_ORDER_LINEAR ?
+                "linear" : "interleaved";
+
+        std::fill(words.begin(), words.end(), 0);
+        err = hb_mc_manycore_read_mem_extents(mc, extents.data(), extents.size(), words.data());
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("%s extent read failed: %s\n", label, hb_mc_strerror(err));
+                return err;
+        }
+        err = check_words(label, extent_npas.data(), words.data(), n_words);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* the same extents, each into its own place in the buffer */
+        std::vector<hb_mc_manycore_iovec_t> iov(extents.size());
+        size_t off = 0;
+        for (size_t i = 0; i < extents.size(); i++) {
+                iov[i].npa = extents[i].npa;
+                iov[i].base = &words[off];
+                iov[i].len = extents[i].sz;
+                off += extents[i].sz / sizeof(uint32_t);
+        }
+
+        std::fill(words.begin(), words.end(), 0);
+        err = hb_mc_manycore_readv(mc, iov.data(), iov.size());
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("%s vectored read failed: %s\n", label, hb_mc_strerror(err));
+                return err;
+        }
+        err = check_words(label, extent_npas.data(), words.data(), n_words);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        return HB_MC_SUCCESS;
+}
+
+int test_read_mem_out_of_order(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pod = hb_mc_coordinate(0, 0);
+        hb_mc_coordinate_t bank;
+        std::vector<hb_mc_coordinate_t> banks;
+
+        hb_mc_config_pod_foreach_dram(bank, pod, cfg)
+        {
+                banks.push_back(bank);
+                for (size_t w = 0; w < BANK_WORDS; w++) {
+                        hb_mc_npa_t npa = bank_word(bank, w);
+                        BSG_MANYCORE_CALL(mc, hb_mc_manycore_write32(mc, &npa, expected(&npa)));
+                }
+        }
+
+        if (banks.size() * BANK_WORDS <= hb_mc_config_get_io_remote_load_cap(cfg)) {
+                test_pr_err("%zu words do not fill the load window more than once\n",
+                            banks.size() * BANK_WORDS);
+                return HB_MC_FAIL;
+        }
+
+        /* one reader: every response is its own, in any order */
+        for (hb_mc_manycore_bulk_order_t order : {HB_MC_MANYCORE_BULK_ORDER_LINEAR,
+                                                  HB_MC_MANYCORE_BULK_ORDER_INTERLEAVED}) {
+                hb_mc_manycore_set_bulk_order(mc, order);
+                BSG_MANYCORE_CALL(mc, read_banks(mc, banks, 0));
+        }
+
+        /* several readers: responses to one reader's loads may be received by another */
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_enable_threads(mc));
+
+        std::atomic<int> failed(HB_MC_SUCCESS);
+        std::vector<std::thread> readers;
+        for (size_t t = 0; t < THREADS; t++) {
+                readers.emplace_back([&, t] {
+                        for (size_t r = 0; r < REPS && failed == HB_MC_SUCCESS; r++) {
+                                int err = read_banks(mc, banks, t * banks.size() / THREADS + r);
+                                if (err != HB_MC_SUCCESS)
+                                        failed = err;
+                        }
+                });
+        }
+        for (std::thread &reader : readers)
+                reader.join();
+
+        BSG_MANYCORE_CALL(mc, failed.load());
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(TEST_NAME, test_read_mem_out_of_order);
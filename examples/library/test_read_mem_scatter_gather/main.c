@@ -30,9 +30,11 @@
 #include <bsg_manycore.h>
 #include <bsg_manycore_npa.h>
 #include <bsg_manycore_printing.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #define TEST_NAME "test_read_mem_scatter_gather"
 
@@ -126,6 +128,167 @@ static int compare(void)
         }
 }
 
+/*
+ * Vectored transfers: segments of different lengths spread over the
+ * DRAM banks of one row, moved either with a call per segment or with
+ * one hb_mc_manycore_writev()/hb_mc_manycore_readv() call.
+ */
+#define SEGMENTS      64
+#define SEGMENT_WORDS 16
+#define SEGMENT_EPA   0x1000
+#define REPS          4
+
+hb_mc_manycore_iovec_t segments [SEGMENTS];
+uint32_t seg_out [SEGMENTS][SEGMENT_WORDS];
+uint32_t seg_in  [SEGMENTS][SEGMENT_WORDS];
+
+typedef struct {
+        double   ns;
+        uint64_t packets;
+        uint64_t fences;
+} xfer_stats_t;
+
+static double now_ns(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void stats_begin(xfer_stats_t *stats)
+{
+        stats->packets = mc->request_packets_tx;
+        stats->fences = mc->host_request_fences;
+        stats->ns = now_ns();
+}
+
+static void stats_end(xfer_stats_t *stats, const char *label)
+{
+        stats->ns = (now_ns() - stats->ns) / REPS;
+        stats->packets = (mc->request_packets_tx - stats->packets) / REPS;
+        stats->fences = (mc->host_request_fences - stats->fences) / REPS;
+        bsg_pr_test_info("%-12s: %10.0f ns, %6" PRIu64 " packets, %4" PRIu64 " fences per round\n",
+                         label, stats->ns, stats->packets, stats->fences);
+}
+
+static void initialize_segments(void)
+{
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pod = {.x=0, .y=0};
+        hb_mc_idx_t y = hb_mc_config_pod_dram_y(cfg, pod, 0);
+        hb_mc_idx_t columns = hb_mc_dimension_get_x(hb_mc_config_get_dimension_vcore(cfg));
+        hb_mc_idx_t base_x = hb_mc_config_get_vcore_base_x(cfg);
+        int i;
+
+        for (i = 0; i < SEGMENTS; i++) {
+                hb_mc_epa_t epa = SEGMENT_EPA + (i / columns) * sizeof(seg_out[i]);
+                segments[i].npa = hb_mc_npa_from_x_y(base_x + i % columns, y, epa);
+                segments[i].len = sizeof(uint32_t) * (1 + i % SEGMENT_WORDS);
+        }
+}
+
+static void refresh_segment_data(void)
+{
+        int i, j;
+        for (i = 0; i < SEGMENTS; i++)
+                for (j = 0; j < SEGMENT_WORDS; j++)
+                        seg_out[i][j] = (uint32_t)rand();
+        memset(seg_in, 0, sizeof(seg_in));
+}
+
+static int compare_segments(const char *label)
+{
+        int i;
+        for (i = 0; i < SEGMENTS; i++) {
+                if (memcmp(seg_out[i], seg_in[i], segments[i].len) != 0) {
+                        test_pr_err("%s: segment %d read back does not match\n", label, i);
+                        return HB_MC_FAIL;
+                }
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int transfer_per_segment(void)
+{
+        int i, err;
+        for (i = 0; i < SEGMENTS; i++) {
+                err = hb_mc_manycore_write_mem(mc, &segments[i].npa, seg_out[i], segments[i].len);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        for (i = 0; i < SEGMENTS; i++) {
+                err = hb_mc_manycore_read_mem(mc, &segments[i].npa, seg_in[i], segments[i].len);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        return HB_MC_SUCCESS;
+}
+
+static int transfer_vectored(void)
+{
+        int i, err;
+        for (i = 0; i < SEGMENTS; i++)
+                segments[i].base = seg_out[i];
+        err = hb_mc_manycore_writev(mc, segments, SEGMENTS);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        for (i = 0; i < SEGMENTS; i++)
+                segments[i].base = seg_in[i];
+        return hb_mc_manycore_readv(mc, segments, SEGMENTS);
+}
+
+/*
+ * Move the segments both ways, check them, and compare the cost.
+ */
+static int test_vectored(void)
+{
+        xfer_stats_t per_segment, vectored;
+        int r, err;
+
+        initialize_segments();
+
+        stats_begin(&per_segment);
+        for (r = 0; r < REPS; r++) {
+                refresh_segment_data();
+                err = transfer_per_segment();
+                if (err != HB_MC_SUCCESS) {
+                        test_pr_err("failed per-segment transfer: %s\n", hb_mc_strerror(err));
+                        return err;
+                }
+                err = compare_segments("per segment");
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        stats_end(&per_segment, "per segment");
+
+        stats_begin(&vectored);
+        for (r = 0; r < REPS; r++) {
+                refresh_segment_data();
+                err = transfer_vectored();
+                if (err != HB_MC_SUCCESS) {
+                        test_pr_err("failed vectored transfer: %s\n", hb_mc_strerror(err));
+                        return err;
+                }
+                err = compare_segments("vectored");
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        stats_end(&vectored, "vectored");
+
+        bsg_pr_test_info("vectored transfers are %.2fx as fast\n", per_segment.ns / vectored.ns);
+
+        // the write goes out in one stream behind a single fence
+        if (vectored.fences != 1 || vectored.packets != per_segment.packets) {
+                test_pr_err("vectored write sent %" PRIu64 " packets with %" PRIu64 " fences, "
+                            "expected %" PRIu64 " with 1\n",
+                            vectored.packets, vectored.fences, per_segment.packets);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
 static int run_tests(int argc, char *argv[])
 {
         int err, rc = HB_MC_FAIL;
@@ -149,6 +312,10 @@ static int run_tests(int argc, char *argv[])
                 goto cleanup;
 
         rc = compare();
+        if (rc != HB_MC_SUCCESS)
+                goto cleanup;
+
+        rc = test_vectored();
 
 cleanup:
         hb_mc_manycore_exit(mc);
@@ -0,0 +1,210 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_responder.h>
+#include <bsg_manycore_request_packet_id.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#define TEST_NAME "test_responder_dispatch"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+#define CHECK_PACKETS (1 << 16)
+#define BENCH_PACKETS (1 << 22)
+
+/*
+ * Two counting responders. Their ids overlap with each other and with
+ * themselves, and mix exact addresses, masked addresses, and source
+ * coordinate ranges - none of them overlap the built-in responders.
+ */
+static hb_mc_request_packet_id_t ids_a [] = {
+        RQST_ID( RQST_ID_ANY_X, RQST_ID_ANY_Y, RQST_ID_ADDR(0x1F100) ),
+        RQST_ID( RQST_ID_RANGE_X(1, 3), RQST_ID_ANY_Y, RQST_ID_ADDR_UNDER_MASK(0x20000, 0xFFFF0000) ),
+        RQST_ID( RQST_ID_ANY_X, RQST_ID_Y(2), RQST_ID_ADDR(0x20040) ),
+        { /* sentinel */ },
+};
+
+static hb_mc_request_packet_id_t ids_b [] = {
+        RQST_ID( RQST_ID_X(2), RQST_ID_ANY_Y, RQST_ID_ADDR(0x1F100) ),
+        RQST_ID( RQST_ID_ANY_X, RQST_ID_RANGE_Y(0, 1), RQST_ID_ADDR_UNDER_MASK(0x20040, 0xFFFFFFC0) ),
+        { /* sentinel */ },
+};
+
+static uint64_t count_a = 0, count_b = 0;
+
+static int init(hb_mc_responder_t *responder, hb_mc_manycore_t *mc)
+{
+        return HB_MC_SUCCESS;
+}
+
+static int quit(hb_mc_responder_t *responder, hb_mc_manycore_t *mc)
+{
+        return HB_MC_SUCCESS;
+}
+
+static int respond(hb_mc_responder_t *responder, hb_mc_manycore_t *mc,
+                   const hb_mc_request_packet_t *rqst)
+{
+        (*static_cast<uint64_t*>(responder->responder_data))++;
+        return HB_MC_SUCCESS;
+}
+
+static hb_mc_responder_t responder_a("Count A", ids_a, init, quit, respond);
+static hb_mc_responder_t responder_b("Count B", ids_b, init, quit, respond);
+
+/* the addresses of interest, plus ones no responder wants */
+static const hb_mc_epa_t epas [] = {
+        0x1F100, 0x20000, 0x20040, 0x20044, 0x2007C, 0x20080, 0x2FFFC, 0x30000,
+        0xF000, 0xF004, 0x100, 0x1000, 0x80000000,
+};
+
+static void format(hb_mc_request_packet_t *rqst, hb_mc_epa_t epa, uint8_t x, uint8_t y)
+{
+        hb_mc_request_packet_set_x_src(rqst, x);
+        hb_mc_request_packet_set_y_src(rqst, y);
+        hb_mc_request_packet_set_op(rqst, HB_MC_PACKET_OP_REMOTE_SW);
+        hb_mc_request_packet_set_epa(rqst, epa);
+        hb_mc_request_packet_set_data(rqst, 0);
+}
+
+static int matches(const hb_mc_request_packet_t *rqst, const hb_mc_request_packet_id_t *ids)
+{
+        for (const hb_mc_request_packet_id_t *id = ids; id->init != 0; id++)
+                if (hb_mc_request_packet_is_match(rqst, id))
+                        return 1;
+        return 0;
+}
+
+/*
+ * Each responder must be called exactly once for a packet that matches
+ * any of its ids, and never otherwise.
+ */
+static int check_dispatch(hb_mc_manycore_t *mc)
+{
+        uint64_t expect_a = 0, expect_b = 0;
+        count_a = count_b = 0;
+
+        for (int i = 0; i < CHECK_PACKETS; i++) {
+                hb_mc_request_packet_t rqst = {};
+                hb_mc_epa_t epa = epas[rand() % (sizeof(epas)/sizeof(epas[0]))];
+                if (rand() % 2)
+                        epa += (rand() % 16) * sizeof(uint32_t);
+                format(&rqst, epa, rand() % 5, rand() % 5);
+
+                expect_a += matches(&rqst, ids_a);
+                expect_b += matches(&rqst, ids_b);
+
+                BSG_MANYCORE_CALL(mc, hb_mc_responders_respond(mc, &rqst));
+                if (count_a != expect_a || count_b != expect_b) {
+                        test_pr_err("packet to 0x%08" PRIx32 " from (%d,%d): "
+                                    "responded %" PRIu64 "/%" PRIu64 " times, expected %" PRIu64 "/%" PRIu64 "\n",
+                                    epa,
+                                    hb_mc_request_packet_get_x_src(&rqst),
+                                    hb_mc_request_packet_get_y_src(&rqst),
+                                    count_a, count_b, expect_a, expect_b);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        bsg_pr_test_info("Dispatched %d packets: %" PRIu64 " and %" PRIu64 " responses\n",
+                         CHECK_PACKETS, count_a, count_b);
+        return HB_MC_SUCCESS;
+}
+
+/*
+ * Time the common case: finish packets and DRAM addresses that only
+ * the built-in responders are registered for, and none of them want.
+ */
+static int bench_dispatch(hb_mc_manycore_t *mc)
+{
+        std::vector<hb_mc_request_packet_t> rqsts(256);
+        for (size_t i = 0; i < rqsts.size(); i++) {
+                hb_mc_epa_t epa = (i % 2) ? 0xF000 + (i << 2) : 0x80000000 + (i << 6);
+                format(&rqsts[i], epa, i % 16, 1 + i % 8);
+        }
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < BENCH_PACKETS; i++)
+                BSG_MANYCORE_CALL(mc, hb_mc_responders_respond(mc, &rqsts[i % rqsts.size()]));
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+        bsg_pr_test_info("Handled %d request packets in %.3f ms (%.2f ns/packet, %.2f Mpackets/s)\n",
+                         BENCH_PACKETS, ns / 1e6, ns / BENCH_PACKETS, 1e3 * BENCH_PACKETS / ns);
+        return HB_MC_SUCCESS;
+}
+
+int test_responder_dispatch(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        BSG_MANYCORE_CALL(mc, bench_dispatch(mc));
+
+        responder_a.responder_data = &count_a;
+        responder_b.responder_data = &count_b;
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_add(&responder_a));
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_init(&responder_a, mc));
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_add(&responder_b));
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_init(&responder_b, mc));
+
+        srand(42);
+        BSG_MANYCORE_CALL(mc, check_dispatch(mc));
+
+        /* removed responders are never called again */
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_quit(&responder_b, mc));
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_del(&responder_b));
+        hb_mc_request_packet_t rqst = {};
+        format(&rqst, 0x1F100, 2, 0);
+        count_a = count_b = 0;
+        BSG_MANYCORE_CALL(mc, hb_mc_responders_respond(mc, &rqst));
+        if (count_a != 1 || count_b != 0) {
+                test_pr_err("after removing a responder: responded %" PRIu64 "/%" PRIu64 " times\n",
+                            count_a, count_b);
+                return HB_MC_FAIL;
+        }
+
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_quit(&responder_a, mc));
+        BSG_MANYCORE_CALL(mc, hb_mc_responder_del(&responder_a));
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(TEST_NAME, test_responder_dispatch);
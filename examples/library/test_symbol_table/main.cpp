@@ -0,0 +1,256 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_elf.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <elf.h>
+#include <inttypes.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define TEST_NAME "test_symbol_table"
+#define OBJECT_FILE TEST_NAME ".riscv"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+typedef struct {
+        const char *name;
+        hb_mc_eva_t value;
+} test_symbol_t;
+
+/* the first symbol table defines 'shared' twice, the second once more */
+static const test_symbol_t first_symtab[] = {
+        { "alpha",  0x00001000 },
+        { "shared", 0x00002000 },
+        { "shared", 0x00002004 },
+        { "",       0x00002008 },
+};
+
+static const test_symbol_t second_symtab[] = {
+        { "shared", 0x80003000 },
+        { "beta",   0x80004000 },
+};
+
+/* names to look up: defined once, defined three times, and never defined */
+static const char *lookups[] = { "alpha", "beta", "shared", "missing", "" };
+
+template <typename T>
+static size_t append(std::vector<unsigned char> &obj, const T &v)
+{
+        size_t off = obj.size();
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(&v);
+        obj.insert(obj.end(), p, p + sizeof(v));
+        return off;
+}
+
+/* append a symbol table section's entries and return its offset */
+static size_t append_symtab(std::vector<unsigned char> &obj, std::string &strtab,
+                            const test_symbol_t *syms, size_t n)
+{
+        size_t off = append(obj, Elf32_Sym());
+        for (size_t i = 0; i < n; i++) {
+                Elf32_Sym sym = {};
+                if (syms[i].name[0] != '\0') {
+                        sym.st_name = strtab.size();
+                        strtab += syms[i].name;
+                        strtab += '\0';
+                }
+                sym.st_value = syms[i].value;
+                sym.st_info = ELF32_ST_INFO(STB_GLOBAL, STT_OBJECT);
+                sym.st_shndx = SHN_ABS;
+                append(obj, sym);
+        }
+        return off;
+}
+
+/*
+ * Build an RV32 executable with no program, two symbol tables sharing a
+ * string table, and #extra appended to the name of 'alpha' so that the
+ * object changes size.
+ */
+static std::vector<unsigned char> build_object(hb_mc_eva_t alpha, const char *extra)
+{
+        std::vector<unsigned char> obj;
+        std::string strtab(1, '\0');
+
+        test_symbol_t first[sizeof(first_symtab) / sizeof(first_symtab[0])];
+        memcpy(first, first_symtab, sizeof(first));
+        first[0].value = alpha;
+
+        Elf32_Ehdr ehdr = {};
+        memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+        ehdr.e_ident[EI_CLASS] = ELFCLASS32;
+        ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+        ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+        ehdr.e_type = ET_EXEC;
+        ehdr.e_machine = EM_RISCV;
+        ehdr.e_version = EV_CURRENT;
+        ehdr.e_ehsize = sizeof(Elf32_Ehdr);
+        ehdr.e_shentsize = sizeof(Elf32_Shdr);
+        append(obj, ehdr);
+
+        size_t first_off = append_symtab(obj, strtab, first, sizeof(first) / sizeof(first[0]));
+        size_t second_off = append_symtab(obj, strtab, second_symtab,
+                                          sizeof(second_symtab) / sizeof(second_symtab[0]));
+        size_t strtab_off = obj.size();
+        strtab += extra;
+        strtab += '\0';
+        obj.insert(obj.end(), strtab.begin(), strtab.end());
+
+        /* sections: null, first symtab, string table, second symtab */
+        Elf32_Shdr shdr[4] = {};
+        shdr[1].sh_type = SHT_SYMTAB;
+        shdr[1].sh_offset = first_off;
+        shdr[1].sh_size = second_off - first_off;
+        shdr[1].sh_link = 2;
+        shdr[1].sh_entsize = sizeof(Elf32_Sym);
+        shdr[2].sh_type = SHT_STRTAB;
+        shdr[2].sh_offset = strtab_off;
+        shdr[2].sh_size = strtab.size();
+        shdr[3] = shdr[1];
+        shdr[3].sh_offset = second_off;
+        shdr[3].sh_size = strtab_off - second_off;
+
+        while (obj.size() % 4)
+                obj.push_back(0);
+        size_t shoff = obj.size();
+        for (const Elf32_Shdr &s : shdr)
+                append(obj, s);
+
+        Elf32_Ehdr *hdr = reinterpret_cast<Elf32_Ehdr *>(obj.data());
+        hdr->e_shoff = shoff;
+        hdr->e_shnum = 4;
+        return obj;
+}
+
+/* the hashed table must agree with a scan of the binary, found or not */
+static int check_lookups(const std::vector<unsigned char> &obj)
+{
+        hb_mc_loader_symbol_table_t *symbols;
+        int err = hb_mc_loader_symbol_table_init(obj.data(), obj.size(), &symbols);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to build symbol table: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        err = HB_MC_SUCCESS;
+        for (const char *name : lookups) {
+                hb_mc_eva_t table_eva = 0, scan_eva = 0;
+                int table_rc = hb_mc_loader_symbol_table_lookup(symbols, name, &table_eva);
+                int scan_rc = hb_mc_loader_symbol_to_eva(obj.data(), obj.size(), name, &scan_eva);
+                if (table_rc != scan_rc || (scan_rc == HB_MC_SUCCESS && table_eva != scan_eva)) {
+                        test_pr_err("'%s': table gives %s 0x%08" PRIx32 ", scan gives %s 0x%08" PRIx32 "\n",
+                                    name, hb_mc_strerror(table_rc), table_eva,
+                                    hb_mc_strerror(scan_rc), scan_eva);
+                        err = HB_MC_FAIL;
+                }
+        }
+
+        /* spot-check the rules both follow */
+        hb_mc_eva_t eva;
+        if (hb_mc_loader_symbol_table_lookup(symbols, "shared", &eva) != HB_MC_SUCCESS
+            || eva != first_symtab[1].value) {
+                test_pr_err("'shared' does not resolve to its first definition\n");
+                err = HB_MC_FAIL;
+        }
+
+        if (hb_mc_loader_symbol_table_lookup(symbols, "missing", &eva) != HB_MC_NOTFOUND) {
+                test_pr_err("'missing' was found\n");
+                err = HB_MC_FAIL;
+        }
+
+        hb_mc_loader_symbol_table_cleanup(symbols);
+        return err;
+}
+
+static int write_object(const std::vector<unsigned char> &obj)
+{
+        FILE *f = fopen(OBJECT_FILE, "wb");
+        if (f == NULL) {
+                test_pr_err("could not create %s\n", OBJECT_FILE);
+                return HB_MC_FAIL;
+        }
+
+        size_t n = fwrite(obj.data(), 1, obj.size(), f);
+        if (fclose(f) != 0 || n != obj.size()) {
+                test_pr_err("could not write %s\n", OBJECT_FILE);
+                return HB_MC_FAIL;
+        }
+        return HB_MC_SUCCESS;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+/* symbol_to_eva() must see a file that was rebuilt since it was last read */
+static int check_file_cache()
+{
+        eva_t eva;
+        int err;
+
+        err = write_object(build_object(0x1000, ""));
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        if (symbol_to_eva(OBJECT_FILE, "alpha", &eva) != HB_MC_SUCCESS || eva != 0x1000) {
+                test_pr_err("'alpha' in %s is not 0x1000\n", OBJECT_FILE);
+                return HB_MC_FAIL;
+        }
+
+        err = write_object(build_object(0x1100, "rebuilt"));
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        if (symbol_to_eva(OBJECT_FILE, "alpha", &eva) != HB_MC_SUCCESS || eva != 0x1100) {
+                test_pr_err("'alpha' in rebuilt %s is not 0x1100\n", OBJECT_FILE);
+                return HB_MC_FAIL;
+        }
+
+        if (symbol_to_eva(OBJECT_FILE, "missing", &eva) != HB_MC_FAIL) {
+                test_pr_err("'missing' was found in %s\n", OBJECT_FILE);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+#pragma GCC diagnostic pop
+
+int test_symbol_table(int argc, char **argv)
+{
+        int err = check_lookups(build_object(first_symtab[0].value, ""));
+        if (err == HB_MC_SUCCESS)
+                err = check_file_cache();
+
+        remove(OBJECT_FILE);
+        return err;
+}
+
+declare_program_main(TEST_NAME, test_symbol_table);
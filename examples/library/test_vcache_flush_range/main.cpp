@@ -0,0 +1,201 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+//
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_npa.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_regression.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <vector>
+
+#define TEST_NAME "test_vcache_flush_range"
+
+#define test_pr_err(msg, ...)                           \
+        bsg_pr_err(TEST_NAME ": " msg , ##__VA_ARGS__)
+
+/* DRAM EVA under test - clear of address zero */
+#define DRAM_EVA_BASE 0x80010000
+
+typedef int (*eva_range_function_t)(hb_mc_manycore_t *mc,
+                                    const hb_mc_eva_map_t *map,
+                                    const hb_mc_coordinate_t *tgt,
+                                    const hb_mc_eva_t *eva,
+                                    size_t sz);
+
+/* number of cache lines overlapping [eva, eva + sz) */
+static uint64_t lines_in_range(uint64_t eva, uint64_t sz, uint64_t bsize)
+{
+        if (sz == 0)
+                return 0;
+        return (eva + sz - 1) / bsize - eva / bsize + 1;
+}
+
+/*
+ * Apply a range operation and check that it sent one packet per line
+ * in the range and fenced exactly once.
+ */
+static int check_eva_range_cost(hb_mc_manycore_t *mc,
+                                const hb_mc_coordinate_t *tgt,
+                                const char *name,
+                                eva_range_function_t fn,
+                                hb_mc_eva_t eva, size_t sz)
+{
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        uint64_t bsize = hb_mc_config_get_vcache_block_size(cfg);
+        uint64_t pkts = mc->request_packets_tx;
+        uint64_t fences = mc->host_request_fences;
+
+        int err = fn(mc, &default_map, tgt, &eva, sz);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("%s(0x%08" PRIx32 ", %zu) failed: %s\n",
+                            name, eva, sz, hb_mc_strerror(err));
+                return err;
+        }
+
+        uint64_t expect_pkts = hb_mc_manycore_has_cache(mc) ? lines_in_range(eva, sz, bsize) : 0;
+        uint64_t expect_fences = hb_mc_manycore_has_cache(mc) ? 1 : 0;
+        pkts = mc->request_packets_tx - pkts;
+        fences = mc->host_request_fences - fences;
+        if (pkts != expect_pkts || fences != expect_fences) {
+                test_pr_err("%s(0x%08" PRIx32 ", %zu): sent %" PRIu64 " packets and %" PRIu64
+                            " fences, expected %" PRIu64 " and %" PRIu64 "\n",
+                            name, eva, sz, pkts, fences, expect_pkts, expect_fences);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/*
+ * Data written through the cache must be visible to a DMA read after
+ * a range flush, and data written by DMA must be visible through the
+ * cache after a range invalidate.
+ */
+static int check_eva_range_coherence(hb_mc_manycore_t *mc,
+                                     const hb_mc_coordinate_t *tgt,
+                                     hb_mc_eva_t eva, size_t sz,
+                                     uint32_t seed)
+{
+        std::vector<uint8_t> wr(sz), rd(sz);
+
+        for (size_t i = 0; i < sz; i++)
+                wr[i] = static_cast<uint8_t>(seed + i * 7);
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_eva_write(mc, &default_map, tgt, &eva, wr.data(), sz));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_vcache_flush_eva_range(mc, &default_map, tgt, &eva, sz));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_eva_read_dma(mc, &default_map, tgt, &eva, rd.data(), sz));
+        if (rd != wr) {
+                test_pr_err("DMA read of 0x%08" PRIx32 " (%zu bytes) after a range flush "
+                            "does not match the cached write\n", eva, sz);
+                return HB_MC_FAIL;
+        }
+
+        for (size_t i = 0; i < sz; i++)
+                wr[i] = static_cast<uint8_t>(~(seed + i * 13));
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_eva_write_dma(mc, &default_map, tgt, &eva, wr.data(), sz));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_vcache_invalidate_eva_range(mc, &default_map, tgt, &eva, sz));
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_eva_read(mc, &default_map, tgt, &eva, rd.data(), sz));
+        if (rd != wr) {
+                test_pr_err("Cached read of 0x%08" PRIx32 " (%zu bytes) after a range invalidate "
+                            "does not match the DMA write\n", eva, sz);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+int test_vcache_flush_range(int argc, char **argv)
+{
+        hb_mc_manycore_t manycore = {0}, *mc = &manycore;
+        int err = hb_mc_manycore_init(mc, TEST_NAME, 0);
+        if (err != HB_MC_SUCCESS) {
+                test_pr_err("failed to initialize manycore: %s\n", hb_mc_strerror(err));
+                return err;
+        }
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t tgt = hb_mc_config_get_origin_vcore(cfg);
+        size_t bsize = hb_mc_config_get_vcache_block_size(cfg);
+        size_t stripe = hb_mc_config_get_vcache_stripe_words(cfg) * sizeof(uint32_t);
+
+        /* (offset, size) pairs: single words, line crossings, and stripe crossings */
+        std::vector<std::pair<size_t, size_t>> ranges = {
+                {0, 4},
+                {4, bsize - 8},
+                {bsize - 4, 8},
+                {3, 10 * bsize + 5},
+                {stripe - 4, 8},
+                {stripe / 2, 4 * stripe + 12},
+        };
+
+        for (auto &r : ranges) {
+                hb_mc_eva_t eva = DRAM_EVA_BASE + r.first;
+                BSG_MANYCORE_CALL(mc, check_eva_range_cost(mc, &tgt, "flush",
+                                                   hb_mc_manycore_vcache_flush_eva_range,
+                                                   eva, r.second));
+                BSG_MANYCORE_CALL(mc, check_eva_range_cost(mc, &tgt, "invalidate",
+                                                   hb_mc_manycore_vcache_invalidate_eva_range,
+                                                   eva, r.second));
+        }
+
+        /* a multi-line NPA range sends one packet per line */
+        hb_mc_npa_t npa;
+        size_t npa_sz;
+        hb_mc_eva_t eva = DRAM_EVA_BASE;
+        BSG_MANYCORE_CALL(mc, hb_mc_eva_to_npa(mc, &default_map, &tgt, &eva, &npa, &npa_sz));
+        npa_sz = std::min(npa_sz, 3 * bsize + 4);
+        uint64_t pkts = mc->request_packets_tx;
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_vcache_invalidate_npa_range(mc, &npa, npa_sz));
+        pkts = mc->request_packets_tx - pkts;
+        if (hb_mc_manycore_has_cache(mc) && pkts != lines_in_range(0, npa_sz, bsize)) {
+                test_pr_err("NPA range invalidate of %zu bytes sent %" PRIu64 " packets\n",
+                            npa_sz, pkts);
+                return HB_MC_FAIL;
+        }
+
+        if (hb_mc_manycore_supports_dma_read(mc) && hb_mc_manycore_supports_dma_write(mc)) {
+                /* network writes and reads are whole words */
+                uint32_t seed = 0;
+                for (auto &r : ranges) {
+                        size_t off = r.first & ~static_cast<size_t>(3);
+                        size_t sz = (r.second + 3) & ~static_cast<size_t>(3);
+                        BSG_MANYCORE_CALL(mc, check_eva_range_coherence(mc, &tgt, DRAM_EVA_BASE + off,
+                                                                        sz, seed++));
+                }
+        } else {
+                bsg_pr_test_info("DMA is not supported: skipping coherence checks\n");
+        }
+
+        BSG_MANYCORE_CALL(mc, hb_mc_manycore_exit(mc));
+        return HB_MC_SUCCESS;
+}
+
+declare_program_main(TEST_NAME, test_vcache_flush_range);
@@ -26,6 +26,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <bsg_manycore.h>
+#include <bsg_manycore_api_trace.h>
 #include <bsg_manycore_platform.h>
 #include <bsg_manycore_dma.h>
 #include <bsg_manycore_fifo.h>
@@ -34,6 +35,7 @@
 #include <bsg_manycore_responder.h>
 #include <bsg_manycore_epa.h>
 #include <bsg_manycore_vcache.h>
+#include <bsg_manycore_eva.h>
 
 #include <cinttypes>
 #include <cstdint>
@@ -45,10 +47,14 @@
 #include <cassert>
 
 #include <type_traits>
-#include <stack>
 #include <map>
 #include <queue>
+#include <deque>
 #include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
 
 #define array_size(x)                           \
         (sizeof(x)/sizeof(x[0]))
@@ -69,6 +75,377 @@
 #define manycore_pr_info(mc, fmt, ...)                  \
         bsg_pr_info("%s: " fmt, mc->name, ##__VA_ARGS__)
 
+/* number of write requests formatted before handing them to the platform */
+#define HB_MC_MANYCORE_TX_BATCH_PACKETS 64
+
+/////////////////////////
+/* Host Threads Helpers */
+/////////////////////////
+
+/**
+ * Packet I/O state shared by the host threads driving a manycore.
+ *
+ * The platform is not thread-safe, so every call into it holds #lock.
+ * Response packets carry no source, only the load id of the request
+ * they answer, so readers take load ids from a shared pool and a
+ * response is parked in its id's slot until the reader owning that id
+ * collects it. Request packets are parked in a queue per source pod
+ * until the thread bound to that pod receives them; the last queue
+ * holds requests from pods with no thread bound.
+ *
+ * Threads waiting for packets poll the platform without blocking and
+ * release #lock between polls, so that other pods' threads can send and
+ * receive meanwhile. A thread that parks a packet for another wakes it
+ * through #parked.
+ */
+typedef struct hb_mc_manycore_io {
+        std::mutex lock;
+        std::condition_variable ids_freed;
+        std::condition_variable parked;  //!< signalled when a packet is parked for another thread
+        bool rsp_pollable;     //!< the platform can poll for responses without blocking
+        uint32_t free_ids;     //!< load ids not held by a reader
+        unsigned id_waiters;   //!< readers waiting for a free load id
+        uint32_t received;     //!< load ids whose response is parked
+        std::vector<hb_mc_response_packet_t> responses;            //!< parked responses, by load id
+        std::vector<std::deque<hb_mc_request_packet_t>> requests;  //!< parked requests, by pod
+        std::vector<bool> bound;                                    //!< pods with a thread bound
+        unsigned bulk_transfers; //!< bulk transfers in progress
+} hb_mc_manycore_io_t;
+
+static hb_mc_manycore_io_t *manycore_io(hb_mc_manycore_t *mc)
+{
+        return reinterpret_cast<hb_mc_manycore_io_t*>(mc->io);
+}
+
+/* how long a thread waiting for packets sleeps between polls of the platform */
+#define HB_MC_MANYCORE_IO_POLL_US 20
+
+/* the most requests a thread drains from the platform at once */
+#define HB_MC_MANYCORE_IO_RX_BATCH 16
+
+/* index of the pod this thread is bound to, or -1 */
+static thread_local int hb_mc_manycore_thread_pod = -1;
+
+/**
+ * Holds the I/O lock of a manycore for its lifetime, if threads are enabled.
+ */
+class hb_mc_manycore_io_guard {
+public:
+        explicit hb_mc_manycore_io_guard(hb_mc_manycore_t *mc) {
+                if (mc->io)
+                        lock = std::unique_lock<std::mutex>(manycore_io(mc)->lock);
+        }
+private:
+        std::unique_lock<std::mutex> lock;
+};
+
+/**
+ * Brackets a sequence of bulk transfers, finishing it on every return path
+ * so that an error does not leave the platform in bulk mode.
+ */
+class hb_mc_manycore_bulk_transfer {
+public:
+        explicit hb_mc_manycore_bulk_transfer(hb_mc_manycore_t *mc) : mc(mc) {
+                hb_mc_manycore_start_bulk_transfer(mc);
+        }
+        ~hb_mc_manycore_bulk_transfer() {
+                hb_mc_manycore_finish_bulk_transfer(mc);
+        }
+private:
+        hb_mc_manycore_t *mc;
+};
+
+/**
+ * Load ids held by one reader. They are taken from the shared pool if
+ * threads are enabled, and are returned to it on destruction.
+ */
+class hb_mc_manycore_io_load_ids {
+public:
+        explicit hb_mc_manycore_io_load_ids(hb_mc_manycore_t *mc) : mc(mc), ids(0) {}
+        ~hb_mc_manycore_io_load_ids() { release(); }
+
+        /* wait for at least one free load id, then take up to n; returns the ids taken */
+        uint32_t acquire(unsigned n) {
+                hb_mc_manycore_io_t *io = manycore_io(mc);
+                std::unique_lock<std::mutex> lock(io->lock);
+                io->id_waiters++;
+                io->ids_freed.wait(lock, [io] { return io->free_ids != 0; });
+                io->id_waiters--;
+                return take(io, n);
+        }
+
+        /* take up to n free load ids without waiting; returns the ids taken */
+        uint32_t try_acquire(unsigned n) {
+                hb_mc_manycore_io_t *io = manycore_io(mc);
+                std::lock_guard<std::mutex> lock(io->lock);
+                return take(io, n);
+        }
+
+        /* give one held load id back to the pool */
+        void release(uint32_t id) {
+                hb_mc_manycore_io_t *io = manycore_io(mc);
+                {
+                        std::lock_guard<std::mutex> lock(io->lock);
+                        io->free_ids |= id;
+                }
+                io->ids_freed.notify_all();
+                ids &= ~id;
+        }
+
+        /* give one held load id back to the pool if another reader is waiting for one */
+        bool hand_over(uint32_t id) {
+                hb_mc_manycore_io_t *io = manycore_io(mc);
+                {
+                        std::lock_guard<std::mutex> lock(io->lock);
+                        if (io->id_waiters == 0)
+                                return false;
+                        io->free_ids |= id;
+                }
+                io->ids_freed.notify_all();
+                ids &= ~id;
+                return true;
+        }
+
+        void release() {
+                if (ids == 0)
+                        return;
+                release(ids);
+        }
+
+private:
+        uint32_t take(hb_mc_manycore_io_t *io, unsigned n) {
+                uint32_t taken = 0;
+                for (unsigned i = 0; i < n && io->free_ids != 0; i++) {
+                        uint32_t id = io->free_ids & (~io->free_ids + 1);
+                        io->free_ids &= ~id;
+                        taken |= id;
+                }
+                ids |= taken;
+                return taken;
+        }
+
+        hb_mc_manycore_t *mc;
+        uint32_t ids;
+};
+
+/**
+ * Receive the responses to loads issued with a set of held load ids.
+ * Responses to other readers' loads are parked for them.
+ * @param[in]  mc     A manycore instance with threads enabled
+ * @param[in]  ids    The load ids held by the caller
+ * @param[out] pkts   Responses, in the order they were collected
+ * @param[in]  n      The number of responses to receive
+ * @param[out] got    If not null, return once at least one response is received and
+ *                    no more are ready, and set to the number received
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_io_receive_responses(hb_mc_manycore_t *mc, uint32_t ids,
+                                               hb_mc_packet_t *pkts, size_t n,
+                                               size_t *got = nullptr)
+{
+        hb_mc_manycore_io_t *io = manycore_io(mc);
+        std::unique_lock<std::mutex> lock(io->lock);
+        size_t enough = got != nullptr ? 1 : n;
+        size_t n_got = 0;
+        hb_mc_packet_t batch[HB_MC_REMOTE_LOAD_MAX];
+
+        while (true) {
+                for (uint32_t ready = io->received & ids; ready != 0 && n_got < n; ready &= ready - 1) {
+                        unsigned id = __builtin_ctz(ready);
+                        pkts[n_got++].response = io->responses[id];
+                        io->received &= ~(1u << id);
+                }
+
+                if (n_got == n || (n_got >= enough && !io->rsp_pollable))
+                        break;
+
+                // poll, so that the lock is not held while the loads are in flight;
+                // platforms that cannot poll responses are waited on instead
+                size_t n_batch = 0;
+                int err = HB_MC_NOIMPL;
+                if (io->rsp_pollable) {
+                        err = hb_mc_platform_receive_batch(mc, batch, io->responses.size(), &n_batch,
+                                                           HB_MC_FIFO_RX_RSP, 0);
+                        if (err == HB_MC_NOIMPL)
+                                io->rsp_pollable = false;
+                }
+                if (err == HB_MC_NOIMPL) {
+                        if (n_got >= enough)
+                                break;
+                        err = hb_mc_platform_receive_batch(mc, batch, io->responses.size(), &n_batch,
+                                                           HB_MC_FIFO_RX_RSP, -1);
+                }
+
+                if (err == HB_MC_BUSY) {
+                        if (n_got >= enough)
+                                break;
+                        // sleep until another thread parks one of ours, or it is time to poll again
+                        io->parked.wait_for(lock, std::chrono::microseconds(HB_MC_MANYCORE_IO_POLL_US));
+                        continue;
+                }
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                bool parked = false;
+                for (size_t i = 0; i < n_batch; i++) {
+                        uint32_t id = hb_mc_response_packet_get_load_id(&batch[i].response);
+                        if (id >= io->responses.size() ||
+                            (io->free_ids & (1u << id)) ||
+                            (io->received & (1u << id))) {
+                                manycore_pr_err(mc, "%s: Response with unexpected load id %" PRIu32 "\n",
+                                                __func__, id);
+                                return HB_MC_FAIL;
+                        }
+
+                        io->responses[id] = batch[i].response;
+                        io->received |= (1u << id);
+                        parked |= !(ids & (1u << id));
+                }
+
+                if (parked)
+                        io->parked.notify_all();
+        }
+
+        if (got != nullptr)
+                *got = n_got;
+        return HB_MC_SUCCESS;
+}
+
+/* the queue of requests a thread bound to pod_idx receives */
+static std::deque<hb_mc_request_packet_t> &
+hb_mc_manycore_io_requests(hb_mc_manycore_io_t *io, int pod_idx)
+{
+        if (pod_idx < 0 || static_cast<size_t>(pod_idx) >= io->bound.size() || !io->bound[pod_idx])
+                return io->requests.back();
+
+        return io->requests[pod_idx];
+}
+
+/* index of the pod that sent a request, or -1 if it is not from a pod */
+static int hb_mc_manycore_request_pod_idx(hb_mc_manycore_t *mc,
+                                          const hb_mc_request_packet_t *request)
+{
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t src = hb_mc_coordinate(hb_mc_request_packet_get_x_src(request),
+                                                  hb_mc_request_packet_get_y_src(request));
+
+        if (!hb_mc_config_is_vanilla_core(cfg, src) &&
+            !hb_mc_config_is_dram(cfg, src))
+                return -1;
+
+        hb_mc_coordinate_t pod = hb_mc_config_pod(cfg, src);
+        return hb_mc_coordinate_to_index(pod, hb_mc_config_pods(cfg));
+}
+
+/**
+ * Receive a request packet for the calling thread, parking requests meant for others.
+ * @param[in]  mc      A manycore instance with threads enabled
+ * @param[out] request A packet into which data should be read
+ * @param[in]  timeout Set to -1 to wait forever, or to 0 to return HB_MC_BUSY if none is waiting.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_manycore_io_request_rx(hb_mc_manycore_t *mc,
+                                        hb_mc_request_packet_t *request,
+                                        long timeout)
+{
+        hb_mc_manycore_io_t *io = manycore_io(mc);
+
+        std::unique_lock<std::mutex> lock(io->lock);
+        std::deque<hb_mc_request_packet_t> &mine =
+                hb_mc_manycore_io_requests(io, hb_mc_manycore_thread_pod);
+
+        while (true) {
+                bool parked = false;
+                while (mine.empty()) {
+                        hb_mc_packet_t batch[HB_MC_MANYCORE_IO_RX_BATCH];
+                        size_t n_batch;
+                        int err = hb_mc_platform_receive_batch(mc, batch, HB_MC_MANYCORE_IO_RX_BATCH,
+                                                               &n_batch, HB_MC_FIFO_RX_REQ, 0);
+                        if (err == HB_MC_BUSY)
+                                break;
+                        else if (err != HB_MC_SUCCESS)
+                                return err;
+
+                        for (size_t i = 0; i < n_batch; i++) {
+                                int pod_idx = hb_mc_manycore_request_pod_idx(mc, &batch[i].request);
+                                std::deque<hb_mc_request_packet_t> &theirs = hb_mc_manycore_io_requests(io, pod_idx);
+                                theirs.push_back(batch[i].request);
+                                parked |= &theirs != &mine;
+                        }
+                }
+
+                if (parked)
+                        io->parked.notify_all();
+
+                if (!mine.empty()) {
+                        *request = mine.front();
+                        mine.pop_front();
+                        return HB_MC_SUCCESS;
+                }
+
+                if (timeout == 0)
+                        return HB_MC_BUSY;
+
+                // sleep until another thread parks a request for us, or it is time to poll again
+                io->parked.wait_for(lock, std::chrono::microseconds(HB_MC_MANYCORE_IO_POLL_US));
+        }
+}
+
+
+////////////////////////
+/* Remote Load Engine */
+////////////////////////
+
+/**
+ * Load id bookkeeping for pipelined reads, kept with the manycore so that
+ * reads allocate nothing. A load id is an index into flat tables, the ids
+ * in flight are a bitmask, and a response of any id is matched in O(1).
+ * With host threads, readers take their ids from the shared pool, and
+ * since no two readers hold the same id they share these tables safely.
+ */
+typedef struct hb_mc_manycore_load_engine {
+        unsigned n_ids;                      //!< load ids the hardware accepts in flight
+        uint32_t ids;                        //!< mask of those load ids
+        size_t   slot[HB_MC_REMOTE_LOAD_MAX]; //!< by load id: where the response is returned
+} hb_mc_manycore_load_engine_t;
+
+/* fill in a load engine for a manycore's configuration */
+static void hb_mc_manycore_load_engine_compute(const hb_mc_config_t *cfg,
+                                               hb_mc_manycore_load_engine_t *engine)
+{
+        engine->n_ids = hb_mc_config_get_io_remote_load_cap(cfg);
+        engine->ids = engine->n_ids == 32 ? 0xFFFFFFFFu : (1u << engine->n_ids) - 1;
+}
+
+/* the load engine of a manycore, or #scratch filled in if it has none */
+static hb_mc_manycore_load_engine_t *hb_mc_manycore_load_engine(hb_mc_manycore_t *mc,
+                                                                hb_mc_manycore_load_engine_t *scratch)
+{
+        if (mc->loads != nullptr)
+                return reinterpret_cast<hb_mc_manycore_load_engine_t*>(mc->loads);
+
+        hb_mc_manycore_load_engine_compute(hb_mc_manycore_get_config(mc), scratch);
+        return scratch;
+}
+
+/* allocate the load engine of a manycore */
+static int hb_mc_manycore_load_engine_init(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_load_engine_t *engine = new (std::nothrow) hb_mc_manycore_load_engine_t;
+        if (engine == nullptr)
+                return HB_MC_NOMEM;
+
+        hb_mc_manycore_load_engine_compute(hb_mc_manycore_get_config(mc), engine);
+        mc->loads = engine;
+        return HB_MC_SUCCESS;
+}
+
+/* free the load engine of a manycore */
+static void hb_mc_manycore_load_engine_cleanup(hb_mc_manycore_t *mc)
+{
+        delete reinterpret_cast<hb_mc_manycore_load_engine_t*>(mc->loads);
+        mc->loads = nullptr;
+}
 
 /////////////////////////////////
 /* Flow Control Help Functions */
@@ -89,6 +466,9 @@ static int hb_mc_manycore_get_remote_load_cap(hb_mc_manycore_t *mc, unsigned *ca
  */
 int hb_mc_manycore_host_request_fence(hb_mc_manycore_t *mc, long timeout)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, 0);
+        hb_mc_manycore_io_guard guard(mc);
+        mc->host_request_fences++;
         return hb_mc_platform_fence(mc, timeout);
 }
 
@@ -136,6 +516,7 @@ static int hb_mc_manycore_init_config(hb_mc_manycore_t *mc)
  */
 int  hb_mc_manycore_init(hb_mc_manycore_t *mc, const char *name, hb_mc_manycore_id_t id)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", nullptr, 0);
         int r = HB_MC_FAIL, err;
 
         // check if null
@@ -201,6 +582,21 @@ int  hb_mc_manycore_init(hb_mc_manycore_t *mc, const char *name, hb_mc_manycore_
                 return err;
         }
 
+        // precompute the default EVA map's translation plan
+        if ((err = hb_mc_eva_plan_init(mc)) != HB_MC_SUCCESS) {
+                hb_mc_platform_cleanup(mc);
+                free((void*)mc->name);
+                return err;
+        }
+
+        // set up load id tracking for reads
+        if ((err = hb_mc_manycore_load_engine_init(mc)) != HB_MC_SUCCESS) {
+                hb_mc_eva_plan_cleanup(mc);
+                hb_mc_platform_cleanup(mc);
+                free((void*)mc->name);
+                return err;
+        }
+
         return HB_MC_SUCCESS;
 }
 
@@ -210,6 +606,7 @@ int  hb_mc_manycore_init(hb_mc_manycore_t *mc, const char *name, hb_mc_manycore_
  */
 int hb_mc_manycore_exit(hb_mc_manycore_t *mc)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", nullptr, 0);
         int err;
         err = hb_mc_responders_quit(mc);
         if (err != HB_MC_SUCCESS) {
@@ -218,6 +615,10 @@ int hb_mc_manycore_exit(hb_mc_manycore_t *mc)
                 return err;
         }
         hb_mc_platform_cleanup(mc);
+        delete manycore_io(mc);
+        mc->io = nullptr;
+        hb_mc_eva_plan_cleanup(mc);
+        hb_mc_manycore_load_engine_cleanup(mc);
         free((void*)mc->name);
         return HB_MC_SUCCESS;
 }
@@ -237,9 +638,154 @@ int hb_mc_manycore_get_cycle(hb_mc_manycore_t *mc, uint64_t *time)
                 return HB_MC_INVALID;
         }
                 
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_get_cycle(mc, time);
 }
 
+//////////////////////
+// Host Threads API //
+//////////////////////
+
+/**
+ * Make a manycore instance safe to drive from several host threads at once.
+ * @param[in] mc   A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_enable_threads(hb_mc_manycore_t *mc)
+{
+        if (mc->io != nullptr)
+                return HB_MC_SUCCESS;
+
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t pods = hb_mc_config_pods(cfg);
+        unsigned cap;
+        hb_mc_manycore_get_remote_load_cap(mc, &cap);
+        if (cap == 0 || cap > 32) {
+                manycore_pr_err(mc, "%s: Remote load cap of %u does not fit the load id pool\n",
+                                __func__, cap);
+                return HB_MC_INVALID;
+        }
+
+        hb_mc_manycore_io_t *io = new (std::nothrow) hb_mc_manycore_io_t;
+        if (io == nullptr)
+                return HB_MC_NOMEM;
+
+        io->free_ids = cap == 32 ? 0xFFFFFFFFu : (1u << cap) - 1;
+        io->id_waiters = 0;
+        io->received = 0;
+        io->responses.resize(cap);
+        io->requests.resize(pods.x * pods.y + 1);
+        io->bound.resize(pods.x * pods.y, false);
+        io->bulk_transfers = 0;
+        io->rsp_pollable = true;
+
+        mc->io = io;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Bind the calling thread to a pod, so that it receives the request packets sent by that pod's tiles.
+ * @param[in] mc   A manycore instance with threads enabled by hb_mc_manycore_enable_threads()
+ * @param[in] pod  The coordinate of a pod with no thread bound to it
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_thread_bind_pod(hb_mc_manycore_t *mc, hb_mc_coordinate_t pod)
+{
+        hb_mc_manycore_io_t *io = manycore_io(mc);
+        if (io == nullptr) {
+                manycore_pr_err(mc, "%s: Threads are not enabled\n", __func__);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        hb_mc_coordinate_t pods = hb_mc_config_pods(hb_mc_manycore_get_config(mc));
+        if (pod.x >= pods.x || pod.y >= pods.y) {
+                manycore_pr_err(mc, "%s: Invalid pod (%d,%d)\n",
+                                __func__, pod.x, pod.y);
+                return HB_MC_INVALID;
+        }
+
+        int pod_idx = hb_mc_coordinate_to_index(pod, pods);
+        std::lock_guard<std::mutex> lock(io->lock);
+        if (hb_mc_manycore_thread_pod != -1 || io->bound[pod_idx]) {
+                manycore_pr_err(mc, "%s: Thread or pod (%d,%d) is already bound\n",
+                                __func__, pod.x, pod.y);
+                return HB_MC_BUSY;
+        }
+
+        // take the requests this pod sent before it had a thread
+        std::deque<hb_mc_request_packet_t> &unbound = io->requests.back();
+        std::deque<hb_mc_request_packet_t> &mine = io->requests[pod_idx];
+        for (auto it = unbound.begin(); it != unbound.end(); ) {
+                if (hb_mc_manycore_request_pod_idx(mc, &*it) == pod_idx) {
+                        mine.push_back(*it);
+                        it = unbound.erase(it);
+                } else {
+                        ++it;
+                }
+        }
+
+        io->bound[pod_idx] = true;
+        hb_mc_manycore_thread_pod = pod_idx;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Unbind the calling thread from its pod, if any.
+ * @param[in] mc   A manycore instance with threads enabled by hb_mc_manycore_enable_threads()
+ */
+void hb_mc_manycore_thread_unbind_pod(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_io_t *io = manycore_io(mc);
+        int pod_idx = hb_mc_manycore_thread_pod;
+        if (io == nullptr || pod_idx == -1)
+                return;
+
+        std::lock_guard<std::mutex> lock(io->lock);
+        std::deque<hb_mc_request_packet_t> &mine = io->requests[pod_idx];
+        std::deque<hb_mc_request_packet_t> &unbound = io->requests.back();
+        unbound.insert(unbound.end(), mine.begin(), mine.end());
+        mine.clear();
+
+        io->bound[pod_idx] = false;
+        hb_mc_manycore_thread_pod = -1;
+}
+
+/**
+ * Tell the platform that a sequence of bulk transfers is starting.
+ * @param[in] mc   A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_start_bulk_transfer(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_io_t *io = manycore_io(mc);
+        if (io == nullptr)
+                return hb_mc_platform_start_bulk_transfer(mc);
+
+        std::lock_guard<std::mutex> lock(io->lock);
+        if (io->bulk_transfers++ > 0)
+                return HB_MC_SUCCESS;
+
+        return hb_mc_platform_start_bulk_transfer(mc);
+}
+
+/**
+ * Tell the platform that a sequence of bulk transfers is done.
+ * @param[in] mc   A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_finish_bulk_transfer(hb_mc_manycore_t *mc)
+{
+        hb_mc_manycore_io_t *io = manycore_io(mc);
+        if (io == nullptr)
+                return hb_mc_platform_finish_bulk_transfer(mc);
+
+        std::lock_guard<std::mutex> lock(io->lock);
+        if (io->bulk_transfers == 0 || --io->bulk_transfers > 0)
+                return HB_MC_SUCCESS;
+
+        return hb_mc_platform_finish_bulk_transfer(mc);
+}
+
 ////////////////
 // Packet API //
 ////////////////
@@ -255,8 +801,15 @@ int hb_mc_manycore_request_tx(hb_mc_manycore_t *mc,
                               hb_mc_request_packet_t *request,
                               long timeout)
 {
+        int err;
+
         /* send the request packet */
-        return hb_mc_platform_transmit(mc, (hb_mc_packet_t*)request, HB_MC_FIFO_TX_REQ, timeout);
+        hb_mc_manycore_io_guard guard(mc);
+        err = hb_mc_platform_transmit(mc, (hb_mc_packet_t*)request, HB_MC_FIFO_TX_REQ, timeout);
+        if (err == HB_MC_SUCCESS)
+                mc->request_packets_tx++;
+
+        return err;
 }
 
 /**
@@ -271,6 +824,7 @@ int hb_mc_manycore_response_rx(hb_mc_manycore_t *mc,
                                long timeout)
 {
         /* receive the response packet */
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_receive(mc, (hb_mc_packet_t*)response, HB_MC_FIFO_RX_RSP, timeout);
 }
 
@@ -285,6 +839,7 @@ int hb_mc_manycore_response_tx(hb_mc_manycore_t *mc,
                                hb_mc_response_packet_t *response,
                                long timeout)
 {
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_transmit(mc, (hb_mc_packet_t*)response, HB_MC_FIFO_TX_RSP, timeout);
 }
 
@@ -300,10 +855,14 @@ int hb_mc_manycore_request_rx(hb_mc_manycore_t *mc,
                               long timeout)
 {
         int err;
-        err = hb_mc_platform_receive(mc, (hb_mc_packet_t*)request, HB_MC_FIFO_RX_REQ, timeout);
+        if (mc->io)
+                err = hb_mc_manycore_io_request_rx(mc, request, timeout);
+        else
+                err = hb_mc_platform_receive(mc, (hb_mc_packet_t*)request, HB_MC_FIFO_RX_REQ, timeout);
         if (err != HB_MC_SUCCESS)
                 return err;
 
+        hb_mc_manycore_io_guard guard(mc);
         err = hb_mc_responders_respond(mc, request);
         if (err != HB_MC_SUCCESS) {
                 char request_str[64];
@@ -493,6 +1052,7 @@ int hb_mc_manycore_vcache_apply_to_npa(hb_mc_manycore_t *mc,
         if (err != HB_MC_SUCCESS) {
                 manycore_pr_err(mc, "%s: Failed to send request packet: %s\n",
                                 __func__, hb_mc_strerror(err));
+                return err;
         }
 
         return HB_MC_SUCCESS;
@@ -504,12 +1064,17 @@ int hb_mc_manycore_vcache_apply_to_npa(hb_mc_manycore_t *mc,
  * @param[in]  npa    A valid hb_mc_npa_t (must map to DRAM) - start of the range to invalidate
  * @param[in]  sz     The size of the range to invalidate in bytes
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ *
+ * One packet is sent for each cache line that overlaps the range. No fence is performed.
  */
 static int hb_mc_manycore_vcache_apply_to_npa_range(hb_mc_manycore_t *mc,
                                                     const hb_mc_npa_t *npa,
                                                     size_t range_sz,
                                                     hb_mc_packet_cache_op_t cache_op)
 {
+        if (!hb_mc_manycore_has_cache(mc))
+                return HB_MC_SUCCESS;
+
         hb_mc_epa_t epa = hb_mc_npa_get_epa(npa);
         const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
         ssize_t sz = static_cast<ssize_t>(range_sz);
@@ -526,7 +1091,7 @@ static int hb_mc_manycore_vcache_apply_to_npa_range(hb_mc_manycore_t *mc,
                 hb_mc_npa_t line_npa = *npa;
                 hb_mc_npa_set_epa(&line_npa, epa);
 
-                err = hb_mc_manycore_vcache_apply_to_npa(mc, npa, cache_op);
+                err = hb_mc_manycore_vcache_apply_to_npa(mc, &line_npa, cache_op);
                 if (err != HB_MC_SUCCESS)
                         return err;
 
@@ -548,6 +1113,29 @@ static int hb_mc_manycore_vcache_apply_to_npa_range(hb_mc_manycore_t *mc,
 int hb_mc_manycore_vcache_invalidate_npa_range(hb_mc_manycore_t *mc,
                                                const hb_mc_npa_t *npa,
                                                size_t sz)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
+        if (!hb_mc_manycore_has_cache(mc))
+                return HB_MC_SUCCESS;
+
+        int err;
+        err = hb_mc_manycore_vcache_invalidate_npa_range_nofence(mc, npa, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        return hb_mc_manycore_host_request_fence(mc, -1);
+}
+
+/**
+ * Invalidate a range of manycore DRAM addresses without waiting for completion.
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t (must map to DRAM) - start of the range to invalidate
+ * @param[in]  sz     The size of the range to invalidate in bytes
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_vcache_invalidate_npa_range_nofence(hb_mc_manycore_t *mc,
+                                                       const hb_mc_npa_t *npa,
+                                                       size_t sz)
 {
         return hb_mc_manycore_vcache_apply_to_npa_range(mc, npa, sz,
                                                         HB_MC_PACKET_CACHE_OP_AINV);
@@ -564,6 +1152,7 @@ int hb_mc_manycore_vcache_flush_npa_range(hb_mc_manycore_t *mc,
                                           const hb_mc_npa_t *npa,
                                           size_t sz)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
         if (!hb_mc_manycore_has_cache(mc))
                 return HB_MC_SUCCESS;
 
@@ -578,6 +1167,21 @@ int hb_mc_manycore_vcache_flush_npa_range(hb_mc_manycore_t *mc,
         return hb_mc_manycore_read32(mc, npa, &dummy);
 }
 
+/**
+ * Flush a range of manycore DRAM addresses without waiting for completion.
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t (must map to DRAM) - start of the range to flush
+ * @param[in]  sz     The size of the range to flush in bytes
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_vcache_flush_npa_range_nofence(hb_mc_manycore_t *mc,
+                                                  const hb_mc_npa_t *npa,
+                                                  size_t sz)
+{
+        return hb_mc_manycore_vcache_apply_to_npa_range(mc, npa, sz,
+                                                        HB_MC_PACKET_CACHE_OP_AFL);
+}
+
 int hb_mc_manycore_vcache_flush_tag(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa)
 {
 
@@ -631,6 +1235,7 @@ static int hb_mc_manycore_pod_apply_to_vcache(hb_mc_manycore_t *mc, hb_mc_coordi
  */
 int hb_mc_manycore_pod_invalidate_vcache(hb_mc_manycore_t *mc, hb_mc_coordinate_t pod)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, 0);
         return hb_mc_manycore_pod_apply_to_vcache(mc, pod, [](hb_mc_manycore_t *mc, const hb_mc_npa_t *way_addr) {
                         // write way_id (no valid bit)
                         char npa_str [256];
@@ -664,6 +1269,7 @@ int hb_mc_manycore_pod_validate_vcache(hb_mc_manycore_t *mc, hb_mc_coordinate_t
  */
 int hb_mc_manycore_pod_flush_vcache(hb_mc_manycore_t *mc, hb_mc_coordinate_t pod)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, 0);
         if (!hb_mc_manycore_has_cache(mc))
                 return HB_MC_SUCCESS;
 
@@ -698,6 +1304,7 @@ int hb_mc_manycore_pod_flush_vcache(hb_mc_manycore_t *mc, hb_mc_coordinate_t pod
  */
 int hb_mc_manycore_invalidate_vcache(hb_mc_manycore_t *mc)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, 0);
         int err;
         hb_mc_coordinate_t pod;
         hb_mc_config_foreach_pod(pod, &mc->config)
@@ -733,6 +1340,7 @@ int hb_mc_manycore_validate_vcache(hb_mc_manycore_t *mc)
  */
 int hb_mc_manycore_flush_vcache(hb_mc_manycore_t *mc)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, 0);
         int err;
         hb_mc_coordinate_t pod;
         hb_mc_config_foreach_pod(pod, &mc->config)
@@ -749,16 +1357,16 @@ int hb_mc_manycore_flush_vcache(hb_mc_manycore_t *mc)
 // Memory API //
 ////////////////
 
-/* send a read request and don't wait for the return packet */
-static int hb_mc_manycore_send_read_rqst(hb_mc_manycore_t *mc,
-                                         const hb_mc_npa_t *npa, size_t sz,
-                                         uint32_t id = 0)
+/* format a read request with a given load id */
+static int hb_mc_manycore_format_read_rqst(hb_mc_manycore_t *mc,
+                                           hb_mc_request_packet_t *rqst,
+                                           const hb_mc_npa_t *npa, size_t sz,
+                                           uint32_t id = 0)
 {
-        hb_mc_packet_t rqst;
         int err;
 
         /* format the request packet */
-        err = hb_mc_manycore_format_load_request_packet(mc, &rqst.request, npa);
+        err = hb_mc_manycore_format_load_request_packet(mc, rqst, npa);
         if (err != HB_MC_SUCCESS) {
                 manycore_pr_err(mc, "%s: Failed to format load request packet: %s\n",
                                 __func__, hb_mc_strerror(err));
@@ -773,7 +1381,7 @@ static int hb_mc_manycore_send_read_rqst(hb_mc_manycore_t *mc,
                 return err;
 
         // mark request with id
-        hb_mc_request_packet_set_load_id(&rqst.request, id);
+        hb_mc_request_packet_set_load_id(rqst, id);
 
         // set load info
         hb_mc_request_packet_load_info_t info = {};
@@ -782,16 +1390,31 @@ static int hb_mc_manycore_send_read_rqst(hb_mc_manycore_t *mc,
         info.is_hex_op      = sz == 2;
         info.is_byte_op     = sz == 1;
 
-        hb_mc_request_packet_set_load_info(&rqst.request, info);
+        hb_mc_request_packet_set_load_info(rqst, info);
 
-        /* transmit the request to the hardware */
-        manycore_pr_dbg(mc, "Sending %d-byte read request to NPA "
+        manycore_pr_dbg(mc, "Formatted %d-byte read request to NPA "
                         "(x: %d, y: %d, 0x%08" PRIx32 ")\n",
                         sz,
                         hb_mc_npa_get_x(npa),
                         hb_mc_npa_get_y(npa),
                         hb_mc_npa_get_epa(npa));
 
+        return HB_MC_SUCCESS;
+}
+
+/* send a read request and don't wait for the return packet */
+static int hb_mc_manycore_send_read_rqst(hb_mc_manycore_t *mc,
+                                         const hb_mc_npa_t *npa, size_t sz,
+                                         uint32_t id = 0)
+{
+        hb_mc_packet_t rqst;
+        int err;
+
+        err = hb_mc_manycore_format_read_rqst(mc, &rqst.request, npa, sz, id);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* transmit the request to the hardware */
         err = hb_mc_manycore_request_tx(mc, &rqst.request, -1);
         if (err == HB_MC_BUSY)
                 return err; // omit the error message if just busy
@@ -834,32 +1457,51 @@ static int hb_mc_manycore_recv_read_rsp(hb_mc_manycore_t *mc,
 template <typename UINT>
 static int hb_mc_manycore_read(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, UINT *vp)
 {
+        hb_mc_manycore_io_load_ids held(mc);
+        uint32_t id = 0;
         int err;
 
+        /* other host threads may have loads in flight */
+        if (mc->io)
+                id = __builtin_ctz(held.acquire(1));
+
         /* send load request */
-        err = hb_mc_manycore_send_read_rqst(mc, npa, sizeof(UINT));
+        err = hb_mc_manycore_send_read_rqst(mc, npa, sizeof(UINT), id);
         if (err != HB_MC_SUCCESS)
                 return err;
 
         /* read back response */
         uint32_t load_data;
-        err = hb_mc_manycore_recv_read_rsp(mc, &load_data);
-        if (err != HB_MC_SUCCESS)
-                return err;
+        if (mc->io) {
+                hb_mc_packet_t rsp;
+                err = hb_mc_manycore_io_receive_responses(mc, 1u << id, &rsp, 1);
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to read response packet: %s\n",
+                                        __func__, hb_mc_strerror(err));
+                        return err;
+                }
+                load_data = hb_mc_response_packet_get_data(&rsp.response);
+        } else {
+                err = hb_mc_manycore_recv_read_rsp(mc, &load_data);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
 
         /* mask off unused bits */
         *vp = static_cast<UINT>(load_data);
         return HB_MC_SUCCESS;
 }
 
-/* write to a memory address on the manycore */
-static int hb_mc_manycore_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, const void *vp, size_t sz)
+/* format a write request to a memory address on the manycore */
+static int hb_mc_manycore_format_write_rqst(hb_mc_manycore_t *mc,
+                                            hb_mc_request_packet_t *rqst,
+                                            const hb_mc_npa_t *npa,
+                                            const void *vp, size_t sz)
 {
         int err;
-        hb_mc_packet_t rqst;
 
         /* format the request packet */
-        err = hb_mc_manycore_format_request_packet(mc, &rqst.request, npa);
+        err = hb_mc_manycore_format_request_packet(mc, rqst, npa);
         if (err != HB_MC_SUCCESS)
                 return err;
 
@@ -875,49 +1517,80 @@ static int hb_mc_manycore_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, co
         /* set data and size */
         switch (sz) {
         case 4:
-                hb_mc_request_packet_set_op(&rqst.request, HB_MC_PACKET_OP_REMOTE_SW);
-                hb_mc_request_packet_set_data(&rqst.request, *(const uint32_t*)vp);
+                hb_mc_request_packet_set_op(rqst, HB_MC_PACKET_OP_REMOTE_SW);
+                hb_mc_request_packet_set_data(rqst, *(const uint32_t*)vp);
                 break;
         case 2:
-                hb_mc_request_packet_set_op(&rqst.request, HB_MC_PACKET_OP_REMOTE_STORE);
-                hb_mc_request_packet_set_data(&rqst.request, static_cast<uint32_t>(*(const uint16_t*)vp) << data_shift);
-                hb_mc_request_packet_set_mask(&rqst.request, static_cast<hb_mc_packet_mask_t>(
+                hb_mc_request_packet_set_op(rqst, HB_MC_PACKET_OP_REMOTE_STORE);
+                hb_mc_request_packet_set_data(rqst, static_cast<uint32_t>(*(const uint16_t*)vp) << data_shift);
+                hb_mc_request_packet_set_mask(rqst, static_cast<hb_mc_packet_mask_t>(
                                                       HB_MC_PACKET_REQUEST_MASK_SHORT << mask_shift));
                 break;
         case 1:
-                hb_mc_request_packet_set_op(&rqst.request, HB_MC_PACKET_OP_REMOTE_STORE);
-                hb_mc_request_packet_set_data(&rqst.request, static_cast<uint32_t>(*(const  uint8_t*)vp) << data_shift);
-                hb_mc_request_packet_set_mask(&rqst.request, static_cast<hb_mc_packet_mask_t>(
+                hb_mc_request_packet_set_op(rqst, HB_MC_PACKET_OP_REMOTE_STORE);
+                hb_mc_request_packet_set_data(rqst, static_cast<uint32_t>(*(const  uint8_t*)vp) << data_shift);
+                hb_mc_request_packet_set_mask(rqst, static_cast<hb_mc_packet_mask_t>(
                                                       HB_MC_PACKET_REQUEST_MASK_BYTE << mask_shift));
                 break;
         default:
                 return HB_MC_INVALID;
         }
 
-        /* transmit the request */
-        manycore_pr_dbg(mc, "Sending %d-byte write request to NPA "
+        manycore_pr_dbg(mc, "Formatted %d-byte write request to NPA "
                         "(x: %d, y: %d, 0x%08x) (data = 0x%08" PRIx32 ")\n",
                         sz,
                         hb_mc_npa_get_x(npa),
                         hb_mc_npa_get_y(npa),
                         hb_mc_npa_get_epa(npa),
-                        hb_mc_request_packet_get_data(&rqst.request));
+                        hb_mc_request_packet_get_data(rqst));
 
-        return hb_mc_manycore_request_tx(mc, &rqst.request, -1);
+        return HB_MC_SUCCESS;
 }
 
-/* checks that the arguments of read/write_mem are supported */
-static int hb_mc_manycore_read_write_mem_check_args(hb_mc_manycore_t *mc,
-                                                    const char *caller_name,
-                                                    const void *data, size_t sz)
+/* write to a memory address on the manycore */
+static int hb_mc_manycore_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, const void *vp, size_t sz)
 {
-        uintptr_t ptr = (uintptr_t)data;
+        int err;
+        hb_mc_packet_t rqst;
 
-        if (ptr & 0x3) {
-                manycore_pr_err(mc, "%s: Input 'data' = %p: "
-                                "only 32-bit aligned data is supported\n",
-                                caller_name, data);
-                return HB_MC_NOIMPL;
+        err = hb_mc_manycore_format_write_rqst(mc, &rqst.request, npa, vp, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* transmit the request */
+        return hb_mc_manycore_request_tx(mc, &rqst.request, -1);
+}
+
+/* transmit a vector of request packets */
+static int hb_mc_manycore_request_tx_batch(hb_mc_manycore_t *mc,
+                                           hb_mc_packet_t *rqsts, size_t count)
+{
+        int err;
+
+        if (count == 0)
+                return HB_MC_SUCCESS;
+
+        hb_mc_manycore_io_guard guard(mc);
+        err = hb_mc_platform_transmit_batch(mc, rqsts, count, HB_MC_FIFO_TX_REQ, -1);
+        if (err == HB_MC_SUCCESS)
+                mc->request_packets_tx += count;
+
+        return err;
+}
+
+
+/* checks that the arguments of read/write_mem are supported */
+static int hb_mc_manycore_read_write_mem_check_args(hb_mc_manycore_t *mc,
+                                                    const char *caller_name,
+                                                    const void *data, size_t sz)
+{
+        uintptr_t ptr = (uintptr_t)data;
+
+        if (ptr & 0x3) {
+                manycore_pr_err(mc, "%s: Input 'data' = %p: "
+                                "only 32-bit aligned data is supported\n",
+                                caller_name, data);
+                return HB_MC_NOIMPL;
         }
 
         if (sz & 0x3) {
@@ -930,15 +1603,15 @@ static int hb_mc_manycore_read_write_mem_check_args(hb_mc_manycore_t *mc,
 }
 
 /**
- * Write memory out to manycore hardware starting at a given NPA
+ * Stream write requests for a buffer starting at a given NPA without fencing
  * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
  * @param[in]  npa    A valid hb_mc_npa_t
  * @param[in]  data   A buffer to be written out manycore hardware
  * @param[in]  sz     The number of bytes to write to manycore hardware
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-int hb_mc_manycore_write_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
-                             const void *data, size_t sz)
+int hb_mc_manycore_write_mem_nofence(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                     const void *data, size_t sz)
 {
         int err;
 
@@ -946,44 +1619,72 @@ int hb_mc_manycore_write_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
         if (err != HB_MC_SUCCESS)
                 return err;
 
-        hb_mc_platform_start_bulk_transfer(mc);
-
         const uint32_t *words = (const uint32_t*)data;
         size_t n_words = sz >> 2;
         hb_mc_npa_t addr = *npa;
+        hb_mc_packet_t rqsts[HB_MC_MANYCORE_TX_BATCH_PACKETS];
+
+        /* format store requests a batch at a time and send them together */
+        for (size_t i = 0; i < n_words; ) {
+                size_t n_rqsts = 0;
+                for (; i < n_words && n_rqsts < array_size(rqsts); i++, n_rqsts++) {
+                        err = hb_mc_manycore_format_write_rqst(mc, &rqsts[n_rqsts].request,
+                                                               &addr, &words[i], 4);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
 
-        /* send store requests one word at a time */
-        for (size_t i = 0; i < n_words; i++) {
+                        // Increment EPA by 4:
+                        hb_mc_npa_set_epa(&addr, hb_mc_npa_get_epa(&addr) + 4);
+                }
 
-                err = hb_mc_manycore_write(mc, &addr, &words[i], 4);
+                err = hb_mc_manycore_request_tx_batch(mc, rqsts, n_rqsts);
                 if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to send write request: %s\n",
+                        manycore_pr_err(mc, "%s: Failed to send write requests: %s\n",
                                         __func__, hb_mc_strerror(err));
                         return err;
                 }
-
-                // Increment EPA by 4:
-                hb_mc_npa_set_epa(&addr, hb_mc_npa_get_epa(&addr) + 4);
         }
 
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Write memory out to manycore hardware starting at a given NPA
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t
+ * @param[in]  data   A buffer to be written out manycore hardware
+ * @param[in]  sz     The number of bytes to write to manycore hardware
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_write_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                             const void *data, size_t sz)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
+        int err;
+
+        hb_mc_manycore_bulk_transfer bulk(mc);
+
+        err = hb_mc_manycore_write_mem_nofence(mc, npa, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
         err = hb_mc_manycore_host_request_fence(mc, -1);
         if (err != HB_MC_SUCCESS)
                 return err;
 
-        hb_mc_platform_finish_bulk_transfer(mc);
         return HB_MC_SUCCESS;
 }
 
 /**
- * Set memory to a given value starting at a given NPA
+ * Stream write requests setting memory to a value starting at a given NPA without fencing
  * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
  * @param[in]  npa    A valid hb_mc_npa_t
  * @param[in]  val    Value to be written out
  * @param[in]  sz     The number of bytes to write to manycore hardware
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
-int hb_mc_manycore_memset(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
-                          uint8_t val, size_t sz)
+int hb_mc_manycore_memset_nofence(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                  uint8_t val, size_t sz)
 {
         int err;
 
@@ -994,43 +1695,529 @@ int hb_mc_manycore_memset(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
         const uint32_t word = (val << 24) | (val << 16) | (val << 8) | val;
         size_t n_words = sz >> 2;
         hb_mc_npa_t addr = *npa;
+        hb_mc_packet_t rqsts[HB_MC_MANYCORE_TX_BATCH_PACKETS];
+
+        /* format store requests a batch at a time and send them together */
+        for (size_t i = 0; i < n_words; ) {
+                size_t n_rqsts = 0;
+                for (; i < n_words && n_rqsts < array_size(rqsts); i++, n_rqsts++) {
+                        err = hb_mc_manycore_format_write_rqst(mc, &rqsts[n_rqsts].request,
+                                                               &addr, &word, 4);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
 
-        hb_mc_platform_start_bulk_transfer(mc);
+                        // increment EPA by 1: (EPA's address words)
+                        hb_mc_npa_set_epa(&addr, hb_mc_npa_get_epa(&addr) + sizeof(uint32_t));
+                }
+
+                err = hb_mc_manycore_request_tx_batch(mc, rqsts, n_rqsts);
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to send write requests: %s\n",
+                                        __func__, hb_mc_strerror(err));
+                        return err;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Stream the same words to several NPAs, one word to each NPA in turn.
+ * @param[in]  mc        A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npas      Destinations
+ * @param[in]  n         The number of destinations
+ * @param[in]  n_words   The number of words to write to each destination
+ * @param[in]  word_at   Returns a pointer to word i of the data
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+template <typename WordFunction>
+static int hb_mc_manycore_write_interleaved_nofence(hb_mc_manycore_t *mc,
+                                                    const hb_mc_npa_t *npas, size_t n,
+                                                    size_t n_words, WordFunction word_at)
+{
+        int err;
+        hb_mc_packet_t rqsts[HB_MC_MANYCORE_TX_BATCH_PACKETS];
+        size_t n_rqsts = 0;
 
-        /* send store requests one word at a time */
         for (size_t i = 0; i < n_words; i++) {
+                for (size_t d = 0; d < n; d++) {
+                        hb_mc_npa_t addr = npas[d];
+                        hb_mc_npa_set_epa(&addr, hb_mc_npa_get_epa(&addr) + i * sizeof(uint32_t));
+                        err = hb_mc_manycore_format_write_rqst(mc, &rqsts[n_rqsts].request,
+                                                               &addr, word_at(i), 4);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+
+                        if (++n_rqsts < array_size(rqsts))
+                                continue;
+
+                        err = hb_mc_manycore_request_tx_batch(mc, rqsts, n_rqsts);
+                        if (err != HB_MC_SUCCESS) {
+                                manycore_pr_err(mc, "%s: Failed to send write requests: %s\n",
+                                                __func__, hb_mc_strerror(err));
+                                return err;
+                        }
+                        n_rqsts = 0;
+                }
+        }
 
-                err = hb_mc_manycore_write(mc, &addr, &word, 4);
+        err = hb_mc_manycore_request_tx_batch(mc, rqsts, n_rqsts);
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to send write requests: %s\n",
+                                __func__, hb_mc_strerror(err));
+                return err;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Stream write requests copying one buffer to several NPAs without fencing
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npas   Valid hb_mc_npa_t destinations
+ * @param[in]  n      The number of destinations
+ * @param[in]  data   A buffer to be written out to each destination
+ * @param[in]  sz     The number of bytes to write to each destination
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_write_mem_interleaved_nofence(hb_mc_manycore_t *mc,
+                                                 const hb_mc_npa_t *npas, size_t n,
+                                                 const void *data, size_t sz)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz * n);
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        const uint32_t *words = (const uint32_t*)data;
+        return hb_mc_manycore_write_interleaved_nofence(mc, npas, n, sz >> 2,
+                                                        [=](size_t i) { return &words[i]; });
+}
+
+/**
+ * Stream write requests setting memory to a value at several NPAs without fencing
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npas   Valid hb_mc_npa_t destinations
+ * @param[in]  n      The number of destinations
+ * @param[in]  val    Value to be written out
+ * @param[in]  sz     The number of bytes to write to each destination
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_memset_interleaved_nofence(hb_mc_manycore_t *mc,
+                                              const hb_mc_npa_t *npas, size_t n,
+                                              uint8_t val, size_t sz)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz * n);
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, NULL, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        const uint32_t word = (val << 24) | (val << 16) | (val << 8) | val;
+        return hb_mc_manycore_write_interleaved_nofence(mc, npas, n, sz >> 2,
+                                                        [&](size_t i) { return &word; });
+}
+
+/* the NPA and size of a segment of a bulk transfer, which is an NPA extent or an iovec */
+static const hb_mc_npa_t *hb_mc_manycore_segment_npa(const hb_mc_npa_extent_t *extent) { return &extent->npa; }
+static size_t hb_mc_manycore_segment_sz(const hb_mc_npa_extent_t *extent) { return extent->sz; }
+static const hb_mc_npa_t *hb_mc_manycore_segment_npa(const hb_mc_manycore_iovec_t *iov) { return &iov->npa; }
+static size_t hb_mc_manycore_segment_sz(const hb_mc_manycore_iovec_t *iov) { return iov->len; }
+
+/**
+ * The tables behind the extent schedules of one host thread. They are kept
+ * between transfers and only grow, so a schedule allocates nothing unless
+ * it has more extents than any before it on the same thread.
+ */
+struct hb_mc_manycore_schedule_tables {
+        struct lane {
+                size_t extent; //!< the current extent
+                size_t word;   //!< the next word of the current extent
+                size_t last;   //!< the last extent on this lane, while lanes are formed
+        };
+
+        std::vector<size_t> first_word; //!< by extent: the index of its first word
+        std::vector<size_t> next;       //!< by extent: the next extent on its lane
+        std::vector<lane>   lanes;      //!< lanes with words left to send, in turn order
+        std::vector<size_t> lane_of;    //!< open-addressed by destination: lane + 1, or 0
+};
+
+static thread_local hb_mc_manycore_schedule_tables hb_mc_manycore_schedule_tables_local;
+
+/**
+ * The order in which a bulk transfer visits the words of a list of NPA extents.
+ *
+ * Words are numbered as if the extents were laid back to back. In linear
+ * order each extent is walked in full before the next. Writing a DRAM region
+ * linearly sends a whole stripe to one cache before moving on to the next,
+ * so only one cache works at a time. In interleaved order the extents are
+ * grouped into lanes by destination, and consecutive words round-robin
+ * across the lanes, so every cache behind the extents receives packets while
+ * the host streams. Each lane still walks its own extents in order.
+ *
+ * The extents of a lane are chained through #next in the tables of the
+ * calling thread, so building a schedule does not allocate per transfer.
+ * The segments may be NPA extents or iovecs.
+ */
+template <typename SEGMENT>
+class hb_mc_manycore_extent_schedule {
+public:
+        hb_mc_manycore_extent_schedule(const SEGMENT *extents, size_t n_extents,
+                                       hb_mc_manycore_bulk_order_t order) :
+                extents(extents), n_extents(n_extents),
+                tables(hb_mc_manycore_schedule_tables_local), n_words(0), curr(0) {
+                tables.first_word.resize(n_extents);
+                tables.next.resize(n_extents);
+                tables.lanes.clear();
+
+                bool interleaved = order == HB_MC_MANYCORE_BULK_ORDER_INTERLEAVED;
+                size_t mask = 0;
+                if (interleaved) {
+                        size_t table_sz = 1;
+                        while (table_sz < 2 * n_extents)
+                                table_sz <<= 1;
+                        tables.lane_of.assign(table_sz, 0);
+                        mask = table_sz - 1;
+                }
+
+                for (size_t i = 0; i < n_extents; i++) {
+                        tables.first_word[i] = n_words;
+                        tables.next[i] = n_extents;
+                        n_words += sz(i) >> 2;
+                        if (sz(i) < sizeof(uint32_t))
+                                continue;
+
+                        // find the lane of this destination, or claim a slot for a new one
+                        size_t *lane_slot = nullptr;
+                        if (interleaved) {
+                                for (size_t h = hash(i) & mask; ; h = (h + 1) & mask) {
+                                        lane_slot = &tables.lane_of[h];
+                                        if (*lane_slot == 0 || same_lane(tables.lanes[*lane_slot - 1].last, i))
+                                                break;
+                                }
+                        }
+
+                        size_t l = lane_slot != nullptr ? *lane_slot : !tables.lanes.empty();
+                        if (l == 0) {
+                                tables.lanes.push_back({i, 0, i});
+                                if (lane_slot != nullptr)
+                                        *lane_slot = tables.lanes.size();
+                        } else {
+                                hb_mc_manycore_schedule_tables::lane &ln = tables.lanes[l - 1];
+                                tables.next[ln.last] = i;
+                                ln.last = i;
+                        }
+                }
+        }
+
+        /* the number of words in the extents */
+        size_t words() const { return n_words; }
+
+        /* the index of the first word of an extent among the words */
+        size_t offset(size_t extent) const { return tables.first_word[extent]; }
+
+        /* the NPA of the next word to send, its extent, and its index in the extent */
+        hb_mc_npa_t next(size_t *extent, size_t *word) {
+                hb_mc_manycore_schedule_tables::lane &ln = tables.lanes[curr];
+                size_t e = ln.extent;
+                const hb_mc_npa_t *npa = hb_mc_manycore_segment_npa(&extents[e]);
+                *extent = e;
+                *word = ln.word;
+                hb_mc_npa_t addr = hb_mc_npa_from_x_y(hb_mc_npa_get_x(npa),
+                                                      hb_mc_npa_get_y(npa),
+                                                      hb_mc_npa_get_epa(npa) +
+                                                      ln.word * sizeof(uint32_t));
+
+                // step this lane, dropping it once its extents are done
+                if (++ln.word == sz(e) >> 2) {
+                        ln.word = 0;
+                        ln.extent = tables.next[e];
+                }
+                if (ln.extent == n_extents)
+                        tables.lanes.erase(tables.lanes.begin() + curr);
+                else
+                        curr++;
+                if (curr == tables.lanes.size())
+                        curr = 0;
+
+                return addr;
+        }
+
+private:
+        size_t sz(size_t e) const { return hb_mc_manycore_segment_sz(&extents[e]); }
+
+        /* extents are on the same lane if they have the same destination */
+        bool same_lane(size_t a, size_t b) const {
+                const hb_mc_npa_t *npa_a = hb_mc_manycore_segment_npa(&extents[a]);
+                const hb_mc_npa_t *npa_b = hb_mc_manycore_segment_npa(&extents[b]);
+                return hb_mc_npa_get_x(npa_a) == hb_mc_npa_get_x(npa_b) &&
+                       hb_mc_npa_get_y(npa_a) == hb_mc_npa_get_y(npa_b);
+        }
+
+        size_t hash(size_t e) const {
+                const hb_mc_npa_t *npa = hb_mc_manycore_segment_npa(&extents[e]);
+                uint64_t key = (static_cast<uint64_t>(hb_mc_npa_get_x(npa)) << 32) | hb_mc_npa_get_y(npa);
+                return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+
+        const SEGMENT *extents;
+        size_t n_extents;
+        hb_mc_manycore_schedule_tables &tables;
+        size_t n_words;
+        size_t curr; //!< the lane that sends the next word
+};
+
+/* checks that every extent of a bulk transfer is a whole number of words */
+static int hb_mc_manycore_extents_check_args(hb_mc_manycore_t *mc,
+                                             const char *caller_name,
+                                             const hb_mc_npa_extent_t *extents,
+                                             size_t n_extents)
+{
+        for (size_t i = 0; i < n_extents; i++) {
+                int err = hb_mc_manycore_read_write_mem_check_args(mc, caller_name,
+                                                                   NULL, extents[i].sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        return HB_MC_SUCCESS;
+}
+
+/* the number of bytes in a list of extents, or 0 if it will not be traced */
+static uint64_t hb_mc_manycore_extents_trace_bytes(const hb_mc_npa_extent_t *extents,
+                                                   size_t n_extents)
+{
+        uint64_t bytes = 0;
+        if (!hb_mc_api_trace_is_enabled() || extents == NULL)
+                return 0;
+        for (size_t i = 0; i < n_extents; i++)
+                bytes += extents[i].sz;
+        return bytes;
+}
+
+/**
+ * Stream words to a list of NPA extents in the order of a schedule.
+ * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  schedule   A schedule of the extents to write
+ * @param[in]  word_at    Returns a pointer to word w of extent e, given e and w
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ *
+ * Requests are handed to the platform at most one host credit window at a
+ * time, so each batch the host may have in flight is spread over the lanes.
+ */
+template <typename SCHEDULE, typename WordFunction>
+static int hb_mc_manycore_write_extents_nofence(hb_mc_manycore_t *mc,
+                                                SCHEDULE &schedule,
+                                                WordFunction word_at)
+{
+        int err;
+        hb_mc_packet_t rqsts[HB_MC_MANYCORE_TX_BATCH_PACKETS];
+        size_t batch = array_size(rqsts);
+        uint32_t credits = hb_mc_config_get_transmit_vacancy_max(hb_mc_manycore_get_config(mc));
+
+        if (credits != 0 && credits < batch)
+                batch = credits;
+
+        size_t n_words = schedule.words();
+
+        /* format store requests a batch at a time and send them together */
+        for (size_t i = 0; i < n_words; ) {
+                size_t n_rqsts = 0;
+                for (; i < n_words && n_rqsts < batch; i++, n_rqsts++) {
+                        size_t extent, word;
+                        hb_mc_npa_t addr = schedule.next(&extent, &word);
+                        err = hb_mc_manycore_format_write_rqst(mc, &rqsts[n_rqsts].request,
+                                                               &addr, word_at(extent, word), 4);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+                }
+
+                err = hb_mc_manycore_request_tx_batch(mc, rqsts, n_rqsts);
                 if (err != HB_MC_SUCCESS) {
-                        manycore_pr_err(mc, "%s: Failed to send write request: %s\n",
+                        manycore_pr_err(mc, "%s: Failed to send write requests: %s\n",
                                         __func__, hb_mc_strerror(err));
                         return err;
                 }
+        }
 
-                // increment EPA by 1: (EPA's address words)
-                hb_mc_npa_set_epa(&addr, hb_mc_npa_get_epa(&addr) + sizeof(uint32_t));
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Stream write requests copying one buffer to a list of NPA extents without fencing
+ * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  extents    A vector of NPA extents, each a multiple of 4 bytes in size
+ * @param[in]  n_extents  The number of extents
+ * @param[in]  data       A buffer to be written out to the extents
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_write_mem_extents_nofence(hb_mc_manycore_t *mc,
+                                             const hb_mc_npa_extent_t *extents,
+                                             size_t n_extents,
+                                             const void *data)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, hb_mc_manycore_extents_trace_bytes(extents, n_extents));
+        int err;
+
+        err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, 0);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = hb_mc_manycore_extents_check_args(mc, __func__, extents, n_extents);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* a single extent has nothing to interleave */
+        if (n_extents == 1)
+                return hb_mc_manycore_write_mem_nofence(mc, &extents[0].npa, data, extents[0].sz);
+
+        const uint32_t *words = (const uint32_t*)data;
+        hb_mc_manycore_extent_schedule<hb_mc_npa_extent_t> schedule(extents, n_extents,
+                                                                    hb_mc_manycore_get_bulk_order(mc));
+        return hb_mc_manycore_write_extents_nofence(mc, schedule,
+                                                    [&](size_t e, size_t w) {
+                                                            return &words[schedule.offset(e) + w];
+                                                    });
+}
+
+/**
+ * Stream write requests setting a list of NPA extents to a value without fencing
+ * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  extents    A vector of NPA extents, each a multiple of 4 bytes in size
+ * @param[in]  n_extents  The number of extents
+ * @param[in]  val        Value to be written out
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_memset_extents_nofence(hb_mc_manycore_t *mc,
+                                          const hb_mc_npa_extent_t *extents,
+                                          size_t n_extents,
+                                          uint8_t val)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, hb_mc_manycore_extents_trace_bytes(extents, n_extents));
+        int err;
+
+        err = hb_mc_manycore_extents_check_args(mc, __func__, extents, n_extents);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        /* a single extent has nothing to interleave */
+        if (n_extents == 1)
+                return hb_mc_manycore_memset_nofence(mc, &extents[0].npa, val, extents[0].sz);
+
+        const uint32_t word = (val << 24) | (val << 16) | (val << 8) | val;
+        hb_mc_manycore_extent_schedule<hb_mc_npa_extent_t> schedule(extents, n_extents,
+                                                                    hb_mc_manycore_get_bulk_order(mc));
+        return hb_mc_manycore_write_extents_nofence(mc, schedule,
+                                                    [&](size_t e, size_t w) { return &word; });
+}
+
+/* the number of bytes in a vectored transfer, or 0 if it will not be traced */
+static uint64_t hb_mc_manycore_iovec_trace_bytes(const hb_mc_manycore_iovec_t *iov, size_t iovcnt)
+{
+        uint64_t bytes = 0;
+        if (!hb_mc_api_trace_is_enabled() || iov == NULL)
+                return 0;
+        for (size_t i = 0; i < iovcnt; i++)
+                bytes += iov[i].len;
+        return bytes;
+}
+
+/* checks the segments of a vectored transfer */
+static int hb_mc_manycore_iovec_check_args(hb_mc_manycore_t *mc,
+                                           const char *caller_name,
+                                           const hb_mc_manycore_iovec_t *iov,
+                                           size_t iovcnt)
+{
+        for (size_t i = 0; i < iovcnt; i++) {
+                int err = hb_mc_manycore_read_write_mem_check_args(mc, caller_name,
+                                                                   iov[i].base, iov[i].len);
+                if (err != HB_MC_SUCCESS)
+                        return err;
         }
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Write a list of host buffers to a list of NPAs
+ * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  iov     Segments, each a host buffer and the NPA it is written to
+ * @param[in]  iovcnt  The number of segments
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_writev(hb_mc_manycore_t *mc, const hb_mc_manycore_iovec_t *iov, size_t iovcnt)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, hb_mc_manycore_iovec_trace_bytes(iov, iovcnt));
+        int err;
+
+        err = hb_mc_manycore_iovec_check_args(mc, __func__, iov, iovcnt);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        hb_mc_manycore_extent_schedule<hb_mc_manycore_iovec_t> schedule(iov, iovcnt,
+                                                                        hb_mc_manycore_get_bulk_order(mc));
+
+        hb_mc_manycore_bulk_transfer bulk(mc);
+
+        /* every segment goes out in one packet stream behind one fence */
+        err = hb_mc_manycore_write_extents_nofence(mc, schedule,
+                                                   [&](size_t e, size_t w) {
+                                                           return &static_cast<const uint32_t*>(iov[e].base)[w];
+                                                   });
+        if (err != HB_MC_SUCCESS)
+                return err;
 
         err = hb_mc_manycore_host_request_fence(mc, -1);
         if (err != HB_MC_SUCCESS)
                 return err;
 
-        hb_mc_platform_finish_bulk_transfer(mc);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Set memory to a given value starting at a given NPA
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t
+ * @param[in]  val    Value to be written out
+ * @param[in]  sz     The number of bytes to write to manycore hardware
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_memset(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                          uint8_t val, size_t sz)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
+        int err;
+
+        hb_mc_manycore_bulk_transfer bulk(mc);
+
+        err = hb_mc_manycore_memset_nofence(mc, npa, val, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        err = hb_mc_manycore_host_request_fence(mc, -1);
+        if (err != HB_MC_SUCCESS)
+                return err;
 
         return HB_MC_SUCCESS;
 }
 
 /**
  * Perform #cnt loads from a series of NPAs and return results in an associative container #data.
- * After returning success, #data[i] shall be the data read from the NPA given by #npa(i)
- * for i >= 0 and i < cnt.
+ * Load i is sent to the NPA returned by #npa(i, &slot), and after returning success
+ * #data[slot] shall be the data read from it, for i >= 0 and i < cnt. #npa is called
+ * with increasing i, and must map the loads one to one onto slots less than #cnt.
+ *
+ * Responses may arrive in any order. The load id of each one is reused for the
+ * next load as soon as it is received, so the loads in flight stay at the
+ * remote load cap for the whole of the read rather than draining between rounds.
  *
  * @tparam UINT               The unsigned integer type for data loads.
  * @tparam UINTV              An associative container of UNT words (indexed by i).
- * @tparam NPA_OF_I_FUNCTION  Returns an NPA given an index i.
+ * @tparam NPA_OF_I_FUNCTION  Returns an NPA and a slot in #data given an index i.
  *
  * @param[in]  mc    A manycore instance.
- * @param[in]  npa   A function that takes an index i and returns an NPA.
+ * @param[in]  npa   A function that takes an index i, returns an NPA, and sets the slot of its data.
  * @param[out] data  A mutable associative container by which load data is returned.
  * @param[in]  cnt   The number of loads to perform.
  *
@@ -1041,96 +2228,115 @@ static int hb_mc_manycore_read_mem_internal(hb_mc_manycore_t *mc,
                                             NPA_OF_I_FUNCTION npa,
                                             UINTV & data, size_t cnt)
 {
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
         size_t rsp_i = 0, rqst_i = 0;
-        uint32_t occupancy;
-        unsigned n_ids;
         int err;
 
-        /* cap the number of load ids to the maximum number of pending requests */
-        n_ids = hb_mc_config_get_io_remote_load_cap(cfg);
+        hb_mc_manycore_load_engine_t scratch;
+        hb_mc_manycore_load_engine_t *engine = hb_mc_manycore_load_engine(mc, &scratch);
 
-        hb_mc_platform_start_bulk_transfer(mc);
+        /* requests are formatted into pkts and responses are received back into it */
+        hb_mc_packet_t pkts[HB_MC_REMOTE_LOAD_MAX];
 
-        /* track requests and responses with ids and id_to_rsp_i */
-        std::stack <uint32_t, std::vector<uint32_t> > ids;
-        for (int i = n_ids - 1; i >= 0; i--)
-                ids.push(static_cast<uint32_t>(i));
+        hb_mc_manycore_bulk_transfer bulk(mc);
 
-        std::map<uint32_t, uint32_t> id_to_rsp_i;
-        hb_mc_npa_t id_to_npa[n_ids];
+        /* with host threads, load ids come from a pool shared with other readers */
+        hb_mc_manycore_io_load_ids held(mc);
+
+        /* the load ids free to send a request with, and those with a response to come */
+        uint32_t free = mc->io ? 0 : engine->ids;
+        uint32_t pending = 0;
 
         /* until we've received all responses... */
         while (rsp_i < cnt) {
+                /* with host threads, take load ids for the loads not yet sent */
+                if (mc->io) {
+                        size_t unsent = cnt - rqst_i;
+                        size_t held_ids = __builtin_popcount(free) + __builtin_popcount(pending);
+                        size_t want = std::min<size_t>(unsent - std::min<size_t>(unsent, __builtin_popcount(free)),
+                                                       engine->n_ids - held_ids);
+                        if (want != 0)
+                                free |= pending == 0 ? held.acquire(want) : held.try_acquire(want);
+                }
 
-                /* try to request as many words as we have left */
-                while (rqst_i < cnt) {
-                        // get the NPA of the next load address
-                        hb_mc_npa_t rqst_addr = npa(rqst_i);
-
-                        // if we're out of load ids, break to start reading requests
-                        if (ids.empty())
-                                break;
+                /* send a request with every free load id */
+                size_t n_rqsts = 0;
+                for (; rqst_i < cnt && free != 0; free &= free - 1) {
+                        uint32_t rqst_load_id = __builtin_ctz(free);
 
-                        // get an available load id for this load request
-                        uint32_t rqst_load_id = ids.top();
+                        // get the NPA of the next load address
+                        size_t rqst_slot;
+                        hb_mc_npa_t rqst_addr = npa(rqst_i, &rqst_slot);
 
-                        // save which request this is
-                        id_to_rsp_i[rqst_load_id] = rqst_i;
-                        id_to_npa[rqst_load_id] = rqst_addr;
-
-                        // send a load request
-                        err = hb_mc_manycore_send_read_rqst(mc, &rqst_addr, sizeof(UINT),
-                                                            rqst_load_id);
-                        if (err == HB_MC_SUCCESS) {
-                                // success; increment succesful requests and pop the load id
-                                rqst_i++;
-                                ids.pop();
-                        } else if (err == HB_MC_BUSY) {
-                                // if we're busy, break to start reading requests
-                                break;
-                        } else {
-                                // we've hit some other error: abort with an error message
-                                manycore_pr_err(mc, "%s: Failed to send read request: %s\n",
+                        err = hb_mc_manycore_format_read_rqst(mc, &pkts[n_rqsts].request,
+                                                              &rqst_addr, sizeof(UINT),
+                                                              rqst_load_id);
+                        if (err != HB_MC_SUCCESS) {
+                                manycore_pr_err(mc, "%s: Failed to format read request: %s\n",
                                                 __func__, hb_mc_strerror(err));
                                 return err;
                         }
-                        manycore_pr_dbg(mc, "%s: Sent read request with load_id = %" PRIu32 "\n",
-                                        __func__, rqst_load_id);
+
+                        // save which request this is
+                        engine->slot[rqst_load_id] = rqst_slot;
+                        pending |= 1u << rqst_load_id;
+                        rqst_i++;
+                        n_rqsts++;
                 }
 
-                /* read all available response packets */
-                while (rsp_i < rqst_i) {
-                        /* read a response and write it back to the location marked by load_id */
-                        uint32_t read_data, load_id;
-                        err = hb_mc_manycore_recv_read_rsp(mc, &read_data, &load_id);
+                if (n_rqsts != 0) {
+                        err = hb_mc_manycore_request_tx_batch(mc, pkts, n_rqsts);
                         if (err != HB_MC_SUCCESS) {
-                                manycore_pr_err(mc, "%s: Failed to receive read response: %s\n",
+                                manycore_pr_err(mc, "%s: Failed to send read requests: %s\n",
                                                 __func__, hb_mc_strerror(err));
                                 return err;
                         }
 
+                        manycore_pr_dbg(mc, "%s: Sent %zu read requests\n", __func__, n_rqsts);
+                }
+
+                /* receive the responses that have arrived, waiting for at least one */
+                size_t n_rsps;
+                if (mc->io) {
+                        err = hb_mc_manycore_io_receive_responses(mc, pending, pkts,
+                                                                  __builtin_popcount(pending),
+                                                                  &n_rsps);
+                } else {
+                        err = hb_mc_platform_receive_batch(mc, pkts, __builtin_popcount(pending),
+                                                           &n_rsps, HB_MC_FIFO_RX_RSP, -1);
+                }
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to receive read responses: %s\n",
+                                        __func__, hb_mc_strerror(err));
+                        return err;
+                }
+
+                for (size_t p = 0; p < n_rsps; p++) {
+                        /* write each response back to the location marked by load_id */
+                        const hb_mc_response_packet_t *rsp = &pkts[p].response;
+                        uint32_t read_data = hb_mc_response_packet_get_data(rsp);
+                        uint32_t load_id = hb_mc_response_packet_get_load_id(rsp);
+
                         manycore_pr_dbg(mc, "%s: Received response for load_id = %" PRIu32 "\n",
                                         __func__, load_id);
 
                         // this should never happen unless something is messed up in hardware
-                        if (load_id >= n_ids) {
+                        if (load_id >= engine->n_ids) {
                                 manycore_pr_err(mc, "%s: Bad load id = %" PRIu32 "\n",
                                                 __func__, load_id);
                                 return HB_MC_FAIL;
                         }
 
                         // This would be an unexpected response
-                        if (id_to_rsp_i.count(load_id) == 0) {
+                        if (!(pending & (1u << load_id))) {
                                 manycore_pr_err(mc, "%s: Unexpected load id = %" PRIu32 "\n",
                                                 __func__, load_id);
                                 return HB_MC_FAIL;
                         }
-                        uint32_t idx = id_to_rsp_i[load_id];
-                        
+                        size_t idx = engine->slot[load_id];
+
                         // This would be a runtime writer error... or worse.
-                        if (idx > cnt) {
-                                manycore_pr_err(mc, "%s: Return index outside of array. Idx = %" PRIu32 "\n",
+                        if (idx >= cnt) {
+                                manycore_pr_err(mc, "%s: Return index outside of array. Idx = %zu\n",
                                                 __func__, idx);
                                 return HB_MC_FAIL;
                         }
@@ -1140,15 +2346,40 @@ static int hb_mc_manycore_read_mem_internal(hb_mc_manycore_t *mc,
                         // increment succesful responses
                         rsp_i++;
 
-                        // push the load id onto the stack so we can use it again
-                        ids.push(load_id);
+                        // the load id is free again: reuse it for the next request,
+                        // unless no loads are left or another reader is waiting for it
+                        pending &= ~(1u << load_id);
+                        if (!mc->io)
+                                free |= 1u << load_id;
+                        else if (rqst_i == cnt)
+                                held.release(1u << load_id);
+                        else if (!held.hand_over(1u << load_id))
+                                free |= 1u << load_id;
                 }
         }
-        hb_mc_platform_finish_bulk_transfer(mc);
-
         return HB_MC_SUCCESS;
 }
 
+/* read consecutive words starting at an NPA */
+static int hb_mc_manycore_read_mem_words(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                         uint32_t *words, size_t n_words)
+{
+        /* ith NPA => first NPA + i words */
+        struct npa_function {
+                const hb_mc_npa_t *npa;
+                npa_function(const hb_mc_npa_t *npa) : npa(npa) {}
+                hb_mc_npa_t operator()(size_t i, size_t *slot) {
+                        *slot = i;
+                        return hb_mc_npa_from_x_y(hb_mc_npa_get_x(npa),
+                                                  hb_mc_npa_get_y(npa),
+                                                  hb_mc_npa_get_epa(npa) +
+                                                  i*sizeof(uint32_t));
+                }
+        };
+
+        return hb_mc_manycore_read_mem_internal<uint32_t>(mc, npa_function(npa), words, n_words);
+}
+
 /**
  * Read memory from a vector of NPAs
  * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
@@ -1160,16 +2391,122 @@ static int hb_mc_manycore_read_mem_internal(hb_mc_manycore_t *mc,
 int hb_mc_manycore_read_mem_scatter_gather(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                                            uint32_t *data, size_t words)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, words * sizeof(uint32_t));
         /* ith NPA => npa[i] */
         struct npa_function {
                 const hb_mc_npa_t *npa;
                 npa_function(const hb_mc_npa_t *npa) : npa(npa) {}
-                hb_mc_npa_t operator()(size_t i) { return npa[i]; }
+                hb_mc_npa_t operator()(size_t i, size_t *slot) { *slot = i; return npa[i]; }
         };
 
         return hb_mc_manycore_read_mem_internal<uint32_t>(mc, npa_function(npa), data, words);
 }
 
+/**
+ * Read memory from a list of NPA extents into one contiguous buffer
+ * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  extents    A vector of NPA extents, each a multiple of 4 bytes in size
+ * @param[in]  n_extents  The number of extents
+ * @param[out] data       A buffer into which the extents will be read back to back
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_read_mem_extents(hb_mc_manycore_t *mc,
+                                    const hb_mc_npa_extent_t *extents,
+                                    size_t n_extents,
+                                    void *data)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, hb_mc_manycore_extents_trace_bytes(extents, n_extents));
+        int err;
+        size_t n_words = 0;
+
+        for (size_t i = 0; i < n_extents; i++) {
+                err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, extents[i].sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                n_words += extents[i].sz >> 2;
+        }
+
+        uint32_t *words = static_cast<uint32_t*>(data);
+
+        /* a single extent has nothing to interleave */
+        if (n_extents == 1)
+                return hb_mc_manycore_read_mem_words(mc, &extents[0].npa, words, n_words);
+
+        /* ith NPA => the next word in bulk order */
+        /* loads are requested in increasing order so the schedule is walked once */
+        hb_mc_manycore_extent_schedule<hb_mc_npa_extent_t> schedule(extents, n_extents,
+                                                                    hb_mc_manycore_get_bulk_order(mc));
+        struct npa_function {
+                hb_mc_manycore_extent_schedule<hb_mc_npa_extent_t> *schedule;
+                npa_function(hb_mc_manycore_extent_schedule<hb_mc_npa_extent_t> *schedule) : schedule(schedule) {}
+                hb_mc_npa_t operator()(size_t i, size_t *slot) {
+                        size_t extent, word;
+                        hb_mc_npa_t npa = schedule->next(&extent, &word);
+                        *slot = schedule->offset(extent) + word;
+                        return npa;
+                }
+        };
+
+        return hb_mc_manycore_read_mem_internal<uint32_t>(mc, npa_function(&schedule), words, n_words);
+}
+
+/**
+ * Read a list of NPAs into a list of host buffers
+ * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  iov     Segments, each the NPA to read and the host buffer it is read into
+ * @param[in]  iovcnt  The number of segments
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_manycore_readv(hb_mc_manycore_t *mc, const hb_mc_manycore_iovec_t *iov, size_t iovcnt)
+{
+        HB_MC_API_TRACE_SCOPE("manycore", mc, hb_mc_manycore_iovec_trace_bytes(iov, iovcnt));
+        int err;
+
+        err = hb_mc_manycore_iovec_check_args(mc, __func__, iov, iovcnt);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        hb_mc_manycore_extent_schedule<hb_mc_manycore_iovec_t> schedule(iov, iovcnt,
+                                                                        hb_mc_manycore_get_bulk_order(mc));
+
+        /* ith NPA => the next word in bulk order, slotted among the words of all segments */
+        struct npa_function {
+                hb_mc_manycore_extent_schedule<hb_mc_manycore_iovec_t> *schedule;
+                npa_function(hb_mc_manycore_extent_schedule<hb_mc_manycore_iovec_t> *schedule) : schedule(schedule) {}
+                hb_mc_npa_t operator()(size_t i, size_t *slot) {
+                        size_t extent, word;
+                        hb_mc_npa_t npa = schedule->next(&extent, &word);
+                        *slot = schedule->offset(extent) + word;
+                        return npa;
+                }
+        };
+
+        /* slot => the last segment starting at or before it, which is never empty */
+        struct segment_words {
+                const hb_mc_manycore_iovec_t *iov;
+                const hb_mc_manycore_extent_schedule<hb_mc_manycore_iovec_t> *schedule;
+                size_t iovcnt;
+                segment_words(const hb_mc_manycore_iovec_t *iov,
+                              const hb_mc_manycore_extent_schedule<hb_mc_manycore_iovec_t> *schedule,
+                              size_t iovcnt) : iov(iov), schedule(schedule), iovcnt(iovcnt) {}
+                uint32_t &operator[](size_t slot) {
+                        size_t lo = 0, hi = iovcnt;
+                        while (hi - lo > 1) {
+                                size_t mid = lo + (hi - lo) / 2;
+                                if (schedule->offset(mid) <= slot)
+                                        lo = mid;
+                                else
+                                        hi = mid;
+                        }
+                        return static_cast<uint32_t*>(iov[lo].base)[slot - schedule->offset(lo)];
+                }
+        } words(iov, &schedule, iovcnt);
+
+        return hb_mc_manycore_read_mem_internal<uint32_t>(mc, npa_function(&schedule), words,
+                                                          schedule.words());
+}
+
 /**
  * Read memory from manycore hardware starting at a given NPA
  * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
@@ -1181,28 +2518,14 @@ int hb_mc_manycore_read_mem_scatter_gather(hb_mc_manycore_t *mc, const hb_mc_npa
 int hb_mc_manycore_read_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                             void *data, size_t sz)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
         int err;
 
         err = hb_mc_manycore_read_write_mem_check_args(mc, __func__, data, sz);
         if (err != HB_MC_SUCCESS)
                 return err;
 
-        uint32_t *words = static_cast<uint32_t*>(data);
-        size_t n_words = sz >> 2;
-
-        /* ith NPA => first NPA + i words */
-        struct npa_function {
-                const hb_mc_npa_t *npa;
-                npa_function(const hb_mc_npa_t *npa) : npa(npa) {}
-                hb_mc_npa_t operator()(size_t i) {
-                        return hb_mc_npa_from_x_y(hb_mc_npa_get_x(npa),
-                                                  hb_mc_npa_get_y(npa),
-                                                  hb_mc_npa_get_epa(npa) +
-                                                  i*sizeof(uint32_t));
-                }
-        };
-
-        return hb_mc_manycore_read_mem_internal<uint32_t>(mc, npa_function(npa), words, n_words);
+        return hb_mc_manycore_read_mem_words(mc, npa, static_cast<uint32_t*>(data), sz >> 2);
 }
 
 /**
@@ -1360,6 +2683,7 @@ int hb_mc_manycore_supports_dma_write(const hb_mc_manycore_t *mc)
 int hb_mc_manycore_dma_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                              const void *data, size_t sz)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
         int err;
         if (!hb_mc_manycore_supports_dma_write(mc))
                 return HB_MC_INVALID;
@@ -1390,6 +2714,7 @@ int hb_mc_manycore_dma_write(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
 int hb_mc_manycore_dma_write_no_cache_ainv(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                                            const void *data, size_t sz)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
         int err;
         if (!hb_mc_manycore_supports_dma_write(mc))
                 return HB_MC_NOIMPL;
@@ -1401,6 +2726,7 @@ int hb_mc_manycore_dma_write_no_cache_ainv(hb_mc_manycore_t *mc, const hb_mc_npa
         if (!hb_mc_manycore_npa_is_dram(mc, npa))
                 return HB_MC_INVALID;
 
+        hb_mc_manycore_io_guard guard(mc);
         err = hb_mc_dma_write(mc, npa, data, sz);
         if (err != HB_MC_SUCCESS)
                 return err;
@@ -1426,6 +2752,7 @@ int hb_mc_manycore_dma_write_no_cache_ainv(hb_mc_manycore_t *mc, const hb_mc_npa
 int hb_mc_manycore_dma_read_no_cache_afl(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                                          void *data, size_t sz)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
         int err;
         if (!hb_mc_manycore_supports_dma_read(mc))
                 return HB_MC_NOIMPL;
@@ -1437,6 +2764,7 @@ int hb_mc_manycore_dma_read_no_cache_afl(hb_mc_manycore_t *mc, const hb_mc_npa_t
         if (!hb_mc_manycore_npa_is_dram(mc, npa))
                 return HB_MC_INVALID;
 
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_dma_read(mc, npa, data, sz);
 }
 
@@ -1461,6 +2789,7 @@ int hb_mc_manycore_dma_read_no_cache_afl(hb_mc_manycore_t *mc, const hb_mc_npa_t
 int hb_mc_manycore_dma_read(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                             void *data, size_t sz)
 {
+        HB_MC_API_TRACE_SCOPE("manycore", mc, sz);
         int err;
         if (!hb_mc_manycore_supports_dma_read(mc))
                 return HB_MC_NOIMPL;
@@ -1486,6 +2815,7 @@ int hb_mc_manycore_dma_read(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_get_icount(hb_mc_manycore_t *mc, bsg_instr_type_e itype, int *count){
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_get_icount(mc, itype, count);
 }
 
@@ -1495,6 +2825,7 @@ int hb_mc_manycore_get_icount(hb_mc_manycore_t *mc, bsg_instr_type_e itype, int
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_trace_enable(hb_mc_manycore_t *mc){
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_trace_enable(mc);
 }
 
@@ -1504,6 +2835,7 @@ int hb_mc_manycore_trace_enable(hb_mc_manycore_t *mc){
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_trace_disable(hb_mc_manycore_t *mc){
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_trace_disable(mc);
 }
 
@@ -1513,6 +2845,7 @@ int hb_mc_manycore_trace_disable(hb_mc_manycore_t *mc){
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_log_enable(hb_mc_manycore_t *mc){
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_log_enable(mc);
 }
 
@@ -1522,5 +2855,6 @@ int hb_mc_manycore_log_enable(hb_mc_manycore_t *mc){
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_manycore_log_disable(hb_mc_manycore_t *mc){
+        hb_mc_manycore_io_guard guard(mc);
         return hb_mc_platform_log_disable(mc);
 }
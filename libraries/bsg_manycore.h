@@ -56,9 +56,25 @@ extern "C" {
                 hb_mc_config_t config; //!< configuration of the manycore
                 void *platform;        //!< machine-specific data pointer
                 int dram_enabled;      //!< operating in no-dram mode?
+                size_t write_fence_window;     //!< bytes streamed between fences by bulk writes (0: one fence per call)
+                int bulk_order;                //!< order in which bulk transfers visit their destinations (see hb_mc_manycore_bulk_order_t)
+                uint64_t request_packets_tx;   //!< number of request packets transmitted
+                uint64_t host_request_fences;  //!< number of host request fences performed
+                void *io;              //!< packet I/O state shared by host threads (NULL if single-threaded)
+                void *eva_plan;        //!< default EVA map translation plan (see hb_mc_eva_plan_init())
+                void *loads;           //!< load id tracking shared by reads
         } hb_mc_manycore_t;
 
 #define HB_MC_MANYCORE_INIT {0}
+
+        /**
+         * The order in which bulk transfers spanning several NPA extents send their packets.
+         */
+        typedef enum hb_mc_manycore_bulk_order {
+                HB_MC_MANYCORE_BULK_ORDER_INTERLEAVED = 0, //!< round-robin one word at a time across destinations (default)
+                HB_MC_MANYCORE_BULK_ORDER_LINEAR = 1,      //!< send each extent in full before the next
+        } hb_mc_manycore_bulk_order_t;
+
         /*********************/
         /* Configuration API */
         /*********************/
@@ -77,6 +93,46 @@ extern "C" {
                 return &mc->config;
         }
 
+        /**
+         * Set the number of bytes bulk EVA writes stream before fencing
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  bytes  Bytes to stream between fences. 0 fences once at the end of each call.
+         */
+        static inline void hb_mc_manycore_set_write_fence_window(hb_mc_manycore_t *mc, size_t bytes)
+        {
+                mc->write_fence_window = bytes;
+        }
+
+        /**
+         * Get the number of bytes bulk EVA writes stream before fencing
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @return The fence window in bytes. 0 means one fence at the end of each call.
+         */
+        static inline size_t hb_mc_manycore_get_write_fence_window(const hb_mc_manycore_t *mc)
+        {
+                return mc->write_fence_window;
+        }
+
+        /**
+         * Set the order in which bulk transfers send packets to their destinations
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  order  HB_MC_MANYCORE_BULK_ORDER_INTERLEAVED or HB_MC_MANYCORE_BULK_ORDER_LINEAR
+         */
+        static inline void hb_mc_manycore_set_bulk_order(hb_mc_manycore_t *mc, hb_mc_manycore_bulk_order_t order)
+        {
+                mc->bulk_order = order;
+        }
+
+        /**
+         * Get the order in which bulk transfers send packets to their destinations
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @return The bulk transfer order.
+         */
+        static inline hb_mc_manycore_bulk_order_t hb_mc_manycore_get_bulk_order(const hb_mc_manycore_t *mc)
+        {
+                return (hb_mc_manycore_bulk_order_t)mc->bulk_order;
+        }
+
         ///////////////////
         // Init/Exit API //
         ///////////////////
@@ -98,6 +154,54 @@ extern "C" {
         __attribute__((warn_unused_result))
         int hb_mc_manycore_exit(hb_mc_manycore_t *mc);
 
+        //////////////////////
+        // Host Threads API //
+        //////////////////////
+
+        /**
+         * Make a manycore instance safe to drive from several host threads at once.
+         * Calls into the platform are serialized, each read receives the responses
+         * to its own load requests, and request packets from a pod's tiles are
+         * received by the thread bound to that pod with hb_mc_manycore_thread_bind_pod(),
+         * or by any unbound thread if there is none.
+         * Must be called before other threads start using #mc.
+         * @param[in] mc   A manycore instance initialized with hb_mc_manycore_init()
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_enable_threads(hb_mc_manycore_t *mc);
+
+        /**
+         * Bind the calling thread to a pod, so that it receives the request packets sent by that pod's tiles.
+         * @param[in] mc   A manycore instance with threads enabled by hb_mc_manycore_enable_threads()
+         * @param[in] pod  The coordinate of a pod with no thread bound to it
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_thread_bind_pod(hb_mc_manycore_t *mc, hb_mc_coordinate_t pod);
+
+        /**
+         * Unbind the calling thread from its pod, if any.
+         * Requests from the pod that it has not received are handed to unbound threads.
+         * @param[in] mc   A manycore instance with threads enabled by hb_mc_manycore_enable_threads()
+         */
+        void hb_mc_manycore_thread_unbind_pod(hb_mc_manycore_t *mc);
+
+        /**
+         * Tell the platform that a sequence of bulk transfers is starting.
+         * Calls may nest; only the outermost pair reaches the platform.
+         * @param[in] mc   A manycore instance initialized with hb_mc_manycore_init()
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        int hb_mc_manycore_start_bulk_transfer(hb_mc_manycore_t *mc);
+
+        /**
+         * Tell the platform that a sequence of bulk transfers is done.
+         * @param[in] mc   A manycore instance initialized with hb_mc_manycore_init()
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        int hb_mc_manycore_finish_bulk_transfer(hb_mc_manycore_t *mc);
+
         ////////////////
         // Packet API //
         ////////////////
@@ -277,6 +381,122 @@ extern "C" {
         int hb_mc_manycore_write_mem(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                                      const void *data, size_t sz);
 
+        /**
+         * Stream write requests for a buffer starting at a given NPA without fencing.
+         * The caller must bracket a series of these calls with
+         * hb_mc_platform_start_bulk_transfer() / hb_mc_platform_finish_bulk_transfer()
+         * and call hb_mc_manycore_host_request_fence() before relying on the data.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa    A valid hb_mc_npa_t
+         * @param[in]  data   A buffer to be written out manycore hardware
+         * @param[in]  sz     The number of bytes to write to manycore hardware
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_write_mem_nofence(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                             const void *data, size_t sz);
+
+        /**
+         * Stream write requests setting memory to a value starting at a given NPA without fencing.
+         * The same rules as hb_mc_manycore_write_mem_nofence() apply.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa    A valid hb_mc_npa_t
+         * @param[in]  val    Value to be written out
+         * @param[in]  sz     The number of bytes to write to manycore hardware
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_memset_nofence(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
+                                          uint8_t val, size_t sz);
+
+        /**
+         * Stream write requests copying one buffer to several NPAs without fencing.
+         * Word i is sent to every NPA before word i+1 is sent to any, so that
+         * the destinations receive their data in parallel.
+         * The same rules as hb_mc_manycore_write_mem_nofence() apply.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npas   Valid hb_mc_npa_t destinations
+         * @param[in]  n      The number of destinations
+         * @param[in]  data   A buffer to be written out to each destination
+         * @param[in]  sz     The number of bytes to write to each destination
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_write_mem_interleaved_nofence(hb_mc_manycore_t *mc,
+                                                         const hb_mc_npa_t *npas, size_t n,
+                                                         const void *data, size_t sz);
+
+        /**
+         * Stream write requests setting memory to a value at several NPAs without fencing.
+         * Destinations are interleaved as by hb_mc_manycore_write_mem_interleaved_nofence().
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npas   Valid hb_mc_npa_t destinations
+         * @param[in]  n      The number of destinations
+         * @param[in]  val    Value to be written out
+         * @param[in]  sz     The number of bytes to write to each destination
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_memset_interleaved_nofence(hb_mc_manycore_t *mc,
+                                                      const hb_mc_npa_t *npas, size_t n,
+                                                      uint8_t val, size_t sz);
+
+        /**
+         * Stream write requests copying one buffer to a list of NPA extents without fencing.
+         * The buffer is laid over the extents back to back. Packets are sent in the
+         * bulk order of #mc: interleaved order round-robins one word at a time across
+         * the distinct destinations of the extents, so that every cache behind them is
+         * kept busy instead of one at a time.
+         * The same rules as hb_mc_manycore_write_mem_nofence() apply.
+         * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  extents    A vector of NPA extents, each a multiple of 4 bytes in size
+         * @param[in]  n_extents  The number of extents
+         * @param[in]  data       A buffer to be written out to the extents
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_write_mem_extents_nofence(hb_mc_manycore_t *mc,
+                                                     const hb_mc_npa_extent_t *extents,
+                                                     size_t n_extents,
+                                                     const void *data);
+
+        /**
+         * Stream write requests setting a list of NPA extents to a value without fencing.
+         * Packets are ordered as by hb_mc_manycore_write_mem_extents_nofence().
+         * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  extents    A vector of NPA extents, each a multiple of 4 bytes in size
+         * @param[in]  n_extents  The number of extents
+         * @param[in]  val        Value to be written out
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_memset_extents_nofence(hb_mc_manycore_t *mc,
+                                                  const hb_mc_npa_extent_t *extents,
+                                                  size_t n_extents,
+                                                  uint8_t val);
+
+        /**
+         * One segment of a vectored transfer: a host buffer and the NPA it is
+         * transferred to or from.
+         */
+        typedef struct hb_mc_manycore_iovec {
+                hb_mc_npa_t npa;  //!< the first NPA of the segment
+                void       *base; //!< the host buffer, aligned to 4 bytes
+                size_t      len;  //!< the size of the segment in bytes, a multiple of 4
+        } hb_mc_manycore_iovec_t;
+
+        /**
+         * Write a list of host buffers to a list of NPAs.
+         * The segments are sent as one packet stream, in the bulk order of #mc,
+         * followed by one fence. If segments overlap, later segments win.
+         * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  iov     Segments, each a host buffer and the NPA it is written to
+         * @param[in]  iovcnt  The number of segments
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_writev(hb_mc_manycore_t *mc, const hb_mc_manycore_iovec_t *iov, size_t iovcnt);
+
         /**
          * Read memory from manycore hardware starting at a given NPA
          * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
@@ -302,6 +522,33 @@ extern "C" {
         int hb_mc_manycore_read_mem_scatter_gather(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa,
                                                    uint32_t *data, size_t words);
 
+        /**
+         * Read memory from a list of NPA extents into one contiguous buffer.
+         * Loads are pipelined across extent boundaries and are issued in the
+         * bulk order of #mc (see hb_mc_manycore_write_mem_extents_nofence()).
+         * @param[in]  mc         A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  extents    A vector of NPA extents, each a multiple of 4 bytes in size
+         * @param[in]  n_extents  The number of extents
+         * @param[out] data       A buffer into which the extents will be read back to back
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_read_mem_extents(hb_mc_manycore_t *mc,
+                                            const hb_mc_npa_extent_t *extents,
+                                            size_t n_extents,
+                                            void *data);
+
+        /**
+         * Read a list of NPAs into a list of host buffers.
+         * The loads of every segment share one window of load ids.
+         * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  iov     Segments, each the NPA to read and the host buffer it is read into
+         * @param[in]  iovcnt  The number of segments
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_readv(hb_mc_manycore_t *mc, const hb_mc_manycore_iovec_t *iov, size_t iovcnt);
+
         /***********/
         /* DMA API */
         /***********/
@@ -433,6 +680,32 @@ extern "C" {
         __attribute__((warn_unused_result))
         int hb_mc_manycore_vcache_flush_npa_range(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, size_t sz);
 
+        /**
+         * Invalidate a range of manycore DRAM addresses without waiting for completion.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa    A valid hb_mc_npa_t (must map to DRAM) - start of the range to invalidate
+         * @param[in]  sz     The size of the range to invalidate in bytes
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         *
+         * One AINV packet is sent per cache line. Call hb_mc_manycore_host_request_fence()
+         * before relying on the invalidation.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_vcache_invalidate_npa_range_nofence(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, size_t sz);
+
+        /**
+         * Flush a range of manycore DRAM addresses without waiting for completion.
+         * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  npa    A valid hb_mc_npa_t (must map to DRAM) - start of the range to flush
+         * @param[in]  sz     The size of the range to flush in bytes
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         *
+         * One AFL packet is sent per cache line. Call hb_mc_manycore_host_request_fence()
+         * before relying on the flush.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_vcache_flush_npa_range_nofence(hb_mc_manycore_t *mc, const hb_mc_npa_t *npa, size_t sz);
+
         /**
          * Flush a cache tag.
          * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
@@ -0,0 +1,226 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <bsg_manycore_api_trace.h>
+#include <bsg_manycore_errno.h>
+#include <bsg_manycore_printing.h>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+volatile int hb_mc_api_trace_enabled = 0;
+
+typedef struct api_trace_event {
+        const char *category;
+        const char *name;
+        uint64_t begin_ns;
+        uint64_t end_ns;
+        uint64_t begin_cycle;
+        uint64_t end_cycle;
+        uint64_t bytes;
+} api_trace_event;
+
+/*
+ * Events recorded by one thread. Only the owning thread appends, so no
+ * lock is taken on the recording path; a std::deque never moves an
+ * element once it has been appended. The buffer outlives its thread so
+ * that events recorded by worker threads still appear in the dump.
+ */
+typedef struct api_trace_buffer {
+        unsigned tid;
+        std::deque<api_trace_event> events;
+} api_trace_buffer;
+
+/*
+ * Global state is lazily allocated, as the responder list is, because
+ * static constructors in other objects may record events before ours
+ * have run.
+ */
+typedef struct api_trace_state {
+        std::mutex lock;
+        std::string path;
+        std::vector<api_trace_buffer *> buffers;
+        std::chrono::steady_clock::time_point epoch;
+} api_trace_state;
+
+static std::atomic<api_trace_state *> state(nullptr);
+static std::atomic<bool> cycle_unsupported(false);
+static thread_local api_trace_buffer *thread_buffer = nullptr;
+
+static api_trace_state *api_trace_get_state()
+{
+        api_trace_state *s = state.load(std::memory_order_acquire);
+        if (s != nullptr)
+                return s;
+
+        api_trace_state *n = new api_trace_state;
+        n->epoch = std::chrono::steady_clock::now();
+        if (!state.compare_exchange_strong(s, n, std::memory_order_acq_rel)) {
+                delete n;
+                return s;
+        }
+        return n;
+}
+
+static api_trace_buffer *api_trace_get_buffer()
+{
+        if (thread_buffer != nullptr)
+                return thread_buffer;
+
+        api_trace_state *s = api_trace_get_state();
+        std::lock_guard<std::mutex> guard(s->lock);
+        thread_buffer = new api_trace_buffer;
+        thread_buffer->tid = s->buffers.size();
+        s->buffers.push_back(thread_buffer);
+        return thread_buffer;
+}
+
+uint64_t hb_mc_api_trace_now(void)
+{
+        std::chrono::steady_clock::duration d = std::chrono::steady_clock::now() - api_trace_get_state()->epoch;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+uint64_t hb_mc_api_trace_cycle(hb_mc_manycore_t *mc)
+{
+        uint64_t cycle;
+
+        if (mc == nullptr || mc->platform == nullptr
+            || cycle_unsupported.load(std::memory_order_relaxed))
+                return UINT64_MAX;
+
+        if (hb_mc_manycore_get_cycle(mc, &cycle) != HB_MC_SUCCESS) {
+                cycle_unsupported.store(true, std::memory_order_relaxed);
+                return UINT64_MAX;
+        }
+
+        return cycle;
+}
+
+void hb_mc_api_trace_record(const char *category, const char *name,
+                            uint64_t begin_ns, uint64_t end_ns,
+                            uint64_t begin_cycle, uint64_t end_cycle,
+                            uint64_t bytes)
+{
+        api_trace_event event = {category, name, begin_ns, end_ns, begin_cycle, end_cycle, bytes};
+        api_trace_get_buffer()->events.push_back(event);
+}
+
+int hb_mc_api_trace_enable(const char *path)
+{
+        if (path == nullptr || path[0] == '\0') {
+                bsg_pr_err("%s: No trace file given\n", __func__);
+                return HB_MC_INVALID;
+        }
+
+        api_trace_state *s = api_trace_get_state();
+        {
+                std::lock_guard<std::mutex> guard(s->lock);
+                s->path = path;
+        }
+
+        hb_mc_api_trace_enabled = 1;
+        return HB_MC_SUCCESS;
+}
+
+void hb_mc_api_trace_disable(void)
+{
+        hb_mc_api_trace_enabled = 0;
+}
+
+static void api_trace_write_event(FILE *f, pid_t pid, unsigned tid, const api_trace_event &e, bool first)
+{
+        fprintf(f, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                "\"ts\":%" PRIu64 ".%03" PRIu64 ",\"dur\":%" PRIu64 ".%03" PRIu64 ","
+                "\"pid\":%d,\"tid\":%u,\"args\":{\"bytes\":%" PRIu64,
+                first ? "" : ",", e.name, e.category,
+                e.begin_ns / 1000, e.begin_ns % 1000,
+                (e.end_ns - e.begin_ns) / 1000, (e.end_ns - e.begin_ns) % 1000,
+                static_cast<int>(pid), tid, e.bytes);
+
+        if (e.begin_cycle != UINT64_MAX && e.end_cycle != UINT64_MAX)
+                fprintf(f, ",\"cycle_begin\":%" PRIu64 ",\"cycles\":%" PRIu64,
+                        e.begin_cycle, e.end_cycle - e.begin_cycle);
+
+        fprintf(f, "}}");
+}
+
+int hb_mc_api_trace_dump(void)
+{
+        api_trace_state *s = state.load(std::memory_order_acquire);
+        if (s == nullptr)
+                return HB_MC_SUCCESS;
+
+        std::lock_guard<std::mutex> guard(s->lock);
+        if (s->path.empty())
+                return HB_MC_SUCCESS;
+
+        FILE *f = fopen(s->path.c_str(), "w");
+        if (f == nullptr) {
+                bsg_pr_err("%s: Could not open '%s'\n", __func__, s->path.c_str());
+                return HB_MC_FAIL;
+        }
+
+        pid_t pid = getpid();
+        bool first = true;
+
+        fprintf(f, "{\"traceEvents\":[");
+        for (api_trace_buffer *b : s->buffers) {
+                for (const api_trace_event &e : b->events) {
+                        api_trace_write_event(f, pid, b->tid, e, first);
+                        first = false;
+                }
+                b->events.clear();
+        }
+        fprintf(f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+
+        if (fclose(f) != 0) {
+                bsg_pr_err("%s: Failed to write '%s'\n", __func__, s->path.c_str());
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+__attribute__((constructor))
+static void api_trace_init_from_env()
+{
+        const char *path = getenv(HB_MC_API_TRACE_ENV);
+        if (path == nullptr || path[0] == '\0')
+                return;
+
+        int err = hb_mc_api_trace_enable(path);
+        if (err != HB_MC_SUCCESS)
+                bsg_pr_err("%s: Failed to enable API tracing to '%s' from %s: %s\n",
+                           __func__, path, HB_MC_API_TRACE_ENV, hb_mc_strerror(err));
+}
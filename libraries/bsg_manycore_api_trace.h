@@ -0,0 +1,179 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#ifndef BSG_MANYCORE_API_TRACE_H
+#define BSG_MANYCORE_API_TRACE_H
+
+#include <bsg_manycore_features.h>
+#include <bsg_manycore.h>
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstddef>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+
+/*
+ * A timeline of calls into the host runtime.
+ *
+ * When enabled, the public entry points of the runtime record their
+ * begin and end times, the size of the data they were asked to move,
+ * and, where the platform has a cycle counter, the device cycle at
+ * begin and end. Events are appended to a buffer owned by the calling
+ * thread, without locking, and are written out as Chrome trace-event
+ * JSON (loadable by chrome://tracing and Perfetto) by
+ * hb_mc_api_trace_dump(). hb_mc_device_finish() dumps automatically.
+ *
+ * Tracing is enabled with hb_mc_api_trace_enable(), or by setting
+ * BSG_MANYCORE_API_TRACE to the output path before the program starts.
+ * When disabled, each entry point costs one load and one branch.
+ */
+
+#define HB_MC_API_TRACE_ENV "BSG_MANYCORE_API_TRACE"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+        extern volatile int hb_mc_api_trace_enabled;
+
+        /**
+         * Check if API tracing is enabled.
+         * @return One if tracing is enabled - Zero otherwise.
+         */
+        static inline int hb_mc_api_trace_is_enabled(void)
+        {
+                return hb_mc_api_trace_enabled;
+        }
+
+        /**
+         * Start recording API events.
+         * @param[in] path  File the trace is written to by hb_mc_api_trace_dump().
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_api_trace_enable(const char *path);
+
+        /**
+         * Stop recording API events. Recorded events are kept until dumped.
+         */
+        void hb_mc_api_trace_disable(void);
+
+        /**
+         * Write all recorded events as Chrome trace-event JSON and discard them.
+         * Threads must not be recording events while this runs.
+         * @return HB_MC_SUCCESS if succesful, or if tracing was never enabled.
+         *         Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_api_trace_dump(void);
+
+        /**
+         * Record a completed event. Use HB_MC_API_TRACE_SCOPE() instead where possible.
+         * @param[in] category     A static string naming the layer, e.g. "cuda"
+         * @param[in] name         A static string naming the event, e.g. __func__
+         * @param[in] begin_ns     Host time at the beginning of the event
+         * @param[in] end_ns       Host time at the end of the event
+         * @param[in] begin_cycle  Device cycle at the beginning, or UINT64_MAX if unknown
+         * @param[in] end_cycle    Device cycle at the end, or UINT64_MAX if unknown
+         * @param[in] bytes        Size of the data moved by the call, or 0
+         */
+        void hb_mc_api_trace_record(const char *category, const char *name,
+                                    uint64_t begin_ns, uint64_t end_ns,
+                                    uint64_t begin_cycle, uint64_t end_cycle,
+                                    uint64_t bytes);
+
+        /**
+         * Host time in nanoseconds, as used for event timestamps.
+         */
+        uint64_t hb_mc_api_trace_now(void);
+
+        /**
+         * Device cycle of #mc for event timestamps.
+         * @param[in] mc  A manycore, or NULL.
+         * @return The cycle, or UINT64_MAX if #mc is NULL or has no cycle counter.
+         */
+        uint64_t hb_mc_api_trace_cycle(hb_mc_manycore_t *mc);
+
+#ifdef __cplusplus
+}
+
+/*
+ * Records one event covering the lifetime of this object, if tracing
+ * was enabled when it was constructed.
+ */
+class hb_mc_api_trace_scope {
+public:
+        hb_mc_api_trace_scope(const char *category, const char *name,
+                              hb_mc_manycore_t *mc, uint64_t bytes = 0)
+                : active(hb_mc_api_trace_is_enabled()) {
+                if (!active)
+                        return;
+                this->category = category;
+                this->name = name;
+                this->mc = mc;
+                this->bytes = bytes;
+                begin_cycle = hb_mc_api_trace_cycle(mc);
+                begin_ns = hb_mc_api_trace_now();
+        }
+
+        ~hb_mc_api_trace_scope() {
+                end();
+        }
+
+        /* record the event now, e.g. before the trace is dumped */
+        void end() {
+                if (!active)
+                        return;
+                active = false;
+                uint64_t end_ns = hb_mc_api_trace_now();
+                uint64_t end_cycle = hb_mc_api_trace_cycle(mc);
+                hb_mc_api_trace_record(category, name, begin_ns, end_ns,
+                                       begin_cycle, end_cycle, bytes);
+        }
+
+        hb_mc_api_trace_scope(const hb_mc_api_trace_scope &) = delete;
+        hb_mc_api_trace_scope &operator=(const hb_mc_api_trace_scope &) = delete;
+
+private:
+        bool active;
+        const char *category;
+        const char *name;
+        hb_mc_manycore_t *mc;
+        uint64_t bytes;
+        uint64_t begin_ns;
+        uint64_t begin_cycle;
+};
+
+/* trace the enclosing function, from here to its return */
+#define HB_MC_API_TRACE_SCOPE(category, mc, bytes)                      \
+        hb_mc_api_trace_scope __hb_mc_api_trace_scope(category, __func__, mc, bytes)
+
+#endif
+
+#endif
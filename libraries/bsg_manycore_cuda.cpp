@@ -25,8 +25,10 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <bsg_manycore_cuda.h>
+#include <bsg_manycore_api_trace.h>
 #include <bsg_manycore_tile.h>
-#include <bsg_manycore_memory_manager.h>
+#include <bsg_manycore_vcache.h>
+#include <bsg_manycore_memory_allocator.h>
 #include <bsg_manycore_elf.h>
 #include <bsg_manycore_loader.h>
 #include <bsg_manycore.h>
@@ -41,6 +43,21 @@
 #include <string.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <mutex>
+#include <set>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <thread>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+
 
 
 ////////////////////
@@ -138,6 +155,21 @@ static int kernel_exit(hb_mc_kernel_t *kernel)
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Drop a reference to a kernel, freeing it with the last one
+ */
+__attribute__((warn_unused_result))
+static int kernel_release(hb_mc_kernel_t *kernel)
+{
+        kernel->refcount -= 1;
+        if (kernel->refcount == 0) {
+                BSG_CUDA_CALL(kernel_exit(kernel));
+                free(kernel);
+        }
+
+        return HB_MC_SUCCESS;
+}
+
 ////////////////////////
 // Tile group helpers //
 ////////////////////////
@@ -153,6 +185,8 @@ static int hb_mc_device_pod_tile_group_init(hb_mc_device_t* device,
 __attribute__((warn_unused_result))
 static int hb_mc_device_pod_tile_group_exit(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_group_t *tg);
 
+static void hb_mc_device_streams_cleanup(hb_mc_device_t *device);
+
 /////////////////////
 // Program helpers //
 /////////////////////
@@ -183,7 +217,7 @@ static int hb_mc_program_allocator_init (const hb_mc_config_t *cfg,
         program->allocator->id = id;
 
         hb_mc_eva_t program_end_eva;
-        error = hb_mc_loader_symbol_to_eva(program->bin, program->bin_size, "_bsg_dram_end_addr", &program_end_eva);
+        error = hb_mc_loader_symbol_table_lookup(program->symbols, "_bsg_dram_end_addr", &program_end_eva);
         if (error != HB_MC_SUCCESS) {
                 bsg_pr_err("%s: failed to acquire _bsg_dram_end_addr eva from binary file.\n", __func__);
                 return HB_MC_INVALID;
@@ -192,7 +226,14 @@ static int hb_mc_program_allocator_init (const hb_mc_config_t *cfg,
         uint32_t alignment = hb_mc_config_get_vcache_block_size(cfg);
         uint32_t start = program_end_eva + alignment - (program_end_eva % alignment); /* start at the next aligned block */
         size_t dram_size = hb_mc_config_get_dram_size(cfg);
-        program->allocator->memory_manager = (awsbwhal::MemoryManager *) new awsbwhal::MemoryManager(dram_size, start, alignment);
+        hb_mc_memory_allocator_t *memory_allocator;
+        error = hb_mc_memory_allocator_init(&memory_allocator, start, dram_size, alignment);
+        if (error != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to initialize memory allocator: %s\n",
+                           __func__, hb_mc_strerror(error));
+                return error;
+        }
+        program->allocator->memory_manager = memory_allocator;
 
         return HB_MC_SUCCESS;
 }
@@ -227,13 +268,13 @@ static int hb_mc_program_allocator_exit (hb_mc_allocator_t *allocator) {
 
 
         // Free memory manager
-        const awsbwhal::MemoryManager *memory_manager;
-        memory_manager = (awsbwhal::MemoryManager *) allocator->memory_manager;
+        hb_mc_memory_allocator_t *memory_manager;
+        memory_manager = (hb_mc_memory_allocator_t *) allocator->memory_manager;
         if (!memory_manager) {
                 bsg_pr_err("%s: calling exit on allocator with null memory manager.\n", __func__);
                 return HB_MC_INVALID;
         } else {
-                free ((awsbwhal::MemoryManager *) memory_manager);
+                hb_mc_memory_allocator_exit(memory_manager);
                 allocator->memory_manager = NULL;
         }
         free(allocator);
@@ -248,14 +289,17 @@ static int hb_mc_program_allocator_exit (hb_mc_allocator_t *allocator) {
 
 /**
  * Calculates and returns a tile group's finish signal address based on tile group id and grid dimension
+ * Grids with more tile groups than finish signal words wrap around; tile
+ * groups that share a word are told apart by their origin (see hb_mc_finish_key()).
  * @param[in]  device        Pointer to device
  * @parma[in]  tg            Pointer to tile group
  * @return     finish_signal_addr
  */
 static hb_mc_epa_t hb_mc_tile_group_get_finish_signal_addr(hb_mc_tile_group_t *tg) {
+        uint32_t idx = hb_mc_coordinate_get_y(tg->id) * hb_mc_dimension_get_x(tg->grid_dim)
+                + hb_mc_coordinate_get_x(tg->id);
         hb_mc_epa_t finish_addr = HB_MC_CUDA_HOST_FINISH_SIGNAL_BASE_ADDR
-                + ((hb_mc_coordinate_get_y(tg->id) * hb_mc_dimension_get_x(tg->grid_dim)
-                    + hb_mc_coordinate_get_x(tg->id)) << 2);
+                + ((idx % HB_MC_CUDA_HOST_FINISH_SIGNAL_WORDS) << 2);
         return finish_addr;
 }
 
@@ -276,35 +320,71 @@ static hb_mc_idx_t hb_mc_get_tile_id (hb_mc_coordinate_t origin, hb_mc_dimension
         return tile_id;
 }
 
-/**
- * Set a global symbol value
+/*
+ * Runtime symbols the host writes into each tile before a launch.
+ * cuda_kernel_ptr is not among them: the tile clears it when a kernel
+ * returns, so it is written on every launch.
  */
-static int tile_set_symbol_val(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_t *tile,
-                               const hb_mc_eva_map_t *map,
-                               const char *symbol, uint32_t val)
+typedef enum {
+        TILE_SYMBOL_GRP_ORG_X = 0,
+        TILE_SYMBOL_GRP_ORG_Y,
+        TILE_SYMBOL_X,
+        TILE_SYMBOL_Y,
+        TILE_SYMBOL_ID,
+        TILE_SYMBOL_TILE_GROUP_ID_X,
+        TILE_SYMBOL_TILE_GROUP_ID_Y,
+        TILE_SYMBOL_TILE_GROUP_ID,
+        TILE_SYMBOL_GRID_DIM_X,
+        TILE_SYMBOL_GRID_DIM_Y,
+        TILE_SYMBOL_FINISH_SIGNAL_VAL,
+        TILE_SYMBOL_KERNEL_NOT_LOADED_VAL,
+        TILE_SYMBOL_ARGC,
+        TILE_SYMBOL_ARGV_PTR,
+        TILE_SYMBOL_FINISH_SIGNAL_ADDR,
+        TILE_SYMBOLS,
+} tile_symbol_t;
+
+static const char *tile_symbol_names[TILE_SYMBOLS] = {
+        "__bsg_grp_org_x",
+        "__bsg_grp_org_y",
+        "__bsg_x",
+        "__bsg_y",
+        "__bsg_id",
+        "__bsg_tile_group_id_x",
+        "__bsg_tile_group_id_y",
+        "__bsg_tile_group_id",
+        "__bsg_grid_dim_x",
+        "__bsg_grid_dim_y",
+        "cuda_finish_signal_val",
+        "cuda_kernel_not_loaded_val",
+        "cuda_argc",
+        "cuda_argv_ptr",
+        "cuda_finish_signal_addr",
+};
+
+/* the tile group origin CSRs are shadowed alongside the symbols */
+#define TILE_SHADOW_CSR_ORIGIN TILE_SYMBOLS
+
+/*
+ * What the host last wrote to each tile of a pod, so that a launch only
+ * sends the words that changed. Program load overwrites tile memory and
+ * forgets everything.
+ */
+typedef struct {
+        uint32_t value[TILE_SYMBOLS];   //!< last value written to each symbol
+        hb_mc_coordinate_t csr_origin;  //!< last value written to the origin CSRs
+        uint32_t known;                 //!< bit per symbol (and the CSRs) whose value is known
+} hb_mc_tile_shadow_t;
+
+typedef struct {
+        hb_mc_eva_t eva[TILE_SYMBOLS];          //!< symbol addresses in the program
+        hb_mc_eva_t kernel_ptr_eva;             //!< address of cuda_kernel_ptr in the program
+        std::vector<hb_mc_tile_shadow_t> tiles; //!< indexed like pod->mesh->tiles
+} hb_mc_symbol_shadow_t;
+
+static hb_mc_symbol_shadow_t *pod_symbol_shadow(hb_mc_pod_t *pod)
 {
-        hb_mc_program_t *program = pod->program;
-        hb_mc_eva_t symbol_dev;
-        int r;
-
-        r = hb_mc_loader_symbol_to_eva(program->bin, program->bin_size, symbol, &symbol_dev);
-        if (r != HB_MC_SUCCESS) {
-                bsg_pr_err("%s: failed to find symbol '%s' in program '%s': %s\n",
-                           __func__,
-                           symbol,
-                           program->bin_name,
-                           hb_mc_strerror(r));
-                return r;
-        }
-
-        bsg_pr_dbg("%s: device<%s>: program:<%s>: Setting symbol '%s' @ 0x%08" PRIx32 " = %08" PRIx32 "\n",
-                   __func__, device->name, pod->program->bin_name, symbol, symbol_dev, val);
-
-        BSG_MANYCORE_CALL(device->mc,
-                          hb_mc_manycore_eva_write(device->mc, map, &tile->coord, &symbol_dev,
-                                                   &val, sizeof(val)));
-
-        return HB_MC_SUCCESS;
+        return reinterpret_cast<hb_mc_symbol_shadow_t*>(pod->symbol_shadow);
 }
 
 /**
@@ -331,41 +411,105 @@ static int tile_unfreeze(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_t
 #endif
         bsg_pr_dbg("%s: device<%s>: unfreezing tile %s\n",
                    __func__, device->name, hb_mc_coordinate_to_string(tile->coord, buf, sizeof(buf)));
-        // before unfreezing, clear kernel ptr
-        uint32_t kernel_not_loaded = HB_MC_CUDA_KERNEL_NOT_LOADED_VAL;
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, &default_map, "cuda_kernel_ptr", kernel_not_loaded));
         BSG_MANYCORE_CALL(device->mc, hb_mc_tile_unfreeze(device->mc, &tile->coord));
         return HB_MC_SUCCESS;
 }
 
 /**
- * Sets the CUDA runtime symbols for a  tile
+ * Set a shadowed runtime symbol, if the tile does not already hold #val.
+ * The write is not fenced.
+ */
+static int tile_shadow_set_symbol(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_t *tile,
+                                  const hb_mc_eva_map_t *map,
+                                  tile_symbol_t symbol, uint32_t val)
+{
+        hb_mc_symbol_shadow_t *shadow = pod_symbol_shadow(pod);
+        hb_mc_tile_shadow_t *ts = &shadow->tiles[tile - pod->mesh->tiles];
+        uint32_t bit = 1u << symbol;
+
+        if ((ts->known & bit) && ts->value[symbol] == val)
+                return HB_MC_SUCCESS;
+
+        bsg_pr_dbg("%s: device<%s>: program:<%s>: Setting symbol '%s' @ 0x%08" PRIx32 " = %08" PRIx32 "\n",
+                   __func__, device->name, pod->program->bin_name,
+                   tile_symbol_names[symbol], shadow->eva[symbol], val);
+
+        hb_mc_npa_t npa;
+        size_t sz;
+        BSG_MANYCORE_CALL(device->mc, hb_mc_eva_to_npa(device->mc, map, &tile->coord,
+                                                       &shadow->eva[symbol], &npa, &sz));
+        BSG_MANYCORE_CALL(device->mc, hb_mc_manycore_write_mem_nofence(device->mc, &npa,
+                                                                       &val, sizeof(val)));
+
+        ts->value[symbol] = val;
+        ts->known |= bit;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Set a tile's tile group origin CSRs, if they do not already hold #origin.
+ * The writes are not fenced.
+ */
+static int tile_shadow_set_origin_registers(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_t *tile,
+                                            hb_mc_coordinate_t origin)
+{
+        hb_mc_tile_shadow_t *ts = &pod_symbol_shadow(pod)->tiles[tile - pod->mesh->tiles];
+        uint32_t bit = 1u << TILE_SHADOW_CSR_ORIGIN;
+
+        if ((ts->known & bit) && hb_mc_coordinate_eq(ts->csr_origin, origin))
+                return HB_MC_SUCCESS;
+
+        BSG_MANYCORE_CALL(device->mc, hb_mc_tile_set_origin_registers(device->mc, &tile->coord, &origin));
+
+        ts->csr_origin = origin;
+        ts->known |= bit;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Sets the CUDA runtime symbols for a tile, except for the kernel pointer.
+ * The writes are not fenced.
  */
 __attribute__((warn_unused_result))
 static int tile_set_runtime_symbols(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_t *tile,
                                     const hb_mc_eva_map_t *map,
                                     uint32_t    argc,
                                     hb_mc_eva_t argv_addr,
-                                    hb_mc_npa_t finish_signal_npa,
-                                    hb_mc_eva_t kernel_addr)
+                                    hb_mc_npa_t finish_signal_npa)
 {
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "cuda_argc", argc));
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "cuda_argv_ptr", argv_addr));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_ARGC, argc));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_ARGV_PTR, argv_addr));
 
         hb_mc_eva_t finish_signal_addr;
         size_t sz;
         BSG_CUDA_CALL(hb_mc_npa_to_eva(device->mc, map, &tile->coord, &finish_signal_npa, &finish_signal_addr, &sz));
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "cuda_finish_signal_addr", finish_signal_addr));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_FINISH_SIGNAL_ADDR, finish_signal_addr));
 
-        // tiles wake-on-broken reservation on this address
-        // this write wakes up the kernel and 'launches' it
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "cuda_kernel_ptr", kernel_addr));
+        return HB_MC_SUCCESS;
+}
 
+/**
+ * Points a tile at a kernel, which wakes the tile up and launches it.
+ * The write is not fenced.
+ */
+__attribute__((warn_unused_result))
+static int tile_set_kernel_ptr(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_t *tile,
+                               const hb_mc_eva_map_t *map,
+                               hb_mc_eva_t kernel_addr)
+{
+        hb_mc_npa_t npa;
+        size_t sz;
+        BSG_MANYCORE_CALL(device->mc, hb_mc_eva_to_npa(device->mc, map, &tile->coord,
+                                                       &pod_symbol_shadow(pod)->kernel_ptr_eva,
+                                                       &npa, &sz));
+        BSG_MANYCORE_CALL(device->mc, hb_mc_manycore_write_mem_nofence(device->mc, &npa,
+                                                                       &kernel_addr, sizeof(kernel_addr)));
         return HB_MC_SUCCESS;
 }
 
 /**
- * Sets the CUDA configuration symbols for a tile
+ * Sets the CUDA configuration symbols for a tile.
+ * The writes are not fenced.
  */
 __attribute__((warn_unused_result))
 static int tile_set_config_symbols(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_mc_tile_t *tile,
@@ -376,21 +520,21 @@ static int tile_set_config_symbols(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_
                                    hb_mc_dimension_t grid_dim)
 {
         hb_mc_coordinate_t coord = hb_mc_coordinate_get_relative (origin, tile->coord);
-        BSG_MANYCORE_CALL(device->mc, hb_mc_tile_set_origin_registers(device->mc, &tile->coord, &origin));
+        BSG_CUDA_CALL(tile_shadow_set_origin_registers(device, pod, tile, origin));
 
         // Set tile's tile group origin __bsg_grp_org_x/y symbols.
         hb_mc_idx_t origin_x = hb_mc_coordinate_get_x (origin);
         hb_mc_idx_t origin_y = hb_mc_coordinate_get_y (origin);
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_grp_org_x", origin_x));
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_grp_org_y", origin_y));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_GRP_ORG_X, origin_x));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_GRP_ORG_Y, origin_y));
 
         // Set tile's index __bsg_x/y symbols.
         // A tile's __bsg_x/y symbols represent its X/Y
         // coordinates with respect to the origin tile
         hb_mc_idx_t coord_x = hb_mc_coordinate_get_x (coord);
         hb_mc_idx_t coord_y = hb_mc_coordinate_get_y (coord);
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_x", coord_x));
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_y", coord_y));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_X, coord_x));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_Y, coord_y));
 
         // Set tile's __bsg_id symbol.
         // bsg_id uniquely identifies each tile in a tile group
@@ -400,7 +544,7 @@ static int tile_set_config_symbols(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_
         // and the tile group X/Y coordiantes relative to tile group origin as follows:
         // __bsg_id = __bsg_y * __bsg_tile_group_dim_x + __bsg_x
         hb_mc_idx_t id = hb_mc_coordinate_get_y(coord) * hb_mc_dimension_get_x(tg_dim) + hb_mc_coordinate_get_x(coord);
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_id", id));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_ID, id));
 
         // Set tile's tile group index __bsg_tile_group_id_x/y symbols.
         // Grid is a 2D array of tile groups representing an application
@@ -413,27 +557,80 @@ static int tile_set_config_symbols(hb_mc_device_t *device, hb_mc_pod_t *pod, hb_
         hb_mc_idx_t tg_id_x  = hb_mc_coordinate_get_x (tg_id);
         hb_mc_idx_t tg_id_y  = hb_mc_coordinate_get_y (tg_id);
         hb_mc_idx_t tg_id_id = tg_id_y * hb_mc_dimension_get_x(grid_dim) + tg_id_x;
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_tile_group_id_x", tg_id_x));
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_tile_group_id_y", tg_id_y));
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_tile_group_id",   tg_id_id));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_TILE_GROUP_ID_X, tg_id_x));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_TILE_GROUP_ID_Y, tg_id_y));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_TILE_GROUP_ID,   tg_id_id));
 
         // Set tile's grid dimension __bsg_grid_dim_x/y symbol.
         hb_mc_idx_t grid_dim_x = hb_mc_dimension_get_x (grid_dim);
         hb_mc_idx_t grid_dim_y = hb_mc_dimension_get_y (grid_dim);
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_grid_dim_x", grid_dim_x));
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "__bsg_grid_dim_y", grid_dim_y));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_GRID_DIM_X, grid_dim_x));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_GRID_DIM_Y, grid_dim_y));
 
         // Set tile's finish signal value  cuda_finish_signal_val symbol.
         uint32_t finish_signal_val = HB_MC_CUDA_FINISH_SIGNAL_VAL;
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "cuda_finish_signal_val", finish_signal_val));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_FINISH_SIGNAL_VAL, finish_signal_val));
 
         // Set tile's kernel not loaded value  cuda_kernel_not_loaded_val symbol.
         uint32_t kernel_not_loaded_val = HB_MC_CUDA_KERNEL_NOT_LOADED_VAL;
-        BSG_CUDA_CALL(tile_set_symbol_val(device, pod, tile, map, "cuda_kernel_not_loaded_val", kernel_not_loaded_val));
+        BSG_CUDA_CALL(tile_shadow_set_symbol(device, pod, tile, map, TILE_SYMBOL_KERNEL_NOT_LOADED_VAL, kernel_not_loaded_val));
 
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Look up the shadowed symbols of a program and forget all tile state.
+ */
+__attribute__((warn_unused_result))
+static int pod_symbol_shadow_init(hb_mc_device_t *device, hb_mc_pod_t *pod)
+{
+        hb_mc_symbol_shadow_t *shadow = new (std::nothrow) hb_mc_symbol_shadow_t;
+        if (shadow == NULL) {
+                bsg_pr_err("%s: failed to allocate runtime symbol shadow.\n", __func__);
+                return HB_MC_NOMEM;
+        }
+        pod->symbol_shadow = shadow;
+
+        for (int symbol = 0; symbol < TILE_SYMBOLS; symbol++) {
+                int r = hb_mc_loader_symbol_table_lookup(pod->program->symbols,
+                                                         tile_symbol_names[symbol],
+                                                         &shadow->eva[symbol]);
+                if (r != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: failed to find symbol '%s' in program '%s': %s\n",
+                                   __func__,
+                                   tile_symbol_names[symbol],
+                                   pod->program->bin_name,
+                                   hb_mc_strerror(r));
+                        return r;
+                }
+        }
+
+        BSG_CUDA_CALL(hb_mc_loader_symbol_table_lookup(pod->program->symbols, "cuda_kernel_ptr",
+                                                       &shadow->kernel_ptr_eva));
+
+        hb_mc_tile_shadow_t unknown = {};
+        shadow->tiles.assign(hb_mc_dimension_to_length(pod->mesh->dim), unknown);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Free the symbol shadow of a pod.
+ */
+static void pod_symbol_shadow_exit(hb_mc_pod_t *pod)
+{
+        delete pod_symbol_shadow(pod);
+        pod->symbol_shadow = NULL;
+}
+
+/**
+ * Forget what all tiles of a pod hold, e.g. after loading a program.
+ */
+static void pod_symbol_shadow_invalidate(hb_mc_pod_t *pod)
+{
+        for (hb_mc_tile_shadow_t &ts : pod_symbol_shadow(pod)->tiles)
+                ts.known = 0;
+}
+
 //////////////////
 // Mesh helpers //
 //////////////////
@@ -451,192 +648,746 @@ static int mesh_num_tiles(hb_mc_mesh_t *mesh)
 /////////////////
 // Pod helpers //
 /////////////////
-#define pod_foreach_tile_group(pod, tile_group_ptr)     \
-        for (tile_group_ptr = pod->tile_groups; tile_group_ptr != pod->tile_groups+pod->num_tile_groups; tile_group_ptr++)
-
-///////////////////////
-// Iteration helpers //
-///////////////////////
-#define device_foreach_pod(device, pod_ptr)                             \
-        for (pod_ptr = device->pods; pod_ptr != device->pods+device->num_pods; pod_ptr++)
-
-static hb_mc_pod_id_t hb_mc_device_pod_to_pod_id(hb_mc_device_t *device, hb_mc_pod_t *pod)
+/**
+ * Host time in nanoseconds, for measuring tile utilization
+ */
+static uint64_t hb_mc_device_now_ns(void)
 {
-        return pod - device->pods;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-////////////////////
-// Input Checkers //
-////////////////////
-#define CHECK_PTR(ptr)                                                  \
-        do {                                                            \
-                if (ptr == NULL) {                                      \
-                        bsg_pr_err("%s: called with null input: '%s'\n", \
-                                   __func__, #ptr);                     \
-                        return HB_MC_INVALID;                           \
-                }                                                       \
-        } while (0)
-
-#define CHECK_POD_ID(device, id)                                        \
-        do {                                                            \
-                if (id < 0 || id >= (device)->num_pods) {               \
-                        bsg_pr_err("%s: Bad pod = %d: %d pods present\n", \
-                                   __func__, id, (device)->num_pods);   \
-                        return HB_MC_INVALID;                           \
-                }                                                       \
-        } while (0)
-
+#define tile_group_queue_foreach(queue, tile_group_ptr)                 \
+        for (tile_group_ptr = (queue)->head; tile_group_ptr != NULL; tile_group_ptr = tile_group_ptr->next)
 
-///////////////////////////////////////
-// Device Initialization and Cleanup //
-///////////////////////////////////////
+static void tile_group_queue_init(hb_mc_tile_group_queue_t *queue)
+{
+        queue->head = queue->tail = NULL;
+        queue->length = 0;
+}
 
 /**
- * Initializes a pod for a device.
+ * Add a tile group at the tail of a queue.
  */
-static int hb_mc_device_pod_init(hb_mc_device_t *device,
-                                 hb_mc_pod_t    *pod)
+static void tile_group_queue_push_back(hb_mc_tile_group_queue_t *queue, hb_mc_tile_group_t *tg)
 {
-        pod->program             = NULL;
-        pod->mesh                = NULL;
-        pod->tile_groups         = NULL;
-        pod->num_tile_groups     = 0;
-        pod->tile_group_capacity = 0;
-        pod->num_grids           = 0;
-        pod->program_loaded      = 0;
-        return HB_MC_SUCCESS;
+        tg->prev = queue->tail;
+        tg->next = NULL;
+        if (queue->tail != NULL)
+                queue->tail->next = tg;
+        else
+                queue->head = tg;
+        queue->tail = tg;
+        queue->length++;
 }
 
 /**
- * Cleans-up a pod for a device.
+ * Add a tile group at the head of a queue.
  */
-static int hb_mc_device_pod_exit(hb_mc_device_t *device,
-                                 hb_mc_pod_t    *pod)
+static void tile_group_queue_push_front(hb_mc_tile_group_queue_t *queue, hb_mc_tile_group_t *tg)
 {
-        return HB_MC_SUCCESS;
+        tg->prev = NULL;
+        tg->next = queue->head;
+        if (queue->head != NULL)
+                queue->head->prev = tg;
+        else
+                queue->tail = tg;
+        queue->head = tg;
+        queue->length++;
 }
 
 /**
- * Initializes the manycore struct, and a mesh structure with default (maximum)
- * dimensions inside device struct with list of tiles and their coordinates
- * @param[in]  device        Pointer to device
- * @param[in]  name          Device name
- * @param[in]  id            Device id
- * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ * Unlink a tile group from the queue it is on.
  */
-int hb_mc_device_init (hb_mc_device_t *device,
-                       const char *name,
-                       hb_mc_manycore_id_t id)
+static void tile_group_queue_remove(hb_mc_tile_group_queue_t *queue, hb_mc_tile_group_t *tg)
 {
-        // initialize manycore
-        XMALLOC(device->mc);
-        *(device->mc) = {0};
+        if (tg->prev != NULL)
+                tg->prev->next = tg->next;
+        else
+                queue->head = tg->next;
+        if (tg->next != NULL)
+                tg->next->prev = tg->prev;
+        else
+                queue->tail = tg->prev;
+        tg->prev = tg->next = NULL;
+        queue->length--;
+}
 
-        BSG_MANYCORE_CALL(device->mc, hb_mc_manycore_init(device->mc, name, id))
+/**
+ * Launched tile groups of a pod, indexed by where their finish packet comes
+ * from and where it goes. The finish EPA alone is not unique: tile groups of
+ * different grids with the same id share it, as do ids of a large grid that
+ * wrap around the finish signal words, but never the same origin.
+ */
+typedef std::unordered_map<uint64_t, hb_mc_tile_group_t*> hb_mc_finish_table_t;
 
-        // enumerate pods
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(device->mc);
-        hb_mc_dimension_t pod_geometry = hb_mc_config_pods(cfg);
-        int num_pods = hb_mc_dimension_to_length(pod_geometry);
-        hb_mc_pod_t *pods;
-        XMALLOC_N(pods, num_pods);
-        device->pods = pods;
-        device->num_pods = num_pods;
-        device->default_pod_id = 0;
-        device->default_mesh_dim = HB_MC_MESH_FULL_CORE;
+static uint64_t hb_mc_finish_key(hb_mc_coordinate_t origin, hb_mc_epa_t epa)
+{
+        return ((uint64_t)epa << 32)
+                | ((uint64_t)(hb_mc_coordinate_get_y(origin) & 0xFFFF) << 16)
+                | ((uint64_t)(hb_mc_coordinate_get_x(origin) & 0xFFFF));
+}
 
-        // initialize pods
-        hb_mc_coordinate_t pod_coord;
-        hb_mc_config_foreach_pod(pod_coord, cfg)
-        {
-                hb_mc_pod_id_t pid = hb_mc_coordinate_to_index(pod_coord, pod_geometry);
-                hb_mc_pod_t *pod = &device->pods[pid];
-                hb_mc_device_pod_init(device, pod);
-                // set the pod coordinate
-                pod->pod_coord = pod_coord;
+static hb_mc_finish_table_t *pod_finish_table(hb_mc_pod_t *pod)
+{
+        return reinterpret_cast<hb_mc_finish_table_t*>(pod->finish_table);
+}
+
+/**
+ * Ready tile groups of a pod, most tiles first and then in enqueue order,
+ * kept beside the ready queue so that a largest-first launch pass walks
+ * them in order without sorting.
+ */
+struct hb_mc_tile_group_larger_first {
+        bool operator()(const hb_mc_tile_group_t *a, const hb_mc_tile_group_t *b) const {
+                uint32_t a_tiles = hb_mc_dimension_to_length(a->dim);
+                uint32_t b_tiles = hb_mc_dimension_to_length(b->dim);
+                if (a_tiles != b_tiles)
+                        return a_tiles > b_tiles;
+                return a->ready_seq < b->ready_seq;
         }
+};
 
-        // set name
-        XSTRDUP(device->name, name);
+typedef struct {
+        std::set<hb_mc_tile_group_t*, hb_mc_tile_group_larger_first> tile_groups;
+        uint64_t enqueued; // tile groups ever made ready
+} hb_mc_ready_by_size_t;
 
-        return HB_MC_SUCCESS;
+static hb_mc_ready_by_size_t *pod_ready_by_size(hb_mc_pod_t *pod)
+{
+        return reinterpret_cast<hb_mc_ready_by_size_t*>(pod->ready_by_size);
 }
 
-
 /**
- * Initializes the manycor struct, and a mesh structure with custom
- * diemsnions inside device struct with list of all tiles and their coordinates
- * @param[in]  device        Pointer to device
- * @param[in]  name          Device name
- * @param[in]  id            Device id
- * @param[in]  dim           Tile pool (mesh) dimensions
- * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ * Add a tile group at the tail of a pod's ready queue.
  */
-int hb_mc_device_init_custom_dimensions (hb_mc_device_t *device,
-                                         const char *name,
-                                         hb_mc_manycore_id_t id,
-                                         hb_mc_dimension_t dim)
+static void pod_ready_push_back(hb_mc_pod_t *pod, hb_mc_tile_group_t *tg)
 {
-        BSG_CUDA_CALL(hb_mc_device_init(device, name, id));
-        device->default_mesh_dim = dim;
-        return HB_MC_SUCCESS;
+        hb_mc_ready_by_size_t *by_size = pod_ready_by_size(pod);
+        tg->ready_seq = by_size->enqueued++;
+        by_size->tile_groups.insert(tg);
+        tile_group_queue_push_back(&pod->ready, tg);
 }
 
-
 /**
- * Deletes memory manager, device and manycore struct, and freezes all tiles in device.
- * @param[in]  device        Pointer to device
- * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ * Unlink a tile group from a pod's ready queue.
  */
-int hb_mc_device_program_finish (hb_mc_device_t *device)
+static void pod_ready_remove(hb_mc_pod_t *pod, hb_mc_tile_group_t *tg)
 {
+        pod_ready_by_size(pod)->tile_groups.erase(tg);
+        tile_group_queue_remove(&pod->ready, tg);
+}
 
-        // cleanup pod
-        hb_mc_pod_id_t pod_id = device->default_pod_id;
-        hb_mc_pod_t *pod = &device->pods[pod_id];
-        BSG_CUDA_CALL(hb_mc_device_pod_program_finish(device, pod_id));
+/**
+ * A program file a device has parsed, with what identified the file
+ * when it was read so that a rebuilt binary is parsed again.
+ */
+typedef struct {
+        dev_t dev;
+        ino_t ino;
+        off_t size;
+        struct timespec mtime;
+        hb_mc_loader_program_image_t *image;
+} hb_mc_program_image_file_t;
 
-        // fence on all requests
-        BSG_CUDA_CALL(hb_mc_manycore_host_request_fence(device->mc, -1));
+/**
+ * Program images parsed by a device. Every pod that loads a binary, and
+ * every reload of it, shares one image. Files are found by path; buffers
+ * by a hash of their contents. Each entry holds a reference to its image
+ * until hb_mc_device_finish().
+ */
+typedef struct {
+        std::mutex lock;
+        std::unordered_map<std::string, hb_mc_program_image_file_t> by_file;
+        std::unordered_multimap<uint64_t, hb_mc_loader_program_image_t*> by_content;
+} hb_mc_program_image_cache_t;
 
-        return HB_MC_SUCCESS;
+static hb_mc_program_image_cache_t *device_program_images(hb_mc_device_t *device)
+{
+        return reinterpret_cast<hb_mc_program_image_cache_t*>(device->program_images);
 }
 
-
 /**
- * Deletes memory manager, device and manycore struct, and freezes all tiles in device.
- * @param[in]  device        Pointer to device
- * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ * Streams created on a device with hb_mc_stream_init().
  */
-int hb_mc_device_finish (hb_mc_device_t *device)
+typedef std::vector<hb_mc_stream_t*> hb_mc_stream_list_t;
+
+static hb_mc_stream_list_t *device_streams(hb_mc_device_t *device)
 {
+        return reinterpret_cast<hb_mc_stream_list_t*>(device->streams);
+}
 
-        // cleanup pods
-        hb_mc_pod_id_t pod_id;
-        hb_mc_device_foreach_pod_id(device, pod_id)
-        {
-                hb_mc_pod_t *pod = &device->pods[pod_id];
-                BSG_CUDA_CALL(hb_mc_device_pod_program_finish(device, pod_id));
-                BSG_CUDA_CALL(hb_mc_device_pod_exit(device, pod));
-        }
+///////////////////////
+// Iteration helpers //
+///////////////////////
+#define device_foreach_pod(device, pod_ptr)                             \
+        for (pod_ptr = device->pods; pod_ptr != device->pods+device->num_pods; pod_ptr++)
 
-        // fence on all requests
-        BSG_CUDA_CALL(hb_mc_manycore_host_request_fence(device->mc, -1));
+static hb_mc_pod_id_t hb_mc_device_pod_to_pod_id(hb_mc_device_t *device, hb_mc_pod_t *pod)
+{
+        return pod - device->pods;
+}
 
-        // cleanup manycore
-        BSG_CUDA_CALL(hb_mc_manycore_exit (device->mc));
+/////////////////////////////
+// Kernel argument helpers //
+/////////////////////////////
 
-        // free resources
-        free(device->mc);
-        free(device->pods);
-        free(const_cast<char*>(device->name));
+/* words of pod DRAM reserved at program init for kernel arguments */
+#define HB_MC_ARGV_ARENA_WORDS 4096
 
-        return HB_MC_SUCCESS;
+/*
+ * A ring of pod DRAM that holds the argv of launched tile groups.
+ * Slots are handed out at the head and reclaimed from the tail, once
+ * every slot before them has been released. A slot that does not fit
+ * before the end of the ring skips to the start, and the skipped words
+ * are reclaimed with the slot before it.
+ */
+typedef struct {
+        hb_mc_eva_t base;               //!< device address of word 0
+        uint32_t head;                  //!< next word to hand out
+        uint32_t tail;                  //!< oldest word in use
+        uint32_t used;                  //!< words in use, including skipped words
+        std::vector<uint32_t> span;     //!< words reserved by the slot starting at each word
+        std::vector<bool> live;         //!< whether the slot starting at each word is in use
+} hb_mc_argv_arena_t;
+
+static hb_mc_argv_arena_t *pod_argv_arena(hb_mc_pod_t *pod)
+{
+        return reinterpret_cast<hb_mc_argv_arena_t*>(pod->argv_arena);
 }
 
-
-
-/*****************/
+/**
+ * Reserve the kernel argument arena of a pod.
+ */
+__attribute__((warn_unused_result))
+static int pod_argv_arena_init(hb_mc_device_t *device, hb_mc_pod_t *pod)
+{
+        hb_mc_argv_arena_t *arena = new (std::nothrow) hb_mc_argv_arena_t;
+        if (arena == NULL) {
+                bsg_pr_err("%s: failed to allocate kernel argument arena.\n", __func__);
+                return HB_MC_NOMEM;
+        }
+        pod->argv_arena = arena;
+
+        arena->head = arena->tail = arena->used = 0;
+        arena->span.assign(HB_MC_ARGV_ARENA_WORDS, 0);
+        arena->live.assign(HB_MC_ARGV_ARENA_WORDS, false);
+
+        hb_mc_pod_id_t pod_id = hb_mc_device_pod_to_pod_id(device, pod);
+        return hb_mc_device_pod_malloc(device, pod_id, HB_MC_ARGV_ARENA_WORDS * sizeof(uint32_t), &arena->base);
+}
+
+/**
+ * Free the kernel argument arena of a pod.
+ */
+static void pod_argv_arena_exit(hb_mc_pod_t *pod)
+{
+        // the arena's DRAM goes with the program's allocator
+        delete pod_argv_arena(pod);
+        pod->argv_arena = NULL;
+}
+
+/**
+ * Take a slot of #words from the kernel argument arena.
+ * @return HB_MC_BUSY if the arena has no room, HB_MC_SUCCESS otherwise.
+ */
+static int pod_argv_arena_alloc(hb_mc_pod_t *pod, uint32_t words, hb_mc_eva_t *eva)
+{
+        hb_mc_argv_arena_t *arena = pod_argv_arena(pod);
+        uint32_t off;
+
+        if (arena->used == 0)
+                arena->head = arena->tail = 0;
+
+        if (arena->used == HB_MC_ARGV_ARENA_WORDS || words > HB_MC_ARGV_ARENA_WORDS)
+                return HB_MC_BUSY;
+
+        if (arena->head >= arena->tail) {
+                // free words are [head, end) and [0, tail)
+                if (HB_MC_ARGV_ARENA_WORDS - arena->head >= words) {
+                        off = arena->head;
+                } else if (arena->tail >= words) {
+                        uint32_t skip = HB_MC_ARGV_ARENA_WORDS - arena->head;
+                        if (skip != 0) {
+                                arena->span[arena->head] = skip;
+                                arena->live[arena->head] = false;
+                                arena->used += skip;
+                        }
+                        off = 0;
+                } else {
+                        return HB_MC_BUSY;
+                }
+        } else {
+                // free words are [head, tail)
+                if (arena->tail - arena->head < words)
+                        return HB_MC_BUSY;
+                off = arena->head;
+        }
+
+        arena->span[off] = words;
+        arena->live[off] = true;
+        arena->used += words;
+        arena->head = off + words;
+
+        *eva = arena->base + off * sizeof(uint32_t);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Check if #eva is a slot of the kernel argument arena.
+ */
+static bool pod_argv_arena_contains(hb_mc_pod_t *pod, hb_mc_eva_t eva)
+{
+        hb_mc_argv_arena_t *arena = pod_argv_arena(pod);
+        return eva >= arena->base && eva < arena->base + HB_MC_ARGV_ARENA_WORDS * sizeof(uint32_t);
+}
+
+/**
+ * Return a slot to the kernel argument arena, reclaiming every
+ * released slot at the tail.
+ */
+static void pod_argv_arena_free(hb_mc_pod_t *pod, hb_mc_eva_t eva)
+{
+        hb_mc_argv_arena_t *arena = pod_argv_arena(pod);
+        arena->live[(eva - arena->base) / sizeof(uint32_t)] = false;
+
+        while (arena->used != 0 && !arena->live[arena->tail]) {
+                arena->used -= arena->span[arena->tail];
+                arena->tail += arena->span[arena->tail];
+                if (arena->tail == HB_MC_ARGV_ARENA_WORDS)
+                        arena->tail = 0;
+        }
+}
+
+/**
+ * Write a buffer to pod DRAM without fencing.
+ */
+__attribute__((warn_unused_result))
+static int pod_write_nofence(hb_mc_device_t *device, hb_mc_pod_t *pod,
+                             hb_mc_eva_t eva, const void *data, size_t sz)
+{
+        const unsigned char *src = reinterpret_cast<const unsigned char*>(data);
+        while (sz > 0) {
+                hb_mc_npa_t npa;
+                size_t npa_sz;
+                BSG_MANYCORE_CALL(device->mc, hb_mc_eva_to_npa(device->mc, &default_map, &pod->mesh->origin,
+                                                               &eva, &npa, &npa_sz));
+                npa_sz = std::min(npa_sz, sz);
+                BSG_MANYCORE_CALL(device->mc, hb_mc_manycore_write_mem_nofence(device->mc, &npa, src, npa_sz));
+                eva += npa_sz;
+                src += npa_sz;
+                sz  -= npa_sz;
+        }
+        return HB_MC_SUCCESS;
+}
+
+////////////////////
+// Input Checkers //
+////////////////////
+#define CHECK_PTR(ptr)                                                  \
+        do {                                                            \
+                if (ptr == NULL) {                                      \
+                        bsg_pr_err("%s: called with null input: '%s'\n", \
+                                   __func__, #ptr);                     \
+                        return HB_MC_INVALID;                           \
+                }                                                       \
+        } while (0)
+
+#define CHECK_POD_ID(device, id)                                        \
+        do {                                                            \
+                if (id < 0 || id >= (device)->num_pods) {               \
+                        bsg_pr_err("%s: Bad pod = %d: %d pods present\n", \
+                                   __func__, id, (device)->num_pods);   \
+                        return HB_MC_INVALID;                           \
+                }                                                       \
+        } while (0)
+
+
+/////////////////
+// Pod Threads //
+/////////////////
+
+/**
+ * A host thread bound to one pod. It runs the tasks queued for its
+ * pod in order, and receives the request packets from its pod's tiles.
+ */
+typedef struct {
+        std::thread thread;
+        std::mutex lock;
+        std::condition_variable ready;
+        std::deque<std::packaged_task<int()>> tasks;
+        bool stop;
+} hb_mc_pod_thread_t;
+
+typedef std::vector<hb_mc_pod_thread_t*> hb_mc_pod_threads_t;
+
+static hb_mc_pod_threads_t *device_pod_threads(hb_mc_device_t *device)
+{
+        return reinterpret_cast<hb_mc_pod_threads_t*>(device->pod_threads);
+}
+
+static void hb_mc_pod_thread_main(hb_mc_device_t *device,
+                                  hb_mc_pod_thread_t *pt,
+                                  hb_mc_coordinate_t pod_coord,
+                                  std::promise<int> bound)
+{
+        int err = hb_mc_manycore_thread_bind_pod(device->mc, pod_coord);
+        bound.set_value(err);
+        if (err != HB_MC_SUCCESS)
+                return;
+
+        while (true) {
+                std::packaged_task<int()> task;
+                {
+                        std::unique_lock<std::mutex> lock(pt->lock);
+                        pt->ready.wait(lock, [pt] { return pt->stop || !pt->tasks.empty(); });
+                        if (pt->tasks.empty())
+                                break;
+
+                        task = std::move(pt->tasks.front());
+                        pt->tasks.pop_front();
+                }
+                task();
+        }
+
+        hb_mc_manycore_thread_unbind_pod(device->mc);
+}
+
+static std::future<int> hb_mc_pod_thread_submit(hb_mc_pod_thread_t *pt, std::function<int()> fn)
+{
+        std::packaged_task<int()> task(fn);
+        std::future<int> done = task.get_future();
+        {
+                std::lock_guard<std::mutex> lock(pt->lock);
+                pt->tasks.push_back(std::move(task));
+        }
+        pt->ready.notify_one();
+        return done;
+}
+
+/**
+ * Stops and joins pod threads after they finish their queued tasks.
+ */
+static void hb_mc_pod_threads_stop(hb_mc_pod_threads_t *threads)
+{
+        for (hb_mc_pod_thread_t *pt : *threads) {
+                {
+                        std::lock_guard<std::mutex> lock(pt->lock);
+                        pt->stop = true;
+                }
+                pt->ready.notify_one();
+        }
+
+        for (hb_mc_pod_thread_t *pt : *threads) {
+                if (pt->thread.joinable())
+                        pt->thread.join();
+                delete pt;
+        }
+
+        delete threads;
+}
+
+/**
+ * Runs fn for each pod in podv, on the pods' threads if there are any.
+ * @return HB_MC_SUCCESS if all calls succeeded. Otherwise the error of the first failing pod in podv.
+ */
+static int hb_mc_device_podv_run(hb_mc_device_t *device,
+                                 const hb_mc_pod_id_t *podv, int podc,
+                                 std::function<int(hb_mc_pod_id_t)> fn)
+{
+        hb_mc_pod_threads_t *threads = device_pod_threads(device);
+        if (threads == NULL) {
+                for (int podi = 0; podi < podc; podi++)
+                        BSG_CUDA_CALL(fn(podv[podi]));
+                return HB_MC_SUCCESS;
+        }
+
+        std::vector<std::future<int>> done;
+        for (int podi = 0; podi < podc; podi++) {
+                hb_mc_pod_id_t pod_id = podv[podi];
+                done.push_back(hb_mc_pod_thread_submit((*threads)[pod_id],
+                                                       [=] { return fn(pod_id); }));
+        }
+
+        // wait for every pod, since fn may refer to the caller's stack
+        int err = HB_MC_SUCCESS;
+        for (int podi = 0; podi < podc; podi++) {
+                int r = done[podi].get();
+                if (r != HB_MC_SUCCESS && err == HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: pod %d failed: %s\n",
+                                   __func__, podv[podi], hb_mc_strerror(r));
+                        err = r;
+                }
+        }
+        return err;
+}
+
+/**
+ * Gives each pod of a device its own host thread.
+ * @param[in]  device        Pointer to device
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_enable_pod_threads(hb_mc_device_t *device)
+{
+        if (device->pod_threads != NULL)
+                return HB_MC_SUCCESS;
+
+        BSG_CUDA_CALL(hb_mc_manycore_enable_threads(device->mc));
+
+        hb_mc_pod_threads_t *threads = new (std::nothrow) hb_mc_pod_threads_t;
+        if (threads == NULL) {
+                bsg_pr_err("%s: failed to allocate pod threads.\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        int err = HB_MC_SUCCESS;
+        hb_mc_pod_id_t pod_id;
+        hb_mc_device_foreach_pod_id(device, pod_id)
+        {
+                hb_mc_pod_thread_t *pt = new (std::nothrow) hb_mc_pod_thread_t;
+                if (pt == NULL) {
+                        err = HB_MC_NOMEM;
+                        break;
+                }
+                pt->stop = false;
+                threads->push_back(pt);
+
+                std::promise<int> bound;
+                std::future<int> bind_err = bound.get_future();
+                pt->thread = std::thread(hb_mc_pod_thread_main, device, pt,
+                                         device->pods[pod_id].pod_coord,
+                                         std::move(bound));
+                err = bind_err.get();
+                if (err != HB_MC_SUCCESS)
+                        break;
+        }
+
+        if (err != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to start pod threads: %s\n",
+                           __func__, hb_mc_strerror(err));
+                hb_mc_pod_threads_stop(threads);
+                return err;
+        }
+
+        device->pod_threads = threads;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Runs a function on every pod of a device and waits for all of them.
+ * @param[in]  device        Pointer to device
+ * @param[in]  fn            Function to call for each pod
+ * @param[in]  arg           Argument passed to each call of #fn
+ * @return HB_MC_SUCCESS if all calls succeeded. Otherwise the error of the lowest failing pod.
+ */
+int hb_mc_device_foreach_pod_run(hb_mc_device_t *device,
+                                 hb_mc_device_pod_fn_t fn,
+                                 void *arg)
+{
+        CHECK_PTR(fn);
+        hb_mc_pod_id_t podv[device->num_pods];
+        hb_mc_pod_id_t pod_id;
+        hb_mc_device_foreach_pod_id(device, pod_id)
+        {
+                podv[pod_id] = pod_id;
+        }
+
+        return hb_mc_device_podv_run(device, podv, device->num_pods,
+                                     [=](hb_mc_pod_id_t pod_id) { return fn(device, pod_id, arg); });
+}
+
+///////////////////////////////////////
+// Device Initialization and Cleanup //
+///////////////////////////////////////
+
+/**
+ * Initializes a pod for a device.
+ */
+static int hb_mc_device_pod_init(hb_mc_device_t *device,
+                                 hb_mc_pod_t    *pod)
+{
+        pod->program             = NULL;
+        pod->mesh                = NULL;
+        tile_group_queue_init(&pod->ready);
+        tile_group_queue_init(&pod->launched);
+        tile_group_queue_init(&pod->finished);
+        pod->finish_table        = NULL;
+        pod->ready_by_size       = NULL;
+        pod->symbol_shadow       = NULL;
+        pod->argv_arena          = NULL;
+        pod->num_grids           = 0;
+        pod->program_loaded      = 0;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Cleans-up a pod for a device.
+ */
+static int hb_mc_device_pod_exit(hb_mc_device_t *device,
+                                 hb_mc_pod_t    *pod)
+{
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Initializes the manycore struct, and a mesh structure with default (maximum)
+ * dimensions inside device struct with list of tiles and their coordinates
+ * @param[in]  device        Pointer to device
+ * @param[in]  name          Device name
+ * @param[in]  id            Device id
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_init (hb_mc_device_t *device,
+                       const char *name,
+                       hb_mc_manycore_id_t id)
+{
+        HB_MC_API_TRACE_SCOPE("cuda", nullptr, 0);
+        // initialize manycore
+        XMALLOC(device->mc);
+        *(device->mc) = {0};
+
+        BSG_MANYCORE_CALL(device->mc, hb_mc_manycore_init(device->mc, name, id))
+
+        // enumerate pods
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(device->mc);
+        hb_mc_dimension_t pod_geometry = hb_mc_config_pods(cfg);
+        int num_pods = hb_mc_dimension_to_length(pod_geometry);
+        hb_mc_pod_t *pods;
+        XMALLOC_N(pods, num_pods);
+        device->pods = pods;
+        device->num_pods = num_pods;
+        device->default_pod_id = 0;
+        device->default_mesh_dim = HB_MC_MESH_FULL_CORE;
+        device->tile_group_order = HB_MC_TILE_GROUP_ORDER_BACKFILL;
+        device->tile_group_placement = HB_MC_TILE_GROUP_PLACEMENT_FIRST_FIT;
+
+        device->pod_threads = NULL;
+        device->streams = new (std::nothrow) hb_mc_stream_list_t;
+        if (device->streams == NULL) {
+                bsg_pr_err("%s: failed to allocate stream list.\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        device->program_images = new (std::nothrow) hb_mc_program_image_cache_t;
+        if (device->program_images == NULL) {
+                bsg_pr_err("%s: failed to allocate program image cache.\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        // initialize pods
+        hb_mc_coordinate_t pod_coord;
+        hb_mc_config_foreach_pod(pod_coord, cfg)
+        {
+                hb_mc_pod_id_t pid = hb_mc_coordinate_to_index(pod_coord, pod_geometry);
+                hb_mc_pod_t *pod = &device->pods[pid];
+                hb_mc_device_pod_init(device, pod);
+                // set the pod coordinate
+                pod->pod_coord = pod_coord;
+        }
+
+        // set name
+        XSTRDUP(device->name, name);
+
+        return HB_MC_SUCCESS;
+}
+
+
+/**
+ * Initializes the manycor struct, and a mesh structure with custom
+ * diemsnions inside device struct with list of all tiles and their coordinates
+ * @param[in]  device        Pointer to device
+ * @param[in]  name          Device name
+ * @param[in]  id            Device id
+ * @param[in]  dim           Tile pool (mesh) dimensions
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_init_custom_dimensions (hb_mc_device_t *device,
+                                         const char *name,
+                                         hb_mc_manycore_id_t id,
+                                         hb_mc_dimension_t dim)
+{
+        BSG_CUDA_CALL(hb_mc_device_init(device, name, id));
+        device->default_mesh_dim = dim;
+        return HB_MC_SUCCESS;
+}
+
+
+/**
+ * Deletes memory manager, device and manycore struct, and freezes all tiles in device.
+ * @param[in]  device        Pointer to device
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_program_finish (hb_mc_device_t *device)
+{
+
+        // cleanup pod
+        hb_mc_pod_id_t pod_id = device->default_pod_id;
+        hb_mc_pod_t *pod = &device->pods[pod_id];
+        BSG_CUDA_CALL(hb_mc_device_pod_program_finish(device, pod_id));
+
+        // fence on all requests
+        BSG_CUDA_CALL(hb_mc_manycore_host_request_fence(device->mc, -1));
+
+        return HB_MC_SUCCESS;
+}
+
+
+/**
+ * Deletes memory manager, device and manycore struct, and freezes all tiles in device.
+ * @param[in]  device        Pointer to device
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_finish (hb_mc_device_t *device)
+{
+        hb_mc_api_trace_scope trace("cuda", __func__, nullptr);
+
+        // stop pod threads, cleaning up on this one
+        if (device->pod_threads != NULL) {
+                hb_mc_pod_threads_stop(device_pod_threads(device));
+                device->pod_threads = NULL;
+        }
+
+        // cleanup pods
+        hb_mc_pod_id_t pod_id;
+        hb_mc_device_foreach_pod_id(device, pod_id)
+        {
+                hb_mc_pod_t *pod = &device->pods[pod_id];
+                BSG_CUDA_CALL(hb_mc_device_pod_program_finish(device, pod_id));
+                BSG_CUDA_CALL(hb_mc_device_pod_exit(device, pod));
+        }
+
+        // fence on all requests
+        BSG_CUDA_CALL(hb_mc_manycore_host_request_fence(device->mc, -1));
+
+        // release parsed programs
+        hb_mc_program_image_cache_t *images = device_program_images(device);
+        for (auto &entry : images->by_file)
+                hb_mc_loader_program_image_release(entry.second.image);
+        for (auto &entry : images->by_content)
+                hb_mc_loader_program_image_release(entry.second);
+        delete images;
+        device->program_images = NULL;
+
+        hb_mc_device_streams_cleanup(device);
+
+        // cleanup manycore
+        BSG_CUDA_CALL(hb_mc_manycore_exit (device->mc));
+
+        // free resources
+        free(device->mc);
+        free(device->pods);
+        free(const_cast<char*>(device->name));
+
+        // write out the API trace, including this call
+        trace.end();
+        BSG_CUDA_CALL(hb_mc_api_trace_dump());
+
+        return HB_MC_SUCCESS;
+}
+
+
+
+/*****************/
 /* Pod Interface */
 /*****************/
 void hb_mc_program_options_default(hb_mc_program_options_t *popts)
@@ -729,6 +1480,9 @@ int hb_mc_device_pod_mesh_init(hb_mc_device_t *device,
 
         }
 
+        // index free tiles for tile group allocation
+        BSG_CUDA_CALL(hb_mc_mesh_occupancy_init(&mesh->occupancy, mesh->dim));
+
         pod->mesh = mesh;
 
         return HB_MC_SUCCESS;
@@ -742,20 +1496,24 @@ static
 int hb_mc_device_pod_tile_groups_init(hb_mc_device_t *device,
                                       hb_mc_pod_t *pod)
 {
-        hb_mc_tile_group_t *groups;
-        int capacity = 1;
+        tile_group_queue_init(&pod->ready);
+        tile_group_queue_init(&pod->launched);
+        tile_group_queue_init(&pod->finished);
+        memset(&pod->utilization, 0, sizeof(pod->utilization));
+
+        // allocate finish packet lookup
+        pod->finish_table = new (std::nothrow) hb_mc_finish_table_t;
+        if (pod->finish_table == NULL) {
+                bsg_pr_err("%s: failed to allocate finish signal table.\n", __func__);
+                return HB_MC_NOMEM;
+        }
 
-        // allocate tile groups
-        XMALLOC_N(groups, capacity);
-        if (groups == NULL) {
-                bsg_pr_err("%s: failed to allocated space for list of tile groups.\n", __func__);
+        // allocate the size order of ready tile groups
+        pod->ready_by_size = new (std::nothrow) hb_mc_ready_by_size_t();
+        if (pod->ready_by_size == NULL) {
+                bsg_pr_err("%s: failed to allocate ready tile group index.\n", __func__);
                 return HB_MC_NOMEM;
         }
-        // initialize
-        memset(groups, 0, sizeof(*groups) * capacity);
-        pod->tile_groups = groups;
-        pod->tile_group_capacity = capacity;
-        pod->num_tile_groups = 0;
 
         return HB_MC_SUCCESS;
 
@@ -781,48 +1539,246 @@ int hb_mc_device_pod_program_load (hb_mc_device_t *device, hb_mc_pod_t *pod)
                 tile_list[tile_id] = pod->mesh->tiles[tile_id].coord;
         }
 
-        // Freeze all tiles
-        hb_mc_tile_t *tile;
-        mesh_foreach_tile(pod->mesh, tile)
+        // Freeze all tiles
+        hb_mc_tile_t *tile;
+        mesh_foreach_tile(pod->mesh, tile)
+        {
+                BSG_CUDA_CALL(tile_freeze(device, pod, tile));
+        }
+
+
+        // Load binary into all tiles
+        r = hb_mc_loader_load_image (pod->program->image,
+                                     device->mc,
+                                     &default_map,
+                                     tile_list,
+                                     mesh_num_tiles(pod->mesh));
+        if (r != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to load program '%s': %s\n",
+                           __func__,
+                           pod->program->bin_name,
+                           hb_mc_strerror(r));
+                return r;
+        }
+
+        // Loading overwrote whatever the tiles held
+        pod_symbol_shadow_invalidate(pod);
+
+        // Set all tiles configuration symbols
+        hb_mc_coordinate_t tg_id = hb_mc_coordinate (0, 0);
+        hb_mc_coordinate_t tg_dim = hb_mc_coordinate (1, 1);
+        hb_mc_coordinate_t grid_dim = hb_mc_coordinate (1, 1);
+        mesh_foreach_tile(pod->mesh, tile)
+        {
+                BSG_CUDA_CALL(tile_set_config_symbols(device, pod, tile,
+                                                      &default_map,
+                                                      pod->mesh->origin,
+                                                      tg_id,
+                                                      tg_dim,
+                                                      grid_dim));
+
+                // before unfreezing, clear kernel ptr
+                BSG_CUDA_CALL(tile_set_kernel_ptr(device, pod, tile, &default_map,
+                                                  HB_MC_CUDA_KERNEL_NOT_LOADED_VAL));
+        }
+
+        // Configuration must land before the tiles start running
+        BSG_MANYCORE_CALL(device->mc, hb_mc_manycore_host_request_fence(device->mc, -1));
+
+        mesh_foreach_tile(pod->mesh, tile)
+        {
+                BSG_CUDA_CALL(tile_unfreeze(device, pod, tile));
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Hash a program's contents to find it in a device's program images.
+ */
+static uint64_t hb_mc_program_hash(const unsigned char *bin, size_t sz)
+{
+        // FNV-1a, a word at a time
+        uint64_t h = 0xcbf29ce484222325ull;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= sz; i += sizeof(uint64_t)) {
+                uint64_t w;
+                memcpy(&w, &bin[i], sizeof(w));
+                h = (h ^ w) * 0x100000001b3ull;
+        }
+        for (; i < sz; i++)
+                h = (h ^ bin[i]) * 0x100000001b3ull;
+        return h ^ sz;
+}
+
+/**
+ * Get a program image for a buffer, parsing it only if the device has
+ * not seen the same contents before.
+ * @param[in]  device  Pointer to device
+ * @param[in]  bin     Buffer containing binary
+ * @param[in]  sz      Size of the binary
+ * @param[in]  move    If nonzero, the caller passes ownership of #bin
+ * @param[out] image   Is set to a new reference to the image
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+static int hb_mc_device_program_image_from_binary(hb_mc_device_t *device,
+                                                  const unsigned char *bin,
+                                                  size_t sz, int move,
+                                                  hb_mc_loader_program_image_t **image)
+{
+        hb_mc_program_image_cache_t *images = device_program_images(device);
+        uint64_t hash = hb_mc_program_hash(bin, sz);
+
+        std::lock_guard<std::mutex> guard(images->lock);
+
+        auto range = images->by_content.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++) {
+                size_t image_sz;
+                const unsigned char *image_bin = hb_mc_loader_program_image_get_binary(it->second, &image_sz);
+                if (image_sz == sz && memcmp(image_bin, bin, sz) == 0) {
+                        if (move)
+                                free(const_cast<unsigned char*>(bin));
+                        *image = hb_mc_loader_program_image_retain(it->second);
+                        return HB_MC_SUCCESS;
+                }
+        }
+
+        hb_mc_loader_program_image_t *parsed;
+        BSG_CUDA_CALL(hb_mc_loader_program_image_init(bin, sz, move, &parsed));
+
+        try {
+                images->by_content.emplace(hash, parsed);
+        } catch (const std::bad_alloc &) {
+                // still usable, just not shared
+                *image = parsed;
+                return HB_MC_SUCCESS;
+        }
+
+        *image = hb_mc_loader_program_image_retain(parsed);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get a program image for a file, reading and parsing it only if the
+ * device has not loaded the file, as it is now, before.
+ * @param[in]  device    Pointer to device
+ * @param[in]  bin_name  Path to program file
+ * @param[out] image     Is set to a new reference to the image
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+static int hb_mc_device_program_image_from_file(hb_mc_device_t *device,
+                                                const char *bin_name,
+                                                hb_mc_loader_program_image_t **image)
+{
+        hb_mc_program_image_cache_t *images = device_program_images(device);
+        struct stat st;
+
+        if (stat(bin_name, &st) != 0) {
+                bsg_pr_err("could not stat '%s': %m\n", bin_name);
+                return HB_MC_INVALID;
+        }
+
         {
-                BSG_CUDA_CALL(tile_freeze(device, pod, tile));
+                std::lock_guard<std::mutex> guard(images->lock);
+                auto it = images->by_file.find(bin_name);
+                if (it != images->by_file.end()) {
+                        const hb_mc_program_image_file_t &file = it->second;
+                        if (file.dev == st.st_dev && file.ino == st.st_ino &&
+                            file.size == st.st_size &&
+                            file.mtime.tv_sec == st.st_mtim.tv_sec &&
+                            file.mtime.tv_nsec == st.st_mtim.tv_nsec) {
+                                *image = hb_mc_loader_program_image_retain(file.image);
+                                return HB_MC_SUCCESS;
+                        }
+                }
         }
 
+        // load program data
+        unsigned char *bin_data;
+        size_t bin_size;
+        BSG_CUDA_CALL(hb_mc_loader_read_program_file(bin_name, &bin_data, &bin_size));
 
-        // Load binary into all tiles
-        r = hb_mc_loader_load (pod->program->bin,
-                               pod->program->bin_size,
-                               device->mc,
-                               &default_map,
-                               tile_list,
-                               mesh_num_tiles(pod->mesh));
+        // take ownership of bin_data (don't copy)
+        hb_mc_loader_program_image_t *parsed;
+        int r = hb_mc_device_program_image_from_binary(device, bin_data, bin_size, 1, &parsed);
         if (r != HB_MC_SUCCESS) {
-                bsg_pr_err("%s: failed to load program '%s': %s\n",
-                           __func__,
-                           pod->program->bin_name,
-                           hb_mc_strerror(r));
+                free(bin_data);
                 return r;
         }
 
-        // Set all tiles configuration symbols
-        hb_mc_coordinate_t tg_id = hb_mc_coordinate (0, 0);
-        hb_mc_coordinate_t tg_dim = hb_mc_coordinate (1, 1);
-        hb_mc_coordinate_t grid_dim = hb_mc_coordinate (1, 1);
-        mesh_foreach_tile(pod->mesh, tile)
-        {
-                BSG_CUDA_CALL(tile_set_config_symbols(device, pod, tile,
-                                                      &default_map,
-                                                      pod->mesh->origin,
-                                                      tg_id,
-                                                      tg_dim,
-                                                      grid_dim));
-
-                BSG_CUDA_CALL(tile_unfreeze(device, pod, tile));
+        std::lock_guard<std::mutex> guard(images->lock);
+        try {
+                hb_mc_program_image_file_t &file = images->by_file[bin_name];
+                hb_mc_loader_program_image_release(file.image); // the file was rebuilt
+                file.dev = st.st_dev;
+                file.ino = st.st_ino;
+                file.size = st.st_size;
+                file.mtime = st.st_mtim;
+                file.image = hb_mc_loader_program_image_retain(parsed);
+        } catch (const std::bad_alloc &) {
+                // still usable, just not shared
         }
 
+        *image = parsed;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Initializes a CUDA-Lite program on the manycore on a pod specified.
+ * @param[in] device Pointer to device
+ * @param[in] pod    Pod ID
+ * @param[in] image  A parsed program. The program takes over the caller's reference.
+ * @param[in] popts  Program options defining program behavior
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+static int hb_mc_device_pod_program_init_image(hb_mc_device_t *device,
+                                               hb_mc_pod_id_t pod_id,
+                                               hb_mc_loader_program_image_t *image,
+                                               const hb_mc_program_options_t *popts)
+{
+        bsg_pr_dbg("%s: device<%s>: program<%s>\n", __func__, device->name, popts->program_name);
+
+        // initialize program on pod
+        hb_mc_pod_t *pod = &device->pods[pod_id];
+
+        // initialize mesh
+        BSG_CUDA_CALL(hb_mc_device_pod_mesh_init(device, pod, popts));
+
+        // initialize tile groups
+        BSG_CUDA_CALL(hb_mc_device_pod_tile_groups_init(device, pod));
+
+        // initialize program
+        hb_mc_program_t *program;
+        XMALLOC(program);
+        XSTRDUP(program->bin_name, popts->program_name);
+
+        // the binary and its symbols belong to the shared image
+        program->image = image;
+        program->bin = hb_mc_loader_program_image_get_binary(image, &program->bin_size);
+        program->symbols = hb_mc_loader_program_image_get_symbols(image);
+
+        // initialize memory allocator
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(device->mc);
+        BSG_CUDA_CALL(hb_mc_program_allocator_init (cfg, program, popts->alloc_name, popts->alloc_id));
+
+        // set pod program
+        pod->program = program;
+
+        // resolve the runtime symbols written at each launch
+        BSG_CUDA_CALL(pod_symbol_shadow_init(device, pod));
+
+        // reserve DRAM for the arguments of launched tile groups
+        BSG_CUDA_CALL(pod_argv_arena_init(device, pod));
+
+        // load binary onto all tiles
+        BSG_CUDA_CALL(hb_mc_device_pod_program_load(device, pod));
+
+        pod->program_loaded = 1;
+
         return HB_MC_SUCCESS;
 }
 
+
 /**
  * Initializes a CUDA-Lite program on the manycore on a pod specified.
  * @param[in] device Pointer to device
@@ -857,23 +1813,14 @@ int hb_mc_device_pod_program_init_opts(hb_mc_device_t *device,
                                        const char     *bin_name,
                                        const hb_mc_program_options_t *popts)
 {
-        int r = HB_MC_SUCCESS; // return code
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, 0);
         CHECK_POD_ID(device, pod_id);
 
-        // load program data
-        unsigned char *bin_data;
-        size_t bin_size;
-
-        r = hb_mc_loader_read_program_file(bin_name, &bin_data, &bin_size);
-        if (r != HB_MC_SUCCESS)
-                return r;
+        // find or parse the program
+        hb_mc_loader_program_image_t *image;
+        BSG_CUDA_CALL(hb_mc_device_program_image_from_file(device, bin_name, &image));
 
-        // call with program data loaded
-        hb_mc_program_options_t opts = *popts;
-        opts.move_bin_data = 1;  // take ownership of bin_data (don't copy)
-        return hb_mc_device_pod_program_init_binary_opts(device, pod_id,
-                                                         bin_data, bin_size,
-                                                         &opts);
+        return hb_mc_device_pod_program_init_image(device, pod_id, image, popts);
 }
 
 /**
@@ -912,49 +1859,17 @@ int hb_mc_device_pod_program_init_binary_opts(hb_mc_device_t       *device,
                                               size_t                bin_size,
                                               const hb_mc_program_options_t *popts)
 {
-        bsg_pr_dbg("%s: device<%s>: program<%s>\n", __func__, device->name, popts->program_name);
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, bin_size);
         CHECK_POD_ID(device, pod_id);
 
-        // initialize program on pod
-        hb_mc_pod_t *pod = &device->pods[pod_id];
-
-        // initialize mesh
-        BSG_CUDA_CALL(hb_mc_device_pod_mesh_init(device, pod, popts));
-
-        // initialize tile groups
-        BSG_CUDA_CALL(hb_mc_device_pod_tile_groups_init(device, pod));
-
-        // initialize program
-        hb_mc_program_t *program;
-        XMALLOC(program);
-        XSTRDUP(program->bin_name, popts->program_name);
-
-        // make copy of binary data
-        if (popts->move_bin_data) {
-                program->bin = bin_data;
-                program->bin_size = bin_size;
-        } else {
-                XMALLOC_N(program->bin, bin_size);
-                memcpy(const_cast<unsigned char*>(program->bin), bin_data, bin_size);
-                program->bin_size = bin_size;
-        }
-
-        // initialize memory allocator
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(device->mc);
-        BSG_CUDA_CALL(hb_mc_program_allocator_init (cfg, program, popts->alloc_name, popts->alloc_id));
-
-        // set pod program
-        pod->program = program;
-
-        // load binary onto all tiles
-        BSG_CUDA_CALL(hb_mc_device_pod_program_load(device, pod));
-
-        pod->program_loaded = 1;
+        // find or parse the program
+        hb_mc_loader_program_image_t *image;
+        BSG_CUDA_CALL(hb_mc_device_program_image_from_binary(device, bin_data, bin_size,
+                                                             popts->move_bin_data, &image));
 
-        return HB_MC_SUCCESS;
+        return hb_mc_device_pod_program_init_image(device, pod_id, image, popts);
 }
 
-
 /*************************/
 /* Pod Interface Cleanup */
 /*************************/
@@ -977,6 +1892,8 @@ int hb_mc_device_pod_mesh_exit(hb_mc_device_t *device,
         free ((void *) tiles);
         mesh->tiles = NULL;
 
+        hb_mc_mesh_occupancy_exit(&mesh->occupancy);
+
         // free mesh
         free(mesh);
         pod->mesh = NULL;
@@ -992,19 +1909,29 @@ static
 int hb_mc_device_pod_tile_groups_exit(hb_mc_device_t *device,
                                       hb_mc_pod_t *pod)
 {
-        // cleanup tile groups
-        hb_mc_tile_group_t *tg;
-        pod_foreach_tile_group(pod, tg)
-        {
-                if (tg->status != HB_MC_TILE_GROUP_STATUS_FINISHED)
+        // cleanup tile groups that never finished
+        hb_mc_tile_group_queue_t *unfinished[] = { &pod->ready, &pod->launched };
+        for (hb_mc_tile_group_queue_t *queue : unfinished) {
+                while (queue->head != NULL) {
+                        hb_mc_tile_group_t *tg = queue->head;
+                        tile_group_queue_remove(queue, tg);
                         BSG_CUDA_CALL(hb_mc_device_pod_tile_group_exit(device, pod, tg));
+                        tile_group_queue_push_front(&pod->finished, tg);
+                }
         }
 
+        // free finish packet lookup and the size order of ready tile groups
+        delete pod_finish_table(pod);
+        pod->finish_table = NULL;
+        delete pod_ready_by_size(pod);
+        pod->ready_by_size = NULL;
+
         // free tile groups
-        free(pod->tile_groups);
-        pod->tile_groups = NULL;
-        pod->tile_group_capacity = 0;
-        pod->num_tile_groups = 0;
+        while (pod->finished.head != NULL) {
+                hb_mc_tile_group_t *tg = pod->finished.head;
+                tile_group_queue_remove(&pod->finished, tg);
+                free(tg);
+        }
 
         return HB_MC_SUCCESS;
 }
@@ -1025,6 +1952,7 @@ int hb_mc_device_pod_tile_groups_exit(hb_mc_device_t *device,
 int hb_mc_device_pod_program_finish(hb_mc_device_t *device,
                                     hb_mc_pod_id_t  pod_id)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, 0);
         CHECK_POD_ID(device, pod_id);
         hb_mc_pod_t *pod = &device->pods[pod_id];
 
@@ -1050,14 +1978,22 @@ int hb_mc_device_pod_program_finish(hb_mc_device_t *device,
         // cleanup tile groups
         BSG_CUDA_CALL(hb_mc_device_pod_tile_groups_exit(device, pod));
 
+        // free runtime symbol shadow
+        pod_symbol_shadow_exit(pod);
+
+        // free kernel argument arena
+        pod_argv_arena_exit(pod);
+
         // cleanup mesh
         BSG_CUDA_CALL(hb_mc_device_pod_mesh_exit(device, pod));
 
         // free allocator
         BSG_CUDA_CALL(hb_mc_program_allocator_exit(program->allocator));
 
-        // free bin data
-        free(const_cast<unsigned char*>(program->bin));
+        // drop the parsed binary; the device keeps it for reloads
+        hb_mc_loader_program_image_release(program->image);
+        program->image = NULL;
+        program->symbols = NULL;
         program->bin = NULL;
         program->bin_size = 0;
 
@@ -1092,6 +2028,7 @@ int hb_mc_device_pod_malloc(hb_mc_device_t *device,
                             uint32_t        size,
                             hb_mc_eva_t    *eva)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, size);
         CHECK_POD_ID(device, pod_id);
         hb_mc_pod_t *pod = &device->pods[pod_id];
         hb_mc_program_t *program = pod->program;
@@ -1103,9 +2040,10 @@ int hb_mc_device_pod_malloc(hb_mc_device_t *device,
                 return HB_MC_INVALID;
         }
 
-        awsbwhal::MemoryManager *mem_manager = reinterpret_cast<awsbwhal::MemoryManager*>(program->allocator->memory_manager);
-        hb_mc_eva_t result = mem_manager->alloc(size);
-        if (result == awsbwhal::MemoryManager::mNull) {
+        hb_mc_memory_allocator_t *mem_manager = reinterpret_cast<hb_mc_memory_allocator_t*>(program->allocator->memory_manager);
+        uint64_t result;
+        int r = hb_mc_memory_allocator_alloc(mem_manager, size, &result);
+        if (r != HB_MC_SUCCESS) {
                 bsg_pr_err("%s: failed to allocate %" PRIu32 " bytes\n",
                            __func__, size);
                 return HB_MC_NOMEM;
@@ -1127,8 +2065,45 @@ int hb_mc_device_pod_malloc(hb_mc_device_t *device,
 int hb_mc_device_pod_free(hb_mc_device_t *device,
                           hb_mc_pod_id_t  pod_id,
                           hb_mc_eva_t     eva)
+{
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, 0);
+        CHECK_POD_ID(device, pod_id);
+        hb_mc_pod_t *pod = &device->pods[pod_id];
+        hb_mc_program_t *program = pod->program;
+        // check pod has program loaded
+        if (program == NULL) {
+                bsg_pr_err("%s: no program load on pod %d: %s\n",
+                           __func__,
+                           pod_id,
+                           hb_mc_strerror(HB_MC_INVALID));
+                return HB_MC_INVALID;
+        }
+
+        hb_mc_memory_allocator_t *mem_manager = reinterpret_cast<hb_mc_memory_allocator_t*>(program->allocator->memory_manager);
+        int r = hb_mc_memory_allocator_free(mem_manager, eva);
+        if (r != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: 0x%08" PRIx32 " is not allocated on pod %d\n",
+                           __func__, eva, pod_id);
+                return r;
+        }
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Reports usage of device's DRAM associated with the input pod
+ * hb_mc_device_pod_program_init() should have been called for device and pod
+ * before calling this function to set up a memory allocator.
+ * @param[in]  device        Pointer to device
+ * @param[in]  pod           Pod ID with a prorgam initialized
+ * @param[out] stats         Usage statistics of the pod's memory allocator
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_pod_memory_stats(hb_mc_device_t *device,
+                                  hb_mc_pod_id_t  pod_id,
+                                  hb_mc_memory_allocator_stats_t *stats)
 {
         CHECK_POD_ID(device, pod_id);
+        CHECK_PTR(stats);
         hb_mc_pod_t *pod = &device->pods[pod_id];
         hb_mc_program_t *program = pod->program;
         // check pod has program loaded
@@ -1140,8 +2115,8 @@ int hb_mc_device_pod_free(hb_mc_device_t *device,
                 return HB_MC_INVALID;
         }
 
-        awsbwhal::MemoryManager *mem_manager = reinterpret_cast<awsbwhal::MemoryManager*>(program->allocator->memory_manager);
-        mem_manager->free(eva);
+        hb_mc_memory_allocator_t *mem_manager = reinterpret_cast<hb_mc_memory_allocator_t*>(program->allocator->memory_manager);
+        hb_mc_memory_allocator_get_stats(mem_manager, stats);
         return HB_MC_SUCCESS;
 }
 
@@ -1199,6 +2174,7 @@ int hb_mc_device_pod_memcpy_to_device(hb_mc_device_t *device,
                                       const void *haddr,
                                       uint32_t bytes)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, bytes);
         CHECK_POD_ID(device, pod_id);
 
         hb_mc_pod_t *pod = &device->pods[pod_id];
@@ -1227,6 +2203,7 @@ int hb_mc_device_pod_memcpy_to_host(hb_mc_device_t *device,
                                     hb_mc_eva_t daddr,
                                     uint32_t bytes)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, bytes);
         CHECK_POD_ID(device, pod_id);
 
         hb_mc_pod_t *pod = &device->pods[pod_id];
@@ -1254,6 +2231,7 @@ int hb_mc_device_pod_memset (hb_mc_device_t *device,
                              uint8_t data,
                              size_t sz)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, sz);
         CHECK_POD_ID(device, pod_id);
 
         hb_mc_pod_t *pod = &device->pods[pod_id];
@@ -1308,9 +2286,15 @@ static int hb_mc_device_pod_tile_group_exit(hb_mc_device_t *device, hb_mc_pod_t
 {
 
         // Free the memory location in the device that holds the list of
-        // arguments of tile group's kernel
-        hb_mc_pod_id_t pod_id = hb_mc_device_pod_to_pod_id(device, pod);
-        BSG_CUDA_CALL(hb_mc_device_pod_free(device, pod_id, tg->argv_eva));
+        // arguments of tile group's kernel; only launched tile groups have one
+        if (tg->status == HB_MC_TILE_GROUP_STATUS_LAUNCHED) {
+                if (pod_argv_arena_contains(pod, tg->argv_eva)) {
+                        pod_argv_arena_free(pod, tg->argv_eva);
+                } else {
+                        hb_mc_pod_id_t pod_id = hb_mc_device_pod_to_pod_id(device, pod);
+                        BSG_CUDA_CALL(hb_mc_device_pod_free(device, pod_id, tg->argv_eva));
+                }
+        }
 
         // release tile gorup resources
         tg->dim = HB_MC_DIMENSION(0,0);
@@ -1324,9 +2308,7 @@ static int hb_mc_device_pod_tile_group_exit(hb_mc_device_t *device, hb_mc_pod_t
         free(tg->map);
 
         // decrement the kernel reference count and free if needed
-        tg->kernel->refcount -= 1;
-        if (tg->kernel->refcount == 0)
-                BSG_CUDA_CALL(kernel_exit(tg->kernel));
+        BSG_CUDA_CALL(kernel_release(tg->kernel));
 
         tg->kernel = NULL;
         return HB_MC_SUCCESS;
@@ -1344,21 +2326,24 @@ static int hb_mc_device_pod_tile_group_kernel_enqueue (hb_mc_device_t* device,
                                                        hb_mc_dimension_t dim,
                                                        hb_mc_kernel_t *kernel)
 {
-        // increaase tile group capacity if necessary
-        int cap = pod->tile_group_capacity;
-        int num = pod->num_tile_groups;
-        if (cap == num) {
-                XREALLOC(pod->tile_groups, cap * 2);
-                pod->tile_group_capacity *= 2;
+        // reuse the descriptor of a finished tile group if there is one
+        hb_mc_tile_group_t* tg = pod->finished.head;
+        if (tg != NULL) {
+                tile_group_queue_remove(&pod->finished, tg);
+        } else {
+                XMALLOC(tg);
         }
 
         // initialize tile group
-        hb_mc_tile_group_t* tg = &pod->tile_groups[pod->num_tile_groups];
-        BSG_CUDA_CALL(hb_mc_device_pod_tile_group_init(device, pod, tg,
-                                                       grid_id, tg_id, grid_dim, dim, kernel));
+        int r = hb_mc_device_pod_tile_group_init(device, pod, tg,
+                                                 grid_id, tg_id, grid_dim, dim, kernel);
+        if (r != HB_MC_SUCCESS) {
+                free(tg);
+                return r;
+        }
 
-        // incremement the number of tile groups
-        pod->num_tile_groups += 1;
+        // wait for free tiles
+        pod_ready_push_back(pod, tg);
 
         bsg_pr_dbg("%s: Grid %d: %dx%d tile group (%d,%d) initialized.\n",
                    __func__,
@@ -1397,6 +2382,7 @@ int hb_mc_device_pod_kernel_enqueue(hb_mc_device_t    *device,
                                     uint32_t argc,
                                     const uint32_t *argv)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, argc * sizeof(uint32_t));
         CHECK_POD_ID(device, pod_id);
         CHECK_PTR(device->pods);
 
@@ -1427,12 +2413,8 @@ int hb_mc_device_pod_kernel_enqueue(hb_mc_device_t    *device,
 static
 int hb_mc_device_pod_all_tile_groups_finished(hb_mc_device_t *device, hb_mc_pod_t *pod)
 {
-        hb_mc_tile_group_t *tile_group;
-        pod_foreach_tile_group(pod, tile_group)
-        {
-                if (tile_group->status != HB_MC_TILE_GROUP_STATUS_FINISHED)
-                        return HB_MC_FAIL;
-        }
+        if (pod->ready.length != 0 || pod->launched.length != 0)
+                return HB_MC_FAIL;
         return HB_MC_SUCCESS;
 }
 
@@ -1448,82 +2430,59 @@ int hb_mc_device_pod_tile_group_allocate_tiles(hb_mc_device_t *device, hb_mc_pod
         bsg_pr_dbg("%s: device<%s>: program<%s>: calling\n",
                    __func__, device->name, pod->program->bin_name);
 
-        // calculate boundary condition
-        hb_mc_dimension_t origin_boundary;
-        BSG_CUDA_CALL(hb_mc_coordinate_sub_safe(pod->mesh->dim, tile_group->dim, &origin_boundary));
-        origin_boundary = hb_mc_coordinate_add(origin_boundary, hb_mc_dimension(1,1));
+        // find a free rectangle of tiles
+        hb_mc_coordinate_t rel_origin;
+        int r;
+        if (device->tile_group_placement == HB_MC_TILE_GROUP_PLACEMENT_BEST_FIT)
+                r = hb_mc_mesh_occupancy_find_best_fit(&pod->mesh->occupancy, tile_group->dim, &rel_origin);
+        else
+                r = hb_mc_mesh_occupancy_find(&pod->mesh->occupancy, tile_group->dim, &rel_origin);
+        if (r != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: no free %dx%d group of tiles: %s\n",
+                           __func__,
+                           hb_mc_dimension_get_x(tile_group->dim),
+                           hb_mc_dimension_get_y(tile_group->dim),
+                           hb_mc_strerror(r));
+                return r;
+        }
 
-        // scan for contiguous group of free tile groups
-        hb_mc_coordinate_t origin;
-        int tiles_are_free = 0;
+        // these tiles are free; set the origin as the tile groups origin
+        hb_mc_coordinate_t origin = hb_mc_coordinate_add(pod->mesh->origin, rel_origin);
+        tile_group->origin = origin;
+        BSG_CUDA_CALL(hb_mc_mesh_occupancy_allocate(&pod->mesh->occupancy, rel_origin, tile_group->dim));
 
 #if defined (DEBUG)
         char origin_str[256];
-        char boundary_str[256];
 #endif
-
-        bsg_pr_dbg("%s: scanning orig:%s  dim:%s\n",
+        bsg_pr_dbg("%s: allocated tiles at %s\n",
                    __func__,
-                   hb_mc_coordinate_to_string(pod->mesh->origin, origin_str, sizeof(origin_str)),
-                   hb_mc_coordinate_to_string(origin_boundary, boundary_str, sizeof(boundary_str)));
-
-        foreach_coordinate(origin, pod->mesh->origin, origin_boundary)
-        {
-                // check if this group of tiles is free
-                // this group is free if the group of tiles about the origin matching
-                // the required tile group size are all free
-                tiles_are_free = 1;
-                hb_mc_coordinate_t xy;
-                foreach_coordinate(xy, origin, tile_group->dim)
-                {
-                        hb_mc_idx_t tile_id = hb_mc_get_tile_id(pod->mesh->origin, pod->mesh->dim, xy);
-                        if (pod->mesh->tiles[tile_id].status != HB_MC_TILE_STATUS_FREE) {
-                                tiles_are_free = 0;
-                                break;
-                        }
-                }
+                   hb_mc_coordinate_to_string(origin, origin_str, sizeof(origin_str)));
 
+        // initialize eva map to support tile group addressing
+        BSG_CUDA_CALL(hb_mc_origin_eva_map_exit(tile_group->map));
+        BSG_CUDA_CALL(hb_mc_origin_eva_map_init(tile_group->map, origin));
 
-                bsg_pr_dbg("%s: %s %s\n",
-                           __func__,
-                           hb_mc_coordinate_to_string(origin, origin_str, sizeof(origin_str)),
-                           tiles_are_free ? "free" : "not free");
-
-                if (!tiles_are_free)
-                        continue;
+        // initialize free group of tiles
+        hb_mc_coordinate_t xy;
+        foreach_coordinate(xy, tile_group->origin, tile_group->dim)
+        {
+                hb_mc_idx_t tile_id = hb_mc_get_tile_id(pod->mesh->origin, pod->mesh->dim, xy);
 
-                // these tiles are free; set the origin as the tile groups origin
-                tile_group->origin = origin;
+                // set bookkeeping fields
+                hb_mc_tile_t *tile = &pod->mesh->tiles[tile_id];
+                tile->origin = origin;
+                tile->tile_group_id = tile_group->id;
+                tile->status = HB_MC_TILE_STATUS_BUSY;
 
-                // initialize free group of tiles
-                foreach_coordinate(xy, tile_group->origin, tile_group->dim)
-                {
-                        hb_mc_idx_t tile_id = hb_mc_get_tile_id(pod->mesh->origin, pod->mesh->dim, xy);
-
-                        // initialize eva map to support tile group addressing
-                        BSG_CUDA_CALL(hb_mc_origin_eva_map_exit(tile_group->map));
-                        BSG_CUDA_CALL(hb_mc_origin_eva_map_init(tile_group->map, origin));
-
-                        // set bookkeeping fields
-                        hb_mc_tile_t *tile = &pod->mesh->tiles[tile_id];
-                        tile->origin = origin;
-                        tile->tile_group_id = tile_group->id;
-                        tile->status = HB_MC_TILE_STATUS_BUSY;
-
-                        // set configuration symbols
-                        BSG_CUDA_CALL(tile_set_config_symbols(device, pod, tile,
-                                                              tile_group->map,
-                                                              tile_group->origin,
-                                                              tile_group->id,
-                                                              tile_group->dim,
-                                                              tile_group->grid_dim));
-                }
-                break; // done
+                // set configuration symbols
+                BSG_CUDA_CALL(tile_set_config_symbols(device, pod, tile,
+                                                      tile_group->map,
+                                                      tile_group->origin,
+                                                      tile_group->id,
+                                                      tile_group->dim,
+                                                      tile_group->grid_dim));
         }
 
-        if (!tiles_are_free)
-                return HB_MC_NOTFOUND;
-
         tile_group->status = HB_MC_TILE_GROUP_STATUS_ALLOCATED;
         return HB_MC_SUCCESS;
 }
@@ -1549,6 +2508,10 @@ int hb_mc_device_pod_tile_group_deallocate_tiles(hb_mc_device_t *device, hb_mc_p
                 tile->status = HB_MC_TILE_STATUS_FREE;
         }
 
+        hb_mc_coordinate_t rel_origin;
+        BSG_CUDA_CALL(hb_mc_coordinate_sub_safe(tg->origin, pod->mesh->origin, &rel_origin));
+        BSG_CUDA_CALL(hb_mc_mesh_occupancy_release(&pod->mesh->occupancy, rel_origin, tg->dim));
+
         bsg_pr_dbg("%s: Grid %d: %dx%d tile group (%d,%d) de-allocated at origin (%d,%d).\n",
                    __func__,
                    tg->grid_id,
@@ -1568,40 +2531,62 @@ int hb_mc_device_pod_tile_group_launch(hb_mc_device_t *device, hb_mc_pod_t *pod,
         bsg_pr_dbg("%s: device<%s>: program<%s>: Launching tile group running kernel = '%s'\n",
                    __func__, device->name, pod->program->bin_name, kernel->name);
 
-        // initialize argv
-        // allocate argv
+        // take a slot for argv from the arena, or allocate one if the arena is full
         hb_mc_eva_t argv_addr;
-        hb_mc_pod_id_t pod_id = hb_mc_device_pod_to_pod_id(device, pod);
-        BSG_CUDA_CALL(hb_mc_device_pod_malloc(device, pod_id, kernel->argc * sizeof(*(kernel->argv)), &argv_addr));
+        uint32_t argv_words = std::max<uint32_t>(kernel->argc, 1);
+        if (pod_argv_arena_alloc(pod, argv_words, &argv_addr) != HB_MC_SUCCESS) {
+                hb_mc_pod_id_t pod_id = hb_mc_device_pod_to_pod_id(device, pod);
+                BSG_CUDA_CALL(hb_mc_device_pod_malloc(device, pod_id, argv_words * sizeof(*(kernel->argv)), &argv_addr));
+        }
         tile_group->argv_eva = argv_addr;
 
-        // copy argv over
-        BSG_CUDA_CALL(hb_mc_device_pod_memcpy_to_device(device, pod_id,
-                                                        tile_group->argv_eva,
-                                                        &kernel->argv[0],
-                                                        kernel->argc * sizeof(*(kernel->argv))));
+        // copy argv over, fenced with the runtime symbols below
+        BSG_CUDA_CALL(pod_write_nofence(device, pod, tile_group->argv_eva,
+                                        &kernel->argv[0],
+                                        kernel->argc * sizeof(*(kernel->argv))));
 
         // find kernel
         hb_mc_eva_t kernel_addr;
-        BSG_CUDA_CALL(hb_mc_loader_symbol_to_eva(pod->program->bin, pod->program->bin_size, kernel->name, &kernel_addr));
+        BSG_CUDA_CALL(hb_mc_loader_symbol_table_lookup(pod->program->symbols, kernel->name, &kernel_addr));
 
 
+        // send the runtime symbols that changed since the tiles' last launch
         hb_mc_coordinate_t coord;
         foreach_coordinate(coord, tile_group->origin, tile_group->dim)
         {
                 hb_mc_idx_t tile_id = hb_mc_get_tile_id(pod->mesh->origin, pod->mesh->dim, coord);
                 hb_mc_tile_t *tile = &pod->mesh->tiles[tile_id];
-                // this will wake the tile up
                 BSG_CUDA_CALL(tile_set_runtime_symbols(device, pod, tile,
                                                        tile_group->map,
                                                        kernel->argc,
                                                        tile_group->argv_eva,
-                                                       tile_group->finish_signal_npa,
-                                                       kernel_addr));
+                                                       tile_group->finish_signal_npa));
+        }
+
+        // one fence for the configuration and runtime symbols of the whole tile group
+        BSG_MANYCORE_CALL(device->mc, hb_mc_manycore_host_request_fence(device->mc, -1));
+
+        // tiles wake-on-broken reservation on the kernel pointer
+        // this write wakes up the kernel and 'launches' it
+        foreach_coordinate(coord, tile_group->origin, tile_group->dim)
+        {
+                hb_mc_idx_t tile_id = hb_mc_get_tile_id(pod->mesh->origin, pod->mesh->dim, coord);
+                hb_mc_tile_t *tile = &pod->mesh->tiles[tile_id];
+                BSG_CUDA_CALL(tile_set_kernel_ptr(device, pod, tile, tile_group->map, kernel_addr));
         }
 
         // make tile group as launched
         tile_group->status = HB_MC_TILE_GROUP_STATUS_LAUNCHED;
+        tile_group->launch_ns = hb_mc_device_now_ns();
+        if (pod->launched.length == 0)
+                pod->active_since_ns = tile_group->launch_ns;
+        pod_ready_remove(pod, tile_group);
+        tile_group_queue_push_back(&pod->launched, tile_group);
+
+        // register where its finish packet will come from
+        uint64_t key = hb_mc_finish_key(tile_group->origin,
+                                        hb_mc_npa_get_epa(&tile_group->finish_signal_npa));
+        (*pod_finish_table(pod))[key] = tile_group;
 
         return HB_MC_SUCCESS;
 }
@@ -1627,7 +2612,37 @@ int hb_mc_device_pod_wait_for_tile_group_finish_any(hb_mc_device_t *device, hb_m
 }
 
 /**
- * Try to launch as many tile groups as possible in pod
+ * Try to launch a ready tile group.
+ * @param[inout] last_failed  The last shape that did not fit, which is not tried again
+ * @return HB_MC_NOTFOUND if the tile group does not fit. HB_MC_SUCCESS if it was launched.
+ */
+static
+int hb_mc_device_pod_try_launch_tile_group(hb_mc_device_t *device,
+                                           hb_mc_pod_t *pod,
+                                           hb_mc_tile_group_t *tg,
+                                           hb_mc_dimension_t *last_failed)
+{
+        // skip if we know this shape fails
+        if (last_failed->x == tg->dim.x &&
+            last_failed->y == tg->dim.y)
+                return HB_MC_NOTFOUND;
+
+        // keep going if we can't allocate
+        int r = hb_mc_device_pod_tile_group_allocate_tiles(device, pod, tg);
+        if (r != HB_MC_SUCCESS) {
+                // mark this shape as the last failed
+                *last_failed = tg->dim;
+                return HB_MC_NOTFOUND;
+        }
+
+        // launch the tile tile group
+        BSG_CUDA_CALL(hb_mc_device_pod_tile_group_launch(device, pod, tg));
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Try to launch as many tile groups as possible in pod,
+ * in the order set with hb_mc_device_set_tile_group_policy()
  */
 static
 int hb_mc_device_pod_try_launch_tile_groups(hb_mc_device_t *device,
@@ -1635,31 +2650,56 @@ int hb_mc_device_pod_try_launch_tile_groups(hb_mc_device_t *device,
 
 {
         int r;
-        hb_mc_tile_group_t *tg;
+        hb_mc_tile_group_t *tg, *next;
         hb_mc_dimension_t last_failed = hb_mc_dimension(0,0);
 
-        // scan for ready tile groups
-        pod_foreach_tile_group(pod, tg)
-        {
-                // only look at ready tile groups
-                if (tg->status != HB_MC_TILE_GROUP_STATUS_INITIALIZED)
-                        continue;
+        if (device->tile_group_order == HB_MC_TILE_GROUP_ORDER_LARGEST_FIRST) {
+                auto &ready = pod_ready_by_size(pod)->tile_groups;
+                for (auto it = ready.begin(); it != ready.end(); ) {
+                        // launching removes the tile group from the ready tile groups
+                        tg = *it++;
 
-                // skip if we know this shape fails
-                if (last_failed.x == tg->dim.x &&
-                    last_failed.y == tg->dim.y)
-                        continue;
+                        if (pod->mesh->occupancy.num_free == 0)
+                                break;
 
-                // keep going if we can't allocate
-                r = hb_mc_device_pod_tile_group_allocate_tiles(device, pod, tg);
-                if (r != HB_MC_SUCCESS) {
-                        // mark this shape as the last failed
-                        last_failed = tg->dim;
-                        continue;
+                        r = hb_mc_device_pod_try_launch_tile_group(device, pod, tg, &last_failed);
+                        if (r != HB_MC_SUCCESS && r != HB_MC_NOTFOUND)
+                                return r;
                 }
+                return HB_MC_SUCCESS;
+        }
+
+        // scan the ready tile groups in the order they were enqueued
+        for (tg = pod->ready.head; tg != NULL; tg = next)
+        {
+                // launching moves tg to the launched queue
+                next = tg->next;
+
+                if (pod->mesh->occupancy.num_free == 0)
+                        break;
+
+                r = hb_mc_device_pod_try_launch_tile_group(device, pod, tg, &last_failed);
+                if (r == HB_MC_NOTFOUND && device->tile_group_order == HB_MC_TILE_GROUP_ORDER_FIFO)
+                        break;
+                if (r != HB_MC_SUCCESS && r != HB_MC_NOTFOUND)
+                        return r;
+        }
+
+        return HB_MC_SUCCESS;
+}
 
-                // launch the tile tile group
-                BSG_CUDA_CALL(hb_mc_device_pod_tile_group_launch(device, pod, tg));
+/**
+ * Launch tile groups on a pod until all of them have completed.
+ */
+static
+int hb_mc_device_pod_run_tile_groups(hb_mc_device_t *device, hb_mc_pod_t *pod)
+{
+        while (hb_mc_device_pod_all_tile_groups_finished(device, pod) != HB_MC_SUCCESS) {
+                // try launching as many tile groups as possible
+                BSG_CUDA_CALL(hb_mc_device_pod_try_launch_tile_groups(device, pod));
+
+                // wait for any tile group to complete
+                BSG_CUDA_CALL(hb_mc_device_pod_wait_for_tile_group_finish_any(device, pod));
         }
 
         return HB_MC_SUCCESS;
@@ -1679,22 +2719,14 @@ int hb_mc_device_pod_try_launch_tile_groups(hb_mc_device_t *device,
 int hb_mc_device_pod_kernels_execute(hb_mc_device_t *device,
                                      hb_mc_pod_id_t pod_id)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, 0);
         CHECK_POD_ID(device, pod_id);
         hb_mc_pod_t *pod = &device->pods[pod_id];
-        int r;
 
         bsg_pr_dbg("%s: device<%s>: program<%s>: calling\n",
                    __func__, device->name, pod->program->bin_name);
 
-        while (hb_mc_device_pod_all_tile_groups_finished(device, pod) != HB_MC_SUCCESS) {
-                // try launching as many tile groups as possible
-                BSG_CUDA_CALL(hb_mc_device_pod_try_launch_tile_groups(device, pod));
-
-                // wait for any tile group to complete
-                BSG_CUDA_CALL(hb_mc_device_pod_wait_for_tile_group_finish_any(device, pod));
-        }
-
-        return HB_MC_SUCCESS;
+        return hb_mc_device_pod_run_tile_groups(device, pod);
 }
 
 /**
@@ -1732,23 +2764,25 @@ int hb_mc_device_podv_try_launch_tile_groups(hb_mc_device_t *device,
         return HB_MC_SUCCESS;
 }
 
-/**
- * Wait for any tile group to complete. Cleanup and release that tile groups resources.
- * @return pod_done  The pod on which a tile-group just completed
- */
-static
-int hb_mc_device_podv_wait_for_tile_group_finish_any(hb_mc_device_t *device,
-                                                     hb_mc_pod_id_t *podv,
-                                                     int podc,
-                                                     hb_mc_pod_id_t *pod_done)
-{
-        bsg_pr_dbg("%s: calling\n", __func__);
-
+/**
+ * Receive request packets until one finishes a launched tile group. Cleanup and release that tile groups resources.
+ * @param[in]  timeout   -1 to wait, or 0 to return HB_MC_BUSY once no request packet is waiting
+ * @return pod_done  The pod on which a tile-group just completed
+ */
+static
+int hb_mc_device_tile_group_finish_rx(hb_mc_device_t *device,
+                                      long timeout,
+                                      hb_mc_pod_id_t *pod_done)
+{
         while (true) {
                 hb_mc_request_packet_t rqst;
 
-                // perform a blocking read from the request fifo
-                BSG_CUDA_CALL(hb_mc_manycore_request_rx(device->mc, &rqst, -1));
+                // read from the request fifo
+                int r = hb_mc_manycore_request_rx(device->mc, &rqst, timeout);
+                if (r == HB_MC_BUSY && timeout == 0)
+                        return r;
+
+                BSG_CUDA_CALL(r);
 
                 #ifdef DEBUG
                 char pkt_str[256];
@@ -1773,23 +2807,13 @@ int hb_mc_device_podv_wait_for_tile_group_finish_any(hb_mc_device_t *device,
                 hb_mc_pod_id_t pid = hb_mc_coordinate_to_index(podco, device->mc->config.pods);
                 hb_mc_pod_t *pod = &device->pods[pid];
 
-                // find the tile group with matching origin in pod
-                hb_mc_tile_group_t *tg;
-                pod_foreach_tile_group(pod, tg)
-                {
-                        // only look for launched tile groups
-                        if (tg->status != HB_MC_TILE_GROUP_STATUS_LAUNCHED) {
-                                continue;
-                        }
-
-                        // origin matches?
-                        if (!(tg->origin.x == src.x && tg->origin.y == src.y))
-                                continue;
-
-                        // finish signal epa matches?
-                        if (hb_mc_request_packet_get_epa(&rqst)
-                            != hb_mc_npa_get_epa(&tg->finish_signal_npa))
-                                continue;
+                // find the launched tile group with matching origin and finish epa
+                hb_mc_finish_table_t *finish_table = pod_finish_table(pod);
+                uint64_t key = hb_mc_finish_key(src, hb_mc_request_packet_get_epa(&rqst));
+                auto it = finish_table->find(key);
+                if (it != finish_table->end()) {
+                        hb_mc_tile_group_t *tg = it->second;
+                        finish_table->erase(it);
 
                         #ifdef DEBUG
                         bsg_pr_dbg("%s: received finish packet from (%d,%d)\n",
@@ -1799,8 +2823,17 @@ int hb_mc_device_podv_wait_for_tile_group_finish_any(hb_mc_device_t *device,
                         // deallocate tiles
                         BSG_CUDA_CALL(hb_mc_device_pod_tile_group_deallocate_tiles(device, pod, tg));
 
-                        // cleanup tile group
+                        // account for the time its tiles were busy
+                        uint64_t now = hb_mc_device_now_ns();
+                        pod->utilization.tile_groups += 1;
+                        pod->utilization.busy_tile_ns += (now - tg->launch_ns) * hb_mc_dimension_to_length(tg->dim);
+
+                        // cleanup tile group and keep its descriptor for reuse
+                        tile_group_queue_remove(&pod->launched, tg);
+                        if (pod->launched.length == 0)
+                                pod->utilization.active_ns += now - pod->active_since_ns;
                         BSG_CUDA_CALL(hb_mc_device_pod_tile_group_exit(device, pod, tg));
+                        tile_group_queue_push_front(&pod->finished, tg);
 
                         // mark this pod as having completed a tile-group
                         *pod_done = pid;
@@ -1813,6 +2846,20 @@ int hb_mc_device_podv_wait_for_tile_group_finish_any(hb_mc_device_t *device,
         }
 }
 
+/**
+ * Wait for any tile group to complete. Cleanup and release that tile groups resources.
+ * @return pod_done  The pod on which a tile-group just completed
+ */
+static
+int hb_mc_device_podv_wait_for_tile_group_finish_any(hb_mc_device_t *device,
+                                                     hb_mc_pod_id_t *podv,
+                                                     int podc,
+                                                     hb_mc_pod_id_t *pod_done)
+{
+        bsg_pr_dbg("%s: calling\n", __func__);
+        return hb_mc_device_tile_group_finish_rx(device, -1, pod_done);
+}
+
 /**
  * Launches all kernel invocations enqueued on pods.
  * These kernel invocations are enqueued by
@@ -1829,6 +2876,13 @@ int hb_mc_device_podv_kernels_execute(hb_mc_device_t *device,
                                       hb_mc_pod_id_t *podv,
                                       int podc)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, 0);
+        /* each pod's thread launches and waits on its own tile groups */
+        if (device->pod_threads != NULL)
+                return hb_mc_device_podv_run(device, podv, podc, [=](hb_mc_pod_id_t pod_id) {
+                                return hb_mc_device_pod_run_tile_groups(device, &device->pods[pod_id]);
+                        });
+
         /* launch as many tile groups as possible on all pods */
         BSG_CUDA_CALL(hb_mc_device_podv_try_launch_tile_groups(device, podv, podc));
 
@@ -1867,6 +2921,522 @@ int hb_mc_device_pods_kernels_execute(hb_mc_device_t *device)
         return hb_mc_device_podv_kernels_execute(device, podv, device->num_pods);
 }
 
+/**
+ * Sets the order in which a device tries ready tile groups and where it places them.
+ * @param[in]  device        Pointer to device
+ * @param[in]  order         Order in which ready tile groups are tried
+ * @param[in]  placement     Where a tile group is placed in the mesh
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_set_tile_group_policy(hb_mc_device_t *device,
+                                       hb_mc_tile_group_order_t order,
+                                       hb_mc_tile_group_placement_t placement)
+{
+        switch (order) {
+        case HB_MC_TILE_GROUP_ORDER_BACKFILL:
+        case HB_MC_TILE_GROUP_ORDER_FIFO:
+        case HB_MC_TILE_GROUP_ORDER_LARGEST_FIRST:
+                break;
+        default:
+                bsg_pr_err("%s: invalid tile group order %d\n", __func__, order);
+                return HB_MC_INVALID;
+        }
+
+        switch (placement) {
+        case HB_MC_TILE_GROUP_PLACEMENT_FIRST_FIT:
+        case HB_MC_TILE_GROUP_PLACEMENT_BEST_FIT:
+                break;
+        default:
+                bsg_pr_err("%s: invalid tile group placement %d\n", __func__, placement);
+                return HB_MC_INVALID;
+        }
+
+        device->tile_group_order = order;
+        device->tile_group_placement = placement;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Gets the utilization of a pod's tiles.
+ * @param[in]  device        Pointer to device
+ * @param[in]  pod           Pod ID
+ * @param[out] utilization   Utilization of the pod's tiles
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_pod_get_utilization(hb_mc_device_t *device,
+                                     hb_mc_pod_id_t pod_id,
+                                     hb_mc_pod_utilization_t *utilization)
+{
+        CHECK_POD_ID(device, pod_id);
+        CHECK_PTR(utilization);
+        hb_mc_pod_t *pod = &device->pods[pod_id];
+        if (!pod->program_loaded) {
+                bsg_pr_err("%s: no program loaded on pod %d\n", __func__, pod_id);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        *utilization = pod->utilization;
+        utilization->tiles = hb_mc_dimension_to_length(pod->mesh->dim);
+
+        // count tile groups still running up to now
+        if (pod->launched.length != 0) {
+                uint64_t now = hb_mc_device_now_ns();
+                hb_mc_tile_group_t *tg;
+                tile_group_queue_foreach(&pod->launched, tg)
+                        utilization->busy_tile_ns += (now - tg->launch_ns) * hb_mc_dimension_to_length(tg->dim);
+                utilization->active_ns += now - pod->active_since_ns;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Starts measuring the utilization of a pod's tiles afresh.
+ * @param[in]  device        Pointer to device
+ * @param[in]  pod           Pod ID
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_device_pod_reset_utilization(hb_mc_device_t *device,
+                                       hb_mc_pod_id_t pod_id)
+{
+        CHECK_POD_ID(device, pod_id);
+        hb_mc_pod_t *pod = &device->pods[pod_id];
+        memset(&pod->utilization, 0, sizeof(pod->utilization));
+
+        // running tile groups only count from now on
+        uint64_t now = hb_mc_device_now_ns();
+        hb_mc_tile_group_t *tg;
+        tile_group_queue_foreach(&pod->launched, tg)
+                tg->launch_ns = now;
+        pod->active_since_ns = now;
+
+        return HB_MC_SUCCESS;
+}
+
+
+/*************/
+/* Streams   */
+/*************/
+
+/* bytes a stream copies before letting other streams and kernels progress */
+#define HB_MC_STREAM_COPY_CHUNK (16 * 1024)
+
+typedef enum {
+        HB_MC_STREAM_OP_MEMCPY_TO_DEVICE,
+        HB_MC_STREAM_OP_MEMCPY_TO_HOST,
+        HB_MC_STREAM_OP_MEMSET,
+        HB_MC_STREAM_OP_KERNEL,
+        HB_MC_STREAM_OP_WAIT_EVENT,
+} hb_mc_stream_op_kind_t;
+
+/**
+ * An operation waiting in a stream. Copies advance a chunk at a time;
+ * a kernel's tile groups are enqueued on the pod when it reaches the
+ * head of its stream, and the operation holds a reference to the kernel
+ * until all of them have finished.
+ */
+typedef struct {
+        hb_mc_stream_op_kind_t kind;
+        hb_mc_eva_t            daddr;
+        void                  *haddr;
+        size_t                 bytes;
+        size_t                 done;     // bytes copied so far
+        uint8_t                val;
+        std::string            name;
+        std::vector<uint32_t>  argv;
+        hb_mc_dimension_t      grid_dim;
+        hb_mc_dimension_t      tg_dim;
+        int                    launched;
+        hb_mc_kernel_t        *kernel;
+        hb_mc_event_t          event;
+} hb_mc_stream_op_t;
+
+typedef std::deque<hb_mc_stream_op_t> hb_mc_stream_ops_t;
+
+static hb_mc_stream_ops_t *stream_ops(hb_mc_stream_t *stream)
+{
+        return reinterpret_cast<hb_mc_stream_ops_t*>(stream->ops);
+}
+
+/**
+ * Frees the stream list of a device and the operations of streams
+ * that were never finished.
+ * @param[in]  device        Pointer to device
+ */
+static void hb_mc_device_streams_cleanup(hb_mc_device_t *device)
+{
+        for (hb_mc_stream_t *stream : *device_streams(device)) {
+                // pods have exited, so kernels are only held by the operations
+                for (hb_mc_stream_op_t &op : *stream_ops(stream)) {
+                        if (op.kernel != NULL && kernel_release(op.kernel) != HB_MC_SUCCESS)
+                                bsg_pr_err("%s: failed to release kernel '%s'\n", __func__, op.name.c_str());
+                }
+                delete stream_ops(stream);
+                stream->ops = NULL;
+        }
+        delete device_streams(device);
+        device->streams = NULL;
+}
+
+static bool hb_mc_event_reached(const hb_mc_event_t *event)
+{
+        return event->stream->ops_completed >= event->seq;
+}
+
+static int hb_mc_stream_enqueue(hb_mc_stream_t *stream, hb_mc_stream_op_t &&op)
+{
+        CHECK_PTR(stream->ops);
+        stream_ops(stream)->push_back(std::move(op));
+        stream->ops_enqueued++;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Advance the operation at the head of a stream by one step.
+ * @param[out] progressed  Set if the stream did anything
+ * @param[out] kernels     Incremented if the stream waits on launched tile groups
+ */
+static int hb_mc_stream_step(hb_mc_stream_t *stream, bool *progressed, int *kernels)
+{
+        hb_mc_stream_ops_t *ops = stream_ops(stream);
+        if (ops->empty())
+                return HB_MC_SUCCESS;
+
+        hb_mc_device_t *device = stream->device;
+        hb_mc_pod_t *pod = &device->pods[stream->pod];
+        hb_mc_stream_op_t &op = ops->front();
+        bool complete = false;
+        int r = HB_MC_SUCCESS;
+
+        switch (op.kind) {
+        case HB_MC_STREAM_OP_MEMCPY_TO_DEVICE:
+        case HB_MC_STREAM_OP_MEMCPY_TO_HOST:
+        case HB_MC_STREAM_OP_MEMSET: {
+                size_t n = std::min<size_t>(HB_MC_STREAM_COPY_CHUNK, op.bytes - op.done);
+                unsigned char *host = reinterpret_cast<unsigned char*>(op.haddr) + op.done;
+                hb_mc_eva_t daddr = op.daddr + op.done;
+                if (op.kind == HB_MC_STREAM_OP_MEMCPY_TO_DEVICE)
+                        r = hb_mc_device_pod_memcpy_to_device(device, stream->pod, daddr, host, n);
+                else if (op.kind == HB_MC_STREAM_OP_MEMCPY_TO_HOST)
+                        r = hb_mc_device_pod_memcpy_to_host(device, stream->pod, host, daddr, n);
+                else
+                        r = hb_mc_device_pod_memset(device, stream->pod, daddr, op.val, n);
+
+                op.done += n;
+                complete = op.done == op.bytes;
+                *progressed = true;
+                break;
+        }
+        case HB_MC_STREAM_OP_KERNEL:
+                if (!op.launched) {
+                        r = hb_mc_device_pod_kernel_enqueue(device, stream->pod, op.grid_dim, op.tg_dim,
+                                                            op.name.c_str(), op.argv.size(), op.argv.data());
+                        op.launched = 1;
+                        if (r == HB_MC_SUCCESS) {
+                                // the kernel's tile groups are the newest ready ones
+                                op.kernel = pod->ready.tail->kernel;
+                                op.kernel->refcount += 1;
+                                r = hb_mc_device_pod_try_launch_tile_groups(device, pod);
+                        }
+                        *progressed = true;
+                }
+
+                // only this operation's reference is left once all tile groups finished
+                if (r == HB_MC_SUCCESS && op.kernel != NULL && op.kernel->refcount > 1) {
+                        (*kernels)++;
+                        break;
+                }
+                complete = true;
+                if (op.kernel != NULL) {
+                        int rr = kernel_release(op.kernel);
+                        op.kernel = NULL;
+                        if (r == HB_MC_SUCCESS)
+                                r = rr;
+                }
+                break;
+        case HB_MC_STREAM_OP_WAIT_EVENT:
+                complete = hb_mc_event_reached(&op.event);
+                break;
+        }
+
+        // a failed operation is dropped so that the stream does not stall on it
+        if (complete || r != HB_MC_SUCCESS) {
+                ops->pop_front();
+                stream->ops_completed++;
+                *progressed = true;
+        }
+
+        return r;
+}
+
+/**
+ * Make progress on all streams of a device until reached() holds.
+ * Copies advance between polls for finish packets, so that they overlap
+ * the execution of kernels launched by other streams.
+ * @param[in]  block     If false, make one pass and return HB_MC_BUSY if reached() does not hold
+ */
+template <typename ReachedFunction>
+static int hb_mc_device_streams_progress(hb_mc_device_t *device, ReachedFunction reached, bool block)
+{
+        hb_mc_stream_list_t *streams = device_streams(device);
+
+        while (!reached()) {
+                bool progressed = false;
+                int kernels = 0;
+                for (hb_mc_stream_t *stream : *streams)
+                        BSG_CUDA_CALL(hb_mc_stream_step(stream, &progressed, &kernels));
+
+                if (reached())
+                        break;
+
+                // block on the request fifo only if no stream can move otherwise
+                if (kernels > 0) {
+                        hb_mc_pod_id_t pod_done;
+                        long timeout = (progressed || !block) ? 0 : -1;
+                        int r = hb_mc_device_tile_group_finish_rx(device, timeout, &pod_done);
+                        if (r == HB_MC_SUCCESS) {
+                                BSG_CUDA_CALL(hb_mc_device_pod_try_launch_tile_groups(device, &device->pods[pod_done]));
+                                progressed = true;
+                        } else if (r != HB_MC_BUSY) {
+                                return r;
+                        }
+                }
+
+                if (!block)
+                        return reached() ? HB_MC_SUCCESS : HB_MC_BUSY;
+
+                if (!progressed) {
+                        bsg_pr_err("%s: streams are waiting on events that will never be reached\n",
+                                   __func__);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Creates a stream of operations on a pod.
+ * @param[in]  device        Pointer to device
+ * @param[in]  pod           Pod ID
+ * @param[out] stream        Stream to initialize
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_init(hb_mc_device_t *device, hb_mc_pod_id_t pod, hb_mc_stream_t *stream)
+{
+        CHECK_PTR(stream);
+        CHECK_POD_ID(device, pod);
+
+        // pod threads would receive the finish packets the streams wait on
+        if (device->pod_threads != NULL) {
+                bsg_pr_err("%s: streams cannot be used with pod threads\n", __func__);
+                return HB_MC_INVALID;
+        }
+
+        stream->device = device;
+        stream->pod = pod;
+        stream->ops_enqueued = 0;
+        stream->ops_completed = 0;
+        stream->ops = new (std::nothrow) hb_mc_stream_ops_t;
+        if (stream->ops == NULL) {
+                bsg_pr_err("%s: failed to allocate stream.\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        device_streams(device)->push_back(stream);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Waits for all operations on a stream to complete and destroys it.
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_finish(hb_mc_stream_t *stream)
+{
+        CHECK_PTR(stream->ops);
+        int r = hb_mc_stream_synchronize(stream);
+
+        hb_mc_stream_list_t *streams = device_streams(stream->device);
+        streams->erase(std::remove(streams->begin(), streams->end(), stream), streams->end());
+
+        delete stream_ops(stream);
+        stream->ops = NULL;
+        return r;
+}
+
+/**
+ * Enqueues a copy from the host to the stream's pod.
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @param[in]  daddr         EVA address of destination to be copied into
+ * @param[in]  haddr         Host address of source to be copied from
+ * @param[in]  bytes         Size of buffer to be copied
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_memcpy_to_device_async(hb_mc_stream_t *stream,
+                                        hb_mc_eva_t daddr,
+                                        const void *haddr,
+                                        uint32_t bytes)
+{
+        CHECK_PTR(haddr);
+        hb_mc_stream_op_t op = {};
+        op.kind = HB_MC_STREAM_OP_MEMCPY_TO_DEVICE;
+        op.daddr = daddr;
+        op.haddr = const_cast<void*>(haddr);
+        op.bytes = bytes;
+        return hb_mc_stream_enqueue(stream, std::move(op));
+}
+
+/**
+ * Enqueues a copy from the stream's pod to the host.
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @param[in]  haddr         Host address of destination to be copied into
+ * @param[in]  daddr         EVA address of source to be copied from
+ * @param[in]  bytes         Size of buffer to be copied
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_memcpy_to_host_async(hb_mc_stream_t *stream,
+                                      void *haddr,
+                                      hb_mc_eva_t daddr,
+                                      uint32_t bytes)
+{
+        CHECK_PTR(haddr);
+        hb_mc_stream_op_t op = {};
+        op.kind = HB_MC_STREAM_OP_MEMCPY_TO_HOST;
+        op.daddr = daddr;
+        op.haddr = haddr;
+        op.bytes = bytes;
+        return hb_mc_stream_enqueue(stream, std::move(op));
+}
+
+/**
+ * Enqueues setting memory on the stream's pod to a value.
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @param[in]  daddr         EVA address of destination
+ * @param[in]  val           Value to be written out
+ * @param[in]  bytes         The number of bytes to set
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_memset_async(hb_mc_stream_t *stream,
+                              hb_mc_eva_t daddr,
+                              uint8_t val,
+                              size_t bytes)
+{
+        hb_mc_stream_op_t op = {};
+        op.kind = HB_MC_STREAM_OP_MEMSET;
+        op.daddr = daddr;
+        op.val = val;
+        op.bytes = bytes;
+        return hb_mc_stream_enqueue(stream, std::move(op));
+}
+
+/**
+ * Enqueues a kernel launch.
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @param[in]  grid_dim      X/Y dimensions of the grid to be initialized
+ * @param[in]  tg_dim        X/Y dimensions of tile groups in grid
+ * @param[in]  name          Kernel name to be executed on tile groups in grid
+ * @param[in]  argc          Number of input arguments to kernel
+ * @param[in]  argv          List of input arguments to kernel
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_kernel_launch_async(hb_mc_stream_t *stream,
+                                     hb_mc_dimension_t grid_dim,
+                                     hb_mc_dimension_t tg_dim,
+                                     const char *name,
+                                     uint32_t argc,
+                                     const uint32_t *argv)
+{
+        CHECK_PTR(name);
+        if (argc > 0)
+                CHECK_PTR(argv);
+        hb_mc_pod_t *pod = &stream->device->pods[stream->pod];
+        if (!pod->program_loaded) {
+                bsg_pr_err("%s: no program loaded on pod %d\n", __func__, stream->pod);
+                return HB_MC_UNINITIALIZED;
+        }
+
+        hb_mc_stream_op_t op = {};
+        op.kind = HB_MC_STREAM_OP_KERNEL;
+        op.name = name;
+        op.argv.assign(argv, argv + argc);
+        op.grid_dim = grid_dim;
+        op.tg_dim = tg_dim;
+        return hb_mc_stream_enqueue(stream, std::move(op));
+}
+
+/**
+ * Waits for all operations enqueued on a stream to complete.
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_synchronize(hb_mc_stream_t *stream)
+{
+        HB_MC_API_TRACE_SCOPE("cuda", stream->device->mc, 0);
+        hb_mc_event_t end = { stream, stream->ops_enqueued };
+        return hb_mc_event_synchronize(&end);
+}
+
+/**
+ * Records an event at the current end of a stream.
+ * @param[out] event         Event to record
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_event_record(hb_mc_event_t *event, hb_mc_stream_t *stream)
+{
+        CHECK_PTR(event);
+        CHECK_PTR(stream);
+        event->stream = stream;
+        event->seq = stream->ops_enqueued;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Makes later operations on a stream wait until an event is reached.
+ * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+ * @param[in]  event         An event recorded with hb_mc_event_record()
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_stream_wait_event(hb_mc_stream_t *stream, const hb_mc_event_t *event)
+{
+        CHECK_PTR(event);
+        CHECK_PTR(event->stream);
+        hb_mc_stream_op_t op = {};
+        op.kind = HB_MC_STREAM_OP_WAIT_EVENT;
+        op.event = *event;
+        return hb_mc_stream_enqueue(stream, std::move(op));
+}
+
+/**
+ * Makes progress on the device's streams without blocking and checks an event.
+ * @param[in]  event         An event recorded with hb_mc_event_record()
+ * @return HB_MC_SUCCESS if the event has been reached, HB_MC_BUSY if not.
+ *         Otherwise an error code is returned.
+ */
+int hb_mc_event_query(const hb_mc_event_t *event)
+{
+        CHECK_PTR(event);
+        CHECK_PTR(event->stream);
+        return hb_mc_device_streams_progress(event->stream->device,
+                                             [=] { return hb_mc_event_reached(event); },
+                                             false);
+}
+
+/**
+ * Waits until an event is reached.
+ * @param[in]  event         An event recorded with hb_mc_event_record()
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_event_synchronize(const hb_mc_event_t *event)
+{
+        CHECK_PTR(event);
+        CHECK_PTR(event->stream);
+        return hb_mc_device_streams_progress(event->stream->device,
+                                             [=] { return hb_mc_event_reached(event); },
+                                             true);
+}
+
 
 /********************/
 /* Legacy Interface */
@@ -2027,8 +3597,105 @@ int hb_mc_device_memset (hb_mc_device_t *device,
 }
 
 
+/**
+ * Total size of a set of DMA jobs, for the API trace.
+ * @param[in]  jobs    Vector of DMA jobs
+ * @param[in]  count   Number of jobs
+ * @return The number of bytes moved by #jobs, or zero if tracing is disabled.
+ */
+template <typename DmaJob>
+static uint64_t dma_jobs_trace_size(const DmaJob *jobs, size_t count)
+{
+        uint64_t sz = 0;
+        if (!hb_mc_api_trace_is_enabled())
+                return 0;
+
+        for (size_t i = 0; i < count; i++)
+                sz += jobs[i].size;
+
+        return sz;
+}
+
+/**
+ * Checks if a set of DMA jobs touches more cache lines than a pod's victim caches hold.
+ * @param[in]  mc      A manycore instance
+ * @param[in]  pod     The pod coordinate
+ * @param[in]  jobs    Vector of DMA jobs
+ * @param[in]  count   Number of jobs
+ * @return true if applying a cache operation to every way of the pod is cheaper
+ *         than applying it to the lines of each job.
+ */
+template <typename DmaJob>
+static bool pod_dma_jobs_exceed_vcache(hb_mc_manycore_t *mc,
+                                       hb_mc_coordinate_t pod,
+                                       const DmaJob *jobs,
+                                       size_t count)
+{
+        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        size_t bsize = hb_mc_config_get_vcache_block_size(cfg);
+        size_t caches = 0;
+        hb_mc_coordinate_t dram;
+        hb_mc_config_pod_foreach_dram(dram, pod, cfg) {
+                caches++;
+        }
+
+        size_t capacity = caches * hb_mc_vcache_num_sets(mc) * hb_mc_vcache_num_ways(mc);
+        size_t lines = 0;
+        for (size_t i = 0; i < count; i++) {
+                if (jobs[i].size == 0)
+                        continue;
+
+                size_t first = jobs[i].d_addr / bsize;
+                size_t last  = (jobs[i].d_addr + jobs[i].size - 1) / bsize;
+                lines += last - first + 1;
+                if (lines > capacity)
+                        return true;
+        }
+
+        return false;
+}
+
+/**
+ * Applies a cache operation to the victim cache lines that back a set of DMA jobs.
+ * @param[in]  mc              A manycore instance
+ * @param[in]  pod             Pointer to the pod
+ * @param[in]  jobs            Vector of DMA jobs
+ * @param[in]  count           Number of jobs
+ * @param[in]  whole_cache     Apply #pod_function to the whole pod instead
+ * @param[in]  pod_function    Applies the operation to every way of a pod
+ * @param[in]  range_function  Applies the operation to an EVA range without fencing
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+template <typename DmaJob, typename PodFunction, typename RangeFunction>
+static int pod_dma_jobs_apply_to_vcache(hb_mc_manycore_t *mc,
+                                        hb_mc_pod_t *pod,
+                                        const DmaJob *jobs,
+                                        size_t count,
+                                        bool whole_cache,
+                                        PodFunction pod_function,
+                                        RangeFunction range_function)
+{
+        int err;
+        if (whole_cache)
+                return pod_function(mc, pod->pod_coord);
+
+        if (!hb_mc_manycore_has_cache(mc))
+                return HB_MC_SUCCESS;
+
+        for (size_t i = 0; i < count; i++) {
+                err = range_function(mc, &default_map, &pod->mesh->origin,
+                                     &jobs[i].d_addr, jobs[i].size);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+
+        // one fence for every job
+        return hb_mc_manycore_host_request_fence(mc, -1);
+}
+
 int hb_mc_device_pod_dma_to_device(hb_mc_device_t *device, hb_mc_pod_id_t pod_id, const hb_mc_dma_htod_t *jobs, size_t count)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, dma_jobs_trace_size(jobs, count));
         int err;
         CHECK_POD_ID(device, pod_id);
 
@@ -2037,8 +3704,13 @@ int hb_mc_device_pod_dma_to_device(hb_mc_device_t *device, hb_mc_pod_id_t pod_id
 
         hb_mc_pod_t *pod = &device->pods[pod_id];
 
+        // small transfers only touch the cache lines that can hold them
+        bool whole_cache = pod_dma_jobs_exceed_vcache(device->mc, pod->pod_coord, jobs, count);
+
         // flush cache
-        err = hb_mc_manycore_pod_flush_vcache(device->mc, pod->pod_coord);
+        err = pod_dma_jobs_apply_to_vcache(device->mc, pod, jobs, count, whole_cache,
+                                           hb_mc_manycore_pod_flush_vcache,
+                                           hb_mc_manycore_vcache_flush_eva_range_nofence);
         if (err != HB_MC_SUCCESS) {
                 bsg_pr_err("%s: failed to flush victim cache: %s\n",
                            __func__,
@@ -2069,7 +3741,9 @@ int hb_mc_device_pod_dma_to_device(hb_mc_device_t *device, hb_mc_pod_id_t pod_id
         }
 
         // invalidate cache
-        err = hb_mc_manycore_pod_invalidate_vcache(device->mc, pod->pod_coord);
+        err = pod_dma_jobs_apply_to_vcache(device->mc, pod, jobs, count, whole_cache,
+                                           hb_mc_manycore_pod_invalidate_vcache,
+                                           hb_mc_manycore_vcache_invalidate_eva_range_nofence);
         if (err != HB_MC_SUCCESS) {
                 return err;
         }
@@ -2080,15 +3754,22 @@ int hb_mc_device_pod_dma_to_device(hb_mc_device_t *device, hb_mc_pod_id_t pod_id
 
 int hb_mc_device_pod_dma_to_host(hb_mc_device_t *device, hb_mc_pod_id_t pod_id, const hb_mc_dma_dtoh_t *jobs, size_t count)
 {
+        HB_MC_API_TRACE_SCOPE("cuda", device->mc, dma_jobs_trace_size(jobs, count));
         int err;
         CHECK_POD_ID(device, pod_id);
 
         if (!hb_mc_manycore_supports_dma_read(device->mc))
                 return HB_MC_NOIMPL;
 
-        // flush cache
         hb_mc_pod_t *pod = &device->pods[pod_id];
-        err = hb_mc_manycore_pod_flush_vcache(device->mc, pod->pod_coord);
+
+        // small transfers only touch the cache lines that can hold them
+        bool whole_cache = pod_dma_jobs_exceed_vcache(device->mc, pod->pod_coord, jobs, count);
+
+        // flush cache
+        err = pod_dma_jobs_apply_to_vcache(device->mc, pod, jobs, count, whole_cache,
+                                           hb_mc_manycore_pod_flush_vcache,
+                                           hb_mc_manycore_vcache_flush_eva_range_nofence);
         if (err != HB_MC_SUCCESS) {
                 bsg_pr_err("%s: failed to flush victim cache: %s\n",
                            __func__,
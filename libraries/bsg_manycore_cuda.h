@@ -29,6 +29,9 @@
 #define BSG_MANYCORE_CUDA_H
 #include <bsg_manycore_features.h>
 #include <bsg_manycore_eva.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_mesh_occupancy.h>
+#include <bsg_manycore_memory_allocator.h>
 
 #ifdef __cplusplus
 #include <cstdint>
@@ -47,6 +50,8 @@ extern "C" {
 #define HB_MC_CUDA_FINISH_SIGNAL_VAL            0xFACE
         // The begining of section in host memory intended for tile groups to write finish signals into.
 #define HB_MC_CUDA_HOST_FINISH_SIGNAL_BASE_ADDR 0xF000  
+        // The number of finish signal words between the base and the top of the host's global EPA space.
+#define HB_MC_CUDA_HOST_FINISH_SIGNAL_WORDS     (((1 << HB_MC_GLOBAL_EPA_LOGSZ) - HB_MC_CUDA_HOST_FINISH_SIGNAL_BASE_ADDR) >> 2)
 
 
 
@@ -69,6 +74,37 @@ extern "C" {
         } hb_mc_tile_status_t;
 
 
+        /**
+         * The order in which ready tile groups are tried when tiles are free.
+         */
+        typedef enum {
+                HB_MC_TILE_GROUP_ORDER_BACKFILL=0,      // enqueue order, passing over tile groups that do not fit
+                HB_MC_TILE_GROUP_ORDER_FIFO=1,          // enqueue order, stopping at the first that does not fit
+                HB_MC_TILE_GROUP_ORDER_LARGEST_FIRST=2, // most tiles first, passing over those that do not fit
+        } hb_mc_tile_group_order_t;
+
+
+        /**
+         * Where in the mesh a tile group is placed.
+         */
+        typedef enum {
+                HB_MC_TILE_GROUP_PLACEMENT_FIRST_FIT=0, // lowest x, then lowest y
+                HB_MC_TILE_GROUP_PLACEMENT_BEST_FIT=1,  // bordering the most busy tiles and mesh edges
+        } hb_mc_tile_group_placement_t;
+
+
+        /**
+         * How busy the tiles of a pod were while it ran tile groups,
+         * measured on the host from launch to receipt of the finish packet.
+         */
+        typedef struct {
+                uint64_t tile_groups;  // tile groups finished
+                uint64_t busy_tile_ns; // sum over tile groups of tiles times time launched
+                uint64_t active_ns;    // time with at least one tile group launched
+                uint32_t tiles;        // tiles in the mesh
+        } hb_mc_pod_utilization_t;
+
+
         typedef struct {
                 hb_mc_coordinate_t coord;
                 hb_mc_coordinate_t origin;      
@@ -83,7 +119,7 @@ extern "C" {
                 int             refcount;
         } hb_mc_kernel_t;
 
-        typedef struct {
+        typedef struct hb_mc_tile_group {
                 hb_mc_coordinate_t        id;
                 grid_id_t                 grid_id;
                 hb_mc_dimension_t         grid_dim;
@@ -94,13 +130,27 @@ extern "C" {
                 hb_mc_kernel_t           *kernel;
                 hb_mc_eva_t               argv_eva;
                 hb_mc_npa_t               finish_signal_npa;
+                uint64_t                  launch_ns; // host time of launch
+                uint64_t                  ready_seq; // enqueue order among ready tile groups
+                struct hb_mc_tile_group  *prev; // neighbours in the queue for #status
+                struct hb_mc_tile_group  *next;
         } hb_mc_tile_group_t;
 
+        /**
+         * A queue of tile groups, linked through the tile groups themselves.
+         */
+        typedef struct {
+                hb_mc_tile_group_t *head; // oldest
+                hb_mc_tile_group_t *tail; // newest
+                uint32_t            length;
+        } hb_mc_tile_group_queue_t;
+
 
         typedef struct {
                 hb_mc_dimension_t dim;
                 hb_mc_coordinate_t origin;
                 hb_mc_tile_t* tiles;
+                hb_mc_mesh_occupancy_t occupancy; // free tiles, relative to origin
         } hb_mc_mesh_t;
 
 
@@ -124,31 +174,44 @@ extern "C" {
 
         typedef struct {
                 const char* bin_name;
-                const unsigned char* bin;
+                hb_mc_loader_program_image_t *image; // parsed binary, shared with other pods
+                const unsigned char* bin; // owned by image
                 size_t bin_size;
+                const hb_mc_loader_symbol_table_t *symbols; // owned by image
                 hb_mc_allocator_t *allocator;
         } hb_mc_program_t;
 
         typedef int hb_mc_pod_id_t;
 
         typedef struct {
-                hb_mc_program_t    *program;
-                hb_mc_mesh_t       *mesh;
-                hb_mc_tile_group_t *tile_groups;
-                uint32_t            num_tile_groups;
-                uint32_t            tile_group_capacity;
-                uint8_t             num_grids;
-                hb_mc_coordinate_t  pod_coord; // what pod am I in the global manycore?
-                int                 program_loaded;
+                hb_mc_program_t          *program;
+                hb_mc_mesh_t             *mesh;
+                hb_mc_tile_group_queue_t  ready;         // initialized, waiting for free tiles
+                void                     *ready_by_size; // ready tile groups, most tiles first
+                hb_mc_tile_group_queue_t  launched;      // running, waiting for a finish packet
+                hb_mc_tile_group_queue_t  finished;      // most recent first, reused by later enqueues
+                void                     *finish_table;  // launched tile groups by finish signal
+                void                     *symbol_shadow; // runtime symbols last written to each tile
+                void                     *argv_arena;    // DRAM ring holding the argv of launched tile groups
+                uint8_t                   num_grids;
+                hb_mc_coordinate_t        pod_coord; // what pod am I in the global manycore?
+                int                       program_loaded;
+                hb_mc_pod_utilization_t   utilization;
+                uint64_t                  active_since_ns; // host time the launched queue last became non-empty
         } hb_mc_pod_t;
 
         typedef struct {
-                hb_mc_manycore_t *mc;
-                hb_mc_pod_t      *pods;
-                hb_mc_pod_id_t    num_pods;
-                const char       *name;
-                hb_mc_pod_id_t    default_pod_id;
-                hb_mc_dimension_t default_mesh_dim;
+                hb_mc_manycore_t             *mc;
+                hb_mc_pod_t                  *pods;
+                hb_mc_pod_id_t                num_pods;
+                const char                   *name;
+                hb_mc_pod_id_t                default_pod_id;
+                hb_mc_dimension_t             default_mesh_dim;
+                void                         *program_images; // parsed binaries, shared by pods and reloads
+                void                         *pod_threads;    // a host thread per pod, if enabled
+                void                         *streams;        // streams created with hb_mc_stream_init()
+                hb_mc_tile_group_order_t      tile_group_order;
+                hb_mc_tile_group_placement_t  tile_group_placement;
         } hb_mc_device_t; 
 
 
@@ -178,6 +241,18 @@ extern "C" {
 #define hb_mc_device_foreach_pod_id(device_ptr, pod_id)   \
         for (pod_id = 0; pod_id < (device_ptr)->num_pods; pod_id++)
 
+        /**
+         * Fraction of tile time a pod spent running tile groups while it had any launched.
+         * @param[in]  u   Utilization from hb_mc_device_pod_get_utilization()
+         * @return A number from 0 to 1, or 0 if the pod has not been active.
+         */
+        static inline double hb_mc_pod_utilization_fraction(const hb_mc_pod_utilization_t *u)
+        {
+                if (u->active_ns == 0 || u->tiles == 0)
+                        return 0.0;
+                return (double)u->busy_tile_ns / ((double)u->active_ns * u->tiles);
+        }
+
         /********************************/
         /* Pod Interface Initialization */
         /********************************/
@@ -271,6 +346,21 @@ extern "C" {
                                   hb_mc_pod_id_t  pod,
                                   hb_mc_eva_t     eva);
 
+        /**
+         * Reports usage of device's DRAM associated with the input pod:
+         * live and peak allocated bytes and the largest free block.
+         * hb_mc_device_pod_program_init() should have been called for device and pod
+         * before calling this function to set up a memory allocator.
+         * @param[in]  device        Pointer to device
+         * @param[in]  pod           Pod ID with a prorgam initialized
+         * @param[out] stats         Usage statistics of the pod's memory allocator
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_pod_memory_stats(hb_mc_device_t *device,
+                                          hb_mc_pod_id_t  pod,
+                                          hb_mc_memory_allocator_stats_t *stats);
+
         /*******************************/
         /* Pod Interface Data Movement */
         /*******************************/
@@ -418,6 +508,233 @@ extern "C" {
         __attribute__((warn_unused_result))
         int hb_mc_device_pods_kernels_execute(hb_mc_device_t *device);
 
+        /***************/
+        /* Pod Threads */
+        /***************/
+        /**
+         * Gives each pod of a device its own host thread. Work run with
+         * hb_mc_device_foreach_pod_run(), the replicated calls of the
+         * legacy interface, and hb_mc_device_podv_kernels_execute() then
+         * proceed on all pods at once, each pod waiting only on
+         * packets from its own tiles.
+         * @param[in]  device        Pointer to device
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_enable_pod_threads(hb_mc_device_t *device);
+
+        /**
+         * Work to be done on one pod of a device.
+         * @param[in]  device        Pointer to device
+         * @param[in]  pod           Pod ID
+         * @param[in]  arg           Argument passed to hb_mc_device_foreach_pod_run()
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        typedef int (*hb_mc_device_pod_fn_t)(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg);
+
+        /**
+         * Runs a function on every pod of a device and waits for all of them.
+         * With pod threads enabled, each call runs on its pod's thread in parallel.
+         * Otherwise the calls run in pod order on the calling thread, stopping at the first failure.
+         * @param[in]  device        Pointer to device
+         * @param[in]  fn            Function to call for each pod
+         * @param[in]  arg           Argument passed to each call of #fn
+         * @return HB_MC_SUCCESS if all calls succeeded. Otherwise the error of the lowest failing pod.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_foreach_pod_run(hb_mc_device_t *device,
+                                         hb_mc_device_pod_fn_t fn,
+                                         void *arg);
+
+        /**
+         * Sets the order in which a device tries ready tile groups and where it places them.
+         * The default is HB_MC_TILE_GROUP_ORDER_BACKFILL and HB_MC_TILE_GROUP_PLACEMENT_FIRST_FIT.
+         * @param[in]  device        Pointer to device
+         * @param[in]  order         Order in which ready tile groups are tried
+         * @param[in]  placement     Where a tile group is placed in the mesh
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_set_tile_group_policy(hb_mc_device_t *device,
+                                               hb_mc_tile_group_order_t order,
+                                               hb_mc_tile_group_placement_t placement);
+
+        /**
+         * Gets the utilization of a pod's tiles since its program was
+         * initialized or hb_mc_device_pod_reset_utilization() was last called.
+         * @param[in]  device        Pointer to device
+         * @param[in]  pod           Pod ID
+         * @param[out] utilization   Utilization of the pod's tiles
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_pod_get_utilization(hb_mc_device_t *device,
+                                             hb_mc_pod_id_t pod,
+                                             hb_mc_pod_utilization_t *utilization);
+
+        /**
+         * Starts measuring the utilization of a pod's tiles afresh.
+         * @param[in]  device        Pointer to device
+         * @param[in]  pod           Pod ID
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_device_pod_reset_utilization(hb_mc_device_t *device,
+                                               hb_mc_pod_id_t pod);
+
+        /********************/
+        /* Stream Interface */
+        /********************/
+        /**
+         * An ordered queue of copies and kernel launches on a pod.
+         * Operations in a stream run one after another; operations in
+         * different streams of a device may overlap, e.g. the copies
+         * for one batch with the kernels of the previous one.
+         * Streams make progress while the host waits on any of them.
+         */
+        typedef struct {
+                hb_mc_device_t *device;
+                hb_mc_pod_id_t  pod;
+                uint64_t        ops_enqueued;  // operations ever added
+                uint64_t        ops_completed; // operations completed, in order
+                void           *ops;           // pending operations, oldest first
+        } hb_mc_stream_t;
+
+        /**
+         * A point in a stream, reached when every operation enqueued
+         * on the stream before it has completed.
+         */
+        typedef struct {
+                hb_mc_stream_t *stream;
+                uint64_t        seq;
+        } hb_mc_event_t;
+
+        /**
+         * Creates a stream of operations on a pod.
+         * Streams cannot be used on a device with pod threads enabled.
+         * @param[in]  device        Pointer to device
+         * @param[in]  pod           Pod ID
+         * @param[out] stream        Stream to initialize
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_init(hb_mc_device_t *device, hb_mc_pod_id_t pod, hb_mc_stream_t *stream);
+
+        /**
+         * Waits for all operations on a stream to complete and destroys it.
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_finish(hb_mc_stream_t *stream);
+
+        /**
+         * Enqueues a copy from the host to the stream's pod.
+         * #haddr must stay valid until the copy completes.
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @param[in]  daddr         EVA address of destination to be copied into
+         * @param[in]  haddr         Host address of source to be copied from
+         * @param[in]  bytes         Size of buffer to be copied
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_memcpy_to_device_async(hb_mc_stream_t *stream,
+                                                hb_mc_eva_t daddr,
+                                                const void *haddr,
+                                                uint32_t bytes);
+
+        /**
+         * Enqueues a copy from the stream's pod to the host.
+         * #haddr holds the data once the copy completes.
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @param[in]  haddr         Host address of destination to be copied into
+         * @param[in]  daddr         EVA address of source to be copied from
+         * @param[in]  bytes         Size of buffer to be copied
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_memcpy_to_host_async(hb_mc_stream_t *stream,
+                                              void *haddr,
+                                              hb_mc_eva_t daddr,
+                                              uint32_t bytes);
+
+        /**
+         * Enqueues setting memory on the stream's pod to a value.
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @param[in]  daddr         EVA address of destination
+         * @param[in]  val           Value to be written out
+         * @param[in]  bytes         The number of bytes to set
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_memset_async(hb_mc_stream_t *stream,
+                                      hb_mc_eva_t daddr,
+                                      uint8_t val,
+                                      size_t bytes);
+
+        /**
+         * Enqueues a kernel launch. The kernel's tile groups are handed to
+         * the pod when every earlier operation on the stream has completed,
+         * and the launch completes when all of them have finished.
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @param[in]  grid_dim      X/Y dimensions of the grid to be initialized
+         * @param[in]  tg_dim        X/Y dimensions of tile groups in grid
+         * @param[in]  name          Kernel name to be executed on tile groups in grid
+         * @param[in]  argc          Number of input arguments to kernel
+         * @param[in]  argv          List of input arguments to kernel
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_kernel_launch_async(hb_mc_stream_t *stream,
+                                             hb_mc_dimension_t grid_dim,
+                                             hb_mc_dimension_t tg_dim,
+                                             const char *name,
+                                             uint32_t argc,
+                                             const uint32_t *argv);
+
+        /**
+         * Waits for all operations enqueued on a stream to complete.
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_synchronize(hb_mc_stream_t *stream);
+
+        /**
+         * Records an event at the current end of a stream.
+         * @param[out] event         Event to record
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_event_record(hb_mc_event_t *event, hb_mc_stream_t *stream);
+
+        /**
+         * Makes later operations on a stream wait until an event is reached.
+         * @param[in]  stream        A stream initialized with hb_mc_stream_init()
+         * @param[in]  event         An event recorded with hb_mc_event_record()
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_stream_wait_event(hb_mc_stream_t *stream, const hb_mc_event_t *event);
+
+        /**
+         * Makes progress on the device's streams without blocking and checks an event.
+         * @param[in]  event         An event recorded with hb_mc_event_record()
+         * @return HB_MC_SUCCESS if the event has been reached, HB_MC_BUSY if not.
+         *         Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_event_query(const hb_mc_event_t *event);
+
+        /**
+         * Waits until an event is reached.
+         * @param[in]  event         An event recorded with hb_mc_event_record()
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_event_synchronize(const hb_mc_event_t *event);
+
         /*************************/
         /* Pod Interface Cleanup */
         /*************************/
@@ -46,6 +46,50 @@
 /* Legacy Interface */
 /********************/
 
+/* arguments of replicated calls, for hb_mc_device_foreach_pod_run() */
+typedef struct {
+        const char *bin_name;
+        const unsigned char *bin_data;
+        size_t bin_size;
+        const hb_mc_program_options_t *opts;
+} program_init_args_t;
+
+typedef struct {
+        hb_mc_eva_t daddr;
+        const void *haddr;
+        uint32_t bytes;
+} memcpy_to_device_args_t;
+
+typedef struct {
+        hb_mc_eva_t eva;
+        uint8_t data;
+        size_t sz;
+} memset_args_t;
+
+static int pod_program_init_binary(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        program_init_args_t *args = (program_init_args_t*)arg;
+        return hb_mc_device_pod_program_init_binary_opts(device, pod, args->bin_data, args->bin_size, args->opts);
+}
+
+static int pod_program_init(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        program_init_args_t *args = (program_init_args_t*)arg;
+        return hb_mc_device_pod_program_init_opts(device, pod, args->bin_name, args->opts);
+}
+
+static int pod_memcpy_to_device(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        memcpy_to_device_args_t *args = (memcpy_to_device_args_t*)arg;
+        return hb_mc_device_pod_memcpy_to_device(device, pod, args->daddr, args->haddr, args->bytes);
+}
+
+static int pod_memset(hb_mc_device_t *device, hb_mc_pod_id_t pod, void *arg)
+{
+        memset_args_t *args = (memset_args_t*)arg;
+        return hb_mc_device_pod_memset(device, pod, args->eva, args->data, args->sz);
+}
+
 
 /**
  * Takes in a buffer containing the binary and its size,
@@ -73,11 +117,8 @@ int hb_mc_device_program_init_binary (hb_mc_device_t *device,
         opts.alloc_id = id;
         opts.program_name = bin_name;
 
-        hb_mc_pod_id_t pod;
-        hb_mc_device_foreach_pod_id(device, pod)
-        {
-                BSG_CUDA_CALL(hb_mc_device_pod_program_init_binary_opts(device, pod, bin_data, bin_size, &opts));
-        }
+        program_init_args_t args = { bin_name, bin_data, bin_size, &opts };
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_program_init_binary, &args));
         return HB_MC_SUCCESS;
 }
 
@@ -107,11 +148,8 @@ int hb_mc_device_program_init (hb_mc_device_t *device,
         opts.alloc_id = id;
         opts.program_name = bin_name;
 
-        hb_mc_pod_id_t pod;
-        hb_mc_device_foreach_pod_id(device, pod)
-        {
-                BSG_CUDA_CALL(hb_mc_device_pod_program_init_opts(device, pod, bin_name, &opts));
-        }
+        program_init_args_t args = { bin_name, NULL, 0, &opts };
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_program_init, &args));
         return HB_MC_SUCCESS;
 }
 
@@ -189,12 +227,8 @@ int hb_mc_device_memcpy_to_device(hb_mc_device_t *device,
                                   uint32_t bytes)
 {
         bsg_pr_dbg("%s: calling replicated\n", __func__);
-        hb_mc_pod_id_t pod;
-        hb_mc_device_foreach_pod_id(device, pod)
-        {
-                BSG_CUDA_CALL(hb_mc_device_pod_memcpy_to_device(device, pod,
-                                                                daddr, haddr, bytes));
-        }
+        memcpy_to_device_args_t args = { daddr, haddr, bytes };
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_memcpy_to_device, &args));
         return HB_MC_SUCCESS;
 }
 
@@ -236,11 +270,8 @@ int hb_mc_device_memset (hb_mc_device_t *device,
                          size_t sz)
 {
         bsg_pr_dbg("%s: calling replicated\n", __func__);
-        hb_mc_pod_id_t pod;
-        hb_mc_device_foreach_pod_id(device, pod)
-        {
-                BSG_CUDA_CALL(hb_mc_device_pod_memset(device, pod, *eva, data, sz));
-        }
+        memset_args_t args = { *eva, data, sz };
+        BSG_CUDA_CALL(hb_mc_device_foreach_pod_run(device, pod_memset, &args));
         return HB_MC_SUCCESS;
 }
 
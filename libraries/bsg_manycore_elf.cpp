@@ -46,140 +46,93 @@
 #include <stdio.h>
 #endif
 
-#include <unistd.h>
-#include <elf.h>
+#include <bsg_manycore_loader.h>
+
+#include <sys/stat.h>
 
 #include <map>
+#include <mutex>
 #include <string>
-#include <memory>
 
 using std::string;
 using std::map;
-using std::unique_ptr;
-
-struct SymbolInfo {        
-        char * name;
-        Elf32_Addr   value;
-        Elf32_Word   size;
-        SymbolInfo(const char*name, Elf32_Addr value, Elf32_Word size):
-                name(strdup(name)),
-                value(value),
-                size(size) {}
-        virtual ~SymbolInfo() { free(name); }
-};
-
-typedef unique_ptr<SymbolInfo> SymbolInfoPtr;
-typedef map<string, SymbolInfoPtr> symbol_table;
-
-
 
-static int object_symbol_table_import_symbols(symbol_table& symbols, unsigned char *object_data, Elf32_Shdr *symtab_shdr, Elf32_Shdr *strtab_shdr)
+/* the symbols of a file, and the file as it was when they were parsed */
+typedef struct {
+        dev_t dev;
+        ino_t ino;
+        off_t size;
+        struct timespec mtime;
+        hb_mc_loader_symbol_table_t *symbols;
+} symbol_table_file;
+
+/*
+ * Symbol tables by path. A table lives until the process exits, or
+ * until its file changes and it is parsed again.
+ */
+typedef map<string, symbol_table_file> symbol_table_cache;
+
+static std::mutex symbol_tables_lock;
+static symbol_table_cache symbol_tables;
+
+/**
+ * Parse the symbols of #fname, reading the file again only if it has
+ * changed since it was last read. The caller holds symbol_tables_lock.
+ */
+static hb_mc_loader_symbol_table_t *object_symbol_table_get(const char *fname)
 {
-        Elf32_Word sym_n = symtab_shdr->sh_size/symtab_shdr->sh_entsize;
-        Elf32_Word sym_i;
-        Elf32_Sym *sym, *sym_base = (Elf32_Sym *)&object_data[symtab_shdr->sh_offset];
-        char *strtab_base = (char*) &object_data[strtab_shdr->sh_offset];
-        
-        const char *sym_name;
-        
-        for (sym_i = 0; sym_i < sym_n; sym_i++) {
-                sym = &sym_base[sym_i];
-
-                /* skip symbols with no name */
-                if (sym->st_name == 0)
-                        continue;
-                
-                sym_name = &strtab_base[sym->st_name];
-                
-                SymbolInfo *sym_info = new SymbolInfo(sym_name, sym->st_value, sym->st_size);
-                
-                symbols[string(sym_name)] = SymbolInfoPtr(sym_info);
-        }
-        return 0;
-}
-
-static void object_symbol_table_init(const char *fname, symbol_table& symbols)
-{
-        FILE *f = fopen(fname, "rb");
-        long size;
         unsigned char *object_data;
-        Elf32_Ehdr *ehdr;
-        Elf32_Shdr *shdr, *symtab_shdr, *strtab_shdr;
-        Elf32_Sym  *sym;
-        int section_i, r;
-        
-        if (!f) {
-                bsg_pr_err("%s: failed to open '%s': %s\n", __func__, fname, strerror(errno));
-                goto fail_return;
-        }
-
-        fseek(f, 0, SEEK_END);
-        size = ftell(f);
-        if (size < 0) {
-                bsg_pr_err("%s: failed to stat '%s': %s\n", __func__, fname, strerror(errno));
-                goto fail_close_f;
+        size_t size;
+        hb_mc_loader_symbol_table_t *symbols;
+        struct stat st;
+        int r;
+
+        if (stat(fname, &st) != 0) {
+                bsg_pr_err("%s: could not stat '%s': %m\n", __func__, fname);
+                exit(1);
         }
 
-        object_data = (unsigned char*)malloc(size);
-        if (!object_data) {
-                bsg_pr_err("%s: failed to read '%s': %s\n", __func__, fname, strerror(errno));
-                goto fail_close_f;
+        symbol_table_cache::iterator it = symbol_tables.find(string(fname));
+        if (it != symbol_tables.end()) {
+                const symbol_table_file &file = it->second;
+                if (file.dev == st.st_dev && file.ino == st.st_ino &&
+                    file.size == st.st_size &&
+                    file.mtime.tv_sec == st.st_mtim.tv_sec &&
+                    file.mtime.tv_nsec == st.st_mtim.tv_nsec)
+                        return file.symbols;
         }
 
-        fseek(f, 0, SEEK_SET);
-        if ((r = fread(object_data, size, 1, f)) != 1) {
-                bsg_pr_err("%s: failed to read '%s' (fread returned %d): %s\n", __func__, fname, r, strerror(errno));
-                goto fail_free_object_data;
-        }
+        r = hb_mc_loader_read_program_file(fname, &object_data, &size);
+        if (r != HB_MC_SUCCESS)
+                exit(1);
 
-        /* check that this is indeed an ELF file */
-        if (memcmp(object_data, ELFMAG, SELFMAG) != 0) {
-                bsg_pr_err("%s: '%s' is not a valid ELF file\n", __func__, fname);
-                goto fail_free_object_data;
-        }
-        /* check that this is 32-bit little endian */
-        if (!(object_data[EI_CLASS] == ELFCLASS32  &&
-              object_data[EI_DATA]  == ELFDATA2LSB)) {
-                bsg_pr_err("%s: '%s' is not a 32-bit little endian object file\n", __func__, fname);
-                goto fail_free_object_data;
-        }
-        /* check here for RISC-V? */
-        /* find each section that is a symbol table */
-        ehdr = (Elf32_Ehdr*)object_data;
-        shdr = (Elf32_Shdr*)&object_data[ehdr->e_shoff];
-        for (section_i = 0; section_i < ehdr->e_shnum; section_i++) {
-                // only looking for symbol tables
-                if (shdr[section_i].sh_type != SHT_SYMTAB)
-                        continue;
-                
-                symtab_shdr = &shdr[section_i];
-                strtab_shdr = &shdr[symtab_shdr->sh_link];
-                /* add all symbols to the symbol table */
-                if (object_symbol_table_import_symbols(symbols, object_data, symtab_shdr, strtab_shdr) < 0)
-                        goto fail_free_object_data;
+        r = hb_mc_loader_symbol_table_init(object_data, size, &symbols);
+        free(object_data);
+        if (r != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to read symbols from '%s': %s\n",
+                           __func__, fname, hb_mc_strerror(r));
+                exit(1);
         }
 
-        free(object_data);
-        fclose(f);
-        return;
-        
- fail_free_object_data:
-        free(object_data);
- fail_close_f:
-        fclose(f);
- fail_return:
-        exit(1);
+        symbol_table_file &file = symbol_tables[string(fname)];
+        hb_mc_loader_symbol_table_cleanup(file.symbols); // the file was rebuilt
+        file.dev = st.st_dev;
+        file.ino = st.st_ino;
+        file.size = st.st_size;
+        file.mtime = st.st_mtim;
+        file.symbols = symbols;
+        return symbols;
 }
 
 int symbol_to_eva(const char *fname, const char *sym_name, eva_t* eva)
 {
-        static symbol_table symbols;
-        object_symbol_table_init(fname, symbols);
-        symbol_table::iterator it = symbols.find(string(sym_name));
-        if (it != symbols.end()) {
-                *eva = (it->second->value);
-                return HB_MC_SUCCESS;
-        } else {
+        std::lock_guard<std::mutex> guard(symbol_tables_lock);
+        hb_mc_loader_symbol_table_t *symbols = object_symbol_table_get(fname);
+        hb_mc_eva_t sym_eva;
+
+        if (hb_mc_loader_symbol_table_lookup(symbols, sym_name, &sym_eva) != HB_MC_SUCCESS)
                 return HB_MC_FAIL;
-        }
+
+        *eva = sym_eva;
+        return HB_MC_SUCCESS;
 }
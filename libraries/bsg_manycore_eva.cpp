@@ -40,12 +40,12 @@
 #include <bsg_manycore_tile.h>
 #include <bsg_manycore_vcache.h>
 #include <bsg_manycore_printing.h>
+#include <bsg_manycore_platform.h>
 
 
 #ifdef __cplusplus
-#include <cmath>
-#else
-#include <math.h>
+#include <new>
+#include <vector>
 #endif
 
 #define MAKE_MASK(WIDTH) ((1ULL << (WIDTH)) - 1ULL)
@@ -75,6 +75,106 @@
 #define DEFAULT_DRAM_BITIDX 31
 #define DEFAULT_DRAM_BITMASK (1ULL << DEFAULT_DRAM_BITIDX)
 
+/**
+ * The shifts, masks, and bounds that the default EVA map derives from a
+ * manycore configuration. A plan is computed once per manycore by
+ * hb_mc_eva_plan_init() so that translating an EVA or NPA is a handful of
+ * shifts, masks, and adds instead of config lookups and floating point.
+ */
+typedef struct default_eva_plan {
+        uint32_t dram_stripe_log;      //!< clog2(victim cache stripe size): stripe byte-offset bits
+        uint32_t dram_stripe_mask;     //!< MAKE_MASK(dram_stripe_log)
+        uint32_t dram_x_dimlog;        //!< clog2(pod columns): x-coordinate bits of a DRAM EVA
+        uint32_t dram_x_mask;          //!< MAKE_MASK(dram_x_dimlog)
+        uint32_t dram_ns_shift;        //!< position of the north/south bit of a DRAM EVA
+        uint32_t dram_epa_top_shift;   //!< position of EPA_top in a DRAM EVA
+        size_t   dram_epa_limit[2];    //!< addressable bytes per bank, indexed by dram_enabled
+        size_t   dram_epa_valid[2];    //!< valid EPA bound per bank, indexed by dram_enabled
+        hb_mc_coordinate_t tile_coord_width; //!< bits of a network coordinate within a pod
+        hb_mc_coordinate_t pod_coord_mask;   //!< masks a vanilla core down to its pod's origin
+        hb_mc_dimension_t pod_shape;         //!< vanilla cores in a pod
+        hb_mc_idx_t group_max_x;       //!< largest X a group EVA may name
+        hb_mc_idx_t group_max_y;       //!< largest Y a group EVA may name
+        size_t dmem_size;              //!< bytes of tile data memory
+} default_eva_plan_t;
+
+/**
+ * Integer ceil(log2(#v)).
+ */
+static uint32_t default_clog2(uint64_t v)
+{
+        uint32_t log = 0;
+        while ((1ULL << log) < v)
+                log++;
+        return log;
+}
+
+/**
+ * Compute the default EVA map's translation plan from a configuration.
+ * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[out] plan   A plan to be filled in from #cfg
+ */
+static void default_eva_plan_compute(const hb_mc_config_t *cfg, default_eva_plan_t *plan)
+{
+        hb_mc_dimension_t dim = hb_mc_config_get_dimension_vcore(cfg);
+
+        plan->dram_stripe_log    = default_clog2(hb_mc_config_get_vcache_stripe_size(cfg));
+        plan->dram_stripe_mask   = MAKE_MASK(plan->dram_stripe_log);
+        plan->dram_x_dimlog      = default_clog2(hb_mc_dimension_get_x(dim));
+        plan->dram_x_mask        = MAKE_MASK(plan->dram_x_dimlog);
+        plan->dram_ns_shift      = plan->dram_stripe_log + plan->dram_x_dimlog;
+        plan->dram_epa_top_shift = plan->dram_ns_shift + 1;
+
+        // without DRAM the victim caches are the backing store
+        plan->dram_epa_limit[0] = 1ULL << default_clog2(hb_mc_config_get_vcache_size(cfg));
+        plan->dram_epa_limit[1] = 1ULL << hb_mc_config_get_vcache_bitwidth_data_addr(cfg);
+        plan->dram_epa_valid[0] = hb_mc_config_get_vcache_size(cfg);
+        plan->dram_epa_valid[1] = hb_mc_config_get_dram_size(cfg);
+
+        plan->tile_coord_width = hb_mc_config_tile_coord_width(cfg);
+        plan->pod_coord_mask   = hb_mc_config_pod_coord_mask(cfg);
+        plan->pod_shape        = dim;
+        plan->group_max_x = hb_mc_dimension_get_x(dim) + hb_mc_config_get_vcore_base_x(cfg);
+        plan->group_max_y = hb_mc_dimension_get_y(dim) + hb_mc_config_get_vcore_base_y(cfg);
+        plan->dmem_size   = hb_mc_config_get_dmem_size(cfg);
+}
+
+/**
+ * Get the translation plan of a manycore.
+ * @param[in]  mc       An initialized manycore struct
+ * @param[in]  scratch  Filled in and returned if #mc has no precomputed plan
+ * @return The plan for #mc.
+ */
+static const default_eva_plan_t *default_eva_plan(const hb_mc_manycore_t *mc,
+                                                  default_eva_plan_t *scratch)
+{
+        if (mc->eva_plan != nullptr)
+                return reinterpret_cast<const default_eva_plan_t *>(mc->eva_plan);
+
+        default_eva_plan_compute(hb_mc_manycore_get_config(mc), scratch);
+        return scratch;
+}
+
+/**
+ * Get the vanilla core origin of the pod that a coordinate belongs to.
+ * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  plan   The translation plan for #cfg
+ * @param[in]  co     A network coordinate
+ * @return The origin of the pod that #co belongs to.
+ */
+static hb_mc_coordinate_t default_eva_plan_pod_origin(const hb_mc_config_t *cfg,
+                                                      const default_eva_plan_t *plan,
+                                                      hb_mc_coordinate_t co)
+{
+        // vanilla cores sit in odd network pod rows, and their pod's
+        // origin is their network pod's first tile
+        if ((co.y >> plan->tile_coord_width.y) & 1)
+                return hb_mc_coordinate(co.x & plan->pod_coord_mask.x,
+                                        co.y & plan->pod_coord_mask.y);
+
+        return hb_mc_config_pod_vcore_origin(cfg, hb_mc_config_pod(cfg, co));
+}
+
 /**
  * Determines if an EVA is a tile-local EVA
  * @return true if EVA addresses tile-local memory, false otherwise
@@ -88,14 +188,14 @@ static bool default_eva_is_local(const hb_mc_eva_t *eva)
 /**
  * Returns the EPA and number of contiguous bytes for an EVA in a tile,
  * regardless of the continuity of the underlying NPA.
- * @param[in]  cfg       An initialized manycore configuration struct
+ * @param[in]  plan      The translation plan of the manycore
  * @param[in]  eva       An Endpoint Virtual Address
  * @param[out] epa       An Endpoint Physical Address to be set by translating #eva
  * @param[out] sz        Number of contiguous bytes remaining in the #eva segment
  * @param[in]  epa_mask  A mask for the EPA within the EVA
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-static int default_eva_to_epa_tile(const hb_mc_config_t *cfg,
+static int default_eva_to_epa_tile(const default_eva_plan_t *plan,
                                    const hb_mc_eva_t *eva,
                                    hb_mc_epa_t *epa,
                                    size_t *sz,
@@ -103,7 +203,7 @@ static int default_eva_to_epa_tile(const hb_mc_config_t *cfg,
 {
         hb_mc_eva_t eva_masked, eva_dmem;
         size_t dmem_size;
-        dmem_size = hb_mc_config_get_dmem_size(cfg);
+        dmem_size = plan->dmem_size;
         eva_masked = hb_mc_eva_addr(eva) & epa_mask;
         eva_dmem = eva_masked - HB_MC_TILE_EVA_DMEM_BASE;
 
@@ -137,7 +237,7 @@ static int default_eva_to_epa_tile(const hb_mc_config_t *cfg,
 
 /**
  * Converts a local Endpoint Virtual Address to an Endpoint Physical Address for a global EVA
- * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  plan   The translation plan of the manycore
  * @param[in]  o      Coordinate of the origin for this tile's group
  * @param[in]  src    Coordinate of the tile issuing this #eva
  * @param[in]  eva    An eva to translate
@@ -145,18 +245,18 @@ static int default_eva_to_epa_tile(const hb_mc_config_t *cfg,
  * @param[out] sz     The size in bytes of the NPA segment for the #eva
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-static int default_eva_to_epa_tile_global(const hb_mc_config_t *cfg,
+static int default_eva_to_epa_tile_global(const default_eva_plan_t *plan,
                                           const hb_mc_eva_t *eva,
                                           hb_mc_epa_t *epa,
                                           size_t *sz)
 {
-        return default_eva_to_epa_tile(cfg, eva, epa, sz, MAKE_MASK(HB_MC_GLOBAL_EPA_LOGSZ));
+        return default_eva_to_epa_tile(plan, eva, epa, sz, MAKE_MASK(HB_MC_GLOBAL_EPA_LOGSZ));
 }
 
 
 /**
  * Converts a local Endpoint Virtual Address to an Endpoint Physical Address for group EVA
- * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  plan   The translation plan of the manycore
  * @param[in]  o      Coordinate of the origin for this tile's group
  * @param[in]  src    Coordinate of the tile issuing this #eva
  * @param[in]  eva    An eva to translate
@@ -164,17 +264,17 @@ static int default_eva_to_epa_tile_global(const hb_mc_config_t *cfg,
  * @param[out] sz     The size in bytes of the NPA segment for the #eva
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-static int default_eva_to_epa_tile_group(const hb_mc_config_t *cfg,
+static int default_eva_to_epa_tile_group(const default_eva_plan_t *plan,
                                          const hb_mc_eva_t *eva,
                                          hb_mc_epa_t *epa,
                                          size_t *sz)
 {
-        return default_eva_to_epa_tile(cfg, eva, epa, sz, MAKE_MASK(HB_MC_EPA_LOGSZ));
+        return default_eva_to_epa_tile(plan, eva, epa, sz, MAKE_MASK(HB_MC_EPA_LOGSZ));
 }
 
 /**
  * Converts a local Endpoint Virtual Address to a Network Physical Address
- * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  plan   The translation plan of the manycore
  * @param[in]  o      Coordinate of the origin for this tile's group
  * @param[in]  src    Coordinate of the tile issuing this #eva
  * @param[in]  eva    An eva to translate
@@ -182,7 +282,7 @@ static int default_eva_to_epa_tile_group(const hb_mc_config_t *cfg,
  * @param[out] sz     The size in bytes of the NPA segment for the #eva
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-static int default_eva_to_npa_local(const hb_mc_config_t *cfg,
+static int default_eva_to_npa_local(const default_eva_plan_t *plan,
                                     const hb_mc_coordinate_t *o,
                                     const hb_mc_coordinate_t *src,
                                     const hb_mc_eva_t *eva,
@@ -195,7 +295,7 @@ static int default_eva_to_npa_local(const hb_mc_config_t *cfg,
         x = hb_mc_coordinate_get_x(*src);
         y = hb_mc_coordinate_get_y(*src);
 
-        rc = default_eva_to_epa_tile_group(cfg, eva, &epa, sz);
+        rc = default_eva_to_epa_tile_group(plan, eva, &epa, sz);
         if (rc != HB_MC_SUCCESS)
                 return rc;
         *npa = hb_mc_epa_to_npa(hb_mc_coordinate(x,y), epa);
@@ -221,7 +321,7 @@ static bool default_eva_is_group(const hb_mc_eva_t *eva)
 
 /**
  * Converts a group Endpoint Virtual Address to a Network Physical Address
- * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  plan   The translation plan of the manycore
  * @param[in]  o      Coordinate of the origin for this tile's group
  * @param[in]  src    Coordinate of the tile issuing this #eva
  * @param[in]  eva    An eva to translate
@@ -229,20 +329,18 @@ static bool default_eva_is_group(const hb_mc_eva_t *eva)
  * @param[out] sz     The size in bytes of the NPA segment for the #eva
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-static int default_eva_to_npa_group(const hb_mc_config_t *cfg,
+static int default_eva_to_npa_group(const default_eva_plan_t *plan,
                                     const hb_mc_coordinate_t *o,
                                     const hb_mc_coordinate_t *src,
                                     const hb_mc_eva_t *eva,
                                     hb_mc_npa_t *npa, size_t *sz)
 {
         int rc;
-        hb_mc_dimension_t dim;
         hb_mc_idx_t x, y, ox, oy, dim_x, dim_y;
         hb_mc_epa_t epa;
 
-        dim = hb_mc_config_get_dimension_vcore(cfg);
-        dim_x = hb_mc_dimension_get_x(dim) + hb_mc_config_get_vcore_base_x(cfg);
-        dim_y = hb_mc_dimension_get_y(dim) + hb_mc_config_get_vcore_base_y(cfg);
+        dim_x = plan->group_max_x;
+        dim_y = plan->group_max_y;
         ox = hb_mc_coordinate_get_x(*o);
         oy = hb_mc_coordinate_get_y(*o);
         x = ((hb_mc_eva_addr(eva) & DEFAULT_GROUP_X_BITMASK) >> DEFAULT_GROUP_X_BITIDX);
@@ -263,7 +361,7 @@ static int default_eva_to_npa_group(const hb_mc_config_t *cfg,
                 return HB_MC_FAIL;
         }
 
-        rc = default_eva_to_epa_tile_group(cfg, eva, &epa, sz);
+        rc = default_eva_to_epa_tile_group(plan, eva, &epa, sz);
         if (rc != HB_MC_SUCCESS)
                 return rc;
         *npa = hb_mc_epa_to_npa(hb_mc_coordinate(x,y), epa);
@@ -290,7 +388,7 @@ static bool default_eva_is_global(const hb_mc_eva_t *eva)
 
 /**
  * Converts a global Endpoint Virtual Address to a Network Physical Address
- * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  plan   The translation plan of the manycore
  * @param[in]  o      Coordinate of the origin for this tile's group
  * @param[in]  src    Coordinate of the tile issuing this #eva
  * @param[in]  eva    An eva to translate
@@ -298,7 +396,7 @@ static bool default_eva_is_global(const hb_mc_eva_t *eva)
  * @param[out] sz     The size in bytes of the NPA segment for the #eva
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-static int default_eva_to_npa_global(const hb_mc_config_t *cfg,
+static int default_eva_to_npa_global(const default_eva_plan_t *plan,
                                      const hb_mc_coordinate_t *o,
                                      const hb_mc_coordinate_t *src,
                                      const hb_mc_eva_t *eva,
@@ -313,7 +411,7 @@ static int default_eva_to_npa_global(const hb_mc_config_t *cfg,
         y = ((hb_mc_eva_addr(eva) & DEFAULT_GLOBAL_Y_BITMASK) >> DEFAULT_GLOBAL_Y_BITIDX);
         bsg_pr_dbg("%s: EVA=%08x, x = %x, y = %x\n", __func__, *eva, x, y);
 
-        rc = default_eva_to_epa_tile_global(cfg, eva, &epa, sz);
+        rc = default_eva_to_epa_tile_global(plan, eva, &epa, sz);
         if (rc != HB_MC_SUCCESS)
                 return rc;
         *npa = hb_mc_epa_to_npa(hb_mc_coordinate(x,y), epa);
@@ -338,54 +436,6 @@ static bool default_eva_is_dram(const hb_mc_eva_t *eva)
         return (hb_mc_eva_addr(eva) & DEFAULT_DRAM_BITMASK) != 0;
 }
 
-static uint32_t default_dram_max_x_coord(const hb_mc_config_t *cfg, const hb_mc_coordinate_t *tgt)
-{
-        hb_mc_dimension_t dim = hb_mc_config_get_dimension_vcore(cfg);
-        hb_mc_dimension_t pod = hb_mc_config_pod(cfg, *tgt);
-        hb_mc_coordinate_t og = hb_mc_config_pod_vcore_origin(cfg, pod);
-        return hb_mc_coordinate_get_x(og) + hb_mc_dimension_get_x(dim) - 1;
-}
-
-static uint32_t default_dram_min_x_coord(const hb_mc_config_t *cfg, const hb_mc_coordinate_t *tgt)
-{
-        hb_mc_dimension_t pod = hb_mc_config_pod(cfg, *tgt);
-        hb_mc_coordinate_t og = hb_mc_config_pod_vcore_origin(cfg, pod);
-        return hb_mc_coordinate_get_x(og);
-}
-
-static uint32_t default_get_x_dimlog(const hb_mc_config_t *cfg)
-{
-        // clog2 of the #(columns) in a pod
-        hb_mc_dimension_t dim = hb_mc_config_get_dimension_vcore(cfg);
-        return ceil(log2(hb_mc_dimension_get_x(dim)));
-}
-
-static uint32_t default_get_dram_x_bitidx(const hb_mc_config_t *cfg)
-{
-        uint32_t xdimlog;
-        // The number of bits used for the x index is determined by clog2 of the
-        // x dimension (or the number of bits needed to represent the maximum x
-        // dimension).
-        xdimlog = default_get_x_dimlog(cfg);
-        return MAKE_MASK(xdimlog);
-}
-
-static uint32_t default_get_dram_stripe_size_log(const hb_mc_manycore_t *mc)
-{
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        return ceil(log2(hb_mc_config_get_vcache_stripe_size(cfg)));
-}
-
-static uint32_t default_get_dram_bitwidth(const hb_mc_manycore_t *mc)
-{
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        if (hb_mc_manycore_dram_is_enabled(mc)) {
-                return hb_mc_config_get_vcache_bitwidth_data_addr(cfg);
-        } else {
-                return ceil(log2(hb_mc_config_get_vcache_size(cfg))); // clog2(victim cache size)
-        }
-}
-
 static uint32_t default_get_dram_x_shift_dep(const hb_mc_manycore_t *mc)
 {
         const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
@@ -393,30 +443,14 @@ static uint32_t default_get_dram_x_shift_dep(const hb_mc_manycore_t *mc)
 }
 
 // See comments on default_eva_to_npa_dram 
-static int default_eva_get_x_coord_dram(const hb_mc_manycore_t *mc,
-                                        const hb_mc_config_t *cfg,
-                                        const hb_mc_coordinate_t *src,
+static int default_eva_get_x_coord_dram(const default_eva_plan_t *plan,
+                                        hb_mc_coordinate_t og,
                                         const hb_mc_eva_t *eva,
                                         hb_mc_idx_t *x) {
-        hb_mc_coordinate_t pod = hb_mc_config_pod(cfg, *src);
-        hb_mc_coordinate_t og = hb_mc_config_pod_vcore_origin(cfg, pod);
-#ifdef DEBUG
-        char pod_str[256];
-        char src_str [256];
-        char og_str [256];
-        hb_mc_coordinate_to_string(pod, pod_str, sizeof(pod_str));
-        hb_mc_coordinate_to_string(*src, src_str,  sizeof(src_str));
-        hb_mc_coordinate_to_string(og, og_str,  sizeof(og_str));
-        bsg_pr_dbg("%s: Source = %s maps to (Logical) Pod %s with origin %s\n",
-                    __func__, src_str, pod_str, og_str);
-#endif
-        uint32_t stripe_log = default_get_dram_stripe_size_log(mc);
-        uint32_t xmask = default_get_dram_x_bitidx(cfg);
-
-        uint32_t dram_max_x_coord = default_dram_max_x_coord(cfg, src);
-        uint32_t dram_min_x_coord = default_dram_min_x_coord(cfg, src);
+        uint32_t dram_max_x_coord = hb_mc_coordinate_get_x(og) + hb_mc_dimension_get_x(plan->pod_shape) - 1;
+        uint32_t dram_min_x_coord = hb_mc_coordinate_get_x(og);
 
-        *x = (hb_mc_eva_addr(eva) >> stripe_log) & xmask;
+        *x = (hb_mc_eva_addr(eva) >> plan->dram_stripe_log) & plan->dram_x_mask;
         *x += hb_mc_coordinate_get_x(og);
         if (*x > dram_max_x_coord || *x < dram_min_x_coord) {
                 bsg_pr_err("%s: Translation of EVA 0x%08" PRIx32 " failed. The X-coordinate "
@@ -430,23 +464,18 @@ static int default_eva_get_x_coord_dram(const hb_mc_manycore_t *mc,
 }
 
 // See comments on default_eva_to_npa_dram 
-static int default_eva_get_y_coord_dram(const hb_mc_manycore_t *mc,
-                                        const hb_mc_config_t *cfg,
-                                        const hb_mc_coordinate_t *src,
+static int default_eva_get_y_coord_dram(const default_eva_plan_t *plan,
+                                        hb_mc_coordinate_t og,
                                         const hb_mc_eva_t *eva,
                                         hb_mc_idx_t *y) { 
 
-        // Y can either be the North or South boundary of the chip
-        uint32_t shift
-                = default_get_dram_stripe_size_log(mc) // stripe byte-offset bits
-                + default_get_x_dimlog(cfg); // x-coordinate bits
-
-        uint32_t is_south = (hb_mc_eva_addr(eva) >> shift) & 1;
-        hb_mc_coordinate_t pod = hb_mc_config_pod(cfg, *src);
+        // Y can either be the North or South boundary of the chip; the
+        // north/south bit follows the stripe byte-offset and x-coordinate bits
+        uint32_t is_south = (hb_mc_eva_addr(eva) >> plan->dram_ns_shift) & 1;
 
         *y = is_south
-            ? hb_mc_config_pod_dram_south_y(cfg, pod)
-            : hb_mc_config_pod_dram_north_y(cfg, pod);
+            ? hb_mc_coordinate_get_y(og) + hb_mc_dimension_get_y(plan->pod_shape)
+            : hb_mc_coordinate_get_y(og) - 1;
 
         bsg_pr_dbg("%s: Translating Y-coordinate = %u for EVA 0x%08" PRIx32 "\n",
                    __func__, *y, *eva);
@@ -455,28 +484,23 @@ static int default_eva_get_y_coord_dram(const hb_mc_manycore_t *mc,
 }
 
 // See comments on default_eva_to_npa_dram 
-static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
-                                     const hb_mc_config_t *cfg,
+static int default_eva_get_epa_dram (const default_eva_plan_t *plan,
+                                     int dram_enabled,
                                      const hb_mc_eva_t *eva,
                                      hb_mc_epa_t *epa,
                                      size_t *sz) { 
  
-        uint32_t xdimlog    = default_get_x_dimlog(cfg);
-        uint32_t stripe_log = default_get_dram_stripe_size_log(mc);
-        uint32_t shift
-                = stripe_log // stripe byte-offset bits
-                + xdimlog    // x-coordinate bits
-                + 1;         // north-south bit
+        uint32_t stripe_log = plan->dram_stripe_log;
 
         // Refer to comments on default_eva_to_npa_dram for more clarification
         // DRAM EPA  =  EPA_top + block_offset + word_addressible  
         // Construct (block_offset + word_addressible) portion of EPA
         // i.e. the <stripe_log> lower bits of the EVA 
-        *epa = (hb_mc_eva_addr(eva) & MAKE_MASK(stripe_log));
+        *epa = (hb_mc_eva_addr(eva) & plan->dram_stripe_mask);
         // Construct the EPA_top portion of EPA and append to lower bits  
-        // Shift right by (stripe_log + x_dimlog) and shift left by stripe_log
-        // to remove the X_coord porition of EVA 
-        *epa |= (((hb_mc_eva_addr(eva) & MAKE_MASK(DEFAULT_DRAM_BITIDX)) >> shift ) << stripe_log);
+        // Shift right by (stripe_log + x_dimlog + 1) and shift left by stripe_log
+        // to remove the X_coord and north-south portions of EVA 
+        *epa |= (((hb_mc_eva_addr(eva) & MAKE_MASK(DEFAULT_DRAM_BITIDX)) >> plan->dram_epa_top_shift) << stripe_log);
 
 
         // The EPA portion of an EVA is technically determined by EPA_top + 
@@ -485,9 +509,7 @@ static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
         // xdimlog) != DEFAULT_DRAM_BITIDX, since there are unused bits between
         // the x index and EPA.  To avoid really awful debugging, we check this
         // situation.
-        uint32_t addrbits = default_get_dram_bitwidth(mc);
-        uint32_t errmask = MAKE_MASK(addrbits);
-        size_t max_dram_sz = 1 << addrbits;
+        size_t max_dram_sz = plan->dram_epa_limit[dram_enabled ? 1 : 0];
 
         if (*epa >= max_dram_sz){
                 bsg_pr_err("%s: Translation of EVA 0x%08" PRIx32 " failed. "
@@ -504,7 +526,7 @@ static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
         // Maximum permitted size to write starting from this epa is from 
         // the block offset until the end of the striped block.
         uint32_t max_striped_block_size = 1 << stripe_log;
-        *sz = max_striped_block_size - (hb_mc_eva_addr(eva) & MAKE_MASK(stripe_log));
+        *sz = max_striped_block_size - (hb_mc_eva_addr(eva) & plan->dram_stripe_mask);
 
         return HB_MC_SUCCESS;
 }
@@ -512,7 +534,8 @@ static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
 /**
  * Converts a DRAM Endpoint Virtual Address to a Network Physical Address and
  * size (contiguous bytes following the specified EVA)
- * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  plan   The translation plan of #mc
  * @param[in]  o      Coordinate of the origin for this tile's group
  * @param[in]  src    Coordinate of the tile issuing this #eva
  * @param[in]  eva    An eva to translate
@@ -533,6 +556,7 @@ static int default_eva_get_epa_dram (const hb_mc_manycore_t *mc,
  * DRAM NPA  =  <Y coord, X coord, DRAM EPA>
  */
 static int default_eva_to_npa_dram(const hb_mc_manycore_t *mc,
+                                   const default_eva_plan_t *plan,
                                    const hb_mc_coordinate_t *o,
                                    const hb_mc_coordinate_t *src,
                                    const hb_mc_eva_t *eva,
@@ -541,11 +565,12 @@ static int default_eva_to_npa_dram(const hb_mc_manycore_t *mc,
 {
         int rc;
         const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        hb_mc_coordinate_t og = default_eva_plan_pod_origin(cfg, plan, *src);
         hb_mc_idx_t x,y;
         hb_mc_epa_t epa;
 
         // Calculate X coordinate of NPA from EVA
-        rc = default_eva_get_x_coord_dram (mc, cfg, src, eva, &x); 
+        rc = default_eva_get_x_coord_dram (plan, og, eva, &x); 
         if (rc != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to generate x coordinate from eva 0x%08" PRIx32 ".\n",
                            __func__,
@@ -554,7 +579,7 @@ static int default_eva_to_npa_dram(const hb_mc_manycore_t *mc,
         }
 
         // Calculate Y coordinate of NPA from EVA
-        rc = default_eva_get_y_coord_dram (mc, cfg, src, eva, &y);
+        rc = default_eva_get_y_coord_dram (plan, og, eva, &y);
         if (rc != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to generate y coordinate from eva 0x%08" PRIx32 ".\n",
                            __func__,
@@ -564,7 +589,7 @@ static int default_eva_to_npa_dram(const hb_mc_manycore_t *mc,
 
 
         // Calculate EPA Portion of NPA from EVA
-        rc = default_eva_get_epa_dram (mc, cfg, eva, &epa, sz);
+        rc = default_eva_get_epa_dram (plan, mc->dram_enabled, eva, &epa, sz);
         if (rc != HB_MC_SUCCESS) { 
                 bsg_pr_err("%s: failed to generate npa from eva 0x%08" PRIx32 ".\n",
                            __func__,
@@ -588,95 +613,114 @@ static int default_eva_to_npa_dram(const hb_mc_manycore_t *mc,
 
 /**
  * Translate an Endpoint Virtual Address in a source tile's address space
- * to a Network Physical Address
- * @param[in]  cfg    An initialized manycore configuration struct
- * @param[in]  priv   Private data used for this EVA Map
+ * to a Network Physical Address with a translation plan in hand
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  plan   The translation plan of #mc
+ * @param[in]  origin Coordinate of the origin for this tile's group
  * @param[in]  src    Coordinate of the tile issuing this #eva
  * @param[in]  eva    An eva to translate
  * @param[out] npa    An npa to be set by translating #eva
  * @param[out] sz     The size in bytes of the NPA segment for the #eva
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-int default_eva_to_npa(hb_mc_manycore_t *mc,
-                       const void *priv,
-                       const hb_mc_coordinate_t *src,
-                       const hb_mc_eva_t *eva,
-                       hb_mc_npa_t *npa, size_t *sz)
+static int default_eva_to_npa_planned(const hb_mc_manycore_t *mc,
+                                      const default_eva_plan_t *plan,
+                                      const hb_mc_coordinate_t *origin,
+                                      const hb_mc_coordinate_t *src,
+                                      const hb_mc_eva_t *eva,
+                                      hb_mc_npa_t *npa, size_t *sz)
 {
-        const hb_mc_coordinate_t *origin;
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        origin = (const hb_mc_coordinate_t *) priv;
-
         if(default_eva_is_dram(eva))
-                return default_eva_to_npa_dram(mc, origin, src, eva, npa, sz);
+                return default_eva_to_npa_dram(mc, plan, origin, src, eva, npa, sz);
         if(default_eva_is_global(eva))
-                return default_eva_to_npa_global(cfg, origin, src, eva, npa, sz);
+                return default_eva_to_npa_global(plan, origin, src, eva, npa, sz);
         if(default_eva_is_group(eva))
-                return default_eva_to_npa_group(cfg, origin, src, eva, npa, sz);
+                return default_eva_to_npa_group(plan, origin, src, eva, npa, sz);
         if(default_eva_is_local(eva))
-                return default_eva_to_npa_local(cfg, origin, src, eva, npa, sz);
+                return default_eva_to_npa_local(plan, origin, src, eva, npa, sz);
 
         bsg_pr_err("%s: EVA 0x%08" PRIx32 " did not map to a known region\n",
                    __func__, hb_mc_eva_addr(eva));
         return HB_MC_FAIL;
 }
 
+/**
+ * Translate an Endpoint Virtual Address in a source tile's address space
+ * to a Network Physical Address
+ * @param[in]  cfg    An initialized manycore configuration struct
+ * @param[in]  priv   Private data used for this EVA Map
+ * @param[in]  src    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    An eva to translate
+ * @param[out] npa    An npa to be set by translating #eva
+ * @param[out] sz     The size in bytes of the NPA segment for the #eva
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int default_eva_to_npa(hb_mc_manycore_t *mc,
+                       const void *priv,
+                       const hb_mc_coordinate_t *src,
+                       const hb_mc_eva_t *eva,
+                       hb_mc_npa_t *npa, size_t *sz)
+{
+        default_eva_plan_t scratch;
+        const default_eva_plan_t *plan = default_eva_plan(mc, &scratch);
+        return default_eva_to_npa_planned(mc, plan, (const hb_mc_coordinate_t *) priv,
+                                          src, eva, npa, sz);
+}
+
 /**
  * Check if a DRAM EPA is valid.
- * @param[in] config  An initialized manycore configuration struct
- * @param[in] npa     An npa to translate
+ * @param[in] mc      An initialized manycore struct
+ * @param[in] plan    The translation plan of #mc
+ * @param[in] epa     An epa to check
  * @param[in] tgt     Coordinates of the target tile
  * @return true if the EPA is valid, false otherwise.
  */
 static bool default_dram_epa_is_valid(const hb_mc_manycore_t *mc,
+                                      const default_eva_plan_t *plan,
                                       hb_mc_epa_t epa,
                                       const hb_mc_coordinate_t *tgt)
 {
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        if (hb_mc_manycore_dram_is_enabled(mc)) {
-                return epa < hb_mc_config_get_dram_size(cfg);
-        } else {
-                return epa < hb_mc_config_get_vcache_size(cfg);
-        }
+        return epa < plan->dram_epa_valid[mc->dram_enabled ? 1 : 0];
 }
 
 
 /**
  * Check if a local EPA is valid.
- * @param[in] config  An initialized manycore configuration struct
- * @param[in] npa     An npa to translate
+ * @param[in] plan    The translation plan of the manycore
+ * @param[in] epa     An epa to check
  * @param[in] tgt     Coordinates of the target tile
  * @return true if the EPA is valid, false otherwise.
  */
-static bool default_local_epa_is_valid(const hb_mc_config_t *config,
+static bool default_local_epa_is_valid(const default_eva_plan_t *plan,
                                        hb_mc_epa_t epa,
                                        const hb_mc_coordinate_t *tgt)
 {
         hb_mc_epa_t floor = HB_MC_TILE_EPA_DMEM_BASE;
-        hb_mc_epa_t ceil  = HB_MC_TILE_EPA_DMEM_BASE + hb_mc_config_get_dmem_size(config);
+        hb_mc_epa_t ceil  = HB_MC_TILE_EPA_DMEM_BASE + plan->dmem_size;
         return (epa >= floor) && (epa < ceil);
 }
 
 /**
  * Check if an NPA is a host DRAM.
- * @param[in] config  An initialized manycore configuration struct
+ * @param[in] mc      An initialized manycore struct
+ * @param[in] plan    The translation plan of #mc
  * @param[in] npa     An npa to translate
  * @param[in] tgt     Coordinates of the target tile
  * @return true if the NPA is DRAM, false otherwise.
  */
 static bool default_npa_is_dram(const hb_mc_manycore_t *mc,
+                                const default_eva_plan_t *plan,
                                 const hb_mc_npa_t *npa,
                                 const hb_mc_coordinate_t *tgt)
 {
         char npa_str[64];
         const hb_mc_config_t *config = hb_mc_manycore_get_config(mc);
-        hb_mc_coordinate_t pod = hb_mc_config_pod(config, *tgt);
-        hb_mc_coordinate_t og = hb_mc_config_pod_vcore_origin(config, pod);
+        hb_mc_coordinate_t og = default_eva_plan_pod_origin(config, plan, *tgt);
         bool is_dram
             = hb_mc_config_is_dram(config, hb_mc_npa_get_xy(npa))
-                && default_dram_epa_is_valid(mc, hb_mc_npa_get_epa(npa), tgt)
-            && (hb_mc_npa_get_x(npa) >= default_dram_min_x_coord(config, &og))
-            && (hb_mc_npa_get_x(npa) <= default_dram_max_x_coord(config, &og));
+                && default_dram_epa_is_valid(mc, plan, hb_mc_npa_get_epa(npa), tgt)
+            && (hb_mc_npa_get_x(npa) >= hb_mc_coordinate_get_x(og))
+            && (hb_mc_npa_get_x(npa) <= hb_mc_coordinate_get_x(og) + hb_mc_dimension_get_x(plan->pod_shape) - 1);
 
         bsg_pr_dbg("%s: npa %s %s DRAM\n",
                    __func__,
@@ -714,40 +758,43 @@ static bool default_npa_is_host(const hb_mc_config_t *config,
 
 /**
  * Check if an NPA is a local address.
- * @param[in] config  An initialized manycore configuration struct
+ * @param[in] plan    The translation plan of the manycore
  * @param[in] npa     An npa to translate
  * @param[in] tgt     Coordinates of the target tile
  * @return true if the NPA is local, false otherwise.
  */
-static bool default_npa_is_local(const hb_mc_config_t *config,
+static bool default_npa_is_local(const default_eva_plan_t *plan,
                                  const hb_mc_npa_t *npa,
                                  const hb_mc_coordinate_t *tgt)
 {
         // does your coordinate map to this tgt v-core and is your epa valid?
         return (hb_mc_npa_get_x(npa) == hb_mc_coordinate_get_x(*tgt)) &&
                 (hb_mc_npa_get_y(npa) == hb_mc_coordinate_get_y(*tgt)) &&
-                default_local_epa_is_valid(config, hb_mc_npa_get_epa(npa), tgt);
+                default_local_epa_is_valid(plan, hb_mc_npa_get_epa(npa), tgt);
 }
 
 /**
  * Check if an NPA is a global address.
  * @param[in] config  An initialized manycore configuration struct
+ * @param[in] plan    The translation plan for #config
  * @param[in] npa     An npa to translate
  * @param[in] tgt     Coordinates of the target tile
  * @return true if the NPA is global, false otherwise.
  */
 static bool default_npa_is_global(const hb_mc_config_t *config,
+                                  const default_eva_plan_t *plan,
                                   const hb_mc_npa_t *npa,
                                   const hb_mc_coordinate_t *tgt)
 {
         // does your coordinate map to any v-core and is your epa valid?
         return hb_mc_config_is_vanilla_core(config, hb_mc_npa_get_xy(npa)) &&
-                default_local_epa_is_valid(config, hb_mc_npa_get_epa(npa), tgt);
+                default_local_epa_is_valid(plan, hb_mc_npa_get_epa(npa), tgt);
 }
 
 /**
  * Translate a global NPA to an EVA.
- * @param[in]  cfg      An initialized manycore configuration struct
+ * @param[in]  mc       An initialized manycore struct
+ * @param[in]  plan     The translation plan of #mc
  * @param[in]  origin   Coordinate of the origin for this tile's group
  * @param[in]  tgt      Coordinates of the target tile
  * @param[in]  npa      An npa to translate
@@ -756,6 +803,7 @@ static bool default_npa_is_global(const hb_mc_config_t *config,
  * @return HB_MC_SUCCESS if succesful. HB_MC_FAIL otherwise.
  */
 static int default_npa_to_eva_dram(hb_mc_manycore_t *mc,
+                                   const default_eva_plan_t *plan,
                                    const hb_mc_coordinate_t *o,
                                    const hb_mc_coordinate_t *tgt,
                                    const hb_mc_npa_t *npa,
@@ -765,21 +813,17 @@ static int default_npa_to_eva_dram(hb_mc_manycore_t *mc,
         // build the eva
         hb_mc_eva_t addr = 0;
         const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
-        uint32_t stripe_log, xdimlog;
-        // get the pod and pod origin
-        hb_mc_coordinate_t pod = hb_mc_config_pod(cfg, *tgt);
-        hb_mc_coordinate_t origin = hb_mc_config_pod_vcore_origin(cfg, pod);
+        uint32_t stripe_log = plan->dram_stripe_log;
+        // get the pod origin
+        hb_mc_coordinate_t origin = default_eva_plan_pod_origin(cfg, plan, *tgt);
 
         uint32_t is_south = hb_mc_config_is_dram_south(cfg, hb_mc_npa_get_xy(npa));
 
-        stripe_log = default_get_dram_stripe_size_log(mc);
-        xdimlog    = default_get_x_dimlog(cfg);
-
         // See comments on default_eva_to_npa_dram for clarification
-        addr |= (hb_mc_npa_get_epa(npa) & MAKE_MASK(stripe_log)); // Set byte address and cache block offset
-        addr |= ((hb_mc_npa_get_x(npa)-default_dram_min_x_coord(cfg, &origin)) << stripe_log); // Set the x coordinate
-        addr |= (is_south << (stripe_log + xdimlog)); // Set the N-S bit
-        addr |= (((hb_mc_npa_get_epa(npa) >> stripe_log)) << (stripe_log + xdimlog + 1)); // Set the EPA section
+        addr |= (hb_mc_npa_get_epa(npa) & plan->dram_stripe_mask); // Set byte address and cache block offset
+        addr |= ((hb_mc_npa_get_x(npa)-hb_mc_coordinate_get_x(origin)) << stripe_log); // Set the x coordinate
+        addr |= (is_south << plan->dram_ns_shift); // Set the N-S bit
+        addr |= (((hb_mc_npa_get_epa(npa) >> stripe_log)) << plan->dram_epa_top_shift); // Set the EPA section
         addr |= (1 << DEFAULT_DRAM_BITIDX); // Set the DRAM bit
         *eva  = addr;
 
@@ -949,17 +993,19 @@ int default_npa_to_eva(hb_mc_manycore_t *mc,
 {
         const hb_mc_coordinate_t *origin = (const hb_mc_coordinate_t*)priv;
         const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        default_eva_plan_t scratch;
+        const default_eva_plan_t *plan = default_eva_plan(mc, &scratch);
 
-        if(default_npa_is_dram(mc, npa, tgt))
-                return default_npa_to_eva_dram(mc, origin, tgt, npa, eva, sz);
+        if(default_npa_is_dram(mc, plan, npa, tgt))
+                return default_npa_to_eva_dram(mc, plan, origin, tgt, npa, eva, sz);
 
         if(default_npa_is_host(cfg, npa, tgt))
                 return default_npa_to_eva_host(cfg, origin, tgt, npa, eva, sz);
 
-        if(default_npa_is_local(cfg, npa, tgt))
+        if(default_npa_is_local(plan, npa, tgt))
                 return default_npa_to_eva_local(cfg, origin, tgt, npa, eva, sz);
 
-        if(default_npa_is_global(cfg, npa, tgt))
+        if(default_npa_is_global(cfg, plan, npa, tgt))
                 return default_npa_to_eva_global(cfg, origin, tgt, npa, eva, sz);
 
         return HB_MC_FAIL;
@@ -983,17 +1029,18 @@ int default_eva_size(
         hb_mc_npa_t npa;
         hb_mc_epa_t epa;
         const hb_mc_coordinate_t *o;
-        const hb_mc_config_t *cfg = hb_mc_manycore_get_config(mc);
+        default_eva_plan_t scratch;
+        const default_eva_plan_t *plan = default_eva_plan(mc, &scratch);
         o = (const hb_mc_coordinate_t *) priv;
 
         if(default_eva_is_dram(eva))
-                return default_eva_to_npa_dram(mc, o, o, eva, &npa, sz);
+                return default_eva_to_npa_dram(mc, plan, o, o, eva, &npa, sz);
         if(default_eva_is_global(eva))
-                return default_eva_to_npa_global(cfg, o, o, eva, &npa, sz);
+                return default_eva_to_npa_global(plan, o, o, eva, &npa, sz);
         if(default_eva_is_group(eva))
-                return default_eva_to_npa_group(cfg, o, o, eva, &npa, sz);
+                return default_eva_to_npa_group(plan, o, o, eva, &npa, sz);
         if(default_eva_is_local(eva))
-                return default_eva_to_npa_local(cfg, o, o, eva, &npa, sz);
+                return default_eva_to_npa_local(plan, o, o, eva, &npa, sz);
 
         bsg_pr_err("%s: EVA 0x%08" PRIx32 " did not map to a known region\n",
                    __func__, hb_mc_eva_addr(eva));
@@ -1011,6 +1058,32 @@ hb_mc_eva_map_t default_map = {
         .npa_to_eva  = default_npa_to_eva,
 };
 
+/**
+ * Precompute the default EVA map's translation plan for a manycore.
+ * @param[in]  mc     A manycore instance whose configuration has been read
+ * @return HB_MC_SUCCESS if successful. HB_MC_NOMEM if the plan could not be allocated.
+ */
+int hb_mc_eva_plan_init(hb_mc_manycore_t *mc)
+{
+        default_eva_plan_t *plan = new (std::nothrow) default_eva_plan_t;
+        if (plan == nullptr)
+                return HB_MC_NOMEM;
+
+        default_eva_plan_compute(hb_mc_manycore_get_config(mc), plan);
+        mc->eva_plan = plan;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Free the translation plan built by hb_mc_eva_plan_init().
+ * @param[in]  mc     A manycore instance
+ */
+void hb_mc_eva_plan_cleanup(hb_mc_manycore_t *mc)
+{
+        delete reinterpret_cast<default_eva_plan_t *>(mc->eva_plan);
+        mc->eva_plan = nullptr;
+}
+
 /**
  * Translate a Network Physical Address to an Endpoint Virtual Address in a
  * target tile's address space
@@ -1084,12 +1157,280 @@ int hb_mc_eva_size(hb_mc_manycore_t *mc,
         return HB_MC_SUCCESS;
 }
 
-
 static size_t min_size_t(size_t x, size_t y)
 {
         return x < y ? x : y;
 }
 
+/**
+ * Translate a range of EVAs into NPA extents, one translation per stripe
+ * @param[in]  eva          The first EVA of the range
+ * @param[in]  sz           The number of bytes in the range
+ * @param[out] extents      An array of at least #max_extents extents
+ * @param[in]  max_extents  The capacity of #extents
+ * @param[out] num_extents  Is set to the number of extents written to #extents
+ * @param[out] translated   Is set to the number of bytes covered by #extents
+ * @param[in]  translate    Translates one EVA to an NPA and the size of its segment
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ *
+ * A stripe that continues the previous extent in the same endpoint is
+ * merged into it.
+ */
+template <typename TranslateFunction>
+static int eva_range_to_npa_extents(hb_mc_eva_t eva, size_t sz,
+                                    hb_mc_npa_extent_t *extents, size_t max_extents,
+                                    size_t *num_extents, size_t *translated,
+                                    TranslateFunction translate)
+{
+        size_t n = 0, off = 0;
+
+        while (off < sz) {
+                int err;
+                hb_mc_npa_t npa;
+                size_t npa_sz;
+                hb_mc_eva_t curr_eva = eva + off;
+
+                err = translate(&curr_eva, &npa, &npa_sz);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                if (npa_sz == 0) {
+                        bsg_pr_err("%s: EVA 0x%08" PRIx32 " translated to an empty segment\n",
+                                   __func__, hb_mc_eva_addr(&curr_eva));
+                        return HB_MC_FAIL;
+                }
+
+                size_t xfer_sz = min_size_t(sz - off, npa_sz);
+                hb_mc_npa_extent_t *last = n != 0 ? &extents[n - 1] : nullptr;
+                if (last != nullptr &&
+                    last->npa.x == npa.x && last->npa.y == npa.y &&
+                    last->npa.epa + last->sz == npa.epa) {
+                        last->sz += xfer_sz;
+                } else if (n < max_extents) {
+                        extents[n++] = {npa, xfer_sz};
+                } else {
+                        break;
+                }
+
+                off += xfer_sz;
+        }
+
+        *num_extents = n;
+        *translated = off;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Translate a range of EVAs into the NPA extents that back it
+ * @param[in]  mc           An initialized manycore struct
+ * @param[in]  map          An eva map for computing the eva to npa translation
+ * @param[in]  src          Coordinate of the tile issuing this #eva
+ * @param[in]  eva          The first EVA of the range
+ * @param[in]  sz           The number of bytes in the range
+ * @param[out] extents      An array of at least #max_extents extents
+ * @param[in]  max_extents  The capacity of #extents
+ * @param[out] num_extents  Is set to the number of extents written to #extents
+ * @param[out] translated   Is set to the number of bytes covered by #extents
+ * @return HB_MC_INVALID if #extents cannot hold any extent. HB_MC_FAIL if an
+ *         EVA in the range could not be translated. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_eva_range_to_npa_extents(hb_mc_manycore_t *mc,
+                                   const hb_mc_eva_map_t *map,
+                                   const hb_mc_coordinate_t *src,
+                                   const hb_mc_eva_t *eva,
+                                   size_t sz,
+                                   hb_mc_npa_extent_t *extents,
+                                   size_t max_extents,
+                                   size_t *num_extents,
+                                   size_t *translated)
+{
+        if (sz != 0 && (extents == nullptr || max_extents == 0))
+                return HB_MC_INVALID;
+
+        // the default map's translation is called directly, with its plan
+        // looked up once for the whole range
+        if (map->eva_to_npa == default_eva_to_npa) {
+                default_eva_plan_t scratch;
+                const default_eva_plan_t *plan = default_eva_plan(mc, &scratch);
+                const hb_mc_coordinate_t *origin = (const hb_mc_coordinate_t *) map->priv;
+                return eva_range_to_npa_extents(*eva, sz, extents, max_extents, num_extents, translated,
+                                                [=](const hb_mc_eva_t *e, hb_mc_npa_t *npa, size_t *npa_sz) {
+                                                        return default_eva_to_npa_planned(mc, plan, origin, src,
+                                                                                          e, npa, npa_sz);
+                                                });
+        }
+
+        return eva_range_to_npa_extents(*eva, sz, extents, max_extents, num_extents, translated,
+                                        [=](const hb_mc_eva_t *e, hb_mc_npa_t *npa, size_t *npa_sz) {
+                                                return map->eva_to_npa(mc, map->priv, src, e, npa, npa_sz);
+                                        });
+}
+
+
+/* extents translated at a time by the bulk EVA operations */
+#define EVA_RANGE_BATCH_EXTENTS 64
+
+/* maximum number of stripes handed to one pipelined read by hb_mc_manycore_eva_read() */
+#define EVA_READ_BATCH_EXTENTS 4096
+
+/**
+ * Internal function to visit the NPA extents backing a contiguous EVA region a batch at a time
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa translation
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t
+ * @param[in]  sz     The number of bytes in the region
+ * @param[in]  batch_function  Called for each batch with the extents, their number,
+ *                             and the offset of the first from #eva
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+template <typename BatchFunction>
+static int hb_mc_manycore_eva_foreach_extent_batch(hb_mc_manycore_t *mc,
+                                                   const hb_mc_eva_map_t *map,
+                                                   const hb_mc_coordinate_t *tgt,
+                                                   const hb_mc_eva_t *eva,
+                                                   size_t sz,
+                                                   BatchFunction batch_function)
+{
+        int err;
+        hb_mc_npa_extent_t extents[EVA_RANGE_BATCH_EXTENTS];
+        size_t off = 0;
+
+        while (off < sz) {
+                size_t n, batch_sz;
+                hb_mc_eva_t curr_eva = *eva + off;
+
+                err = hb_mc_eva_range_to_npa_extents(mc, map, tgt, &curr_eva, sz - off,
+                                                     extents, EVA_RANGE_BATCH_EXTENTS,
+                                                     &n, &batch_sz);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
+                                   __func__);
+                        return err;
+                }
+
+                bsg_pr_dbg("%zd bytes in %zu extents at eva %08x\n",
+                           batch_sz, n, curr_eva);
+
+                err = batch_function(extents, n, off);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+                off += batch_sz;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Internal function to visit the NPA extents backing a contiguous EVA region
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa translation
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t
+ * @param[in]  sz     The number of bytes in the region
+ * @param[in]  extent_function  Called for each extent with the extent and its offset from #eva
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+template <typename ExtentFunction>
+static int hb_mc_manycore_eva_foreach_extent(hb_mc_manycore_t *mc,
+                                             const hb_mc_eva_map_t *map,
+                                             const hb_mc_coordinate_t *tgt,
+                                             const hb_mc_eva_t *eva,
+                                             size_t sz,
+                                             ExtentFunction extent_function)
+{
+        return hb_mc_manycore_eva_foreach_extent_batch(mc, map, tgt, eva, sz,
+                                                       [&](const hb_mc_npa_extent_t *extents,
+                                                           size_t n, size_t off) {
+                for (size_t i = 0; i < n; i++) {
+#ifdef DEBUG
+                        char npa_str[256];
+#endif
+                        bsg_pr_dbg("%zd bytes at eva %08x (%s)\n",
+                                   extents[i].sz,
+                                   hb_mc_eva_t(*eva + off),
+                                   hb_mc_npa_to_string(&extents[i].npa, npa_str, sizeof(npa_str)));
+
+                        int err = extent_function(&extents[i], off);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+                        off += extents[i].sz;
+                }
+                return HB_MC_SUCCESS;
+        });
+}
+
+/**
+ * Internal function to stream writes to a contiguous EVA region across stripes
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa translation
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t
+ * @param[in]  sz     The number of bytes to write to manycore hardware
+ * @param[in]  stream_function  Sends (without fencing) the writes for a run of stripes,
+ *                              given their NPA extents, how many there are, and the
+ *                              offset of the first from #eva
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ *
+ * Stripes are handed over a batch at a time, so the packets of neighbouring stripes
+ * can be sent in the bulk order of #mc. The network is fenced once at the end,
+ * or each time the write fence window of #mc has been filled.
+ */
+template <typename StreamFunction>
+static int hb_mc_manycore_eva_stream_internal(hb_mc_manycore_t *mc,
+                                              const hb_mc_eva_map_t *map,
+                                              const hb_mc_coordinate_t *tgt,
+                                              const hb_mc_eva_t *eva,
+                                              size_t sz,
+                                              StreamFunction stream_function)
+{
+        int err;
+        size_t unfenced = 0;
+        size_t window = hb_mc_manycore_get_write_fence_window(mc);
+        const char *fn = __func__;
+
+        hb_mc_manycore_start_bulk_transfer(mc);
+
+        err = hb_mc_manycore_eva_foreach_extent_batch(mc, map, tgt, eva, sz,
+                                                      [&](const hb_mc_npa_extent_t *extents,
+                                                          size_t n, size_t off) {
+                // send the batch in runs that end where a fence window fills
+                size_t first = 0;
+                for (size_t i = 0; i < n; i++) {
+                        unfenced += extents[i].sz;
+                        bool full = window != 0 && unfenced >= window;
+                        if (!full && i + 1 < n)
+                                continue;
+
+                        int err = stream_function(mc, &extents[first], i + 1 - first, off);
+                        if (err != HB_MC_SUCCESS) {
+                                bsg_pr_err("%s: Failed to stream data to NPA\n",
+                                           fn);
+                                return err;
+                        }
+                        for (; first <= i; first++)
+                                off += extents[first].sz;
+
+                        // drain the network once a full window is in flight
+                        if (full) {
+                                err = hb_mc_manycore_host_request_fence(mc, -1);
+                                if (err != HB_MC_SUCCESS)
+                                        return err;
+                                unfenced = 0;
+                        }
+                }
+                return HB_MC_SUCCESS;
+        });
+
+        if (err == HB_MC_SUCCESS && unfenced != 0)
+                err = hb_mc_manycore_host_request_fence(mc, -1);
+
+        // finish the transfer on errors too, so the platform leaves bulk mode
+        hb_mc_manycore_finish_bulk_transfer(mc);
+
+        return err;
+}
+
 /**
  * Internal function to write memory out to manycore hardware starting at a given EVA
  * @param[in]  mc     An initialized manycore struct
@@ -1110,41 +1451,16 @@ int hb_mc_manycore_eva_write_internal(hb_mc_manycore_t *mc,
                                       const void *data, size_t sz,
                                       WriteFunction write_function)
 {
-        int err;
-        size_t dest_sz, xfer_sz;
-        hb_mc_npa_t dest_npa;
-        char *destp;
-        hb_mc_eva_t curr_eva = *eva;
-
-        destp = (char *)data;
-        while(sz > 0){
-                err = hb_mc_eva_to_npa(mc, map, tgt, &curr_eva, &dest_npa, &dest_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
-                                   __func__);
-                        return err;
-                }
-                xfer_sz = min_size_t(sz, dest_sz);
-
-                char npa_str[256];
-                bsg_pr_dbg("writing %zd bytes to eva %08x (%s)\n",
-                           xfer_sz,
-                           curr_eva,
-                           hb_mc_npa_to_string(&dest_npa, npa_str, sizeof(npa_str)));
-
-                err = write_function(mc, &dest_npa, destp, xfer_sz);
-                if(err != HB_MC_SUCCESS){
+        const char *srcp = (const char *)data;
+        const char *fn = __func__;
+        return hb_mc_manycore_eva_foreach_extent(mc, map, tgt, eva, sz,
+                                                 [&](const hb_mc_npa_extent_t *extent, size_t off) {
+                int err = write_function(mc, &extent->npa, srcp + off, extent->sz);
+                if (err != HB_MC_SUCCESS)
                         bsg_pr_err("%s: Failed to copy data from host to NPA\n",
-                                   __func__);
-                        return err;
-                }
-
-                destp += xfer_sz;
-                sz -= xfer_sz;
-                curr_eva += xfer_sz;
-        }
-
-        return HB_MC_SUCCESS;
+                                   fn);
+                return err;
+        });
 }
 
 /**
@@ -1184,8 +1500,12 @@ int hb_mc_manycore_eva_write(hb_mc_manycore_t *mc,
                              const void *data, size_t sz)
 {
         // otherwise do write using the manycore mesh network
-        return hb_mc_manycore_eva_write_internal(mc,map, tgt, eva, data, sz,
-                                                 hb_mc_manycore_write_mem);
+        const char *src = static_cast<const char *>(data);
+        return hb_mc_manycore_eva_stream_internal(mc, map, tgt, eva, sz,
+                                                  [=](hb_mc_manycore_t *mc, const hb_mc_npa_extent_t *extents,
+                                                      size_t n, size_t off) {
+                                                          return hb_mc_manycore_write_mem_extents_nofence(mc, extents, n, src + off);
+                                                  });
 }
 
 
@@ -1209,42 +1529,16 @@ int hb_mc_manycore_eva_read_internal(hb_mc_manycore_t *mc,
                                      void *data, size_t sz,
                                      ReadFunction read_function)
 {
-        int err;
-        size_t src_sz, xfer_sz;
-        hb_mc_npa_t src_npa;
-        char *srcp;
-        hb_mc_eva_t curr_eva = *eva;
-
-        srcp = (char *)data;
-        while(sz > 0){
-                err = hb_mc_eva_to_npa(mc, map, tgt, &curr_eva, &src_npa, &src_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
-                                   __func__);
-                        return err;
-                }
-
-                xfer_sz = min_size_t(sz, src_sz);
-
-                char npa_str[256];
-                bsg_pr_dbg("read %zd bytes from eva %08x (%s)\n",
-                           xfer_sz,
-                           curr_eva,
-                           hb_mc_npa_to_string(&src_npa, npa_str, sizeof(npa_str)));
-
-                err = read_function(mc, &src_npa, srcp, xfer_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to copy data from host to NPA\n",
-                                   __func__);
-                        return err;
-                }
-
-                srcp += xfer_sz;
-                sz -= xfer_sz;
-                curr_eva += xfer_sz;
-        }
-
-        return HB_MC_SUCCESS;
+        char *dstp = (char *)data;
+        const char *fn = __func__;
+        return hb_mc_manycore_eva_foreach_extent(mc, map, tgt, eva, sz,
+                                                 [&](const hb_mc_npa_extent_t *extent, size_t off) {
+                int err = read_function(mc, &extent->npa, dstp + off, extent->sz);
+                if (err != HB_MC_SUCCESS)
+                        bsg_pr_err("%s: Failed to copy data from NPA to host\n",
+                                   fn);
+                return err;
+        });
 }
 
 /**
@@ -1267,6 +1561,124 @@ int hb_mc_manycore_eva_read_dma(hb_mc_manycore_t *mc,
                                                 hb_mc_manycore_dma_read_no_cache_afl);
 }
 
+/**
+ * Internal function to apply a cache operation to the lines backing a contiguous EVA region
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa map
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+ * @param[in]  sz     The number of bytes in the region
+ * @param[in]  npa_range_function  Sends (without fencing) the cache operation for one stripe
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ *
+ * The region is split into stripes with the EVA map, so only the cache lines that
+ * can hold the region are touched, whichever victim cache they belong to.
+ */
+template <typename NpaRangeFunction>
+static int hb_mc_manycore_vcache_apply_to_eva_range(hb_mc_manycore_t *mc,
+                                                    const hb_mc_eva_map_t *map,
+                                                    const hb_mc_coordinate_t *tgt,
+                                                    const hb_mc_eva_t *eva,
+                                                    size_t sz,
+                                                    NpaRangeFunction npa_range_function)
+{
+        if (!hb_mc_manycore_has_cache(mc))
+                return HB_MC_SUCCESS;
+
+        return hb_mc_manycore_eva_foreach_extent(mc, map, tgt, eva, sz,
+                                                 [&](const hb_mc_npa_extent_t *extent, size_t off) {
+                return npa_range_function(mc, &extent->npa, extent->sz);
+        });
+}
+
+/**
+ * Flush the victim cache lines backing a range of EVAs without waiting for completion
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa map
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+ * @param[in]  sz     The number of bytes to flush
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_vcache_flush_eva_range_nofence(hb_mc_manycore_t *mc,
+                                                  const hb_mc_eva_map_t *map,
+                                                  const hb_mc_coordinate_t *tgt,
+                                                  const hb_mc_eva_t *eva,
+                                                  size_t sz)
+{
+        return hb_mc_manycore_vcache_apply_to_eva_range(mc, map, tgt, eva, sz,
+                                                        hb_mc_manycore_vcache_flush_npa_range_nofence);
+}
+
+/**
+ * Invalidate the victim cache lines backing a range of EVAs without waiting for completion
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa map
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+ * @param[in]  sz     The number of bytes to invalidate
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_vcache_invalidate_eva_range_nofence(hb_mc_manycore_t *mc,
+                                                       const hb_mc_eva_map_t *map,
+                                                       const hb_mc_coordinate_t *tgt,
+                                                       const hb_mc_eva_t *eva,
+                                                       size_t sz)
+{
+        return hb_mc_manycore_vcache_apply_to_eva_range(mc, map, tgt, eva, sz,
+                                                        hb_mc_manycore_vcache_invalidate_npa_range_nofence);
+}
+
+/**
+ * Flush the victim cache lines backing a range of EVAs
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa map
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+ * @param[in]  sz     The number of bytes to flush
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_vcache_flush_eva_range(hb_mc_manycore_t *mc,
+                                          const hb_mc_eva_map_t *map,
+                                          const hb_mc_coordinate_t *tgt,
+                                          const hb_mc_eva_t *eva,
+                                          size_t sz)
+{
+        if (!hb_mc_manycore_has_cache(mc))
+                return HB_MC_SUCCESS;
+
+        int err = hb_mc_manycore_vcache_flush_eva_range_nofence(mc, map, tgt, eva, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        return hb_mc_manycore_host_request_fence(mc, -1);
+}
+
+/**
+ * Invalidate the victim cache lines backing a range of EVAs
+ * @param[in]  mc     An initialized manycore struct
+ * @param[in]  map    An eva map for computing the eva to npa map
+ * @param[in]  tgt    Coordinate of the tile issuing this #eva
+ * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+ * @param[in]  sz     The number of bytes to invalidate
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_manycore_vcache_invalidate_eva_range(hb_mc_manycore_t *mc,
+                                               const hb_mc_eva_map_t *map,
+                                               const hb_mc_coordinate_t *tgt,
+                                               const hb_mc_eva_t *eva,
+                                               size_t sz)
+{
+        if (!hb_mc_manycore_has_cache(mc))
+                return HB_MC_SUCCESS;
+
+        int err = hb_mc_manycore_vcache_invalidate_eva_range_nofence(mc, map, tgt, eva, sz);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        return hb_mc_manycore_host_request_fence(mc, -1);
+}
+
 /**
  * Read memory from manycore hardware starting at a given EVA
  * @param[in]  mc     An initialized manycore struct
@@ -1283,8 +1695,48 @@ int hb_mc_manycore_eva_read(hb_mc_manycore_t *mc,
                             const hb_mc_eva_t *eva,
                             void *data, size_t sz)
 {
-        return hb_mc_manycore_eva_read_internal(mc, map, tgt, eva, data, sz,
-                                                hb_mc_manycore_read_mem);
+        int err;
+        char *dstp = (char *)data;
+        hb_mc_eva_t curr_eva = *eva;
+
+        // translate the region a batch of stripes at a time and hand each
+        // batch to a single pipelined read so loads stay in flight
+        // across stripe boundaries; small reads keep their batch on the stack
+        hb_mc_npa_extent_t small[EVA_RANGE_BATCH_EXTENTS];
+        std::vector<hb_mc_npa_extent_t> large;
+        hb_mc_npa_extent_t *extents = small;
+        size_t max_extents = min_size_t(EVA_READ_BATCH_EXTENTS, sz / sizeof(uint32_t) + 1);
+        if (max_extents > EVA_RANGE_BATCH_EXTENTS) {
+                large.resize(max_extents);
+                extents = large.data();
+        } else {
+                max_extents = EVA_RANGE_BATCH_EXTENTS;
+        }
+
+        while (sz > 0) {
+                size_t n, batch_sz;
+                err = hb_mc_eva_range_to_npa_extents(mc, map, tgt, &curr_eva, sz,
+                                                     extents, max_extents,
+                                                     &n, &batch_sz);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
+                                   __func__);
+                        return err;
+                }
+
+                err = hb_mc_manycore_read_mem_extents(mc, extents, n, dstp);
+                if (err != HB_MC_SUCCESS) {
+                        bsg_pr_err("%s: Failed to copy data from NPA to host\n",
+                                   __func__);
+                        return err;
+                }
+
+                dstp += batch_sz;
+                sz -= batch_sz;
+                curr_eva += batch_sz;
+        }
+
+        return HB_MC_SUCCESS;
 }
 
 /**
@@ -1303,37 +1755,9 @@ int hb_mc_manycore_eva_memset(hb_mc_manycore_t *mc,
                               const hb_mc_eva_t *eva,
                               uint8_t val, size_t sz)
 {
-        int err;
-        size_t dest_sz, xfer_sz;
-        hb_mc_npa_t dest_npa;
-        hb_mc_eva_t curr_eva = *eva;
-
-        while(sz > 0){
-                err = hb_mc_eva_to_npa(mc, map, tgt, &curr_eva, &dest_npa, &dest_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to translate EVA into a NPA\n",
-                                   __func__);
-                        return err;
-                }
-                xfer_sz = min_size_t(sz, dest_sz);
-
-
-                char npa_str[256];
-                bsg_pr_dbg("read %zd bytes from eva %08x (%s)\n",
-                           xfer_sz,
-                           curr_eva,
-                           hb_mc_npa_to_string(&dest_npa, npa_str, sizeof(npa_str)));
-
-                err = hb_mc_manycore_memset(mc, &dest_npa, val, xfer_sz);
-                if(err != HB_MC_SUCCESS){
-                        bsg_pr_err("%s: Failed to set NPA region to value\n",
-                                   __func__);
-                        return err;
-                }
-
-                sz -= xfer_sz;
-                curr_eva += xfer_sz;
-        }
-
-        return HB_MC_SUCCESS;
+        return hb_mc_manycore_eva_stream_internal(mc, map, tgt, eva, sz,
+                                                  [=](hb_mc_manycore_t *mc, const hb_mc_npa_extent_t *extents,
+                                                      size_t n, size_t off) {
+                                                          return hb_mc_manycore_memset_extents_nofence(mc, extents, n, val);
+                                                  });
 }
@@ -155,6 +155,22 @@ extern "C" {
         extern const hb_mc_coordinate_t default_origin;
         extern hb_mc_eva_map_t default_map;
 
+        /**
+         * Precompute the shifts, masks, and pod bounds that #default_map
+         * uses to translate addresses, so that translation does no config
+         * lookups or floating point. Called by hb_mc_manycore_init().
+         * @param[in]  mc     A manycore instance whose configuration has been read
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_eva_plan_init(hb_mc_manycore_t *mc);
+
+        /**
+         * Free the translation plan built by hb_mc_eva_plan_init().
+         * @param[in]  mc     A manycore instance
+         */
+        void hb_mc_eva_plan_cleanup(hb_mc_manycore_t *mc);
+
         /**
          * Get the name of an eva map.
          * @param[in] map  An EVA map. Behaviour is undefined if #map is NULL.
@@ -201,6 +217,35 @@ extern "C" {
                              const hb_mc_eva_t *eva,
                              hb_mc_npa_t *npa, size_t *sz);
 
+        /**
+         * Translate a range of EVAs in a source tile's address space into the
+         * NPA extents that back it, in order. Stripes that continue the previous
+         * extent in the same endpoint are merged into it. If #extents fills up
+         * before the range is covered, translation stops and #translated tells
+         * the caller where to resume.
+         * @param[in]  mc           An initialized manycore struct
+         * @param[in]  map          An eva map for computing the eva to npa translation
+         * @param[in]  src          Coordinate of the tile issuing this #eva
+         * @param[in]  eva          The first EVA of the range
+         * @param[in]  sz           The number of bytes in the range
+         * @param[out] extents      An array of at least #max_extents extents
+         * @param[in]  max_extents  The capacity of #extents
+         * @param[out] num_extents  Is set to the number of extents written to #extents
+         * @param[out] translated   Is set to the number of bytes covered by #extents
+         * @return HB_MC_INVALID if #extents cannot hold any extent. HB_MC_FAIL if an
+         *         EVA in the range could not be translated. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_eva_range_to_npa_extents(hb_mc_manycore_t *mc,
+                                           const hb_mc_eva_map_t *map,
+                                           const hb_mc_coordinate_t *src,
+                                           const hb_mc_eva_t *eva,
+                                           size_t sz,
+                                           hb_mc_npa_extent_t *extents,
+                                           size_t max_extents,
+                                           size_t *num_extents,
+                                           size_t *translated);
+
         /**
          * Write memory out to manycore hardware starting at a given EVA
          * @param[in]  mc     An initialized manycore struct
@@ -294,6 +339,78 @@ extern "C" {
                                         const hb_mc_coordinate_t *tgt,
                                         const hb_mc_eva_t *eva,
 					void *data, size_t sz);
+
+        /**
+         * Flush the victim cache lines backing a range of EVAs
+         * @param[in]  mc     An initialized manycore struct
+         * @param[in]  map    An eva map for computing the eva to npa map
+         * @param[in]  tgt    Coordinate of the tile issuing this #eva
+         * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+         * @param[in]  sz     The number of bytes to flush
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         *
+         * One AFL packet is sent per cache line in the range, followed by a single fence.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_vcache_flush_eva_range(hb_mc_manycore_t *mc,
+                                                  const hb_mc_eva_map_t *map,
+                                                  const hb_mc_coordinate_t *tgt,
+                                                  const hb_mc_eva_t *eva,
+                                                  size_t sz);
+
+        /**
+         * Invalidate the victim cache lines backing a range of EVAs
+         * @param[in]  mc     An initialized manycore struct
+         * @param[in]  map    An eva map for computing the eva to npa map
+         * @param[in]  tgt    Coordinate of the tile issuing this #eva
+         * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+         * @param[in]  sz     The number of bytes to invalidate
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         *
+         * One AINV packet is sent per cache line in the range, followed by a single fence.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_vcache_invalidate_eva_range(hb_mc_manycore_t *mc,
+                                                       const hb_mc_eva_map_t *map,
+                                                       const hb_mc_coordinate_t *tgt,
+                                                       const hb_mc_eva_t *eva,
+                                                       size_t sz);
+
+        /**
+         * Flush the victim cache lines backing a range of EVAs without waiting for completion
+         * @param[in]  mc     An initialized manycore struct
+         * @param[in]  map    An eva map for computing the eva to npa map
+         * @param[in]  tgt    Coordinate of the tile issuing this #eva
+         * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+         * @param[in]  sz     The number of bytes to flush
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         *
+         * Call hb_mc_manycore_host_request_fence() before relying on the flush.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_vcache_flush_eva_range_nofence(hb_mc_manycore_t *mc,
+                                                          const hb_mc_eva_map_t *map,
+                                                          const hb_mc_coordinate_t *tgt,
+                                                          const hb_mc_eva_t *eva,
+                                                          size_t sz);
+
+        /**
+         * Invalidate the victim cache lines backing a range of EVAs without waiting for completion
+         * @param[in]  mc     An initialized manycore struct
+         * @param[in]  map    An eva map for computing the eva to npa map
+         * @param[in]  tgt    Coordinate of the tile issuing this #eva
+         * @param[in]  eva    A valid hb_mc_eva_t - must map to DRAM
+         * @param[in]  sz     The number of bytes to invalidate
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         *
+         * Call hb_mc_manycore_host_request_fence() before relying on the invalidation.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_manycore_vcache_invalidate_eva_range_nofence(hb_mc_manycore_t *mc,
+                                                               const hb_mc_eva_map_t *map,
+                                                               const hb_mc_coordinate_t *tgt,
+                                                               const hb_mc_eva_t *eva,
+                                                               size_t sz);
 #ifdef __cplusplus
 }
 #endif
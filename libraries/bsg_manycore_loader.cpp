@@ -26,15 +26,23 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <bsg_manycore_loader.h>
+#include <bsg_manycore_api_trace.h>
 #include <bsg_manycore_tile.h>
 #include <bsg_manycore_vcache.h>
 #include <bsg_manycore_printing.h>
 #include <bsg_manycore_npa.h>
+#include <bsg_manycore_platform.h>
 
 #include <cinttypes>
 #include <elf.h>
 #include <endian.h>
 
+#include <atomic>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -308,25 +316,185 @@ static int hb_mc_loader_load_tile_segment(hb_mc_manycore_t *mc,
 }
 
 /**
- * Load a program segment.
+ * Translate an EVA range to one NPA range for each tile.
+ * @param[in]  mc       A manycore instance.
+ * @param[in]  map      A EVA to NPA map.
+ * @param[in]  eva      The start of the range.
+ * @param[in]  sz       The size of the range.
+ * @param[in]  tiles    Tiles issuing #eva.
+ * @param[in]  ntiles   The number of tiles.
+ * @param[out] npas     Is set to the start NPA of the range for each tile.
+ * @return HB_MC_SUCCESS if successful. HB_MC_NOIMPL if the range is not
+ *         contiguous for some tile. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_tiles_eva_to_npa(hb_mc_manycore_t *mc,
+                                         const hb_mc_eva_map_t *map,
+                                         hb_mc_eva_t eva, size_t sz,
+                                         const hb_mc_coordinate_t *tiles,
+                                         uint32_t ntiles,
+                                         hb_mc_npa_t *npas)
+{
+        int rc;
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                size_t npa_sz;
+                rc = hb_mc_eva_to_npa(mc, map, &tiles[i], &eva, &npas[i], &npa_sz);
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+
+                if (npa_sz < sz)
+                        return HB_MC_NOIMPL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * A segment of a program image, ready to be sent.
+ */
+struct hb_mc_loader_image_segment {
+        const Elf32_Phdr *phdr;             // program header, in the image's binary
+        const unsigned char *data;          // initialized data, in the image's binary
+        bool load_once;                     // loaded once (DRAM) rather than on every tile
+        std::vector<unsigned char> payload; // per-tile data: initialized data padded with zeros to a word
+        hb_mc_eva_t bss_eva;                // the zeroed remainder of a per-tile segment
+        size_t bss_sz;
+};
+
+/**
+ * A binary parsed for loading. Immutable once built.
+ */
+struct hb_mc_loader_program_image {
+        std::atomic<unsigned> refs;
+        const unsigned char *bin;
+        size_t sz;
+        bool owns_bin;
+        hb_mc_loader_symbol_table_t *symbols;
+        hb_mc_eva_t pc_init;
+        std::vector<hb_mc_loader_image_segment> segments;
+        const Elf32_Phdr *icache_phdr;
+        const unsigned char *icache_data;
+
+        hb_mc_loader_program_image(const unsigned char *bin, size_t sz) :
+                refs(1), bin(bin), sz(sz), owns_bin(false), symbols(nullptr), pc_init(0),
+                icache_phdr(nullptr), icache_data(nullptr) {}
+
+        ~hb_mc_loader_program_image() {
+                hb_mc_loader_symbol_table_cleanup(symbols);
+                if (owns_bin)
+                        free(const_cast<unsigned char*>(bin));
+        }
+};
+
+/**
+ * Load a per-tile program segment onto many tiles, with unfenced writes
+ * that visit the tiles in turn so that they are written in parallel.
  * @param[in] mc       A manycore instance.
  * @param[in] map      A EVA to NPA map.
- * @param[in] phdr     A program header for the data to be loaded.
- * @param[in] segdata  Program data to be loaded.
- * @param[in] tile     A manycore coordinate.
+ * @param[in] seg      A segment of a program image.
+ * @param[in] tiles    Tiles to load.
+ * @param[in] ntiles   The number of tiles to load.
+ * @return HB_MC_SUCCESS if successful. HB_MC_NOIMPL if the segment cannot
+ *         be loaded this way. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_load_tiles_segment_interleaved(hb_mc_manycore_t *mc,
+                                                       const hb_mc_eva_map_t *map,
+                                                       const hb_mc_loader_image_segment *seg,
+                                                       const hb_mc_coordinate_t *tiles,
+                                                       uint32_t ntiles)
+{
+        int rc;
+        char segname[64];
+        const Elf32_Phdr *phdr = seg->phdr;
+        hb_mc_eva_t eva = RV32_Addr_to_host(phdr->p_paddr);
+        size_t seg_sz = RV32_Word_to_host(phdr->p_memsz);
+        size_t payload_sz = seg->payload.size();
+
+        hb_mc_loader_segment_to_string(phdr, segname, sizeof(segname));
+
+        for (uint32_t i = 0; i < ntiles; i++) {
+                size_t cap = hb_mc_loader_get_tile_segment_capacity(mc, map, phdr, tiles[i]);
+                if (cap < seg_sz) {
+                        bsg_pr_err("%s: '%s' (%zu bytes) exceeds "
+                                   "maximum (%zu bytes)\n",
+                                   __func__,
+                                   segname,
+                                   seg_sz,
+                                   cap);
+                        return HB_MC_FAIL;
+                }
+        }
+
+        /* the data must be whole words at contiguous NPAs on every tile */
+        if ((payload_sz | seg->bss_sz) & 0x3)
+                return HB_MC_NOIMPL;
+
+        /*
+          Empty ranges are skipped rather than translated: a segment
+          that ends at the top of DMEM has no zeroed range, and its
+          would-be start does not translate.
+        */
+        std::vector<hb_mc_npa_t> data_npas(ntiles), zeros_npas(ntiles);
+        if (payload_sz > 0) {
+                rc = hb_mc_loader_tiles_eva_to_npa(mc, map, eva, payload_sz, tiles, ntiles, data_npas.data());
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+        if (seg->bss_sz > 0) {
+                rc = hb_mc_loader_tiles_eva_to_npa(mc, map, seg->bss_eva, seg->bss_sz, tiles, ntiles, zeros_npas.data());
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
+        }
+
+        bsg_pr_dbg("%s: writing program data to %" PRIu32 " tiles: %s\n", __func__, ntiles, segname);
+
+        hb_mc_manycore_start_bulk_transfer(mc);
+
+        rc = HB_MC_SUCCESS;
+        if (payload_sz > 0) {
+                rc = hb_mc_manycore_write_mem_interleaved_nofence(mc, data_npas.data(), ntiles,
+                                                                  seg->payload.data(), payload_sz);
+                if (rc != HB_MC_SUCCESS)
+                        bsg_pr_err("%s: failed to write %s: %s\n", __func__, segname, hb_mc_strerror(rc));
+        }
+
+        if (rc == HB_MC_SUCCESS && seg->bss_sz > 0) {
+                rc = hb_mc_manycore_memset_interleaved_nofence(mc, zeros_npas.data(), ntiles, 0, seg->bss_sz);
+                if (rc != HB_MC_SUCCESS)
+                        bsg_pr_err("%s: failed to memset %s: %s\n", __func__, segname, hb_mc_strerror(rc));
+        }
+
+        // finish the transfer on errors too, so the platform leaves bulk mode
+        hb_mc_manycore_finish_bulk_transfer(mc);
+
+        return rc;
+}
+
+/**
+ * Load a per-tile program segment onto many tiles.
+ * @param[in] mc       A manycore instance.
+ * @param[in] map      A EVA to NPA map.
+ * @param[in] seg      A segment of a program image.
+ * @param[in] tiles    Tiles to load.
+ * @param[in] ntiles   The number of tiles to load.
  * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
  */
 static int hb_mc_loader_load_tiles_segment(hb_mc_manycore_t *mc,
                                            const hb_mc_eva_map_t *map,
-                                           const Elf32_Phdr *phdr,
-                                           const unsigned char *segdata,
+                                           const hb_mc_loader_image_segment *seg,
                                            const hb_mc_coordinate_t *tiles,
                                            uint32_t ntiles)
 {
         int rc;
 
+        rc = hb_mc_loader_load_tiles_segment_interleaved(mc, map, seg, tiles, ntiles);
+        if (rc != HB_MC_NOIMPL)
+                return rc;
+
+        /* fall back to loading one tile at a time */
         for (uint32_t i = 0; i < ntiles; i++) {
-                rc = hb_mc_loader_load_tile_segment(mc, map, phdr, segdata, tiles[i]);
+                rc = hb_mc_loader_load_tile_segment(mc, map, seg->phdr, seg->data, tiles[i]);
                 if (rc != HB_MC_SUCCESS)
                         return rc;
         }
@@ -404,13 +572,48 @@ static int hb_mc_loader_load_tiles_icache(hb_mc_manycore_t *mc,
                                           const hb_mc_coordinate_t *tiles,
                                           uint32_t ntiles)
 {       int rc;
+        size_t sz = min_size_t(RV32_Word_to_host(phdr->p_filesz),
+                               hb_mc_tile_get_size_icache(mc, &tiles[0]));
+        bool interleave = (sz & 0x3) == 0;
 
-        for (uint32_t i = 0; i < ntiles; i++) {
-                rc = hb_mc_loader_load_tile_icache(mc, map, phdr, segdata, tiles[i]);
-                if (rc != HB_MC_SUCCESS)
-                        return rc;
+        /* see hb_mc_loader_load_tile_icache() */
+        if ((HB_MC_TILE_EPA_ICACHE + sz - 1) & 0x00FFF000) {
+                bsg_pr_dbg("%s: Oops: ICACHE EPA 0x%08" PRIx32 " sets tag bits\n",
+                           __func__, HB_MC_TILE_EPA_ICACHE);
+                return HB_MC_FAIL;
         }
-        return HB_MC_SUCCESS;
+
+        std::vector<hb_mc_npa_t> icache_npas(ntiles);
+        for (uint32_t i = 0; i < ntiles && interleave; i++) {
+                icache_npas[i] = hb_mc_npa(tiles[i], HB_MC_TILE_EPA_ICACHE);
+                interleave = sz == min_size_t(RV32_Word_to_host(phdr->p_filesz),
+                                              hb_mc_tile_get_size_icache(mc, &tiles[i]));
+        }
+
+        /* fall back to loading one tile at a time */
+        if (!interleave) {
+                for (uint32_t i = 0; i < ntiles; i++) {
+                        rc = hb_mc_loader_load_tile_icache(mc, map, phdr, segdata, tiles[i]);
+                        if (rc != HB_MC_SUCCESS)
+                                return rc;
+                }
+                return HB_MC_SUCCESS;
+        }
+
+        bsg_pr_dbg("%s: writing %zu bytes to the icache of %" PRIu32 " tiles\n",
+                   __func__, sz, ntiles);
+
+        hb_mc_manycore_start_bulk_transfer(mc);
+
+        rc = hb_mc_manycore_write_mem_interleaved_nofence(mc, icache_npas.data(), ntiles, segdata, sz);
+        if (rc != HB_MC_SUCCESS)
+                bsg_pr_dbg("%s: failed to write icaches: %s\n",
+                           __func__, hb_mc_strerror(rc));
+
+        // finish the transfer on errors too, so the platform leaves bulk mode
+        hb_mc_manycore_finish_bulk_transfer(mc);
+
+        return rc;
 }
 
 /**
@@ -603,52 +806,60 @@ static int hb_mc_loader_get_segment(const void *bin, size_t sz, unsigned segidx,
 }
 
 /**
- * Load program segments onto tiles.
- * @param[in] bin     A binary object to load onto the tiles.
- * @param[in] sz      The size of the binary object.
- * @param[in] mc      A manycore instance.
- * @param[in] map     An EVA<->NPA map.
- * @param[in] tiles   Tiles to load.
- * @param[in] ntiles  The number of tiles to load.
+ * Validate the binary of a program image and find the segments to load.
+ * @param[in] image   A program image with its binary set.
  * @return HB_MC_SUCCESS if succseful. Otherwise an error code is returned.
  */
-static int hb_mc_loader_load_segments(const void *bin, size_t sz,
-                                      hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
-                                      const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+static int hb_mc_loader_program_image_parse(hb_mc_loader_program_image_t *image)
 {
-        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)bin;
-        int rc, icache_segidx = -1;
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)image->bin;
+        int rc;
 
-        /////////////////////////////////////
-        // Load all segments to their EVAs //
-        /////////////////////////////////////
+        rc = hb_mc_loader_elf_validate(image->bin, image->sz);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to validate binary\n", __func__);
+                return rc;
+        }
 
         /* for each program header */
         for (int segidx = 0; segidx < RV32_Half_to_host(ehdr->e_phnum); segidx++) {
-                const Elf32_Phdr *phdr;
-                const unsigned char *segdata;
+                hb_mc_loader_image_segment seg;
 
-                rc = hb_mc_loader_get_segment(bin, sz, segidx, &phdr, &segdata);
+                rc = hb_mc_loader_get_segment(image->bin, image->sz, segidx, &seg.phdr, &seg.data);
                 if (rc != HB_MC_SUCCESS) {
                         bsg_pr_dbg("%s: failed to get segment %d\n", __func__, segidx);
                         return rc;
                 }
 
                 /* check if program header should be loaded never, once, or for each tile */
-                if (hb_mc_loader_segment_is_load_never(mc, phdr, map, tiles, ntiles)) {
-                        // this segment should not be loaded
+                if (hb_mc_loader_segment_is_load_never(nullptr, seg.phdr, nullptr, nullptr, 0))
                         continue;
-                } else if (hb_mc_loader_segment_is_load_once(mc, phdr, map, tiles, ntiles)) {
-                        // this segment should be loaded only once (e.g. DRAM = .text + .dram)
-                        rc = hb_mc_loader_load_tile_segment(mc, map, phdr, segdata, tiles[0]);
-                        if (rc != HB_MC_SUCCESS) {
-                                return rc;
+
+                seg.load_once = hb_mc_loader_segment_is_load_once(nullptr, seg.phdr, nullptr, nullptr, 0);
+                seg.bss_eva = 0;
+                seg.bss_sz = 0;
+
+                /*
+                  Per-tile segments (e.g. DMEM = .data) are sent to every
+                  tile, so build their payload here once: the initialized
+                  data, padded with zeros from the segment's remainder
+                  to a whole word, and the extent of what's left to zero.
+                */
+                if (!seg.load_once) {
+                        size_t file_sz = RV32_Word_to_host(seg.phdr->p_filesz);
+                        size_t seg_sz  = RV32_Word_to_host(seg.phdr->p_memsz);
+                        if (file_sz > seg_sz) {
+                                bsg_pr_dbg("%s: segment %d has more data (%zu bytes) "
+                                           "than memory (%zu bytes)\n",
+                                           __func__, segidx, file_sz, seg_sz);
+                                return HB_MC_INVALID;
                         }
-                } else { // this segment should be loaded once for each tile (e.g. DMEM = .data)
-                        rc = hb_mc_loader_load_tiles_segment(mc, map, phdr, segdata,
-                                                             tiles, ntiles);
-                        if (rc != HB_MC_SUCCESS)
-                                return rc;
+
+                        size_t payload_sz = min_size_t((file_sz + 3) & ~(size_t)0x3, seg_sz);
+                        seg.payload.assign(seg.data, seg.data + file_sz);
+                        seg.payload.resize(payload_sz, 0);
+                        seg.bss_eva = RV32_Addr_to_host(seg.phdr->p_paddr) + payload_sz;
+                        seg.bss_sz = seg_sz - payload_sz;
                 }
 
                 /*
@@ -658,30 +869,67 @@ static int hb_mc_loader_load_segments(const void *bin, size_t sz,
                   So when we find the segment with program text in it, we save it
                   for further loading.
                 */
-                if (hb_mc_loader_segment_is_load_icache(mc, phdr, map, tiles, ntiles))
-                        icache_segidx = segidx;
-        }
+                if (hb_mc_loader_segment_is_load_icache(nullptr, seg.phdr, nullptr, nullptr, 0)) {
+                        image->icache_phdr = seg.phdr;
+                        image->icache_data = seg.data;
+                }
 
-        const Elf32_Phdr *icache_phdr;
-        const unsigned char *icache_data;
+                image->segments.push_back(std::move(seg));
+        }
 
-        if (icache_segidx == -1) {
+        if (image->icache_phdr == nullptr) {
                 bsg_pr_err("RISCV program has no loadable segment that is executable\n");
                 return HB_MC_INVALID;
         }
 
-        rc = hb_mc_loader_get_segment(bin, sz, icache_segidx, &icache_phdr, &icache_data);
-        if (rc != HB_MC_SUCCESS) {
-                bsg_pr_dbg("%s: while fetching ICACHE segment (segidx = %d): %s\n",
-                           __func__, icache_segidx, hb_mc_strerror(icache_segidx));
-                return rc;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Load program segments onto tiles.
+ * @param[in] image   A program image to load onto the tiles.
+ * @param[in] mc      A manycore instance.
+ * @param[in] map     An EVA<->NPA map.
+ * @param[in] tiles   Tiles to load.
+ * @param[in] ntiles  The number of tiles to load.
+ * @return HB_MC_SUCCESS if succseful. Otherwise an error code is returned.
+ */
+static int hb_mc_loader_load_segments(const hb_mc_loader_program_image_t *image,
+                                      hb_mc_manycore_t *mc, const hb_mc_eva_map_t *map,
+                                      const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+{
+        int rc;
+
+        /////////////////////////////////////
+        // Load all segments to their EVAs //
+        /////////////////////////////////////
+
+        for (const hb_mc_loader_image_segment &seg : image->segments) {
+                if (seg.load_once) {
+                        // this segment should be loaded only once (e.g. DRAM = .text + .dram)
+                        rc = hb_mc_loader_load_tile_segment(mc, map, seg.phdr, seg.data, tiles[0]);
+                } else { // this segment should be loaded once for each tile (e.g. DMEM = .data)
+                        rc = hb_mc_loader_load_tiles_segment(mc, map, &seg, tiles, ntiles);
+                }
+
+                if (rc != HB_MC_SUCCESS)
+                        return rc;
         }
 
         /* init icache */
-        rc = hb_mc_loader_load_tiles_icache(mc, map, icache_phdr, icache_data, tiles, ntiles);
+        rc = hb_mc_loader_load_tiles_icache(mc, map, image->icache_phdr, image->icache_data,
+                                            tiles, ntiles);
         if (rc != HB_MC_SUCCESS)
                 return rc;
 
+        /* one fence for the data and icaches of every tile */
+        rc = hb_mc_manycore_host_request_fence(mc, -1);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_err("%s: failed to fence program load: %s\n",
+                           __func__, hb_mc_strerror(rc));
+                return rc;
+        }
+
         return HB_MC_SUCCESS;
 }
 
@@ -828,38 +1076,48 @@ static int hb_mc_loader_tiles_initialize(hb_mc_manycore_t *mc,
 }
 
 /**
- * Loads an ELF file into a list of tiles and DRAM
- * @param[in]  bin    A memory buffer containing a valid manycore binary
- * @param[in]  sz     Size of #bin in bytes
+ * Tell the platform that a program has been loaded onto a list of tiles
+ *
+ * NOTE: This method is declared with __attribute__((weak)) so that
+ * only platforms that model program execution need to define it.
+ *
+ * @param[in] mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] bin    A memory buffer containing the manycore binary that was loaded
+ * @param[in] sz     Size of #bin in bytes
+ * @param[in] tiles  The tiles that #bin was loaded onto
+ * @param[in] ntiles The number of tiles in #tiles
+ * @return HB_MC_SUCCESS
+ */
+__attribute__((weak))
+int hb_mc_platform_program_loaded(hb_mc_manycore_t *mc,
+                                  const void *bin, size_t sz,
+                                  const hb_mc_coordinate_t *tiles,
+                                  uint32_t ntiles)
+{
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Loads a parsed program image into a list of tiles and DRAM
+ * @param[in]  image  A program image
+ * @param[in]  pc_init Initial PC address
  * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
  * @param[in]  map    An eva map for computing the eva to npa translation
- * @param[in]  tiles  A list of manycore to load with #bin, with the origin at 0
+ * @param[in]  tiles  A list of manycore to load with #image, with the origin at 0
  * @param[in]  ntiles The number of tiles in #tiles
  * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
  */
-int hb_mc_loader_load(const void *bin, size_t sz, hb_mc_manycore_t *mc,
-                      const hb_mc_eva_map_t *map,
-                      const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+static int hb_mc_loader_load_image_pc(const hb_mc_loader_program_image_t *image,
+                                      hb_mc_eva_t pc_init,
+                                      hb_mc_manycore_t *mc,
+                                      const hb_mc_eva_map_t *map,
+                                      const hb_mc_coordinate_t *tiles, uint32_t ntiles)
 {
         int rc;
-        hb_mc_eva_t pc_init;
-
-        rc = hb_mc_loader_symbol_to_eva(bin, sz, "_start", &pc_init);
-        if (rc != HB_MC_SUCCESS) {
-                bsg_pr_warn("%s: failed to find _start symbol. Defaulting to 0\n", __func__);
-                pc_init = 0;
-        }
 
         if (ntiles < 1)
                 return HB_MC_INVALID;
 
-        // Validate ELF File
-        rc = hb_mc_loader_elf_validate(bin, sz);
-        if (rc != HB_MC_SUCCESS) {
-                bsg_pr_dbg("%s: failed to validate binary\n", __func__);
-                return rc;
-        }
-
         // Set CSRs
         rc = hb_mc_loader_tiles_initialize(mc, map, pc_init, tiles, ntiles);
         if (rc != HB_MC_SUCCESS) {
@@ -868,15 +1126,85 @@ int hb_mc_loader_load(const void *bin, size_t sz, hb_mc_manycore_t *mc,
         }
 
         // Load segments
-        rc = hb_mc_loader_load_segments(bin, sz, mc, map, tiles, ntiles);
+        rc = hb_mc_loader_load_segments(image, mc, map, tiles, ntiles);
         if (rc != HB_MC_SUCCESS) {
                 bsg_pr_dbg("%s: failed to load segments\n", __func__);
                 return rc;
         }
 
+        rc = hb_mc_platform_program_loaded(mc, image->bin, image->sz, tiles, ntiles);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: platform failed to accept program\n", __func__);
+                return rc;
+        }
+
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Loads an ELF file into a list of tiles and DRAM
+ * @param[in]  bin    A memory buffer containing a valid manycore binary
+ * @param[in]  sz     Size of #bin in bytes
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  map    An eva map for computing the eva to npa translation
+ * @param[in]  tiles  A list of manycore to load with #bin, with the origin at 0
+ * @param[in]  ntiles The number of tiles in #tiles
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+static int hb_mc_loader_load_pc(const void *bin, size_t sz, hb_mc_eva_t pc_init,
+                                hb_mc_manycore_t *mc,
+                                const hb_mc_eva_map_t *map,
+                                const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+{
+        int rc;
+
+        if (ntiles < 1)
+                return HB_MC_INVALID;
+
+        // Parse an image that borrows #bin for just this load
+        hb_mc_loader_program_image_t image((const unsigned char *)bin, sz);
+        try {
+                rc = hb_mc_loader_program_image_parse(&image);
+        } catch (const std::bad_alloc &) {
+                bsg_pr_err("%s: failed to allocate program image\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to parse binary\n", __func__);
+                return rc;
+        }
+
+        return hb_mc_loader_load_image_pc(&image, pc_init, mc, map, tiles, ntiles);
+}
+
+/**
+ * Loads an ELF file into a list of tiles and DRAM
+ * @param[in]  bin    A memory buffer containing a valid manycore binary
+ * @param[in]  sz     Size of #bin in bytes
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  map    An eva map for computing the eva to npa translation
+ * @param[in]  tiles  A list of manycore to load with #bin, with the origin at 0
+ * @param[in]  ntiles The number of tiles in #tiles
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_loader_load(const void *bin, size_t sz, hb_mc_manycore_t *mc,
+                      const hb_mc_eva_map_t *map,
+                      const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+{
+        HB_MC_API_TRACE_SCOPE("loader", mc, sz);
+        int rc;
+        hb_mc_eva_t pc_init;
+
+        rc = hb_mc_loader_symbol_to_eva(bin, sz, "_start", &pc_init);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_warn("%s: failed to find _start symbol. Defaulting to 0\n", __func__);
+                pc_init = 0;
+        }
+
+        return hb_mc_loader_load_pc(bin, sz, pc_init, mc, map, tiles, ntiles);
+}
+
 static int hb_mc_loader_get_section(const void *bin, size_t sz, unsigned idx,
                                     const Elf32_Shdr **shdr, const unsigned char **section_data)
 {
@@ -915,16 +1243,61 @@ static bool hb_mc_loader_section_is_symbol_table(const Elf32_Shdr *shdr)
         return RV32_Word_to_host(shdr->sh_type) == SHT_SYMTAB;
 }
 
-static int hb_mc_loader_symbol_search_symbol_table(const void *bin, size_t sz, const char *symbol,
-                                                   const Elf32_Shdr *symtab_shdr, const unsigned char *symtab_data,
-                                                   hb_mc_eva_t *eva)
+/**
+ * Get an EVA for a symbol from a program data.
+ * @param[in]  bin     A memory buffer containing a valid manycore binary.
+ * @param[in]  sz      Size of #bin in bytes.
+ * @param[in]  symbol  A program symbol.
+ * @param[out] eva     An EVA that addresses #symbol.
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_loader_symbol_to_eva(const void *bin, size_t sz, const char *symbol,
+                               hb_mc_eva_t *eva)
+{
+        hb_mc_loader_symbol_table_t *symbols;
+        int rc;
+
+        if (!symbol || !eva)
+                return HB_MC_INVALID;
+
+        rc = hb_mc_loader_symbol_table_init(bin, sz, &symbols);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to read symbols: %s\n",
+                           __func__, hb_mc_strerror(rc));
+                return rc;
+        }
+
+        rc = hb_mc_loader_symbol_table_lookup(symbols, symbol, eva);
+        hb_mc_loader_symbol_table_cleanup(symbols);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_dbg("%s: failed to find symbol '%s': %s\n",
+                           __func__,
+                           symbol,
+                           hb_mc_strerror(rc));
+                return rc;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+
+
+
+
+struct hb_mc_loader_symbol_table {
+        std::unordered_map<std::string, hb_mc_eva_t> eva;
+};
+
+static int hb_mc_loader_symbol_table_add_section(const void *bin, size_t sz,
+                                                 const Elf32_Shdr *symtab_shdr,
+                                                 const unsigned char *symtab_data,
+                                                 hb_mc_loader_symbol_table_t *symbols)
 {
         int rc;
         unsigned strtab_idx = RV32_Word_to_host(symtab_shdr->sh_link);
         const Elf32_Shdr *strtab_shdr;
         const unsigned char *strtab_data;
         const Elf32_Sym *symbol_table = (const Elf32_Sym*)symtab_data, *sym;
-        const char *sym_name;
 
         /* get the string table for this section */
         rc = hb_mc_loader_get_section(bin, sz, strtab_idx,
@@ -935,7 +1308,7 @@ static int hb_mc_loader_symbol_search_symbol_table(const void *bin, size_t sz, c
                 return rc;
         }
 
-        /* total number of symbols in symtab */
+        Elf32_Word strtab_sz = RV32_Word_to_host(strtab_shdr->sh_size);
         Elf32_Word sym_n = RV32_Word_to_host(symtab_shdr->sh_size)/RV32_Word_to_host(symtab_shdr->sh_entsize);
 
         for (Elf32_Word sym_i = 0; sym_i < sym_n; sym_i++) {
@@ -948,72 +1321,41 @@ static int hb_mc_loader_symbol_search_symbol_table(const void *bin, size_t sz, c
                         continue;
 
                 /* symbol's name is in bounds? */
-                if (sym_name_off > RV32_Word_to_host(strtab_shdr->sh_size))
+                if (sym_name_off >= strtab_sz)
                         return HB_MC_INVALID;
 
-                /* is this the symbol we're looking for? */
-                sym_name = (const char *)&strtab_data[sym_name_off];
-                if (strcmp(sym_name, symbol) == 0) {
-                        *eva = RV32_Addr_to_host(sym->st_value);
-                        return HB_MC_SUCCESS;
-                }
-        }
-
-        /* for each symbol */
-        return HB_MC_NOTFOUND;
-}
-
-static int hb_mc_loader_symbol_search_symbol_tables(const void *bin, size_t sz, const char *symbol,
-                                                    hb_mc_eva_t *eva)
-{
-        Elf32_Ehdr *ehdr = (Elf32_Ehdr*) bin;
-        const Elf32_Shdr *shdr;
-        const unsigned char *section_data;
-        size_t section_sz;
-        int rc;
-
-        for (unsigned idx = 0; idx < RV32_Half_to_host(ehdr->e_shnum); idx++) {
-                rc = hb_mc_loader_get_section(bin, sz, idx, &shdr, &section_data);
-                if (rc != HB_MC_SUCCESS) {
-                        bsg_pr_dbg("%s: failed to get section %u: %s\n",
-                                   __func__, idx, hb_mc_strerror(rc));
-                        return rc;
-                }
-
-                if (!hb_mc_loader_section_is_symbol_table(shdr))
-                        continue;
+                /* the name must be terminated inside the string table */
+                const char *sym_name = (const char *)&strtab_data[sym_name_off];
+                size_t sym_name_len = strnlen(sym_name, strtab_sz - sym_name_off);
+                if (sym_name_len == strtab_sz - sym_name_off)
+                        return HB_MC_INVALID;
 
-                rc = hb_mc_loader_symbol_search_symbol_table(bin, sz, symbol,
-                                                             shdr, section_data,
-                                                             eva);
-                if (rc == HB_MC_NOTFOUND) {
-                        continue;
-                } else if (rc != HB_MC_SUCCESS) {
-                        bsg_pr_dbg("%s: failed search for symbol '%s' in section %u: %s\n",
-                                   __func__, symbol, idx, hb_mc_strerror(rc));
-                        return rc;
-                } else {
-                        return rc;
-                }
+                /* first definition wins */
+                symbols->eva.emplace(std::string(sym_name, sym_name_len),
+                                     RV32_Addr_to_host(sym->st_value));
         }
 
-        return HB_MC_NOTFOUND;
+        return HB_MC_SUCCESS;
 }
 
 /**
- * Get an EVA for a symbol from a program data.
+ * Parse the symbol tables of a binary into a hashed symbol table.
  * @param[in]  bin     A memory buffer containing a valid manycore binary.
  * @param[in]  sz      Size of #bin in bytes.
- * @param[in]  symbol  A program symbol.
- * @param[out] eva     An EVA that addresses #symbol.
- * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ * @param[out] symbols A symbol table to be freed with hb_mc_loader_symbol_table_cleanup().
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
  */
-int hb_mc_loader_symbol_to_eva(const void *bin, size_t sz, const char *symbol,
-                               hb_mc_eva_t *eva)
+int hb_mc_loader_symbol_table_init(const void *bin, size_t sz,
+                                   hb_mc_loader_symbol_table_t **symbols)
 {
+        HB_MC_API_TRACE_SCOPE("loader", nullptr, sz);
+        const Elf32_Ehdr *ehdr = (const Elf32_Ehdr*) bin;
+        const Elf32_Shdr *shdr;
+        const unsigned char *section_data;
+        hb_mc_loader_symbol_table_t *table;
         int rc;
 
-        if (!symbol || !eva)
+        if (!symbols)
                 return HB_MC_INVALID;
 
         rc = hb_mc_loader_elf_validate(bin, sz);
@@ -1022,21 +1364,77 @@ int hb_mc_loader_symbol_to_eva(const void *bin, size_t sz, const char *symbol,
                 return rc;
         }
 
-        rc = hb_mc_loader_symbol_search_symbol_tables(bin, sz, symbol, eva);
+        table = new (std::nothrow) hb_mc_loader_symbol_table_t;
+        if (!table) {
+                bsg_pr_err("%s: failed to allocate symbol table\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        try {
+                for (unsigned idx = 0; idx < RV32_Half_to_host(ehdr->e_shnum); idx++) {
+                        rc = hb_mc_loader_get_section(bin, sz, idx, &shdr, &section_data);
+                        if (rc != HB_MC_SUCCESS) {
+                                bsg_pr_dbg("%s: failed to get section %u: %s\n",
+                                           __func__, idx, hb_mc_strerror(rc));
+                                break;
+                        }
+
+                        if (!hb_mc_loader_section_is_symbol_table(shdr))
+                                continue;
+
+                        rc = hb_mc_loader_symbol_table_add_section(bin, sz, shdr,
+                                                                   section_data, table);
+                        if (rc != HB_MC_SUCCESS) {
+                                bsg_pr_dbg("%s: failed to read symbols from section %u: %s\n",
+                                           __func__, idx, hb_mc_strerror(rc));
+                                break;
+                        }
+                }
+        } catch (const std::bad_alloc &) {
+                bsg_pr_err("%s: failed to allocate symbol table\n", __func__);
+                rc = HB_MC_NOMEM;
+        }
+
         if (rc != HB_MC_SUCCESS) {
-                bsg_pr_dbg("%s: failed to find symbol '%s': %s\n",
-                           __func__,
-                           symbol,
-                           hb_mc_strerror(rc));
+                delete table;
                 return rc;
         }
 
+        *symbols = table;
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Free a symbol table built with hb_mc_loader_symbol_table_init().
+ * @param[in]  symbols A symbol table. May be NULL.
+ */
+void hb_mc_loader_symbol_table_cleanup(hb_mc_loader_symbol_table_t *symbols)
+{
+        delete symbols;
+}
 
+/**
+ * Get an EVA for a symbol from a symbol table.
+ * @param[in]  symbols A symbol table built with hb_mc_loader_symbol_table_init().
+ * @param[in]  symbol  A program symbol.
+ * @param[out] eva     An EVA that addresses #symbol.
+ * @return HB_MC_NOTFOUND if #symbol is not defined. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_loader_symbol_table_lookup(const hb_mc_loader_symbol_table_t *symbols,
+                                     const char *symbol, hb_mc_eva_t *eva)
+{
+        if (!symbols || !symbol || !eva)
+                return HB_MC_INVALID;
 
+        auto it = symbols->eva.find(symbol);
+        if (it == symbols->eva.end()) {
+                bsg_pr_dbg("%s: failed to find symbol '%s'\n", __func__, symbol);
+                return HB_MC_NOTFOUND;
+        }
 
+        *eva = it->second;
+        return HB_MC_SUCCESS;
+}
 
 /**
  * Takes in the path to a binary and loads the binary into a buffer and set the binary size.
@@ -1080,3 +1478,134 @@ int hb_mc_loader_read_program_file(const char *file_name, unsigned char **file_d
         *file_size = st.st_size;
         return HB_MC_SUCCESS;
 }
+
+/**
+ * Parse a binary into a program image that can be loaded any number of times.
+ * @param[in]  bin    A memory buffer containing a valid manycore binary.
+ * @param[in]  sz     Size of #bin in bytes.
+ * @param[in]  move   If nonzero, the image takes ownership of #bin, which must
+ *                    have been allocated with malloc(). Otherwise #bin is copied.
+ * @param[out] image  A program image to be released with hb_mc_loader_program_image_release().
+ * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned,
+ *         and the caller keeps ownership of #bin.
+ */
+int hb_mc_loader_program_image_init(const unsigned char *bin, size_t sz, int move,
+                                    hb_mc_loader_program_image_t **image)
+{
+        HB_MC_API_TRACE_SCOPE("loader", nullptr, sz);
+        hb_mc_loader_program_image_t *img;
+        int rc;
+
+        if (!bin || !image)
+                return HB_MC_INVALID;
+
+        img = new (std::nothrow) hb_mc_loader_program_image_t(bin, sz);
+        if (!img) {
+                bsg_pr_err("%s: failed to allocate program image\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        if (!move) {
+                unsigned char *copy = (unsigned char *) malloc(sz);
+                if (!copy) {
+                        bsg_pr_err("%s: failed to copy binary: %m\n", __func__);
+                        delete img;
+                        return HB_MC_NOMEM;
+                }
+                memcpy(copy, bin, sz);
+                img->bin = copy;
+                img->owns_bin = true;
+        }
+
+        try {
+                rc = hb_mc_loader_program_image_parse(img);
+        } catch (const std::bad_alloc &) {
+                bsg_pr_err("%s: failed to allocate program image\n", __func__);
+                rc = HB_MC_NOMEM;
+        }
+
+        if (rc == HB_MC_SUCCESS)
+                rc = hb_mc_loader_symbol_table_init(img->bin, img->sz, &img->symbols);
+
+        if (rc != HB_MC_SUCCESS) {
+                delete img;
+                return rc;
+        }
+
+        rc = hb_mc_loader_symbol_table_lookup(img->symbols, "_start", &img->pc_init);
+        if (rc != HB_MC_SUCCESS) {
+                bsg_pr_warn("%s: failed to find _start symbol. Defaulting to 0\n", __func__);
+                img->pc_init = 0;
+        }
+
+        /* the binary is ours only once nothing else can fail */
+        img->owns_bin = true;
+        *image = img;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Take another reference to a program image.
+ * @param[in]  image  A program image.
+ * @return #image.
+ */
+hb_mc_loader_program_image_t *hb_mc_loader_program_image_retain(hb_mc_loader_program_image_t *image)
+{
+        if (image)
+                image->refs.fetch_add(1, std::memory_order_relaxed);
+        return image;
+}
+
+/**
+ * Drop a reference to a program image, freeing it with the last one.
+ * @param[in]  image  A program image. May be NULL.
+ */
+void hb_mc_loader_program_image_release(hb_mc_loader_program_image_t *image)
+{
+        if (image && image->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete image;
+}
+
+/**
+ * Get the binary a program image was parsed from.
+ * @param[in]  image  A program image.
+ * @param[out] sz     Is set to the size of the binary in bytes.
+ * @return The binary, which lives as long as #image.
+ */
+const unsigned char *hb_mc_loader_program_image_get_binary(const hb_mc_loader_program_image_t *image,
+                                                          size_t *sz)
+{
+        *sz = image->sz;
+        return image->bin;
+}
+
+/**
+ * Get the symbol table of a program image.
+ * @param[in]  image  A program image.
+ * @return The symbol table, which lives as long as #image.
+ */
+const hb_mc_loader_symbol_table_t *hb_mc_loader_program_image_get_symbols(const hb_mc_loader_program_image_t *image)
+{
+        return image->symbols;
+}
+
+/**
+ * Loads a program image into a list of tiles and DRAM
+ * @param[in]  image   A program image built with hb_mc_loader_program_image_init()
+ * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  map     An eva map for computing the eva to npa translation
+ * @param[in]  tiles   A list of manycore to load with #image, with the origin at 0
+ * @param[in]  ntiles  The number of tiles in #tiles
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_loader_load_image(const hb_mc_loader_program_image_t *image,
+                            hb_mc_manycore_t *mc,
+                            const hb_mc_eva_map_t *map,
+                            const hb_mc_coordinate_t *tiles, uint32_t ntiles)
+{
+        if (!image)
+                return HB_MC_INVALID;
+
+        HB_MC_API_TRACE_SCOPE("loader", mc, image->sz);
+        return hb_mc_loader_load_image_pc(image, image->pc_init, mc, map, tiles, ntiles);
+}
@@ -64,7 +64,107 @@ extern "C" {
         int hb_mc_loader_symbol_to_eva(const void *bin, size_t sz, const char *symbol,
                                        hb_mc_eva_t *eva);
 
+        /**
+         * A table of the symbols defined by a manycore binary.
+         * The binary is parsed once when the table is built; lookups are
+         * then constant time and do not touch the binary again.
+         */
+        typedef struct hb_mc_loader_symbol_table hb_mc_loader_symbol_table_t;
+
+        /**
+         * Parse the symbol tables of a binary into a hashed symbol table.
+         * @param[in]  bin     A memory buffer containing a valid manycore binary.
+         * @param[in]  sz      Size of #bin in bytes.
+         * @param[out] symbols A symbol table to be freed with hb_mc_loader_symbol_table_cleanup().
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_symbol_table_init(const void *bin, size_t sz,
+                                           hb_mc_loader_symbol_table_t **symbols);
+
+        /**
+         * Free a symbol table built with hb_mc_loader_symbol_table_init().
+         * @param[in]  symbols A symbol table. May be NULL.
+         */
+        void hb_mc_loader_symbol_table_cleanup(hb_mc_loader_symbol_table_t *symbols);
+
+        /**
+         * Get an EVA for a symbol from a symbol table.
+         * @param[in]  symbols A symbol table built with hb_mc_loader_symbol_table_init().
+         * @param[in]  symbol  A program symbol. Behavior is undefined if #symbol is not a zero terminated string.
+         * @param[out] eva     An EVA that addresses #symbol.
+         * @return HB_MC_NOTFOUND if #symbol is not defined. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_symbol_table_lookup(const hb_mc_loader_symbol_table_t *symbols,
+                                             const char *symbol, hb_mc_eva_t *eva);
 
+        /**
+         * A binary parsed for loading: its validated headers, the byte
+         * ranges of its segments, the payload and zeroed extent that each
+         * tile receives, and its symbol table. An image is immutable once
+         * built, so one image can be loaded onto any number of pods.
+         */
+        typedef struct hb_mc_loader_program_image hb_mc_loader_program_image_t;
+
+        /**
+         * Parse a binary into a program image that can be loaded any number of times.
+         * @param[in]  bin    A memory buffer containing a valid manycore binary.
+         * @param[in]  sz     Size of #bin in bytes.
+         * @param[in]  move   If nonzero, the image takes ownership of #bin, which must
+         *                    have been allocated with malloc(). Otherwise #bin is copied.
+         * @param[out] image  A program image to be released with hb_mc_loader_program_image_release().
+         * @return HB_MC_SUCCESS if successful. Otherwise an error code is returned,
+         *         and the caller keeps ownership of #bin.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_program_image_init(const unsigned char *bin, size_t sz, int move,
+                                            hb_mc_loader_program_image_t **image);
+
+        /**
+         * Take another reference to a program image.
+         * @param[in]  image  A program image.
+         * @return #image.
+         */
+        hb_mc_loader_program_image_t *hb_mc_loader_program_image_retain(hb_mc_loader_program_image_t *image);
+
+        /**
+         * Drop a reference to a program image, freeing it with the last one.
+         * @param[in]  image  A program image. May be NULL.
+         */
+        void hb_mc_loader_program_image_release(hb_mc_loader_program_image_t *image);
+
+        /**
+         * Get the binary a program image was parsed from.
+         * @param[in]  image  A program image.
+         * @param[out] sz     Is set to the size of the binary in bytes.
+         * @return The binary, which lives as long as #image.
+         */
+        const unsigned char *hb_mc_loader_program_image_get_binary(const hb_mc_loader_program_image_t *image,
+                                                                  size_t *sz);
+
+        /**
+         * Get the symbol table of a program image.
+         * @param[in]  image  A program image.
+         * @return The symbol table, which lives as long as #image.
+         */
+        const hb_mc_loader_symbol_table_t *hb_mc_loader_program_image_get_symbols(const hb_mc_loader_program_image_t *image);
+
+        /**
+         * Loads a program image into a list of tiles and DRAM
+         * @param[in]  image   A program image built with hb_mc_loader_program_image_init()
+         * @param[in]  mc      A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in]  map     An eva map for computing the eva to npa translation
+         * @param[in]  tiles   A list of manycore to load with #image, with the origin at 0
+         * @param[in]  len     The number of tiles in #tiles
+         * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_loader_load_image(const hb_mc_loader_program_image_t *image,
+                                    hb_mc_manycore_t *mc,
+                                    const hb_mc_eva_map_t *map,
+                                    const hb_mc_coordinate_t *tiles,
+                                    uint32_t len);
 
         /**
          * Takes in the path to a binary and loads it into a buffer and sets the binary size. 
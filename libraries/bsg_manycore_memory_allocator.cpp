@@ -0,0 +1,228 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore_memory_allocator.h>
+#include <bsg_manycore_printing.h>
+
+#include <cinttypes>
+#include <map>
+#include <new>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+struct hb_mc_memory_allocator {
+        uint64_t start;
+        uint64_t size;
+        uint64_t alignment;
+
+        // free blocks: address -> size, and (size, address)
+        std::map<uint64_t, uint64_t> free_by_addr;
+        std::set<std::pair<uint64_t, uint64_t> > free_by_size;
+
+        // allocated blocks: address -> size
+        std::unordered_map<uint64_t, uint64_t> busy;
+
+        uint64_t live_bytes;
+        uint64_t peak_bytes;
+};
+
+typedef std::map<uint64_t, uint64_t>::iterator free_iterator;
+
+static void allocator_insert_free(hb_mc_memory_allocator_t *a, uint64_t addr, uint64_t size)
+{
+        a->free_by_addr.emplace(addr, size);
+        a->free_by_size.emplace(size, addr);
+}
+
+static void allocator_erase_free(hb_mc_memory_allocator_t *a, free_iterator it)
+{
+        a->free_by_size.erase(std::make_pair(it->second, it->first));
+        a->free_by_addr.erase(it);
+}
+
+/**
+ * Initialize an allocator for [start, start + size).
+ * @param[out] allocator  An allocator to be freed with hb_mc_memory_allocator_exit().
+ * @param[in]  start      First address of the range. Must be a multiple of #alignment.
+ * @param[in]  size       Size of the range in bytes.
+ * @param[in]  alignment  Alignment in bytes. Must be a power of two.
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_memory_allocator_init(hb_mc_memory_allocator_t **allocator,
+                                uint64_t start, uint64_t size, uint32_t alignment)
+{
+        if (!allocator)
+                return HB_MC_INVALID;
+
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+                bsg_pr_err("%s: alignment %" PRIu32 " is not a power of two\n", __func__, alignment);
+                return HB_MC_INVALID;
+        }
+
+        if (start % alignment != 0) {
+                bsg_pr_err("%s: start 0x%" PRIx64 " is not aligned to %" PRIu32 " bytes\n",
+                           __func__, start, alignment);
+                return HB_MC_INVALID;
+        }
+
+        hb_mc_memory_allocator_t *a = new (std::nothrow) hb_mc_memory_allocator_t;
+        if (!a) {
+                bsg_pr_err("%s: failed to allocate allocator\n", __func__);
+                return HB_MC_NOMEM;
+        }
+
+        // only whole aligned blocks can be handed out
+        a->start = start;
+        a->size = size - (size % alignment);
+        a->alignment = alignment;
+        a->live_bytes = 0;
+        a->peak_bytes = 0;
+
+        if (a->size > 0)
+                allocator_insert_free(a, a->start, a->size);
+
+        *allocator = a;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Cleanup an allocator.
+ * @param[in] allocator  An allocator initialized with hb_mc_memory_allocator_init(). May be NULL.
+ */
+void hb_mc_memory_allocator_exit(hb_mc_memory_allocator_t *allocator)
+{
+        delete allocator;
+}
+
+/**
+ * Allocate memory.
+ * @param[in]  allocator  An allocator.
+ * @param[in]  size       Number of bytes. Zero allocates one aligned block.
+ * @param[out] addr       The address of the allocated memory.
+ * @return HB_MC_NOMEM if no free block is large enough. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_memory_allocator_alloc(hb_mc_memory_allocator_t *allocator,
+                                 uint64_t size, uint64_t *addr)
+{
+        hb_mc_memory_allocator_t *a = allocator;
+
+        if (!a || !addr)
+                return HB_MC_INVALID;
+
+        if (size == 0)
+                size = a->alignment;
+
+        // round up to the alignment, checking for overflow
+        uint64_t aligned = (size + a->alignment - 1) & ~(a->alignment - 1);
+        if (aligned < size)
+                return HB_MC_NOMEM;
+
+        // best fit: the smallest free block that is large enough,
+        // the lowest addressed one among equals
+        auto fit = a->free_by_size.lower_bound(std::make_pair(aligned, (uint64_t)0));
+        if (fit == a->free_by_size.end())
+                return HB_MC_NOMEM;
+
+        uint64_t block_addr = fit->second, block_size = fit->first;
+        allocator_erase_free(a, a->free_by_addr.find(block_addr));
+
+        // return the remainder to the free trees
+        if (block_size > aligned)
+                allocator_insert_free(a, block_addr + aligned, block_size - aligned);
+
+        a->busy.emplace(block_addr, aligned);
+        a->live_bytes += aligned;
+        if (a->live_bytes > a->peak_bytes)
+                a->peak_bytes = a->live_bytes;
+
+        *addr = block_addr;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Free memory.
+ * @param[in]  allocator  An allocator.
+ * @param[in]  addr       An address returned by hb_mc_memory_allocator_alloc().
+ * @return HB_MC_INVALID if #addr is not currently allocated. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_memory_allocator_free(hb_mc_memory_allocator_t *allocator, uint64_t addr)
+{
+        hb_mc_memory_allocator_t *a = allocator;
+
+        if (!a)
+                return HB_MC_INVALID;
+
+        auto busy = a->busy.find(addr);
+        if (busy == a->busy.end())
+                return HB_MC_INVALID;
+
+        uint64_t block_addr = busy->first, block_size = busy->second;
+        a->busy.erase(busy);
+        a->live_bytes -= block_size;
+
+        // coalesce with the free block after this one
+        free_iterator next = a->free_by_addr.lower_bound(block_addr);
+        if (next != a->free_by_addr.end() && next->first == block_addr + block_size) {
+                block_size += next->second;
+                free_iterator after = std::next(next);
+                allocator_erase_free(a, next);
+                next = after;
+        }
+
+        // coalesce with the free block before this one
+        if (next != a->free_by_addr.begin()) {
+                free_iterator prev = std::prev(next);
+                if (prev->first + prev->second == block_addr) {
+                        block_addr = prev->first;
+                        block_size += prev->second;
+                        allocator_erase_free(a, prev);
+                }
+        }
+
+        allocator_insert_free(a, block_addr, block_size);
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get the usage statistics of an allocator.
+ * @param[in]  allocator  An allocator.
+ * @param[out] stats      Usage statistics.
+ */
+void hb_mc_memory_allocator_get_stats(const hb_mc_memory_allocator_t *allocator,
+                                      hb_mc_memory_allocator_stats_t *stats)
+{
+        const hb_mc_memory_allocator_t *a = allocator;
+
+        stats->total_bytes = a->size;
+        stats->live_bytes = a->live_bytes;
+        stats->peak_bytes = a->peak_bytes;
+        stats->free_bytes = a->size - a->live_bytes;
+        stats->largest_free_block = a->free_by_size.empty() ? 0 : a->free_by_size.rbegin()->first;
+        stats->free_blocks = a->free_by_addr.size();
+        stats->live_allocations = a->busy.size();
+}
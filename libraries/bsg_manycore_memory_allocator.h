@@ -0,0 +1,118 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BSG_MANYCORE_MEMORY_ALLOCATOR_H
+#define BSG_MANYCORE_MEMORY_ALLOCATOR_H
+
+#include <bsg_manycore_features.h>
+#include <bsg_manycore_errno.h>
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+        /**
+         * An allocator for a range of device memory.
+         *
+         * Free blocks are kept in a size-ordered tree for best-fit
+         * allocation and an address-ordered tree for coalescing with
+         * their neighbors; allocated blocks are kept in a hash table.
+         * Allocation and free are O(log n) in the number of free blocks.
+         */
+        typedef struct hb_mc_memory_allocator hb_mc_memory_allocator_t;
+
+        /**
+         * Usage statistics of a memory allocator.
+         */
+        typedef struct {
+                uint64_t total_bytes;        //!< Size of the managed range
+                uint64_t live_bytes;         //!< Bytes currently allocated, after alignment
+                uint64_t peak_bytes;         //!< Largest value of live_bytes so far
+                uint64_t free_bytes;         //!< Bytes currently free
+                uint64_t largest_free_block; //!< Largest allocation that can currently succeed
+                uint64_t free_blocks;        //!< Number of free blocks
+                uint64_t live_allocations;   //!< Number of allocations not yet freed
+        } hb_mc_memory_allocator_stats_t;
+
+        /**
+         * Initialize an allocator for [start, start + size).
+         * Every allocation is a multiple of #alignment bytes and starts on
+         * an #alignment boundary.
+         * @param[out] allocator  An allocator to be freed with hb_mc_memory_allocator_exit().
+         * @param[in]  start      First address of the range. Must be a multiple of #alignment.
+         * @param[in]  size       Size of the range in bytes.
+         * @param[in]  alignment  Alignment in bytes. Must be a power of two.
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_memory_allocator_init(hb_mc_memory_allocator_t **allocator,
+                                        uint64_t start, uint64_t size, uint32_t alignment);
+
+        /**
+         * Cleanup an allocator.
+         * @param[in] allocator  An allocator initialized with hb_mc_memory_allocator_init(). May be NULL.
+         */
+        void hb_mc_memory_allocator_exit(hb_mc_memory_allocator_t *allocator);
+
+        /**
+         * Allocate memory.
+         * @param[in]  allocator  An allocator.
+         * @param[in]  size       Number of bytes. Zero allocates one aligned block.
+         * @param[out] addr       The address of the allocated memory.
+         * @return HB_MC_NOMEM if no free block is large enough. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_memory_allocator_alloc(hb_mc_memory_allocator_t *allocator,
+                                         uint64_t size, uint64_t *addr);
+
+        /**
+         * Free memory.
+         * @param[in]  allocator  An allocator.
+         * @param[in]  addr       An address returned by hb_mc_memory_allocator_alloc().
+         * @return HB_MC_INVALID if #addr is not currently allocated. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_memory_allocator_free(hb_mc_memory_allocator_t *allocator, uint64_t addr);
+
+        /**
+         * Get the usage statistics of an allocator.
+         * @param[in]  allocator  An allocator.
+         * @param[out] stats      Usage statistics.
+         */
+        void hb_mc_memory_allocator_get_stats(const hb_mc_memory_allocator_t *allocator,
+                                              hb_mc_memory_allocator_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
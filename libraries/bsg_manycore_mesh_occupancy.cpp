@@ -0,0 +1,377 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <bsg_manycore_mesh_occupancy.h>
+#include <bsg_manycore_printing.h>
+
+#ifdef __cplusplus
+#include <cstring>
+#include <cstdlib>
+#else
+#include <string.h>
+#include <stdlib.h>
+#endif
+
+#define WORD_BITS 64
+
+static uint64_t *occupancy_column(const hb_mc_mesh_occupancy_t *occ, hb_mc_idx_t x)
+{
+        return &occ->free[x * occ->words];
+}
+
+/**
+ * The bits of word #w that cover rows [y, y + h)
+ */
+static uint64_t occupancy_rows_mask(uint32_t w, hb_mc_idx_t y, hb_mc_idx_t h)
+{
+        uint32_t base = w * WORD_BITS;
+        uint32_t lo = y > base ? y : base;
+        uint32_t hi = (y + h) < (base + WORD_BITS) ? (y + h) : (base + WORD_BITS);
+
+        if (lo >= hi)
+                return 0;
+
+        uint32_t bits = hi - lo;
+        uint64_t mask = bits == WORD_BITS ? ~0ull : ((1ull << bits) - 1);
+        return mask << (lo - base);
+}
+
+/**
+ * dst = src >> n, treating the #words words of src as one bitmap
+ */
+static void occupancy_shift_right(uint64_t *dst, const uint64_t *src, uint32_t words, uint32_t n)
+{
+        uint32_t q = n / WORD_BITS, r = n % WORD_BITS;
+
+        for (uint32_t w = 0; w < words; w++) {
+                uint64_t lo = (w + q     < words) ? src[w + q]     : 0;
+                uint64_t hi = (w + q + 1 < words) ? src[w + q + 1] : 0;
+                dst[w] = r == 0 ? lo : (lo >> r) | (hi << (WORD_BITS - r));
+        }
+}
+
+/**
+ * Compute the rows y of a column at which h consecutive tiles starting at y are free.
+ * Runs are doubled in length at each step, so this takes O(log h) word operations.
+ */
+static void occupancy_column_runs(const hb_mc_mesh_occupancy_t *occ, hb_mc_idx_t x, hb_mc_idx_t h,
+                                  uint64_t *run, uint64_t *tmp)
+{
+        uint32_t words = occ->words;
+        hb_mc_idx_t len = 1;
+
+        memcpy(run, occupancy_column(occ, x), words * sizeof(*run));
+
+        while (2 * len <= h) {
+                occupancy_shift_right(tmp, run, words, len);
+                for (uint32_t w = 0; w < words; w++)
+                        run[w] &= tmp[w];
+                len *= 2;
+        }
+
+        if (len < h) {
+                occupancy_shift_right(tmp, run, words, h - len);
+                for (uint32_t w = 0; w < words; w++)
+                        run[w] &= tmp[w];
+        }
+}
+
+static int occupancy_rect_in_mesh(const hb_mc_mesh_occupancy_t *occ,
+                                  hb_mc_coordinate_t origin, hb_mc_dimension_t dim)
+{
+        return dim.x > 0 && dim.y > 0
+                && origin.x < occ->dim.x && dim.x <= occ->dim.x - origin.x
+                && origin.y < occ->dim.y && dim.y <= occ->dim.y - origin.y;
+}
+
+/**
+ * Initialize an occupancy index with all tiles free.
+ * @param[in] occ  An occupancy index.
+ * @param[in] dim  The dimension of the mesh.
+ * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+ */
+int hb_mc_mesh_occupancy_init(hb_mc_mesh_occupancy_t *occ, hb_mc_dimension_t dim)
+{
+        if (!occ || dim.x == 0 || dim.y == 0)
+                return HB_MC_INVALID;
+
+        occ->dim = dim;
+        occ->words = (dim.y + WORD_BITS - 1) / WORD_BITS;
+        occ->num_free = dim.x * dim.y;
+
+        occ->free = (uint64_t*)calloc(dim.x * occ->words, sizeof(uint64_t));
+        // one run per column, plus a temporary and an accumulator
+        occ->scratch = (uint64_t*)calloc((dim.x + 2) * occ->words, sizeof(uint64_t));
+        if (!occ->free || !occ->scratch) {
+                bsg_pr_err("%s: failed to allocate occupancy bitmaps\n", __func__);
+                free(occ->free);
+                free(occ->scratch);
+                occ->free = NULL;
+                occ->scratch = NULL;
+                return HB_MC_NOMEM;
+        }
+
+        for (hb_mc_idx_t x = 0; x < dim.x; x++) {
+                uint64_t *col = occupancy_column(occ, x);
+                for (uint32_t w = 0; w < occ->words; w++)
+                        col[w] = occupancy_rows_mask(w, 0, dim.y);
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Cleanup an occupancy index.
+ * @param[in] occ  An occupancy index initialized with hb_mc_mesh_occupancy_init().
+ */
+void hb_mc_mesh_occupancy_exit(hb_mc_mesh_occupancy_t *occ)
+{
+        if (!occ)
+                return;
+
+        free(occ->free);
+        free(occ->scratch);
+        occ->free = NULL;
+        occ->scratch = NULL;
+        occ->num_free = 0;
+}
+
+/**
+ * Call #visit with the origin of each free rectangle of #dim tiles, lowest x
+ * first, then lowest y, as in foreach_coordinate(), until it returns true.
+ * #dim must fit in the mesh.
+ */
+template <typename VisitFunction>
+static void occupancy_foreach_free_origin(hb_mc_mesh_occupancy_t *occ, hb_mc_dimension_t dim,
+                                          VisitFunction visit)
+{
+        uint32_t words = occ->words;
+        uint64_t *runs = occ->scratch;
+        uint64_t *tmp = &occ->scratch[occ->dim.x * words];
+        uint64_t *acc = &occ->scratch[(occ->dim.x + 1) * words];
+
+        // rows at which each column has dim.y free tiles
+        for (hb_mc_idx_t x = 0; x < occ->dim.x; x++)
+                occupancy_column_runs(occ, x, dim.y, &runs[x * words], tmp);
+
+        for (hb_mc_idx_t x0 = 0; x0 + dim.x <= occ->dim.x; x0++) {
+                uint64_t any = 0;
+                memcpy(acc, &runs[x0 * words], words * sizeof(*acc));
+                for (hb_mc_idx_t x = x0 + 1; x < x0 + dim.x; x++) {
+                        any = 0;
+                        for (uint32_t w = 0; w < words; w++) {
+                                acc[w] &= runs[x * words + w];
+                                any |= acc[w];
+                        }
+                        if (!any)
+                                break;
+                }
+
+                for (uint32_t w = 0; w < words; w++) {
+                        for (uint64_t bits = acc[w]; bits != 0; bits &= bits - 1) {
+                                if (visit(hb_mc_coordinate(x0, w * WORD_BITS + __builtin_ctzll(bits))))
+                                        return;
+                        }
+                }
+        }
+}
+
+/**
+ * The number of busy tiles in rows [y, y + h) of column #x.
+ * Columns outside the mesh count as busy.
+ */
+static uint32_t occupancy_column_busy(const hb_mc_mesh_occupancy_t *occ, int64_t x,
+                                      hb_mc_idx_t y, hb_mc_idx_t h)
+{
+        if (x < 0 || x >= occ->dim.x)
+                return h;
+
+        const uint64_t *col = occupancy_column(occ, x);
+        uint32_t num_free = 0;
+        for (uint32_t w = 0; w < occ->words; w++)
+                num_free += __builtin_popcountll(col[w] & occupancy_rows_mask(w, y, h));
+        return h - num_free;
+}
+
+/**
+ * The number of busy tiles and mesh edges bordering a rectangle.
+ */
+static uint32_t occupancy_contact(const hb_mc_mesh_occupancy_t *occ,
+                                  hb_mc_coordinate_t origin, hb_mc_dimension_t dim)
+{
+        uint32_t contact = occupancy_column_busy(occ, (int64_t)origin.x - 1, origin.y, dim.y)
+                + occupancy_column_busy(occ, (int64_t)origin.x + dim.x, origin.y, dim.y);
+
+        for (hb_mc_idx_t x = origin.x; x < origin.x + dim.x; x++) {
+                contact += origin.y == 0 ? 1 : occupancy_column_busy(occ, x, origin.y - 1, 1);
+                contact += origin.y + dim.y == occ->dim.y ? 1 : occupancy_column_busy(occ, x, origin.y + dim.y, 1);
+        }
+
+        return contact;
+}
+
+/**
+ * Find a free rectangle of tiles.
+ * @param[in]  occ     An occupancy index.
+ * @param[in]  dim     The dimension of the rectangle.
+ * @param[out] origin  The origin of a free rectangle of #dim tiles.
+ * @return HB_MC_NOTFOUND if no such rectangle is free. HB_MC_INVALID if
+ *         #dim is empty or larger than the mesh. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_mesh_occupancy_find(hb_mc_mesh_occupancy_t *occ, hb_mc_dimension_t dim,
+                              hb_mc_coordinate_t *origin)
+{
+        if (!occ || !origin || !occupancy_rect_in_mesh(occ, hb_mc_coordinate(0, 0), dim))
+                return HB_MC_INVALID;
+
+        if (occ->num_free < dim.x * dim.y)
+                return HB_MC_NOTFOUND;
+
+        int found = HB_MC_NOTFOUND;
+        occupancy_foreach_free_origin(occ, dim, [&](hb_mc_coordinate_t o) -> bool {
+                        *origin = o;
+                        found = HB_MC_SUCCESS;
+                        return true;
+                });
+
+        return found;
+}
+
+/**
+ * Find the free rectangle of tiles that fits most tightly.
+ * @param[in]  occ     An occupancy index.
+ * @param[in]  dim     The dimension of the rectangle.
+ * @param[out] origin  The origin of a free rectangle of #dim tiles.
+ * @return HB_MC_NOTFOUND if no such rectangle is free. HB_MC_INVALID if
+ *         #dim is empty or larger than the mesh. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_mesh_occupancy_find_best_fit(hb_mc_mesh_occupancy_t *occ, hb_mc_dimension_t dim,
+                                       hb_mc_coordinate_t *origin)
+{
+        if (!occ || !origin || !occupancy_rect_in_mesh(occ, hb_mc_coordinate(0, 0), dim))
+                return HB_MC_INVALID;
+
+        if (occ->num_free < dim.x * dim.y)
+                return HB_MC_NOTFOUND;
+
+        // a rectangle cannot border more than its perimeter
+        uint32_t most = 2 * (dim.x + dim.y);
+        int found = HB_MC_NOTFOUND;
+        uint32_t best = 0;
+        occupancy_foreach_free_origin(occ, dim, [&](hb_mc_coordinate_t o) -> bool {
+                        uint32_t contact = occupancy_contact(occ, o, dim);
+                        if (found != HB_MC_SUCCESS || contact > best) {
+                                *origin = o;
+                                best = contact;
+                                found = HB_MC_SUCCESS;
+                        }
+                        return best == most;
+                });
+
+        return found;
+}
+
+/**
+ * Check if a rectangle of tiles is free.
+ * @param[in]  occ     An occupancy index.
+ * @param[in]  origin  The origin of the rectangle.
+ * @param[in]  dim     The dimension of the rectangle.
+ * @return Non-zero if every tile in the rectangle is free and the
+ *         rectangle is inside the mesh.
+ */
+int hb_mc_mesh_occupancy_is_free(const hb_mc_mesh_occupancy_t *occ,
+                                 hb_mc_coordinate_t origin, hb_mc_dimension_t dim)
+{
+        if (!occ || !occupancy_rect_in_mesh(occ, origin, dim))
+                return 0;
+
+        for (hb_mc_idx_t x = origin.x; x < origin.x + dim.x; x++) {
+                const uint64_t *col = occupancy_column(occ, x);
+                for (uint32_t w = 0; w < occ->words; w++) {
+                        uint64_t mask = occupancy_rows_mask(w, origin.y, dim.y);
+                        if ((col[w] & mask) != mask)
+                                return 0;
+                }
+        }
+
+        return 1;
+}
+
+/**
+ * Mark a free rectangle of tiles as busy.
+ * @param[in]  occ     An occupancy index.
+ * @param[in]  origin  The origin of the rectangle.
+ * @param[in]  dim     The dimension of the rectangle.
+ * @return HB_MC_INVALID if any tile is outside the mesh or already busy.
+ *         HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_mesh_occupancy_allocate(hb_mc_mesh_occupancy_t *occ,
+                                  hb_mc_coordinate_t origin, hb_mc_dimension_t dim)
+{
+        if (!hb_mc_mesh_occupancy_is_free(occ, origin, dim))
+                return HB_MC_INVALID;
+
+        for (hb_mc_idx_t x = origin.x; x < origin.x + dim.x; x++) {
+                uint64_t *col = occupancy_column(occ, x);
+                for (uint32_t w = 0; w < occ->words; w++)
+                        col[w] &= ~occupancy_rows_mask(w, origin.y, dim.y);
+        }
+
+        occ->num_free -= dim.x * dim.y;
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Mark a busy rectangle of tiles as free.
+ * @param[in]  occ     An occupancy index.
+ * @param[in]  origin  The origin of the rectangle.
+ * @param[in]  dim     The dimension of the rectangle.
+ * @return HB_MC_INVALID if any tile is outside the mesh or already free.
+ *         HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_mesh_occupancy_release(hb_mc_mesh_occupancy_t *occ,
+                                 hb_mc_coordinate_t origin, hb_mc_dimension_t dim)
+{
+        if (!occ || !occupancy_rect_in_mesh(occ, origin, dim))
+                return HB_MC_INVALID;
+
+        for (hb_mc_idx_t x = origin.x; x < origin.x + dim.x; x++) {
+                const uint64_t *col = occupancy_column(occ, x);
+                for (uint32_t w = 0; w < occ->words; w++)
+                        if (col[w] & occupancy_rows_mask(w, origin.y, dim.y))
+                                return HB_MC_INVALID;
+        }
+
+        for (hb_mc_idx_t x = origin.x; x < origin.x + dim.x; x++) {
+                uint64_t *col = occupancy_column(occ, x);
+                for (uint32_t w = 0; w < occ->words; w++)
+                        col[w] |= occupancy_rows_mask(w, origin.y, dim.y);
+        }
+
+        occ->num_free += dim.x * dim.y;
+        return HB_MC_SUCCESS;
+}
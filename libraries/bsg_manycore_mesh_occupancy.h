@@ -0,0 +1,145 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BSG_MANYCORE_MESH_OCCUPANCY_H
+#define BSG_MANYCORE_MESH_OCCUPANCY_H
+
+#include <bsg_manycore_features.h>
+#include <bsg_manycore_coordinate.h>
+#include <bsg_manycore_errno.h>
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+        /**
+         * An index of the free tiles in a mesh.
+         *
+         * Each column of the mesh is a bitmap with one bit per row,
+         * set when that tile is free. A free rectangle is found by
+         * combining whole words of these bitmaps, instead of testing
+         * each tile of each candidate rectangle.
+         *
+         * All coordinates are relative to the origin of the mesh.
+         */
+        typedef struct {
+                hb_mc_dimension_t dim;      //!< Dimension of the mesh
+                uint32_t          words;    //!< Bitmap words per column
+                uint32_t          num_free; //!< Number of free tiles
+                uint64_t         *free;     //!< dim.x columns of #words words
+                uint64_t         *scratch;  //!< Working space for searches
+        } hb_mc_mesh_occupancy_t;
+
+        /**
+         * Initialize an occupancy index with all tiles free.
+         * @param[in] occ  An occupancy index.
+         * @param[in] dim  The dimension of the mesh.
+         * @return HB_MC_SUCCESS if succesful. Otherwise an error code is returned.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_mesh_occupancy_init(hb_mc_mesh_occupancy_t *occ, hb_mc_dimension_t dim);
+
+        /**
+         * Cleanup an occupancy index.
+         * @param[in] occ  An occupancy index initialized with hb_mc_mesh_occupancy_init().
+         */
+        void hb_mc_mesh_occupancy_exit(hb_mc_mesh_occupancy_t *occ);
+
+        /**
+         * Find a free rectangle of tiles.
+         * Origins are tried in the same order as foreach_coordinate():
+         * lowest x first, then lowest y.
+         * @param[in]  occ     An occupancy index.
+         * @param[in]  dim     The dimension of the rectangle.
+         * @param[out] origin  The origin of a free rectangle of #dim tiles.
+         * @return HB_MC_NOTFOUND if no such rectangle is free. HB_MC_INVALID if
+         *         #dim is empty or larger than the mesh. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_mesh_occupancy_find(hb_mc_mesh_occupancy_t *occ, hb_mc_dimension_t dim,
+                                      hb_mc_coordinate_t *origin);
+
+        /**
+         * Find the free rectangle of tiles that fits most tightly.
+         * Of all free origins, picks the one whose rectangle borders the
+         * most busy tiles and mesh edges, so that large free areas stay
+         * whole. Ties go to the origin hb_mc_mesh_occupancy_find() would try first.
+         * @param[in]  occ     An occupancy index.
+         * @param[in]  dim     The dimension of the rectangle.
+         * @param[out] origin  The origin of a free rectangle of #dim tiles.
+         * @return HB_MC_NOTFOUND if no such rectangle is free. HB_MC_INVALID if
+         *         #dim is empty or larger than the mesh. HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_mesh_occupancy_find_best_fit(hb_mc_mesh_occupancy_t *occ, hb_mc_dimension_t dim,
+                                               hb_mc_coordinate_t *origin);
+
+        /**
+         * Check if a rectangle of tiles is free.
+         * @param[in]  occ     An occupancy index.
+         * @param[in]  origin  The origin of the rectangle.
+         * @param[in]  dim     The dimension of the rectangle.
+         * @return Non-zero if every tile in the rectangle is free and the
+         *         rectangle is inside the mesh.
+         */
+        int hb_mc_mesh_occupancy_is_free(const hb_mc_mesh_occupancy_t *occ,
+                                         hb_mc_coordinate_t origin, hb_mc_dimension_t dim);
+
+        /**
+         * Mark a free rectangle of tiles as busy.
+         * @param[in]  occ     An occupancy index.
+         * @param[in]  origin  The origin of the rectangle.
+         * @param[in]  dim     The dimension of the rectangle.
+         * @return HB_MC_INVALID if any tile is outside the mesh or already busy.
+         *         HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_mesh_occupancy_allocate(hb_mc_mesh_occupancy_t *occ,
+                                          hb_mc_coordinate_t origin, hb_mc_dimension_t dim);
+
+        /**
+         * Mark a busy rectangle of tiles as free.
+         * @param[in]  occ     An occupancy index.
+         * @param[in]  origin  The origin of the rectangle.
+         * @param[in]  dim     The dimension of the rectangle.
+         * @return HB_MC_INVALID if any tile is outside the mesh or already free.
+         *         HB_MC_SUCCESS otherwise.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_mesh_occupancy_release(hb_mc_mesh_occupancy_t *occ,
+                                         hb_mc_coordinate_t origin, hb_mc_dimension_t dim);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
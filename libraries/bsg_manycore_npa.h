@@ -58,6 +58,15 @@ extern "C" {
                 hb_mc_epa_t epa;
         } hb_mc_npa_t;
 
+        /**
+         * A contiguous range of Network Physical Addresses.
+         * Bulk transfers over an EVA range are described as a list of these.
+         */
+        typedef struct {
+                hb_mc_npa_t npa; //!< the first NPA of the range
+                size_t      sz;  //!< the size of the range in bytes
+        } hb_mc_npa_extent_t;
+
         /**
          * Get the X coordinate from #npa.
          * @param[in] npa   A Network Physical Address. Behavior is undefined if #npa is NULL.
@@ -0,0 +1,101 @@
+// Copyright (c) 2021, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Generic implementations of the optional parts of the platform
+// interface. They are weak so that a platform's bsg_manycore_platform.cpp
+// can override them with a faster, platform-specific version.
+
+#include <bsg_manycore_platform.h>
+#include <bsg_manycore_printing.h>
+
+/**
+ * Transmit a vector of packets to manycore hardware, one packet at a time
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] packets A vector of packets to transmit to manycore hardware
+ * @param[in] count   The number of packets in #packets
+ * @param[in] type    Is this a vector of request or response packets?
+ * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @return HB_MC_SUCCESS if all packets were sent. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+__attribute__((weak))
+int hb_mc_platform_transmit_batch(hb_mc_manycore_t *mc,
+                                  hb_mc_packet_t *packets,
+                                  size_t count,
+                                  hb_mc_fifo_tx_t type,
+                                  long timeout)
+{
+        int err;
+        for (size_t i = 0; i < count; i++) {
+                err = hb_mc_platform_transmit(mc, &packets[i], type, timeout);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Receive the packets that are waiting in a manycore FIFO, one packet at a time
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[out] packets  A vector of packets into which data should be read
+ * @param[in]  count    The most packets to receive
+ * @param[out] received Set to the number of packets received
+ * @param[in]  type     Receive from the request or response FIFO?
+ * @param[in]  timeout  Set to -1 to wait for the first packet, or to 0 to return HB_MC_BUSY if none is waiting.
+ * @return HB_MC_SUCCESS if at least one packet was received. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+__attribute__((weak))
+int hb_mc_platform_receive_batch(hb_mc_manycore_t *mc,
+                                 hb_mc_packet_t *packets,
+                                 size_t count,
+                                 size_t *received,
+                                 hb_mc_fifo_rx_t type,
+                                 long timeout)
+{
+        *received = 0;
+        if (count == 0)
+                return HB_MC_SUCCESS;
+
+        int err = hb_mc_platform_receive(mc, &packets[0], type, timeout);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        // take the rest only while they are already waiting; platforms
+        // that cannot poll hand them over one at a time
+        size_t n = 1;
+        for (; n < count; n++) {
+                err = hb_mc_platform_receive(mc, &packets[n], type, 0);
+                if (err == HB_MC_BUSY || err == HB_MC_NOIMPL)
+                        break;
+                if (err != HB_MC_SUCCESS) {
+                        *received = n;
+                        return err;
+                }
+        }
+
+        *received = n;
+        return HB_MC_SUCCESS;
+}
@@ -51,7 +51,9 @@ extern "C" {
          * Receive a packet from manycore hardware
          * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
          * @param[in] response A packet into which data should be read
-         * @param[in] timeout  A timeout counter. Unused - set to -1 to wait forever.
+         * @param[in] timeout  Set to -1 to wait forever, or to 0 to return HB_MC_BUSY
+         *                     if no packet is waiting. Platforms are only required to
+         *                     support 0 for HB_MC_FIFO_RX_REQ.
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */
         int hb_mc_platform_receive(hb_mc_manycore_t *mc,
@@ -59,6 +61,54 @@ extern "C" {
                                    hb_mc_fifo_rx_t type,
                                    long timeout);
 
+        /**
+         * Transmit a vector of packets to manycore hardware
+         *
+         * Platforms that can amortize flow-control checks over
+         * several packets should implement this. A generic version
+         * built on hb_mc_platform_transmit() is used otherwise.
+         *
+         * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in] packets A vector of packets to transmit to manycore hardware
+         * @param[in] count   The number of packets in #packets
+         * @param[in] type    Is this a vector of request or response packets?
+         * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+         * @return HB_MC_SUCCESS if all packets were sent. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        int hb_mc_platform_transmit_batch(hb_mc_manycore_t *mc,
+                                          hb_mc_packet_t *packets,
+                                          size_t count,
+                                          hb_mc_fifo_tx_t type,
+                                          long timeout);
+
+        /**
+         * Receive the packets that are waiting in a manycore FIFO
+         *
+         * Receives up to #count packets, stopping at the first one
+         * that has not yet arrived. With a timeout of -1 this waits
+         * for the first packet; with 0 it returns HB_MC_BUSY if none
+         * is waiting. Platforms that cannot poll a FIFO return
+         * HB_MC_NOIMPL for a timeout of 0, and hand over one packet
+         * at a time otherwise. Platforms that can amortize occupancy
+         * checks over several packets should implement this. A
+         * generic version built on hb_mc_platform_receive() is used
+         * otherwise.
+         *
+         * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+         * @param[out] packets  A vector of packets into which data should be read
+         * @param[in]  count    The most packets to receive
+         * @param[out] received Set to the number of packets received
+         * @param[in]  type     Receive from the request or response FIFO?
+         * @param[in]  timeout  Set to -1 to wait for the first packet, or to 0 to return HB_MC_BUSY if none is waiting.
+         * @return HB_MC_SUCCESS if at least one packet was received. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        int hb_mc_platform_receive_batch(hb_mc_manycore_t *mc,
+                                         hb_mc_packet_t *packets,
+                                         size_t count,
+                                         size_t *received,
+                                         hb_mc_fifo_rx_t type,
+                                         long timeout);
+
         /**
          * Read the configuration register at an index
          * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
@@ -158,6 +208,25 @@ extern "C" {
          * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
          */        
         int hb_mc_platform_wait_reset_done(hb_mc_manycore_t *mc);
+
+        /**
+         * Tell the platform that a program has been loaded onto a list of tiles.
+         *
+         * Hardware and RTL simulations run the program, so they have no
+         * use for this hook and need not define it: the loader provides
+         * a weak definition that does nothing.
+         *
+         * @param[in] mc     A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in] bin    A memory buffer containing the manycore binary that was loaded
+         * @param[in] sz     Size of #bin in bytes
+         * @param[in] tiles  The tiles that #bin was loaded onto
+         * @param[in] ntiles The number of tiles in #tiles
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        int hb_mc_platform_program_loaded(hb_mc_manycore_t *mc,
+                                          const void *bin, size_t sz,
+                                          const hb_mc_coordinate_t *tiles,
+                                          uint32_t ntiles);
 #ifdef __cplusplus
 }
 #endif
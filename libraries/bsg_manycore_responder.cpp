@@ -27,13 +27,113 @@
 
 #include <bsg_manycore_responder.h>
 #include <bsg_manycore_errno.h>
+#include <algorithm>
 #include <list>
+#include <new>
+#include <vector>
 #include <stdint.h>
 
 typedef std::list<hb_mc_responder_t *> responder_list;
 
 static responder_list *responders = nullptr;
 
+/*
+ * The ids of all responders, compiled into tables that are searched by
+ * the masked EPA of a request packet. There is one table per distinct
+ * address mask; the built-in responders all match exact addresses, so
+ * a request is usually dispatched with one bounds check and one binary
+ * search.
+ */
+typedef struct responder_dispatch_entry {
+        hb_mc_epa_t value;                     //!< id address under the table's mask
+        size_t order;                          //!< position of the responder in the list
+        const hb_mc_request_packet_id_t *id;   //!< id to match the source coordinates with
+        hb_mc_responder_t *responder;
+} responder_dispatch_entry;
+
+typedef struct responder_dispatch_table {
+        hb_mc_epa_t mask;                      //!< address mask shared by all entries
+        hb_mc_epa_t lo;                        //!< smallest value of any entry
+        hb_mc_epa_t hi;                        //!< largest value of any entry
+        std::vector<responder_dispatch_entry> entries; //!< sorted by value, then order
+} responder_dispatch_table;
+
+typedef struct responder_dispatch {
+        bool stale;                            //!< responders changed since the last compile
+        bool invalid;                          //!< some responder cannot respond
+        std::vector<responder_dispatch_table> tables;
+} responder_dispatch;
+
+static responder_dispatch *dispatch = nullptr;
+
+static bool responder_dispatch_entry_lt(const responder_dispatch_entry &a,
+                                        const responder_dispatch_entry &b)
+{
+        if (a.value != b.value)
+                return a.value < b.value;
+        return a.order < b.order;
+}
+
+/* rebuild the dispatch tables from the responder list */
+static int hb_mc_responders_compile(void)
+{
+        if (dispatch == nullptr) {
+                dispatch = new (std::nothrow) responder_dispatch;
+                if (dispatch == nullptr)
+                        return HB_MC_NOMEM;
+        }
+
+        dispatch->invalid = false;
+        dispatch->tables.clear();
+
+        size_t order = 0;
+        for (auto it = responders->begin();
+             it != responders->end();
+             it++, order++) {
+                hb_mc_responder_t *responder = *it;
+
+                if (responder->respond == nullptr)
+                        dispatch->invalid = true; // no respond
+
+                if (responder->ids == nullptr)
+                        continue; // no ids
+
+                for (const hb_mc_request_packet_id_t *id = responder->ids;
+                     id->init != 0;
+                     id++) {
+                        hb_mc_epa_t mask = id->id_addr.a_mask;
+                        auto table = std::find_if(dispatch->tables.begin(),
+                                                  dispatch->tables.end(),
+                                                  [=](const responder_dispatch_table &t) {
+                                                          return t.mask == mask;
+                                                  });
+                        if (table == dispatch->tables.end()) {
+                                dispatch->tables.push_back(responder_dispatch_table());
+                                table = dispatch->tables.end() - 1;
+                                table->mask = mask;
+                        }
+
+                        table->entries.push_back({id->id_addr.a_value, order, id, responder});
+                }
+        }
+
+        for (auto &table : dispatch->tables) {
+                std::sort(table.entries.begin(), table.entries.end(),
+                          responder_dispatch_entry_lt);
+                table.lo = table.entries.front().value;
+                table.hi = table.entries.back().value;
+        }
+
+        dispatch->stale = false;
+        return HB_MC_SUCCESS;
+}
+
+static void hb_mc_responders_mark_stale(void)
+{
+        if (dispatch != nullptr)
+                dispatch->stale = true;
+}
+
 int hb_mc_responder_init(hb_mc_responder_t *responder, hb_mc_manycore_t *mc)
 {
         int err;
@@ -52,6 +152,10 @@ int hb_mc_responders_init(hb_mc_manycore_t *mc)
         if (responders == nullptr)
                 return HB_MC_SUCCESS; //  no responders
 
+        int err = hb_mc_responders_compile();
+        if (err != HB_MC_SUCCESS)
+                return err;
+
         for (auto it = responders->begin();
              it != responders->end();
              it++) {
@@ -96,23 +200,42 @@ int hb_mc_responders_quit(hb_mc_manycore_t *mc)
         return HB_MC_SUCCESS;
 }
 
-static int hb_mc_responder_respond(hb_mc_responder_t *responder,
-                                   hb_mc_manycore_t *mc,
-                                   const hb_mc_request_packet_t *rqst)
+/*
+ * Collect the responders in #table matching #rqst, in list order,
+ * and let each respond once.
+ */
+static int hb_mc_responders_respond_table(const responder_dispatch_table &table,
+                                          hb_mc_manycore_t *mc,
+                                          const hb_mc_request_packet_t *rqst,
+                                          std::vector<responder_dispatch_entry> *matches)
 {
-        int err;
+        hb_mc_epa_t value = hb_mc_request_packet_get_epa(rqst) & table.mask;
 
-        if (responder->respond == nullptr)
-                return HB_MC_INVALID; // no respond
+        // fast path: no responder in this table is interested
+        if (value < table.lo || value > table.hi)
+                return HB_MC_SUCCESS;
+
+        responder_dispatch_entry key = {value, 0, nullptr, nullptr};
+        auto it = std::lower_bound(table.entries.begin(), table.entries.end(),
+                                   key, responder_dispatch_entry_lt);
+
+        hb_mc_responder_t *last = nullptr;
+        for (; it != table.entries.end() && it->value == value; it++) {
+                if (it->responder == last)
+                        continue; // already matched
+
+                if (hb_mc_request_packet_is_match(rqst, it->id) != 1)
+                        continue;
 
-        if (responder->ids == nullptr)
-                return HB_MC_SUCCESS; // no ids
+                last = it->responder;
+                if (matches != nullptr) {
+                        matches->push_back(*it);
+                        continue;
+                }
 
-        for (hb_mc_request_packet_id_t *id = responder->ids;
-             id->init != 0;
-             id++) {
-                if (hb_mc_request_packet_is_match(rqst, id) == 1)
-                        return responder->respond(responder, mc, rqst);
+                int err = it->responder->respond(it->responder, mc, rqst);
+                if (err != HB_MC_SUCCESS)
+                        return err;
         }
 
         return HB_MC_SUCCESS;
@@ -125,14 +248,49 @@ int hb_mc_responders_respond(hb_mc_manycore_t *mc, const hb_mc_request_packet_t
         if (responders == nullptr)
                 return HB_MC_SUCCESS; // no responders
 
-        for (auto it = responders->begin();
-             it != responders->end();
-             it++) {
-                auto responder = *it;
-                err = hb_mc_responder_respond(responder, mc, rqst);
+        if (dispatch == nullptr || dispatch->stale) {
+                err = hb_mc_responders_compile();
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+
+        if (dispatch->invalid)
+                return HB_MC_INVALID; // no respond
+
+        if (dispatch->tables.size() <= 1) {
+                for (auto &table : dispatch->tables) {
+                        err = hb_mc_responders_respond_table(table, mc, rqst, nullptr);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+                }
+                return HB_MC_SUCCESS;
+        }
+
+        // responders may match under more than one mask:
+        // merge the matches so each responds once, in list order
+        std::vector<responder_dispatch_entry> matches;
+        for (auto &table : dispatch->tables) {
+                err = hb_mc_responders_respond_table(table, mc, rqst, &matches);
                 if (err != HB_MC_SUCCESS)
                         return err;
         }
+
+        std::sort(matches.begin(), matches.end(),
+                  [](const responder_dispatch_entry &a, const responder_dispatch_entry &b) {
+                          return a.order < b.order;
+                  });
+
+        hb_mc_responder_t *last = nullptr;
+        for (auto &match : matches) {
+                if (match.responder == last)
+                        continue;
+
+                last = match.responder;
+                err = match.responder->respond(match.responder, mc, rqst);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+        }
+
         return HB_MC_SUCCESS;
 }
 
@@ -143,6 +301,7 @@ int hb_mc_responder_add(hb_mc_responder_t *responder)
                 responders = new responder_list;
 
         responders->push_front(responder);
+        hb_mc_responders_mark_stale();
         return HB_MC_SUCCESS;
 }
 
@@ -152,5 +311,6 @@ int hb_mc_responder_del(hb_mc_responder_t *responder)
                 return HB_MC_FAIL;
 
         responders->remove(responder);
+        hb_mc_responders_mark_stale();
         return HB_MC_SUCCESS;
 }
@@ -32,6 +32,7 @@ LIB_CSOURCES   +=
 LIB_CSOURCES   += $(LIBRARIES_PATH)/bsg_manycore_config_id_to_string.c
 LIB_CSOURCES   += $(LIBRARIES_PATH)/bsg_manycore_memsys.c
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore.cpp
+LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_api_trace.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_epa.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_bits.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_config.cpp
@@ -39,8 +40,11 @@ LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_cuda.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_elf.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_eva.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_loader.cpp
+LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_memory_allocator.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_memory_manager.cpp
+LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_mesh_occupancy.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_origin_eva_map.cpp
+LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_platform.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_print_int_responder.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_printing.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_request_packet_id.cpp
@@ -51,13 +55,16 @@ LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_trace_responder.cpp
 LIB_CXXSOURCES += $(LIBRARIES_PATH)/bsg_manycore_vcache.cpp
 
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore.h
+LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_api_trace.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_bits.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_config.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_cuda.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_elf.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_eva.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_loader.h
+LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_memory_allocator.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_memory_manager.h
+LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_mesh_occupancy.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_origin_eva_map.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_printing.h
 LIB_HEADERS += $(LIBRARIES_PATH)/bsg_manycore_request_packet_id.h
@@ -110,6 +117,9 @@ $(BSG_PLATFORM_PATH)/libbsg_manycore_runtime.so.1.0: INCLUDES :=
 
 include $(BSG_PLATFORM_PATH)/library.mk
 
+# Pod threads (see hb_mc_device_enable_pod_threads) use std::thread
+$(BSG_PLATFORM_PATH)/libbsg_manycore_runtime.so.1.0: LDFLAGS += -lpthread
+
 $(LIB_OBJECTS) $(LIB_OBJECTS_CUDA_POD_REPL) $(LIB_OBJECTS_REGRESSION): INCLUDES := -I$(LIBRARIES_PATH)
 $(LIB_OBJECTS) $(LIB_OBJECTS_CUDA_POD_REPL) $(LIB_OBJECTS_REGRESSION): INCLUDES += -I$(LIBRARIES_PATH)/xcl
 $(LIB_OBJECTS) $(LIB_OBJECTS_CUDA_POD_REPL) $(LIB_OBJECTS_REGRESSION): INCLUDES += -I$(LIBRARIES_PATH)/features/dma
@@ -253,7 +253,9 @@ int hb_mc_platform_transmit(hb_mc_manycore_t *mc,
  * Receive a packet from manycore hardware
  * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] response A packet into which data should be read
- * @param[in] timeout  A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout  Set to -1 to wait forever. Requests may also be polled with 0,
+ *                     which returns HB_MC_BUSY if no request packet is waiting.
+ *                     Polling responses returns HB_MC_NOIMPL.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_platform_receive(hb_mc_manycore_t *mc,
@@ -267,9 +269,14 @@ int hb_mc_platform_receive(hb_mc_manycore_t *mc,
         uint32_t occupancy;
         int err;
 
-        if (timeout != -1) {
-                platform_pr_err(pl, "%s: Only a timeout value of -1 is supported\n",
-                                __func__);
+        // RX RSP occupancy is not readable, so only requests can be polled;
+        // callers that try to poll responses fall back to waiting for them
+        if (timeout == 0 && type == HB_MC_FIFO_RX_RSP)
+                return HB_MC_NOIMPL;
+
+        if (timeout != -1 && timeout != 0) {
+                platform_pr_err(pl, "%s: Only a timeout value of -1 is supported for %s\n",
+                                __func__, typestr);
                 return HB_MC_INVALID;
         }
 
@@ -285,6 +292,9 @@ int hb_mc_platform_receive(hb_mc_manycore_t *mc,
                                 return err;
                         }
 
+                        if (occupancy < 1 && timeout == 0)
+                                return HB_MC_BUSY;
+
                 } while (occupancy < 1);  // this is packet occupancy, not word occupancy!
         }
 
@@ -300,6 +310,138 @@ int hb_mc_platform_receive(hb_mc_manycore_t *mc,
         return HB_MC_SUCCESS;
 }
 
+/**
+ * Transmit a vector of packets to manycore hardware
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] packets A vector of packets to transmit to manycore hardware
+ * @param[in] count   The number of packets in #packets
+ * @param[in] type    Is this a vector of request or response packets?
+ * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @return HB_MC_SUCCESS if all packets were sent. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_transmit_batch(hb_mc_manycore_t *mc,
+                                  hb_mc_packet_t *packets,
+                                  size_t count,
+                                  hb_mc_fifo_tx_t type,
+                                  long timeout)
+{
+        hb_mc_platform_t *pl = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        uintptr_t data_addr;
+        int err;
+
+        if (timeout != -1) {
+                platform_pr_err(pl, "%s: Only a timeout value of -1 is supported\n",
+                                __func__);
+                return HB_MC_INVALID;
+        }
+
+        data_addr = hb_mc_mmio_fifo_get_addr(type, HB_MC_MMIO_FIFO_TX_DATA_OFFSET);
+
+        size_t sent = 0;
+        while (sent < count) {
+                // only go back to the vacancy register once the
+                // software copy has been used up
+                while (pl->transmit_vacancy == 0) {
+                        err = hb_mc_platform_get_transmit_vacancy(mc, HB_MC_FIFO_TX_REQ, &pl->transmit_vacancy);
+                        if (err != HB_MC_SUCCESS)
+                                return err;
+                }
+
+                size_t burst = static_cast<size_t>(pl->transmit_vacancy);
+                if (burst > count - sent)
+                        burst = count - sent;
+
+                for (size_t p = sent; p < sent + burst; p++) {
+                        for (unsigned i = 0; i < array_size(packets[p].words); i++) {
+                                err = hb_mc_mmio_write32(pl->mmio, data_addr, packets[p].words[i]);
+                                if (err != HB_MC_SUCCESS)
+                                        return err;
+                        }
+                        pl->transmit_vacancy--;
+                }
+
+                sent += burst;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Receive the packets that are waiting in a manycore FIFO
+ * @param[in]  mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[out] packets  A vector of packets into which data should be read
+ * @param[in]  count    The most packets to receive
+ * @param[out] received Set to the number of packets received
+ * @param[in]  type     Receive from the request or response FIFO?
+ * @param[in]  timeout  Set to -1 to wait for the first packet. Requests may also be polled with 0,
+ *                      which returns HB_MC_BUSY if no request packet is waiting.
+ *                      Polling responses returns HB_MC_NOIMPL.
+ * @return HB_MC_SUCCESS if at least one packet was received. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_receive_batch(hb_mc_manycore_t *mc,
+                                 hb_mc_packet_t *packets,
+                                 size_t count,
+                                 size_t *received,
+                                 hb_mc_fifo_rx_t type,
+                                 long timeout)
+{
+        hb_mc_platform_t *pl = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        const char *typestr = hb_mc_fifo_rx_to_string(type);
+        uintptr_t data_addr;
+        uint32_t occupancy;
+        int err;
+
+        *received = 0;
+        if (count == 0)
+                return HB_MC_SUCCESS;
+
+        // the response FIFO has no occupancy register, so there is no
+        // telling how many responses are waiting: hand over one
+        if (type == HB_MC_FIFO_RX_RSP) {
+                err = hb_mc_platform_receive(mc, &packets[0], type, timeout);
+                if (err == HB_MC_SUCCESS)
+                        *received = 1;
+                return err;
+        }
+
+        if (timeout != -1 && timeout != 0) {
+                platform_pr_err(pl, "%s: Only a timeout value of -1 or 0 is supported for %s\n",
+                                __func__, typestr);
+                return HB_MC_INVALID;
+        }
+
+        data_addr = hb_mc_mmio_fifo_get_addr(type, HB_MC_MMIO_FIFO_RX_DATA_OFFSET);
+
+        // one occupancy read covers every packet already waiting
+        do {
+                err = hb_mc_platform_rx_fifo_get_occupancy(pl, type, &occupancy);
+                if (err != HB_MC_SUCCESS) {
+                        platform_pr_err(pl, "%s: Failed to get %s FIFO occupancy while waiting for packet: %s\n",
+                                        __func__, typestr, hb_mc_strerror(err));
+                        return err;
+                }
+
+                if (occupancy < 1 && timeout == 0)
+                        return HB_MC_BUSY;
+
+        } while (occupancy < 1);
+
+        size_t burst = count < occupancy ? count : occupancy;
+        for (size_t p = 0; p < burst; p++) {
+                for (unsigned i = 0; i < array_size(packets[p].words); i++) {
+                        err = hb_mc_mmio_read32(pl->mmio, data_addr, &packets[p].words[i]);
+                        if (err != HB_MC_SUCCESS) {
+                                platform_pr_err(pl, "%s: Failed read data from %s FIFO: %s\n",
+                                                __func__, typestr, hb_mc_strerror(err));
+                                return err;
+                        }
+                }
+                *received = p + 1;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
 /**
  * Read the configuration register at an index
  * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
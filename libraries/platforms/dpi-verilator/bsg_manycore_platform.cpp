@@ -317,7 +317,7 @@ int hb_mc_platform_transmit(hb_mc_manycore_t *mc,
  * Receive a packet from manycore hardware
  * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
  * @param[in] response A packet into which data should be read
- * @param[in] timeout  A timeout counter. Unused - set to -1 to wait forever.
+ * @param[in] timeout  Set to -1 to wait forever, or to 0 to return HB_MC_BUSY if no packet is waiting.
  * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
  */
 int hb_mc_platform_receive(hb_mc_manycore_t *mc,
@@ -331,8 +331,8 @@ int hb_mc_platform_receive(hb_mc_manycore_t *mc,
         SimulationWrapper *top = platform->top;
         __m128i *pkt = reinterpret_cast<__m128i*>(packet);
 
-        if (timeout != -1) {
-                manycore_pr_err(mc, "%s: Only a timeout value of -1 is supported\n",
+        if (timeout != -1 && timeout != 0) {
+                manycore_pr_err(mc, "%s: Only a timeout value of -1 or 0 is supported\n",
                                 __func__);
                 return HB_MC_INVALID;
         }
@@ -352,6 +352,10 @@ int hb_mc_platform_receive(hb_mc_manycore_t *mc,
                         return HB_MC_NOIMPL;
                 }
 
+                // A poll tries once, giving the simulation one evaluation to produce a packet
+                if (timeout == 0 && err == BSG_NONSYNTH_DPI_NOT_VALID)
+                        return HB_MC_BUSY;
+
         } while (err != BSG_NONSYNTH_DPI_SUCCESS &&
                  (err == BSG_NONSYNTH_DPI_NOT_WINDOW ||
                   err == BSG_NONSYNTH_DPI_BUSY ||
@@ -0,0 +1,983 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// The software-model platform is a purely functional model of a
+// HammerBlade manycore. It is meant for developing and benchmarking
+// the host runtime without a simulator or an FPGA:
+//
+// - The configuration ROM is read from the machine's
+//   bsg_bladerunner_configuration.rom, so the model has the same
+//   geometry and memory system as the machine it was built for.
+//
+// - Every tile and every victim cache has its own sparse,
+//   zero-initialized address space indexed by EPA. Tile DMEM,
+//   instruction cache, and CSRs live there, as do the DRAM data,
+//   tags, and write-hint registers of each cache. DRAM is never
+//   cached, so cache operations are accepted and have no effect.
+//
+// - Requests are executed synchronously, in order, when they are
+//   transmitted. Responses are queued immediately, so the network
+//   never runs out of credits and fences always complete. They are
+//   received newest first: on hardware, loads to different
+//   destinations return out of order, and the host must match each
+//   response to its load by load id. The first poll for responses
+//   after more are queued finds none, as if they were still in
+//   flight, so host threads that poll interleave as on hardware.
+//
+// - Tiles do NOT execute RISC-V code. The loader tells the model
+//   where a CUDA-lite program keeps its runtime symbols, and a kernel
+//   launched by writing a tile's cuda_kernel_ptr returns at once:
+//   the tile clears its kernel pointer and the tile group's origin
+//   stores the finish signal to the host, as the device runtime
+//   does. Fail and print packets, or finish packets for programs
+//   that are not CUDA-lite, can be sent to the host with
+//   hb_mc_software_model_send_request().
+
+#include <bsg_manycore_platform.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_config.h>
+#include <bsg_manycore_config_pod.h>
+#include <bsg_manycore_packet.h>
+#include <bsg_manycore_printing.h>
+#include <bsg_manycore_vcache.h>
+#include <bsg_manycore_tile.h>
+#include <bsg_manycore_dma.h>
+#include <bsg_manycore_eva.h>
+#include <bsg_manycore_loader.h>
+#include <bsg_manycore_origin_eva_map.h>
+#include <bsg_manycore_software_model.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+/* these are convenience macros that are only good for one line prints */
+#define manycore_pr_dbg(mc, fmt, ...)                   \
+        bsg_pr_dbg("%s: " fmt, mc->name, ##__VA_ARGS__)
+
+#define manycore_pr_err(mc, fmt, ...)                   \
+        bsg_pr_err("%s: " fmt, mc->name, ##__VA_ARGS__)
+
+#define manycore_pr_warn(mc, fmt, ...)                          \
+        bsg_pr_warn("%s: " fmt, mc->name, ##__VA_ARGS__)
+
+#define manycore_pr_info(mc, fmt, ...)                          \
+        bsg_pr_info("%s: " fmt, mc->name, ##__VA_ARGS__)
+
+// Path to the configuration ROM of the machine this platform is
+// modelling. This is set by library.mk.
+#ifndef HB_MC_SOFTWARE_MODEL_ROM
+#error "HB_MC_SOFTWARE_MODEL_ROM must be defined as the path to bsg_bladerunner_configuration.rom"
+#endif
+
+// A global EVA names a network coordinate and an EPA below
+// 2^HB_MC_GLOBAL_EPA_LOGSZ: {1'b0, 1'b1, y[6:0], x[6:0], epa}
+#define HB_MC_SWMODEL_GLOBAL_COORD_LOGSZ 7
+#define HB_MC_SWMODEL_GLOBAL_COORD_MASK  ((1 << HB_MC_SWMODEL_GLOBAL_COORD_LOGSZ) - 1)
+#define HB_MC_SWMODEL_GLOBAL_X_BITIDX    HB_MC_GLOBAL_EPA_LOGSZ
+#define HB_MC_SWMODEL_GLOBAL_Y_BITIDX    (HB_MC_SWMODEL_GLOBAL_X_BITIDX + HB_MC_SWMODEL_GLOBAL_COORD_LOGSZ)
+#define HB_MC_SWMODEL_GLOBAL_BITIDX      (HB_MC_SWMODEL_GLOBAL_Y_BITIDX + HB_MC_SWMODEL_GLOBAL_COORD_LOGSZ)
+
+// Endpoint memory is allocated in pages on first touch.
+#define HB_MC_SWMODEL_PAGE_LOGSZ 12
+#define HB_MC_SWMODEL_PAGE_SIZE  (1 << HB_MC_SWMODEL_PAGE_LOGSZ)
+#define HB_MC_SWMODEL_PAGE_MASK  (HB_MC_SWMODEL_PAGE_SIZE - 1)
+
+typedef enum __hb_mc_swmodel_endpoint_type_t {
+        HB_MC_SWMODEL_ENDPOINT_TILE,
+        HB_MC_SWMODEL_ENDPOINT_VCACHE,
+} hb_mc_swmodel_endpoint_type_t;
+
+// The CUDA-lite runtime symbols that the model uses to run a kernel
+typedef enum __hb_mc_swmodel_cuda_symbol_t {
+        HB_MC_SWMODEL_CUDA_KERNEL_PTR = 0,
+        HB_MC_SWMODEL_CUDA_KERNEL_NOT_LOADED_VAL,
+        HB_MC_SWMODEL_CUDA_FINISH_SIGNAL_ADDR,
+        HB_MC_SWMODEL_CUDA_FINISH_SIGNAL_VAL,
+        HB_MC_SWMODEL_CUDA_X,
+        HB_MC_SWMODEL_CUDA_Y,
+        HB_MC_SWMODEL_CUDA_SYMBOLS,
+} hb_mc_swmodel_cuda_symbol_t;
+
+static const char *hb_mc_swmodel_cuda_symbol_names[HB_MC_SWMODEL_CUDA_SYMBOLS] = {
+        "cuda_kernel_ptr",
+        "cuda_kernel_not_loaded_val",
+        "cuda_finish_signal_addr",
+        "cuda_finish_signal_val",
+        "__bsg_x",
+        "__bsg_y",
+};
+
+typedef struct hb_mc_swmodel_endpoint_t {
+        hb_mc_swmodel_endpoint_type_t type;
+        std::unordered_map<hb_mc_epa_t, std::vector<uint8_t> > pages;
+        // set if the tile was loaded with a CUDA-lite program
+        bool cuda;
+        // DMEM EPAs of the program's runtime symbols
+        hb_mc_epa_t cuda_epa[HB_MC_SWMODEL_CUDA_SYMBOLS];
+} hb_mc_swmodel_endpoint_t;
+
+typedef struct hb_mc_platform_t {
+        hb_mc_manycore_id_t id;
+        hb_mc_config_raw_t rom[HB_MC_CONFIG_MAX];
+        hb_mc_config_t cfg;
+        // keyed by hb_mc_swmodel_endpoint_key()
+        std::unordered_map<uint32_t, hb_mc_swmodel_endpoint_t> endpoints;
+        std::deque<hb_mc_packet_t> rx_req;
+        std::deque<hb_mc_packet_t> rx_rsp;
+        // set when responses are queued, until the host next polls or waits for one
+        bool rsp_in_flight;
+        uint64_t cycle;
+} hb_mc_platform_t;
+
+// These track active manycore machine IDs
+static std::set<hb_mc_manycore_id_t> active_ids;
+
+static inline uint32_t hb_mc_swmodel_endpoint_key(hb_mc_idx_t x, hb_mc_idx_t y)
+{
+        return (static_cast<uint32_t>(x) << 16) | (static_cast<uint32_t>(y) & 0xFFFF);
+}
+
+/**
+ * Find the endpoint at a network coordinate
+ * @return A pointer to the endpoint, or nullptr if nothing responds at (x, y)
+ */
+static hb_mc_swmodel_endpoint_t *
+hb_mc_swmodel_endpoint(hb_mc_platform_t *platform, hb_mc_idx_t x, hb_mc_idx_t y)
+{
+        auto it = platform->endpoints.find(hb_mc_swmodel_endpoint_key(x, y));
+        if (it == platform->endpoints.end())
+                return nullptr;
+        return &it->second;
+}
+
+/**
+ * Copy data into an endpoint's address space
+ */
+static void hb_mc_swmodel_write(hb_mc_swmodel_endpoint_t *ep, hb_mc_epa_t epa,
+                                const void *data, size_t sz)
+{
+        const uint8_t *src = reinterpret_cast<const uint8_t *>(data);
+        while (sz > 0) {
+                std::vector<uint8_t> &page = ep->pages[epa >> HB_MC_SWMODEL_PAGE_LOGSZ];
+                if (page.empty())
+                        page.resize(HB_MC_SWMODEL_PAGE_SIZE, 0);
+
+                size_t off = epa & HB_MC_SWMODEL_PAGE_MASK;
+                size_t n = std::min(sz, HB_MC_SWMODEL_PAGE_SIZE - off);
+                memcpy(&page[off], src, n);
+
+                src += n;
+                epa += n;
+                sz  -= n;
+        }
+}
+
+/**
+ * Copy data out of an endpoint's address space. Untouched memory reads as zero.
+ */
+static void hb_mc_swmodel_read(hb_mc_swmodel_endpoint_t *ep, hb_mc_epa_t epa,
+                               void *data, size_t sz)
+{
+        uint8_t *dst = reinterpret_cast<uint8_t *>(data);
+        while (sz > 0) {
+                size_t off = epa & HB_MC_SWMODEL_PAGE_MASK;
+                size_t n = std::min(sz, HB_MC_SWMODEL_PAGE_SIZE - off);
+
+                auto it = ep->pages.find(epa >> HB_MC_SWMODEL_PAGE_LOGSZ);
+                if (it == ep->pages.end())
+                        memset(dst, 0, n);
+                else
+                        memcpy(dst, &it->second[off], n);
+
+                dst += n;
+                epa += n;
+                sz  -= n;
+        }
+}
+
+static uint32_t hb_mc_swmodel_read32(hb_mc_swmodel_endpoint_t *ep, hb_mc_epa_t epa)
+{
+        uint32_t v;
+        hb_mc_swmodel_read(ep, epa, &v, sizeof(v));
+        return v;
+}
+
+static void hb_mc_swmodel_write32(hb_mc_swmodel_endpoint_t *ep, hb_mc_epa_t epa, uint32_t v)
+{
+        hb_mc_swmodel_write(ep, epa, &v, sizeof(v));
+}
+
+/**
+ * Read the configuration ROM of the modelled machine
+ * @param[in]  mc   A manycore instance
+ * @param[out] rom  The raw configuration values
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_swmodel_rom_read(hb_mc_manycore_t *mc, hb_mc_config_raw_t rom[HB_MC_CONFIG_MAX])
+{
+        FILE *f = fopen(HB_MC_SOFTWARE_MODEL_ROM, "r");
+        if (f == NULL) {
+                manycore_pr_err(mc, "%s: Failed to open configuration ROM '%s'\n",
+                                __func__, HB_MC_SOFTWARE_MODEL_ROM);
+                return HB_MC_FAIL;
+        }
+
+        // Each line of the ROM is a 32-character binary string.
+        // Entries past the end of the file (e.g. unused memory system
+        // fields) read as zero, as they do in hardware.
+        char line[64];
+        unsigned int idx = 0;
+        memset(rom, 0, sizeof(hb_mc_config_raw_t) * HB_MC_CONFIG_MAX);
+        while (idx < HB_MC_CONFIG_MAX && fgets(line, sizeof(line), f) != NULL) {
+                if (line[0] == '\n' || line[0] == '\0')
+                        continue;
+
+                char *end;
+                rom[idx] = static_cast<hb_mc_config_raw_t>(strtoul(line, &end, 2));
+                if (end == line || (*end != '\n' && *end != '\r' && *end != '\0')) {
+                        manycore_pr_err(mc, "%s: Malformed entry %u in configuration ROM '%s'\n",
+                                        __func__, idx, HB_MC_SOFTWARE_MODEL_ROM);
+                        fclose(f);
+                        return HB_MC_FAIL;
+                }
+                idx++;
+        }
+
+        fclose(f);
+
+        if (idx <= HB_MC_CONFIG_MEMSYS) {
+                manycore_pr_err(mc, "%s: Configuration ROM '%s' is truncated (%u entries)\n",
+                                __func__, HB_MC_SOFTWARE_MODEL_ROM, idx);
+                return HB_MC_FAIL;
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Create an endpoint for every tile and cache in the machine, and
+ * put each tile in its reset state.
+ */
+static void hb_mc_swmodel_endpoints_init(hb_mc_platform_t *platform)
+{
+        const hb_mc_config_t *cfg = &platform->cfg;
+        hb_mc_coordinate_t pod, co;
+
+        hb_mc_config_foreach_pod(pod, cfg) {
+                hb_mc_config_pod_foreach_vcore(co, pod, cfg) {
+                        hb_mc_swmodel_endpoint_t &ep =
+                                platform->endpoints[hb_mc_swmodel_endpoint_key(co.x, co.y)];
+                        ep.type = HB_MC_SWMODEL_ENDPOINT_TILE;
+                        ep.cuda = false;
+                        // tiles come out of reset frozen
+                        hb_mc_swmodel_write32(&ep, HB_MC_TILE_EPA_CSR_FREEZE, HB_MC_CSR_FREEZE);
+                }
+
+                hb_mc_config_pod_foreach_dram(co, pod, cfg) {
+                        hb_mc_swmodel_endpoint_t &ep =
+                                platform->endpoints[hb_mc_swmodel_endpoint_key(co.x, co.y)];
+                        ep.type = HB_MC_SWMODEL_ENDPOINT_VCACHE;
+                        ep.cuda = false;
+                }
+        }
+}
+
+static int hb_mc_swmodel_execute(hb_mc_manycore_t *mc, const hb_mc_request_packet_t *rqst);
+
+/**
+ * Run the kernel that a store to a tile's cuda_kernel_ptr launched.
+ *
+ * Tiles do not execute code, so the kernel returns at once. The tile
+ * clears its kernel pointer, and if it is the origin of its tile group
+ * it stores the finish signal value to the finish signal address, which
+ * is an EVA in the tile group's address space. The host writes the
+ * origin's kernel pointer first, so the finish packet is queued behind
+ * the launch of the rest of the group.
+ * @param[in] mc    A manycore instance
+ * @param[in] ep    The tile that was stored to
+ * @param[in] x     The tile's X coordinate
+ * @param[in] y     The tile's Y coordinate
+ * @param[in] epa   The EPA that was stored to
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_swmodel_cuda_kernel_run(hb_mc_manycore_t *mc, hb_mc_swmodel_endpoint_t *ep,
+                                         hb_mc_idx_t x, hb_mc_idx_t y, hb_mc_epa_t epa)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        const hb_mc_epa_t *sym = ep->cuda_epa;
+        int err;
+
+        if (!ep->cuda || epa != sym[HB_MC_SWMODEL_CUDA_KERNEL_PTR])
+                return HB_MC_SUCCESS;
+
+        // a frozen tile does not look at its kernel pointer
+        if (hb_mc_swmodel_read32(ep, HB_MC_TILE_EPA_CSR_FREEZE) == HB_MC_CSR_FREEZE)
+                return HB_MC_SUCCESS;
+
+        uint32_t not_loaded = hb_mc_swmodel_read32(ep, sym[HB_MC_SWMODEL_CUDA_KERNEL_NOT_LOADED_VAL]);
+        if (hb_mc_swmodel_read32(ep, sym[HB_MC_SWMODEL_CUDA_KERNEL_PTR]) == not_loaded)
+                return HB_MC_SUCCESS;
+
+        hb_mc_swmodel_write32(ep, sym[HB_MC_SWMODEL_CUDA_KERNEL_PTR], not_loaded);
+
+        if (hb_mc_swmodel_read32(ep, sym[HB_MC_SWMODEL_CUDA_X]) != 0 ||
+            hb_mc_swmodel_read32(ep, sym[HB_MC_SWMODEL_CUDA_Y]) != 0)
+                return HB_MC_SUCCESS;
+
+        // translate the finish signal address as the tile would. The
+        // host is outside the tile array, so it is addressed with a
+        // global EVA, which hb_mc_eva_to_npa() only accepts for tiles.
+        hb_mc_coordinate_t tile = hb_mc_coordinate(x, y);
+        hb_mc_eva_t eva = hb_mc_swmodel_read32(ep, sym[HB_MC_SWMODEL_CUDA_FINISH_SIGNAL_ADDR]);
+        hb_mc_npa_t npa;
+        size_t sz;
+
+        if (eva & (1u << HB_MC_SWMODEL_GLOBAL_BITIDX)) {
+                npa = hb_mc_npa_from_x_y((eva >> HB_MC_SWMODEL_GLOBAL_X_BITIDX) & HB_MC_SWMODEL_GLOBAL_COORD_MASK,
+                                         (eva >> HB_MC_SWMODEL_GLOBAL_Y_BITIDX) & HB_MC_SWMODEL_GLOBAL_COORD_MASK,
+                                         eva & ((1u << HB_MC_GLOBAL_EPA_LOGSZ) - 1));
+                err = HB_MC_SUCCESS;
+        } else {
+                hb_mc_eva_map_t map;
+                err = hb_mc_origin_eva_map_init(&map, tile);
+                if (err != HB_MC_SUCCESS)
+                        return err;
+
+                err = hb_mc_eva_to_npa(mc, &map, &tile, &eva, &npa, &sz);
+                int exit_err = hb_mc_origin_eva_map_exit(&map);
+                if (err == HB_MC_SUCCESS && exit_err != HB_MC_SUCCESS)
+                        return exit_err;
+        }
+
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: (x: %d, y: %d) has a bad finish signal address 0x%08" PRIx32 "\n",
+                                __func__, x, y, eva);
+                return err;
+        }
+
+        hb_mc_packet_t finish = {};
+        hb_mc_request_packet_set_x_dst(&finish.request, hb_mc_npa_get_x(&npa));
+        hb_mc_request_packet_set_y_dst(&finish.request, hb_mc_npa_get_y(&npa));
+        hb_mc_request_packet_set_x_src(&finish.request, x);
+        hb_mc_request_packet_set_y_src(&finish.request, y);
+        hb_mc_request_packet_set_op(&finish.request, HB_MC_PACKET_OP_REMOTE_SW);
+        hb_mc_request_packet_set_mask(&finish.request, HB_MC_PACKET_REQUEST_MASK_WORD);
+        hb_mc_request_packet_set_epa(&finish.request, hb_mc_npa_get_epa(&npa));
+        hb_mc_request_packet_set_data(&finish.request,
+                                      hb_mc_swmodel_read32(ep, sym[HB_MC_SWMODEL_CUDA_FINISH_SIGNAL_VAL]));
+
+        if (hb_mc_coordinate_eq(hb_mc_npa_get_xy(&npa),
+                                hb_mc_config_get_host_interface(&platform->cfg))) {
+                platform->rx_req.push_back(finish);
+                return HB_MC_SUCCESS;
+        }
+
+        return hb_mc_swmodel_execute(mc, &finish.request);
+}
+
+/**
+ * Execute a request packet at its destination
+ * @param[in] mc    A manycore instance
+ * @param[in] rqst  A request packet
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+static int hb_mc_swmodel_execute(hb_mc_manycore_t *mc, const hb_mc_request_packet_t *rqst)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        hb_mc_idx_t x = hb_mc_request_packet_get_x_dst(rqst);
+        hb_mc_idx_t y = hb_mc_request_packet_get_y_dst(rqst);
+        hb_mc_epa_t epa = hb_mc_request_packet_get_epa(rqst);
+        uint32_t data = hb_mc_request_packet_get_data(rqst);
+        uint8_t op = hb_mc_request_packet_get_op(rqst);
+
+        platform->cycle++;
+
+        hb_mc_swmodel_endpoint_t *ep = hb_mc_swmodel_endpoint(platform, x, y);
+        if (ep == nullptr) {
+                manycore_pr_err(mc, "%s: No endpoint at (x: %d, y: %d); dropping packet\n",
+                                __func__, x, y);
+                return HB_MC_INVALID;
+        }
+
+        switch (op) {
+        case HB_MC_PACKET_OP_REMOTE_SW:
+                hb_mc_swmodel_write32(ep, epa, data);
+                return hb_mc_swmodel_cuda_kernel_run(mc, ep, x, y, epa);
+
+        case HB_MC_PACKET_OP_REMOTE_STORE: {
+                // The data is already in its byte lanes; write only
+                // the lanes that are set in the mask.
+                uint8_t mask = hb_mc_request_packet_get_mask(rqst);
+                for (int b = 0; b < 4; b++) {
+                        if (mask & (1 << b)) {
+                                uint8_t v = (data >> (CHAR_BIT * b)) & 0xFF;
+                                hb_mc_swmodel_write(ep, epa + b, &v, sizeof(v));
+                        }
+                }
+                return hb_mc_swmodel_cuda_kernel_run(mc, ep, x, y, epa);
+        }
+
+        case HB_MC_PACKET_OP_CACHE_OP:
+                if (ep->type != HB_MC_SWMODEL_ENDPOINT_VCACHE) {
+                        manycore_pr_err(mc, "%s: Cache operation sent to a tile at (x: %d, y: %d)\n",
+                                        __func__, x, y);
+                        return HB_MC_INVALID;
+                }
+                // DRAM is never cached, so there is nothing to flush
+                // or invalidate.
+                return HB_MC_SUCCESS;
+
+        case HB_MC_PACKET_OP_REMOTE_LOAD: {
+                hb_mc_request_packet_load_info_t info = hb_mc_request_packet_get_load_info(rqst);
+                uint32_t v = hb_mc_swmodel_read32(ep, epa) >> (CHAR_BIT * info.part_sel);
+                if (info.is_byte_op)
+                        v = info.is_unsigned_op ? (v & 0xFF) : static_cast<uint32_t>(static_cast<int8_t>(v));
+                else if (info.is_hex_op)
+                        v = info.is_unsigned_op ? (v & 0xFFFF) : static_cast<uint32_t>(static_cast<int16_t>(v));
+                data = v;
+                break;
+        }
+
+        case HB_MC_PACKET_OP_REMOTE_AMOSWAP:
+        case HB_MC_PACKET_OP_REMOTE_AMOADD:
+        case HB_MC_PACKET_OP_REMOTE_AMOXOR:
+        case HB_MC_PACKET_OP_REMOTE_AMOAND:
+        case HB_MC_PACKET_OP_REMOTE_AMOOR:
+        case HB_MC_PACKET_OP_REMOTE_AMOMIN:
+        case HB_MC_PACKET_OP_REMOTE_AMOMAX:
+        case HB_MC_PACKET_OP_REMOTE_AMOMINU:
+        case HB_MC_PACKET_OP_REMOTE_AMOMAXU: {
+                uint32_t v, old = hb_mc_swmodel_read32(ep, epa);
+                switch (op) {
+                case HB_MC_PACKET_OP_REMOTE_AMOSWAP: v = data; break;
+                case HB_MC_PACKET_OP_REMOTE_AMOADD:  v = old + data; break;
+                case HB_MC_PACKET_OP_REMOTE_AMOXOR:  v = old ^ data; break;
+                case HB_MC_PACKET_OP_REMOTE_AMOAND:  v = old & data; break;
+                case HB_MC_PACKET_OP_REMOTE_AMOOR:   v = old | data; break;
+                case HB_MC_PACKET_OP_REMOTE_AMOMIN:
+                        v = std::min(static_cast<int32_t>(old), static_cast<int32_t>(data));
+                        break;
+                case HB_MC_PACKET_OP_REMOTE_AMOMAX:
+                        v = std::max(static_cast<int32_t>(old), static_cast<int32_t>(data));
+                        break;
+                case HB_MC_PACKET_OP_REMOTE_AMOMINU: v = std::min(old, data); break;
+                default:                             v = std::max(old, data); break;
+                }
+                hb_mc_swmodel_write32(ep, epa, v);
+                data = old;
+                break;
+        }
+
+        default:
+                manycore_pr_err(mc, "%s: Unsupported packet op %d\n", __func__, op);
+                return HB_MC_NOIMPL;
+        }
+
+        // Loads and atomics return a response to the sender
+        hb_mc_packet_t rsp = {};
+        hb_mc_response_packet_fill(&rsp.response, rqst);
+        hb_mc_response_packet_set_data(&rsp.response, data);
+        platform->rx_rsp.push_back(rsp);
+        platform->rsp_in_flight = true;
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Clean up the runtime platform
+ * @param[in] mc    A manycore to clean up
+ */
+void hb_mc_platform_cleanup(hb_mc_manycore_t *mc)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+
+        // Remove the key
+        auto key = active_ids.find(platform->id);
+        active_ids.erase(key);
+
+        delete platform;
+        mc->platform = nullptr;
+
+        return;
+}
+
+/**
+ * Initialize the runtime platform
+ * @param[in] mc    A manycore to initialize
+ * @param[in] id    ID which selects the physical hardware from which this manycore is configured
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_platform_init(hb_mc_manycore_t *mc, hb_mc_manycore_id_t id)
+{
+        int err;
+
+        // check if mc is already initialized
+        if (mc->platform)
+                return HB_MC_INITIALIZED_TWICE;
+
+        if (id != 0) {
+                manycore_pr_err(mc, "Failed to init platform: invalid ID\n");
+                return HB_MC_INVALID;
+        }
+
+        // Check if the ID has already been initialized
+        if(active_ids.find(id) != active_ids.end()){
+                manycore_pr_err(mc, "Already initialized ID\n");
+                return HB_MC_INVALID;
+        }
+
+        hb_mc_platform_t *platform = new hb_mc_platform_t;
+        platform->id = id;
+        platform->cycle = 0;
+        platform->rsp_in_flight = false;
+
+        err = hb_mc_swmodel_rom_read(mc, platform->rom);
+        if (err != HB_MC_SUCCESS) {
+                delete platform;
+                return err;
+        }
+
+        err = hb_mc_config_init(platform->rom, &platform->cfg);
+        if (err != HB_MC_SUCCESS) {
+                manycore_pr_err(mc, "%s: Failed to parse configuration ROM: %s\n",
+                                __func__, hb_mc_strerror(err));
+                delete platform;
+                return err;
+        }
+
+        hb_mc_swmodel_endpoints_init(platform);
+
+        active_ids.insert(id);
+        mc->platform = reinterpret_cast<void *>(platform);
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Transmit a packet to manycore hardware
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] request A request packet to transmit to manycore hardware
+ * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_transmit(hb_mc_manycore_t *mc,
+                            hb_mc_packet_t *packet,
+                            hb_mc_fifo_tx_t type,
+                            long timeout)
+{
+        if (type == HB_MC_FIFO_TX_RSP) {
+                manycore_pr_err(mc, "TX Response Not Supported!\n");
+                return HB_MC_NOIMPL;
+        }
+
+        return hb_mc_swmodel_execute(mc, &packet->request);
+}
+
+/**
+ * Receive a packet from manycore hardware
+ * @param[in] mc       A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] response A packet into which data should be read
+ * @param[in] timeout  Set to -1 to wait forever, or to 0 to return HB_MC_BUSY if no packet is waiting.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_receive(hb_mc_manycore_t *mc,
+                           hb_mc_packet_t *packet,
+                           hb_mc_fifo_rx_t type,
+                           long timeout)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        std::deque<hb_mc_packet_t> *fifo;
+
+        switch(type){
+        case HB_MC_FIFO_RX_REQ:
+                fifo = &platform->rx_req;
+                break;
+        case HB_MC_FIFO_RX_RSP:
+                fifo = &platform->rx_rsp;
+                break;
+        default:
+                manycore_pr_err(mc, "%s: Unknown packet type\n", __func__);
+                return HB_MC_NOIMPL;
+        }
+
+        if (timeout != -1 && timeout != 0) {
+                manycore_pr_err(mc, "%s: Only a timeout value of -1 or 0 is supported\n",
+                                __func__);
+                return HB_MC_INVALID;
+        }
+
+        // Responses that were just queued have not arrived for a poll.
+        if (type == HB_MC_FIFO_RX_RSP && platform->rsp_in_flight) {
+                platform->rsp_in_flight = false;
+                if (timeout == 0)
+                        return HB_MC_BUSY;
+        }
+
+        // Another host thread may still send the request that fills
+        // the FIFO, so a poll just reports that it is empty.
+        if (fifo->empty() && timeout == 0)
+                return HB_MC_BUSY;
+
+        // Everything is executed synchronously, so an empty FIFO will
+        // stay empty. Report it instead of waiting forever.
+        if (fifo->empty()) {
+                if (type == HB_MC_FIFO_RX_REQ)
+                        manycore_pr_err(mc, "%s: No request packets from the manycore. "
+                                        "Tiles only finish CUDA-lite kernels on this platform.\n",
+                                        __func__);
+                else
+                        manycore_pr_err(mc, "%s: No outstanding responses\n", __func__);
+                return HB_MC_TIMEOUT;
+        }
+
+        // responses are returned out of order, as from different destinations
+        if (type == HB_MC_FIFO_RX_RSP) {
+                *packet = fifo->back();
+                fifo->pop_back();
+        } else {
+                *packet = fifo->front();
+                fifo->pop_front();
+        }
+        platform->cycle++;
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Transmit a vector of packets to manycore hardware
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] packets A vector of request packets to transmit to manycore hardware
+ * @param[in] count   The number of packets in #packets
+ * @param[in] type    Is this a vector of request or response packets?
+ * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @return HB_MC_SUCCESS if all packets were sent. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_transmit_batch(hb_mc_manycore_t *mc,
+                                  hb_mc_packet_t *packets,
+                                  size_t count,
+                                  hb_mc_fifo_tx_t type,
+                                  long timeout)
+{
+        int err;
+
+        if (type == HB_MC_FIFO_TX_RSP) {
+                manycore_pr_err(mc, "TX Response Not Supported!\n");
+                return HB_MC_NOIMPL;
+        }
+
+        for (size_t p = 0; p < count; p++) {
+                err = hb_mc_swmodel_execute(mc, &packets[p].request);
+                if (err != HB_MC_SUCCESS) {
+                        manycore_pr_err(mc, "%s: Failed to transmit packet %zu of %zu: %s\n",
+                                        __func__, p, count, hb_mc_strerror(err));
+                        return err;
+                }
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Read the configuration register at an index
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  idx    Configuration register index to access
+ * @param[out] config Configuration value at index
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_get_config_at(hb_mc_manycore_t *mc,
+                                 unsigned int idx,
+                                 hb_mc_config_raw_t *config)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+
+        if(idx < HB_MC_CONFIG_MAX){
+                *config = platform->rom[idx];
+                return HB_MC_SUCCESS;
+        }
+
+        return HB_MC_INVALID;
+}
+
+/**
+ * Stall until the all requests (and responses) have reached their destination.
+ * @param[in] mc      A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] timeout A timeout counter. Unused - set to -1 to wait forever.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_fence(hb_mc_manycore_t *mc, long timeout)
+{
+        // Requests are executed when they are transmitted, so there
+        // is never anything in flight.
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Signal the hardware to start a bulk transfer over the network
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_start_bulk_transfer(hb_mc_manycore_t *mc)
+{
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Signal the hardware to end a bulk transfer over the network
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_finish_bulk_transfer(hb_mc_manycore_t *mc)
+{
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get the current cycle counter of the Manycore Platform
+ *
+ * The software model advances its counter by one for every packet
+ * that crosses the host interface.
+ *
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[out] time   The current counter value.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_get_cycle(hb_mc_manycore_t *mc, uint64_t *time)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+
+        *time = platform->cycle;
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Get the number of instructions executed for a certain class of instructions
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] itype An enum defining the class of instructions to query.
+ * @param[out] count The number of instructions executed in the queried class.
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_get_icount(hb_mc_manycore_t *mc, bsg_instr_type_e itype, int *count)
+{
+        return HB_MC_NOIMPL;
+}
+
+/**
+ * Enable trace file generation (vanilla_operation_trace.csv)
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_trace_enable(hb_mc_manycore_t *mc)
+{
+        return HB_MC_NOIMPL;
+}
+
+/**
+ * Disable trace file generation (vanilla_operation_trace.csv)
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_trace_disable(hb_mc_manycore_t *mc)
+{
+        return HB_MC_NOIMPL;
+}
+
+/**
+ * Enable log file generation (vanilla.log)
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_log_enable(hb_mc_manycore_t *mc)
+{
+        return HB_MC_NOIMPL;
+}
+
+/**
+ * Disable log file generation (vanilla.log)
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_log_disable(hb_mc_manycore_t *mc)
+{
+        return HB_MC_NOIMPL;
+}
+
+/**
+ * Check if chip reset has completed.
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_wait_reset_done(hb_mc_manycore_t *mc)
+{
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Record where a program keeps its CUDA-lite runtime symbols
+ *
+ * A program without all of them is not CUDA-lite, and stores to its
+ * tiles never launch a kernel.
+ *
+ * @param[in] mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] bin    A memory buffer containing the manycore binary that was loaded
+ * @param[in] sz     Size of #bin in bytes
+ * @param[in] tiles  The tiles that #bin was loaded onto
+ * @param[in] ntiles The number of tiles in #tiles
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_platform_program_loaded(hb_mc_manycore_t *mc,
+                                  const void *bin, size_t sz,
+                                  const hb_mc_coordinate_t *tiles,
+                                  uint32_t ntiles)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        hb_mc_loader_symbol_table_t *symbols;
+        hb_mc_epa_t epa[HB_MC_SWMODEL_CUDA_SYMBOLS];
+        bool cuda = true;
+        int err;
+
+        err = hb_mc_loader_symbol_table_init(bin, sz, &symbols);
+        if (err != HB_MC_SUCCESS)
+                return err;
+
+        // runtime symbols live in DMEM
+        size_t dmem_size = hb_mc_config_get_dmem_size(&platform->cfg);
+        for (int i = 0; i < HB_MC_SWMODEL_CUDA_SYMBOLS && cuda; i++) {
+                hb_mc_eva_t eva = 0;
+                cuda = hb_mc_loader_symbol_table_lookup(symbols, hb_mc_swmodel_cuda_symbol_names[i],
+                                                        &eva) == HB_MC_SUCCESS
+                        && eva - HB_MC_TILE_EVA_DMEM_BASE + sizeof(uint32_t) <= dmem_size;
+                epa[i] = eva - HB_MC_TILE_EVA_DMEM_BASE + HB_MC_TILE_EPA_DMEM_BASE;
+        }
+
+        hb_mc_loader_symbol_table_cleanup(symbols);
+
+        for (uint32_t t = 0; t < ntiles; t++) {
+                hb_mc_swmodel_endpoint_t *ep = hb_mc_swmodel_endpoint(platform, tiles[t].x, tiles[t].y);
+                if (ep == nullptr || ep->type != HB_MC_SWMODEL_ENDPOINT_TILE)
+                        return HB_MC_INVALID;
+
+                ep->cuda = cuda;
+                memcpy(ep->cuda_epa, epa, sizeof(epa));
+        }
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Write memory out to manycore DRAM via DMA
+ *
+ * The model has no DRAM behind its caches, so this writes the
+ * cache's address space directly.
+ *
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t - must be an L2 cache coordinate
+ * @param[in]  data   A host buffer to be written out manycore hardware
+ * @param[in]  sz     The number of bytes to write to manycore hardware
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_dma_write(hb_mc_manycore_t *mc,
+                    const hb_mc_npa_t *npa,
+                    const void *data, size_t sz)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        hb_mc_swmodel_endpoint_t *ep =
+                hb_mc_swmodel_endpoint(platform, hb_mc_npa_get_x(npa), hb_mc_npa_get_y(npa));
+
+        if (ep == nullptr || ep->type != HB_MC_SWMODEL_ENDPOINT_VCACHE) {
+                manycore_pr_err(mc, "%s: (x: %d, y: %d) is not a DRAM bank\n",
+                                __func__, hb_mc_npa_get_x(npa), hb_mc_npa_get_y(npa));
+                return HB_MC_INVALID;
+        }
+
+        hb_mc_swmodel_write(ep, hb_mc_npa_get_epa(npa), data, sz);
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Read memory from manycore DRAM via DMA
+ * @param[in]  mc     A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in]  npa    A valid hb_mc_npa_t - must be an L2 cache coordinate
+ * @param[in]  data   A host buffer to be read into from manycore hardware
+ * @param[in]  sz     The number of bytes to read from manycore hardware
+ * @return HB_MC_FAIL if an error occured. HB_MC_SUCCESS otherwise.
+ */
+int hb_mc_dma_read(hb_mc_manycore_t *mc,
+                   const hb_mc_npa_t *npa,
+                   void *data, size_t sz)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+        hb_mc_swmodel_endpoint_t *ep =
+                hb_mc_swmodel_endpoint(platform, hb_mc_npa_get_x(npa), hb_mc_npa_get_y(npa));
+
+        if (ep == nullptr || ep->type != HB_MC_SWMODEL_ENDPOINT_VCACHE) {
+                manycore_pr_err(mc, "%s: (x: %d, y: %d) is not a DRAM bank\n",
+                                __func__, hb_mc_npa_get_x(npa), hb_mc_npa_get_y(npa));
+                return HB_MC_INVALID;
+        }
+
+        hb_mc_swmodel_read(ep, hb_mc_npa_get_epa(npa), data, sz);
+
+        return HB_MC_SUCCESS;
+}
+
+/**
+ * Inject a request packet from a tile into the host's request FIFO.
+ * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+ * @param[in] rqst  A request packet whose destination is the host interface
+ * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+ */
+int hb_mc_software_model_send_request(hb_mc_manycore_t *mc,
+                                      const hb_mc_request_packet_t *rqst)
+{
+        hb_mc_platform_t *platform = reinterpret_cast<hb_mc_platform_t *>(mc->platform);
+
+        if (platform == nullptr)
+                return HB_MC_UNINITIALIZED;
+
+        hb_mc_coordinate_t host = hb_mc_config_get_host_interface(&platform->cfg);
+
+        if (hb_mc_request_packet_get_x_dst(rqst) != host.x ||
+            hb_mc_request_packet_get_y_dst(rqst) != host.y) {
+                manycore_pr_err(mc, "%s: Packet is not addressed to the host interface\n",
+                                __func__);
+                return HB_MC_INVALID;
+        }
+
+        hb_mc_packet_t pkt = {};
+        pkt.request = *rqst;
+        platform->rx_req.push_back(pkt);
+
+        return HB_MC_SUCCESS;
+}
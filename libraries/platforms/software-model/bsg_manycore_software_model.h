@@ -0,0 +1,62 @@
+// Copyright (c) 2019, University of Washington All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// Redistributions of source code must retain the above copyright notice, this list
+// of conditions and the following disclaimer.
+// 
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// 
+// Neither the name of the copyright holder nor the names of its contributors may
+// be used to endorse or promote products derived from this software without
+// specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BSG_MANYCORE_SOFTWARE_MODEL_H
+#define BSG_MANYCORE_SOFTWARE_MODEL_H
+
+#include <bsg_manycore_features.h>
+#include <bsg_manycore.h>
+#include <bsg_manycore_packet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+        /**
+         * Inject a request packet from a tile into the host's request FIFO.
+         *
+         * The software model does not execute RISC-V code on its
+         * tiles. It sends the finish packet of a CUDA-lite kernel
+         * itself, but nothing on the manycore side will ever send a
+         * fail or print packet, or finish a program that is not
+         * CUDA-lite. Tests and benchmarks that need those packets use
+         * this function to play the part of the tiles. The packet
+         * is delivered by the next call to hb_mc_platform_receive()
+         * on HB_MC_FIFO_RX_REQ.
+         *
+         * @param[in] mc    A manycore instance initialized with hb_mc_manycore_init()
+         * @param[in] rqst  A request packet whose destination is the host interface
+         * @return HB_MC_SUCCESS on success. Otherwise an error code defined in bsg_manycore_errno.h.
+         */
+        __attribute__((warn_unused_result))
+        int hb_mc_software_model_send_request(hb_mc_manycore_t *mc,
+                                              const hb_mc_request_packet_t *rqst);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
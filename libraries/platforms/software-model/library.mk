@@ -0,0 +1,83 @@
+# Copyright (c) 2019, University of Washington All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+# 
+# Redistributions of source code must retain the above copyright notice, this list
+# of conditions and the following disclaimer.
+# 
+# Redistributions in binary form must reproduce the above copyright notice, this
+# list of conditions and the following disclaimer in the documentation and/or
+# other materials provided with the distribution.
+# 
+# Neither the name of the copyright holder nor the names of its contributors may
+# be used to endorse or promote products derived from this software without
+# specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# The software-model platform is a functional C++ model of the
+# manycore. It needs no simulator and no FPGA; see
+# bsg_manycore_platform.cpp for what is (and is not) modelled.
+PLATFORM_CXXSOURCES += $(LIBRARIES_PATH)/platforms/software-model/bsg_manycore_platform.cpp
+
+# The model defines its own hb_mc_dma_read/hb_mc_dma_write, which
+# override the weak definitions in the noimpl fragment.
+include $(LIBRARIES_PATH)/features/dma/noimpl/feature.mk
+
+PLATFORM_OBJECTS += $(patsubst %cpp,%o,$(PLATFORM_CXXSOURCES))
+PLATFORM_OBJECTS += $(patsubst %c,%o,$(PLATFORM_CSOURCES))
+
+$(PLATFORM_OBJECTS): INCLUDES := -I$(LIBRARIES_PATH)
+$(PLATFORM_OBJECTS): INCLUDES += -I$(LIBRARIES_PATH)/platforms/software-model
+$(PLATFORM_OBJECTS): INCLUDES += -I$(LIBRARIES_PATH)/features/dma
+$(PLATFORM_OBJECTS): INCLUDES += -I$(LIBRARIES_PATH)/features/profiler
+$(PLATFORM_OBJECTS): INCLUDES += -I$(LIBRARIES_PATH)/features/tracer
+
+# The model reads the configuration ROM of the machine it models when
+# it is initialized, not when it is compiled. execution.mk makes sure
+# the ROM exists.
+$(PLATFORM_OBJECTS): DEFINES  := -DHB_MC_SOFTWARE_MODEL_ROM=\"$(BSG_MACHINE_PATH)/bsg_bladerunner_configuration.rom\"
+$(PLATFORM_OBJECTS): CFLAGS   := -std=c11 -fPIC -D_GNU_SOURCE -D_BSD_SOURCE -D_DEFAULT_SOURCE $(DEFINES) $(INCLUDES)
+$(PLATFORM_OBJECTS): CXXFLAGS := -std=c++11 -fPIC -D_GNU_SOURCE -D_BSD_SOURCE -D_DEFAULT_SOURCE $(DEFINES) $(INCLUDES)
+
+$(BSG_PLATFORM_PATH)/libbsg_manycore_runtime.so.1.0: $(PLATFORM_OBJECTS)
+
+# Mirror the extensions linux installation in /usr/lib provides so
+# that we can use -lbsg_manycore_runtime
+$(BSG_PLATFORM_PATH)/libbsg_manycore_runtime.so.1: %: %.0
+	ln -sf $@.0 $@
+
+$(BSG_PLATFORM_PATH)/libbsgmc_cuda_legacy_pod_repl.so.1: %: %.0
+	ln -sf $@.0 $@
+
+$(BSG_PLATFORM_PATH)/libbsg_manycore_regression.so.1: %: %.0
+	ln -sf $@.0 $@
+
+$(BSG_PLATFORM_PATH)/libbsg_manycore_runtime.so: %: %.1
+	ln -sf $@.1 $@
+
+$(BSG_PLATFORM_PATH)/libbsgmc_cuda_legacy_pod_repl.so: %: %.1
+	ln -sf $@.1 $@
+
+$(BSG_PLATFORM_PATH)/libbsg_manycore_regression.so: %: %.1
+	ln -sf $@.1 $@
+
+.PHONY: platform.clean
+platform.clean:
+	rm -f $(PLATFORM_OBJECTS)
+	rm -f $(BSG_PLATFORM_PATH)/libbsg_manycore_runtime.so
+	rm -f $(BSG_PLATFORM_PATH)/libbsg_manycore_runtime.so.1
+	rm -f $(BSG_PLATFORM_PATH)/libbsg_manycore_regression.so*
+	rm -f $(BSG_PLATFORM_PATH)/libbsgmc_cuda_legacy_pod_repl.so*
+
+libraries.clean: platform.clean
@@ -39,7 +39,8 @@ endif
 
 # BSG_PLATFORM defines the platform to run or simulate on while
 # running examples/regression. Current options are aws-vcs and
-# dpi-verilator for simulation, and aws-fpga for emulation.
+# dpi-verilator for simulation, aws-fpga for emulation, and
+# software-model for a functional model that needs neither.
 
 # We default to simulating the AWS machine uinsg Synopsys VCS-MX,
 # HOWEVER, if VCS_HOME is not defined then we will assume that